@@ -0,0 +1,132 @@
+﻿
+#include "base/mapped_file.hpp"
+
+#include <algorithm>
+#if OS_WIN
+#define NOGDI
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+#include "glog/logging.h"
+
+namespace principia {
+namespace base {
+namespace internal_mapped_file {
+
+namespace {
+
+// The file grows by at least this many bytes, and the mapped size is a
+// multiple of it.  This is the allocation granularity on Windows, and a
+// multiple of the page size elsewhere.
+std::int64_t const granularity = 1 << 16;
+
+}  // namespace
+
+MappedFile::MappedFile(std::experimental::filesystem::path const& path)
+    : path_(path) {
+#if OS_WIN
+  file_ = CreateFileW(path_.c_str(),
+                      GENERIC_READ | GENERIC_WRITE,
+                      /*dwShareMode=*/0,
+                      /*lpSecurityAttributes=*/nullptr,
+                      CREATE_ALWAYS,
+                      FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE,
+                      /*hTemplateFile=*/nullptr);
+  CHECK(file_ != INVALID_HANDLE_VALUE)
+      << path_ << ": error " << GetLastError();
+#else
+  file_ = open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+  CHECK_NE(-1, file_) << path_ << ": " << std::strerror(errno);
+#endif
+}
+
+MappedFile::~MappedFile() {
+  Unmap();
+#if OS_WIN
+  // The file is deleted on close.
+  CloseHandle(file_);
+#else
+  close(file_);
+  std::experimental::filesystem::remove(path_);
+#endif
+}
+
+void MappedFile::Reserve(std::int64_t const size) {
+  if (size <= capacity_) {
+    return;
+  }
+  std::int64_t const new_capacity =
+      (std::max(size, 2 * capacity_) + granularity - 1) / granularity *
+      granularity;
+  Unmap();
+  capacity_ = new_capacity;
+#if !OS_WIN
+  // On Windows, creating the mapping extends the file.
+  CHECK_EQ(0, ftruncate(file_, capacity_))
+      << path_ << ": " << std::strerror(errno);
+#endif
+  Map();
+}
+
+std::int64_t MappedFile::capacity() const {
+  return capacity_;
+}
+
+std::uint8_t* MappedFile::data() {
+  return data_;
+}
+
+std::uint8_t const* MappedFile::data() const {
+  return data_;
+}
+
+void MappedFile::Map() {
+#if OS_WIN
+  mapping_ = CreateFileMappingW(file_,
+                                /*lpFileMappingAttributes=*/nullptr,
+                                PAGE_READWRITE,
+                                static_cast<DWORD>(capacity_ >> 32),
+                                static_cast<DWORD>(capacity_),
+                                /*lpName=*/nullptr);
+  CHECK(mapping_ != nullptr) << path_ << ": error " << GetLastError();
+  data_ = static_cast<std::uint8_t*>(MapViewOfFile(mapping_,
+                                                   FILE_MAP_ALL_ACCESS,
+                                                   /*dwFileOffsetHigh=*/0,
+                                                   /*dwFileOffsetLow=*/0,
+                                                   capacity_));
+  CHECK(data_ != nullptr) << path_ << ": error " << GetLastError();
+#else
+  void* const data = mmap(/*addr=*/nullptr,
+                          capacity_,
+                          PROT_READ | PROT_WRITE,
+                          MAP_SHARED,
+                          file_,
+                          /*offset=*/0);
+  CHECK(data != MAP_FAILED) << path_ << ": " << std::strerror(errno);
+  data_ = static_cast<std::uint8_t*>(data);
+#endif
+}
+
+void MappedFile::Unmap() {
+  if (data_ == nullptr) {
+    return;
+  }
+#if OS_WIN
+  UnmapViewOfFile(data_);
+  CloseHandle(mapping_);
+  mapping_ = nullptr;
+#else
+  munmap(data_, capacity_);
+#endif
+  data_ = nullptr;
+}
+
+}  // namespace internal_mapped_file
+}  // namespace base
+}  // namespace principia
@@ -0,0 +1,60 @@
+﻿
+#pragma once
+
+#include <cstdint>
+#include <experimental/filesystem>
+
+#include "base/macros.hpp"
+
+namespace principia {
+namespace base {
+namespace internal_mapped_file {
+
+// A file mapped in memory for reading and writing, used as a scratch store for
+// data that we don't want to keep in RAM: the operating system pages the data
+// in and out as needed.  The file is created (or truncated) by the constructor
+// and deleted by the destructor.  Not thread-safe.
+class MappedFile final {
+ public:
+  explicit MappedFile(std::experimental::filesystem::path const& path);
+  ~MappedFile();
+
+  MappedFile(MappedFile const&) = delete;
+  MappedFile(MappedFile&&) = delete;
+  MappedFile& operator=(MappedFile const&) = delete;
+  MappedFile& operator=(MappedFile&&) = delete;
+
+  // Ensures that at least |size| bytes are mapped.  This may remap the file,
+  // in which case the pointers previously returned by |data| are invalidated.
+  // The new bytes are zero.
+  void Reserve(std::int64_t size);
+
+  // The number of bytes mapped.
+  std::int64_t capacity() const;
+
+  // Null if |capacity()| is 0.
+  std::uint8_t* data();
+  std::uint8_t const* data() const;
+
+ private:
+  void Map();
+  void Unmap();
+
+  std::experimental::filesystem::path const path_;
+  std::int64_t capacity_ = 0;
+  std::uint8_t* data_ = nullptr;
+#if OS_WIN
+  // Windows |HANDLE|s.
+  void* file_ = nullptr;
+  void* mapping_ = nullptr;
+#else
+  int file_ = -1;
+#endif
+};
+
+}  // namespace internal_mapped_file
+
+using internal_mapped_file::MappedFile;
+
+}  // namespace base
+}  // namespace principia
@@ -0,0 +1,59 @@
+﻿
+#include "base/mapped_file.hpp"
+
+#include <cstdint>
+#include <experimental/filesystem>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace principia {
+namespace base {
+
+class MappedFileTest : public ::testing::Test {
+ protected:
+  MappedFileTest()
+      : path_(std::string(::testing::UnitTest::GetInstance()->
+                              current_test_info()->name()) + ".mapped") {}
+
+  std::experimental::filesystem::path const path_;
+};
+
+TEST_F(MappedFileTest, Reserve) {
+  {
+    MappedFile file(path_);
+    EXPECT_TRUE(std::experimental::filesystem::exists(path_));
+    EXPECT_EQ(0, file.capacity());
+    EXPECT_EQ(nullptr, file.data());
+
+    file.Reserve(10);
+    EXPECT_LE(10, file.capacity());
+    std::int64_t const capacity = file.capacity();
+    for (int i = 0; i < 10; ++i) {
+      file.data()[i] = i;
+    }
+
+    // No remapping if the capacity is sufficient.
+    std::uint8_t const* const data = file.data();
+    file.Reserve(capacity);
+    EXPECT_EQ(capacity, file.capacity());
+    EXPECT_EQ(data, file.data());
+
+    // The data survive remapping and the new bytes are zero.
+    file.Reserve(3 * capacity + 1);
+    EXPECT_LE(3 * capacity + 1, file.capacity());
+    for (int i = 0; i < 10; ++i) {
+      EXPECT_EQ(i, file.data()[i]);
+    }
+    for (std::int64_t i = 10; i < file.capacity(); i += 4096) {
+      EXPECT_EQ(0, file.data()[i]);
+    }
+    file.data()[file.capacity() - 1] = 42;
+    EXPECT_EQ(42, file.data()[file.capacity() - 1]);
+  }
+  EXPECT_FALSE(std::experimental::filesystem::exists(path_));
+}
+
+}  // namespace base
+}  // namespace principia
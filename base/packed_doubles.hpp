@@ -0,0 +1,52 @@
+﻿
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace principia {
+namespace base {
+namespace internal_packed_doubles {
+
+// Compact and exact encodings of sequences of doubles, meant for the columns of
+// serialized time series.  The encodings are independent of the endianness of
+// the machine.  The decoding functions return the |size| values encoded in
+// |bytes|, and check that |bytes| is well-formed.
+
+// Each value is written as 8 little-endian bytes.
+inline void EncodeRawDoubles(std::vector<double> const& values,
+                             std::string& bytes);
+inline std::vector<double> DecodeRawDoubles(std::string const& bytes,
+                                            int size);
+
+// Each value is XORed with the previous one and only the meaningful bits of the
+// result are written, as in the Gorilla time series database (Pelkonen et al.,
+// 2015).  Compact for values that are often repeated or that share their
+// high-order bits; of little use if all the bits of the mantissa change from
+// one value to the next.
+inline void EncodeXorDoubles(std::vector<double> const& values,
+                             std::string& bytes);
+inline std::vector<double> DecodeXorDoubles(std::string const& bytes,
+                                            int size);
+
+// The second differences of the bit patterns of the values are written as
+// zig-zag varints.  Compact for monotonic, nearly equally spaced values, such
+// as the times of a trajectory.
+inline void EncodeDeltaOfDeltaDoubles(std::vector<double> const& values,
+                                      std::string& bytes);
+inline std::vector<double> DecodeDeltaOfDeltaDoubles(std::string const& bytes,
+                                                     int size);
+
+}  // namespace internal_packed_doubles
+
+using internal_packed_doubles::DecodeDeltaOfDeltaDoubles;
+using internal_packed_doubles::DecodeRawDoubles;
+using internal_packed_doubles::DecodeXorDoubles;
+using internal_packed_doubles::EncodeDeltaOfDeltaDoubles;
+using internal_packed_doubles::EncodeRawDoubles;
+using internal_packed_doubles::EncodeXorDoubles;
+
+}  // namespace base
+}  // namespace principia
+
+#include "base/packed_doubles_body.hpp"
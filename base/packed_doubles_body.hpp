@@ -0,0 +1,297 @@
+﻿
+#pragma once
+
+#include "base/packed_doubles.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "base/macros.hpp"
+#include "glog/logging.h"
+
+#if PRINCIPIA_COMPILER_MSVC
+#include <intrin.h>
+#endif
+
+namespace principia {
+namespace base {
+namespace internal_packed_doubles {
+
+inline std::uint64_t ToBits(double const value) {
+  std::uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+inline double FromBits(std::uint64_t const bits) {
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// |x| must not be 0.
+inline int CountLeadingZeros(std::uint64_t const x) {
+#if PRINCIPIA_COMPILER_MSVC
+  unsigned long index;  // NOLINT(runtime/int)
+  _BitScanReverse64(&index, x);
+  return 63 - index;
+#else
+  return __builtin_clzll(x);
+#endif
+}
+
+// |x| must not be 0.
+inline int CountTrailingZeros(std::uint64_t const x) {
+#if PRINCIPIA_COMPILER_MSVC
+  unsigned long index;  // NOLINT(runtime/int)
+  _BitScanForward64(&index, x);
+  return index;
+#else
+  return __builtin_ctzll(x);
+#endif
+}
+
+// Writes bits most significant first, padding the last byte with zeros.
+class BitWriter final {
+ public:
+  explicit BitWriter(std::string& bytes) : bytes_(bytes) {}
+
+  ~BitWriter() {
+    if (free_bits_ < 8) {
+      bytes_.push_back(static_cast<char>(current_));
+    }
+  }
+
+  // Writes the |count| low-order bits of |value|.  |count| must be at most 64.
+  void Write(std::uint64_t const value, int count) {
+    while (count > 0) {
+      int const n = std::min(count, free_bits_);
+      count -= n;
+      std::uint64_t const chunk = (value >> count) & ((1ull << n) - 1);
+      current_ |= static_cast<std::uint8_t>(chunk << (free_bits_ - n));
+      free_bits_ -= n;
+      if (free_bits_ == 0) {
+        bytes_.push_back(static_cast<char>(current_));
+        current_ = 0;
+        free_bits_ = 8;
+      }
+    }
+  }
+
+ private:
+  std::string& bytes_;
+  std::uint8_t current_ = 0;
+  int free_bits_ = 8;
+};
+
+class BitReader final {
+ public:
+  explicit BitReader(std::string const& bytes) : bytes_(bytes) {}
+
+  // Returns the next |count| bits.  |count| must be at most 64.
+  std::uint64_t Read(int count) {
+    std::uint64_t value = 0;
+    while (count > 0) {
+      CHECK_LT(position_, bytes_.size()) << "truncated input";
+      int const available_bits = 8 - bit_;
+      int const n = std::min(count, available_bits);
+      std::uint8_t const byte = static_cast<std::uint8_t>(bytes_[position_]);
+      std::uint64_t const chunk =
+          (byte >> (available_bits - n)) & ((1u << n) - 1);
+      value = (value << n) | chunk;
+      count -= n;
+      bit_ += n;
+      if (bit_ == 8) {
+        ++position_;
+        bit_ = 0;
+      }
+    }
+    return value;
+  }
+
+  // True if all the bytes were consumed, except for the padding of the last
+  // one.
+  bool at_end() const {
+    return position_ == bytes_.size() ||
+           (position_ + 1 == bytes_.size() && bit_ > 0);
+  }
+
+ private:
+  std::string const& bytes_;
+  std::size_t position_ = 0;
+  int bit_ = 0;
+};
+
+inline void WriteVarint(std::uint64_t value, std::string& bytes) {
+  while (value >= 0x80) {
+    bytes.push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  bytes.push_back(static_cast<char>(value));
+}
+
+inline std::uint64_t ReadVarint(std::string const& bytes,
+                                std::size_t& position) {
+  std::uint64_t value = 0;
+  for (int shift = 0;; shift += 7) {
+    CHECK_LT(position, bytes.size()) << "truncated input";
+    CHECK_LT(shift, 64) << "varint too long";
+    std::uint8_t const byte = static_cast<std::uint8_t>(bytes[position++]);
+    value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
+}
+
+// The differences are computed modulo 2⁶⁴, so the encoding is exact even if
+// the bit patterns are not monotonic.
+inline std::uint64_t ZigZagEncode(std::uint64_t const difference) {
+  return (difference << 1) ^ (0 - (difference >> 63));
+}
+
+inline std::uint64_t ZigZagDecode(std::uint64_t const zig_zag) {
+  return (zig_zag >> 1) ^ (0 - (zig_zag & 1));
+}
+
+void EncodeRawDoubles(std::vector<double> const& values, std::string& bytes) {
+  bytes.reserve(bytes.size() + 8 * values.size());
+  for (double const value : values) {
+    std::uint64_t const bits = ToBits(value);
+    for (int i = 0; i < 8; ++i) {
+      bytes.push_back(static_cast<char>(bits >> (8 * i)));
+    }
+  }
+}
+
+std::vector<double> DecodeRawDoubles(std::string const& bytes, int const size) {
+  CHECK_EQ(8 * size, bytes.size()) << "wrong size";
+  std::vector<double> values;
+  values.reserve(size);
+  for (int v = 0; v < size; ++v) {
+    std::uint64_t bits = 0;
+    for (int i = 0; i < 8; ++i) {
+      bits |= static_cast<std::uint64_t>(
+                  static_cast<std::uint8_t>(bytes[8 * v + i])) << (8 * i);
+    }
+    values.push_back(FromBits(bits));
+  }
+  return values;
+}
+
+// The first value is written in full.  For each of the following values, the
+// XOR with its predecessor is written as:
+// - 0 if it is zero;
+// - 10 followed by its meaningful bits if they fit in the window of meaningful
+//   bits of the previous XOR;
+// - 11 followed by the number of leading zeros (5 bits), the number of
+//   meaningful bits minus 1 (6 bits), and the meaningful bits.
+void EncodeXorDoubles(std::vector<double> const& values, std::string& bytes) {
+  if (values.empty()) {
+    return;
+  }
+  BitWriter writer(bytes);
+  std::uint64_t previous = ToBits(values.front());
+  writer.Write(previous, 64);
+  // The window of the previous meaningful bits, none initially.
+  int window_leading_zeros = 64;
+  int window_trailing_zeros = 64;
+  for (int i = 1; i < values.size(); ++i) {
+    std::uint64_t const current = ToBits(values[i]);
+    std::uint64_t const x = current ^ previous;
+    previous = current;
+    if (x == 0) {
+      writer.Write(0b0, 1);
+      continue;
+    }
+    // Only 5 bits are available for the leading zeros.
+    int const leading_zeros = std::min(CountLeadingZeros(x), 31);
+    int const trailing_zeros = CountTrailingZeros(x);
+    if (leading_zeros >= window_leading_zeros &&
+        trailing_zeros >= window_trailing_zeros) {
+      writer.Write(0b10, 2);
+      writer.Write(x >> window_trailing_zeros,
+                   64 - window_leading_zeros - window_trailing_zeros);
+    } else {
+      int const meaningful_bits = 64 - leading_zeros - trailing_zeros;
+      writer.Write(0b11, 2);
+      writer.Write(leading_zeros, 5);
+      writer.Write(meaningful_bits - 1, 6);
+      writer.Write(x >> trailing_zeros, meaningful_bits);
+      window_leading_zeros = leading_zeros;
+      window_trailing_zeros = trailing_zeros;
+    }
+  }
+}
+
+std::vector<double> DecodeXorDoubles(std::string const& bytes, int const size) {
+  std::vector<double> values;
+  if (size == 0) {
+    CHECK(bytes.empty());
+    return values;
+  }
+  values.reserve(size);
+  BitReader reader(bytes);
+  std::uint64_t previous = reader.Read(64);
+  values.push_back(FromBits(previous));
+  int window_leading_zeros = 64;
+  int window_trailing_zeros = 64;
+  for (int i = 1; i < size; ++i) {
+    std::uint64_t x = 0;
+    if (reader.Read(1) == 1) {
+      if (reader.Read(1) == 0) {
+        CHECK_LT(window_leading_zeros + window_trailing_zeros, 64)
+            << "no previous window";
+      } else {
+        window_leading_zeros = reader.Read(5);
+        int const meaningful_bits = reader.Read(6) + 1;
+        window_trailing_zeros = 64 - window_leading_zeros - meaningful_bits;
+        CHECK_LE(0, window_trailing_zeros) << "bad window";
+      }
+      x = reader.Read(64 - window_leading_zeros - window_trailing_zeros)
+          << window_trailing_zeros;
+    }
+    previous ^= x;
+    values.push_back(FromBits(previous));
+  }
+  CHECK(reader.at_end()) << "trailing bytes";
+  return values;
+}
+
+void EncodeDeltaOfDeltaDoubles(std::vector<double> const& values,
+                               std::string& bytes) {
+  std::uint64_t previous = 0;
+  std::uint64_t previous_delta = 0;
+  for (double const value : values) {
+    std::uint64_t const current = ToBits(value);
+    std::uint64_t const delta = current - previous;
+    WriteVarint(ZigZagEncode(delta - previous_delta), bytes);
+    previous = current;
+    previous_delta = delta;
+  }
+}
+
+std::vector<double> DecodeDeltaOfDeltaDoubles(std::string const& bytes,
+                                              int const size) {
+  std::vector<double> values;
+  values.reserve(size);
+  std::size_t position = 0;
+  std::uint64_t previous = 0;
+  std::uint64_t previous_delta = 0;
+  for (int i = 0; i < size; ++i) {
+    std::uint64_t const delta =
+        previous_delta + ZigZagDecode(ReadVarint(bytes, position));
+    previous += delta;
+    previous_delta = delta;
+    values.push_back(FromBits(previous));
+  }
+  CHECK_EQ(position, bytes.size()) << "trailing bytes";
+  return values;
+}
+
+}  // namespace internal_packed_doubles
+}  // namespace base
+}  // namespace principia
@@ -0,0 +1,119 @@
+﻿
+#include "base/packed_doubles.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace principia {
+namespace base {
+
+using ::testing::Lt;
+
+class PackedDoublesTest : public ::testing::Test {
+ protected:
+  // Compares the bit patterns, so that NaNs and signed zeros are checked.
+  static void ExpectBitIdentical(std::vector<double> const& expected,
+                                 std::vector<double> const& actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (int i = 0; i < expected.size(); ++i) {
+      EXPECT_EQ(0, std::memcmp(&expected[i], &actual[i], sizeof(double)))
+          << i << " " << expected[i] << " " << actual[i];
+    }
+  }
+
+  static void ExpectRoundTrip(std::vector<double> const& values) {
+    std::string raw;
+    EncodeRawDoubles(values, raw);
+    ExpectBitIdentical(values, DecodeRawDoubles(raw, values.size()));
+
+    std::string xor_bytes;
+    EncodeXorDoubles(values, xor_bytes);
+    ExpectBitIdentical(values, DecodeXorDoubles(xor_bytes, values.size()));
+
+    std::string delta_of_delta;
+    EncodeDeltaOfDeltaDoubles(values, delta_of_delta);
+    ExpectBitIdentical(
+        values, DecodeDeltaOfDeltaDoubles(delta_of_delta, values.size()));
+  }
+};
+
+using PackedDoublesDeathTest = PackedDoublesTest;
+
+TEST_F(PackedDoublesTest, SpecialValues) {
+  ExpectRoundTrip({});
+  ExpectRoundTrip({1.0});
+  ExpectRoundTrip({0.0, -0.0, 0.0, -0.0});
+  ExpectRoundTrip({std::numeric_limits<double>::infinity(),
+                   -std::numeric_limits<double>::infinity(),
+                   std::numeric_limits<double>::quiet_NaN(),
+                   std::numeric_limits<double>::denorm_min(),
+                   std::numeric_limits<double>::max(),
+                   std::numeric_limits<double>::lowest(),
+                   std::numeric_limits<double>::epsilon()});
+  ExpectRoundTrip({3.0, 3.0, 3.0, 3.0, 3.0});
+}
+
+TEST_F(PackedDoublesTest, RandomValues) {
+  std::mt19937_64 random(42);
+  std::uniform_int_distribution<std::uint64_t> bits_distribution;
+  std::vector<double> values;
+  for (int i = 0; i < 1000; ++i) {
+    std::uint64_t const bits = bits_distribution(random);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    values.push_back(value);
+  }
+  ExpectRoundTrip(values);
+}
+
+// The kind of data found in a trajectory: equally spaced times and smoothly
+// varying coordinates.
+TEST_F(PackedDoublesTest, Trajectory) {
+  std::vector<double> times;
+  std::vector<double> coordinates;
+  int const size = 10000;
+  for (int i = 0; i < size; ++i) {
+    times.push_back(-1.5e9 + 10.0 * i);
+    coordinates.push_back(1.5e11 * std::cos(i * 1e-4) + 1e4 * std::sin(i));
+  }
+  ExpectRoundTrip(times);
+  ExpectRoundTrip(coordinates);
+
+  std::string time_bytes;
+  EncodeDeltaOfDeltaDoubles(times, time_bytes);
+  EXPECT_THAT(time_bytes.size(), Lt(2 * size));
+
+  std::string raw_bytes;
+  std::string xor_bytes;
+  EncodeRawDoubles(coordinates, raw_bytes);
+  EncodeXorDoubles(coordinates, xor_bytes);
+  EXPECT_EQ(8 * size, raw_bytes.size());
+  EXPECT_THAT(xor_bytes.size(), Lt(raw_bytes.size()));
+}
+
+TEST_F(PackedDoublesDeathTest, Malformed) {
+  std::string bytes;
+  EncodeXorDoubles({1.0, 2.0, 3.0}, bytes);
+  EXPECT_DEATH({
+    DecodeXorDoubles(bytes, 10);
+  }, "truncated input");
+  EXPECT_DEATH({
+    DecodeRawDoubles(bytes, 1);
+  }, "wrong size");
+  bytes.clear();
+  EncodeDeltaOfDeltaDoubles({1.0, 2.0, 3.0}, bytes);
+  EXPECT_DEATH({
+    DecodeDeltaOfDeltaDoubles(bytes, 2);
+  }, "trailing bytes");
+}
+
+}  // namespace base
+}  // namespace principia
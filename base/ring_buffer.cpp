@@ -0,0 +1,67 @@
+﻿
+#include "base/ring_buffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#include "glog/logging.h"
+
+namespace principia {
+namespace base {
+namespace internal_ring_buffer {
+
+RingBuffer::RingBuffer(std::int64_t const capacity)
+    : capacity_(capacity),
+      data_(new std::uint8_t[capacity]),
+      head_(0),
+      tail_(0) {
+  CHECK_LT(0, capacity_);
+  CHECK_EQ(0, capacity_ & (capacity_ - 1)) << capacity_;
+}
+
+void RingBuffer::Push(Bytes bytes) {
+  // Only the producer writes |head_|.
+  std::int64_t head = head_.load(std::memory_order_relaxed);
+  while (bytes.size > 0) {
+    std::int64_t const room =
+        capacity_ - (head - tail_.load(std::memory_order_acquire));
+    if (room == 0) {
+      std::this_thread::yield();
+      continue;
+    }
+    std::int64_t const offset = head & (capacity_ - 1);
+    std::int64_t const size =
+        std::min({bytes.size, room, capacity_ - offset});
+    std::memcpy(&data_[offset], bytes.data, size);
+    bytes.data += size;
+    bytes.size -= size;
+    head += size;
+    head_.store(head, std::memory_order_release);
+  }
+}
+
+Bytes RingBuffer::Peek() const {
+  // Only the consumer writes |tail_|.
+  std::int64_t const tail = tail_.load(std::memory_order_relaxed);
+  std::int64_t const offset = tail & (capacity_ - 1);
+  std::int64_t const size =
+      std::min(head_.load(std::memory_order_acquire) - tail,
+               capacity_ - offset);
+  return Bytes(&data_[offset], size);
+}
+
+void RingBuffer::Consume(std::int64_t const size) {
+  std::int64_t const tail = tail_.load(std::memory_order_relaxed);
+  CHECK_LE(size, head_.load(std::memory_order_acquire) - tail);
+  tail_.store(tail + size, std::memory_order_release);
+}
+
+bool RingBuffer::empty() const {
+  return head_.load(std::memory_order_acquire) ==
+         tail_.load(std::memory_order_relaxed);
+}
+
+}  // namespace internal_ring_buffer
+}  // namespace base
+}  // namespace principia
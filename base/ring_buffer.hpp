@@ -0,0 +1,62 @@
+﻿
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "base/array.hpp"
+
+namespace principia {
+namespace base {
+namespace internal_ring_buffer {
+
+// A buffer of bytes through which one producer thread hands data to one
+// consumer thread without taking any lock.  The producer calls |Push|, the
+// consumer calls |Peek| and |Consume|; each of these functions must always be
+// called from the same thread.
+class RingBuffer final {
+ public:
+  // |capacity| must be a power of 2.
+  explicit RingBuffer(std::int64_t capacity);
+
+  RingBuffer(RingBuffer const&) = delete;
+  RingBuffer(RingBuffer&&) = delete;
+  RingBuffer& operator=(RingBuffer const&) = delete;
+  RingBuffer& operator=(RingBuffer&&) = delete;
+
+  // Appends |bytes| to the buffer.  If the buffer is full, yields until the
+  // consumer makes room.  |bytes| may be larger than the capacity, in which
+  // case it is handed over in pieces.
+  void Push(Bytes bytes);
+
+  // Returns the oldest contiguous range of bytes that have been pushed and not
+  // consumed.  The result has size 0 if the buffer is empty.  The range may not
+  // extend to the most recently pushed bytes if they wrap around the end of
+  // the storage.
+  Bytes Peek() const;
+
+  // Releases the first |size| bytes of the range returned by |Peek|.
+  void Consume(std::int64_t size);
+
+  // True if all the bytes that have been pushed have been consumed.  Only
+  // meaningful on the consumer thread, or once the producer has stopped.
+  bool empty() const;
+
+ private:
+  std::int64_t const capacity_;
+  std::unique_ptr<std::uint8_t[]> const data_;
+
+  // The number of bytes ever pushed and consumed, respectively.  They live on
+  // different cache lines to avoid false sharing between the producer and the
+  // consumer.
+  alignas(64) std::atomic<std::int64_t> head_;
+  alignas(64) std::atomic<std::int64_t> tail_;
+};
+
+}  // namespace internal_ring_buffer
+
+using internal_ring_buffer::RingBuffer;
+
+}  // namespace base
+}  // namespace principia
@@ -0,0 +1,91 @@
+﻿
+#include "base/ring_buffer.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace principia {
+namespace base {
+namespace internal_ring_buffer {
+
+using ::testing::ElementsAre;
+
+class RingBufferTest : public ::testing::Test {
+ protected:
+  // Consumes everything that is in |buffer| and appends it to |bytes|.
+  static void Drain(RingBuffer& buffer, std::vector<std::uint8_t>& bytes) {
+    for (Bytes peeked = buffer.Peek();
+         peeked.size > 0;
+         peeked = buffer.Peek()) {
+      bytes.insert(bytes.end(), peeked.data, peeked.data + peeked.size);
+      buffer.Consume(peeked.size);
+    }
+  }
+};
+
+using RingBufferDeathTest = RingBufferTest;
+
+TEST_F(RingBufferDeathTest, Capacity) {
+  EXPECT_DEATH({
+    RingBuffer buffer(12);
+  }, "capacity_");
+}
+
+TEST_F(RingBufferTest, WrapAround) {
+  RingBuffer buffer(8);
+  EXPECT_TRUE(buffer.empty());
+  std::vector<std::uint8_t> consumed;
+
+  std::uint8_t first[] = {1, 2, 3, 4, 5, 6};
+  buffer.Push(Bytes(first, 6));
+  EXPECT_FALSE(buffer.empty());
+  Drain(buffer, consumed);
+  EXPECT_TRUE(buffer.empty());
+
+  // These bytes wrap around the end of the storage, so they are peeked in two
+  // pieces.
+  std::uint8_t second[] = {7, 8, 9, 10, 11};
+  buffer.Push(Bytes(second, 5));
+  EXPECT_EQ(2, buffer.Peek().size);
+  Drain(buffer, consumed);
+  EXPECT_TRUE(buffer.empty());
+
+  EXPECT_THAT(consumed, ElementsAre(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11));
+}
+
+// A producer pushes more bytes than the capacity while a consumer drains them.
+TEST_F(RingBufferTest, Threads) {
+  std::int64_t const size = 1 << 20;
+  std::vector<std::uint8_t> pushed;
+  for (std::int64_t i = 0; i < size; ++i) {
+    pushed.push_back(static_cast<std::uint8_t>(i * 7 + i / 256));
+  }
+
+  RingBuffer buffer(1 << 10);
+  std::thread producer([&buffer, &pushed, size]() {
+    // Push pieces of various sizes, some larger than the capacity.
+    std::int64_t position = 0;
+    for (std::int64_t piece = 1; position < size; ++piece) {
+      std::int64_t const piece_size =
+          std::min(piece % 2000, size - position);
+      buffer.Push(Bytes(&pushed[position], piece_size));
+      position += piece_size;
+    }
+  });
+
+  std::vector<std::uint8_t> consumed;
+  while (consumed.size() < pushed.size()) {
+    Drain(buffer, consumed);
+  }
+  producer.join();
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_EQ(pushed, consumed);
+}
+
+}  // namespace internal_ring_buffer
+}  // namespace base
+}  // namespace principia
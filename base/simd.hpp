@@ -0,0 +1,425 @@
+﻿
+#pragma once
+
+#include "base/macros.hpp"
+
+// The instruction sets enabled by the flags passed to the compiler.  The
+// builds only assume SSE2, which is part of x86-64.
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PRINCIPIA_SIMD_SSE2 1
+#endif
+#if defined(__AVX2__)
+#define PRINCIPIA_SIMD_AVX2 1
+#endif
+#if defined(__AVX512F__)
+#define PRINCIPIA_SIMD_AVX512 1
+#endif
+
+#if PRINCIPIA_SIMD_SSE2
+#include <immintrin.h>
+#endif
+#if PRINCIPIA_SIMD_SSE2 && PRINCIPIA_COMPILER_MSVC
+#include <intrin.h>
+#endif
+
+#include <cmath>
+#include <cstring>
+
+// Marks a function that may use AVX2 instructions even though the compiler
+// flags don't enable them.  Such a function must only be called if
+// |SupportedInstructionSet()| is |InstructionSet::AVX2|.  Visual C++ compiles
+// the intrinsics irrespective of its flags, so it doesn't need the attribute.
+#if PRINCIPIA_COMPILER_MSVC || PRINCIPIA_COMPILER_ICC
+#define PRINCIPIA_TARGET_AVX2
+#else
+#define PRINCIPIA_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace principia {
+namespace base {
+namespace internal_simd {
+
+// The instruction sets for which the SIMD code may be compiled, in increasing
+// order of capability.
+enum class InstructionSet {
+  Scalar,
+  SSE2,
+  AVX2,
+  AVX512,
+};
+
+// The most capable instruction set enabled by the compiler flags.  The code
+// that doesn't select its instruction set at run time uses this one.
+#if PRINCIPIA_SIMD_AVX512
+InstructionSet constexpr compiled_instruction_set = InstructionSet::AVX512;
+#elif PRINCIPIA_SIMD_AVX2
+InstructionSet constexpr compiled_instruction_set = InstructionSet::AVX2;
+#elif PRINCIPIA_SIMD_SSE2
+InstructionSet constexpr compiled_instruction_set = InstructionSet::SSE2;
+#else
+InstructionSet constexpr compiled_instruction_set = InstructionSet::Scalar;
+#endif
+
+// The most capable of |Scalar|, |SSE2| and |AVX2| that is supported by both the
+// processor and the operating system.  CPUID is only queried on the first
+// call.
+inline InstructionSet SupportedInstructionSet() {
+  static InstructionSet const supported = []() {
+#if PRINCIPIA_SIMD_SSE2
+#if PRINCIPIA_COMPILER_MSVC
+    int registers[4];  // EAX, EBX, ECX, EDX.
+    __cpuid(registers, 0);
+    int const max_leaf = registers[0];
+    __cpuid(registers, 1);
+    bool const has_osxsave = registers[2] & (1 << 27);
+    bool const has_avx = registers[2] & (1 << 28);
+    bool has_avx2 = false;
+    // The operating system must save the YMM registers on context switches.
+    if (max_leaf >= 7 && has_osxsave && has_avx &&
+        (_xgetbv(0) & 0b110) == 0b110) {
+      __cpuidex(registers, 7, 0);
+      has_avx2 = registers[1] & (1 << 5);
+    }
+#else
+    // This also checks that the operating system saves the YMM registers.
+    __builtin_cpu_init();
+    bool const has_avx2 = __builtin_cpu_supports("avx2");
+#endif
+    return has_avx2 ? InstructionSet::AVX2 : InstructionSet::SSE2;
+#else
+    return InstructionSet::Scalar;
+#endif
+  }();
+  return supported;
+}
+
+// The following structs wrap the SIMD instructions used by the Чебышёв series,
+// the interleaved series and the vectorized gravitation.  There is no fused
+// multiply-add, so that the results are the same for all the instruction sets.
+
+// |Pack| operates on |width| independent doubles.  The result of
+// |ApproximateReciprocalSquareRoot| must be refined by |newton_iterations| to
+// reach full double precision.
+template<InstructionSet instruction_set>
+struct Pack;
+
+// |CoordinatesPack| operates on the three coordinates of a vector.  In memory
+// the coordinates are stored with a padding zero, as x, y, z, 0, so that they
+// fill a 256-bit register, or two 128-bit registers.
+template<InstructionSet instruction_set>
+struct CoordinatesPack;
+
+template<>
+struct Pack<InstructionSet::Scalar> final {
+  using Register = double;
+  static int constexpr width = 1;
+  static int constexpr newton_iterations = 0;
+
+  FORCE_INLINE static Register Broadcast(double const d) {
+    return d;
+  }
+  FORCE_INLINE static Register Load(double const* const p) {
+    return *p;
+  }
+  FORCE_INLINE static void Store(double* const p, Register const r) {
+    *p = r;
+  }
+  FORCE_INLINE static Register Add(Register const a, Register const b) {
+    return a + b;
+  }
+  FORCE_INLINE static Register Subtract(Register const a, Register const b) {
+    return a - b;
+  }
+  FORCE_INLINE static Register Multiply(Register const a, Register const b) {
+    return a * b;
+  }
+  // Exact, no refinement needed.
+  FORCE_INLINE static Register ApproximateReciprocalSquareRoot(
+      Register const r) {
+    return 1 / std::sqrt(r);
+  }
+  FORCE_INLINE static double HorizontalSum(Register const r) {
+    return r;
+  }
+};
+
+template<>
+struct CoordinatesPack<InstructionSet::Scalar> final {
+  struct Register {
+    double x;
+    double y;
+    double z;
+  };
+
+  FORCE_INLINE static Register Broadcast(double const d) {
+    return {d, d, d};
+  }
+  FORCE_INLINE static Register Load(double const* const p) {
+    return {p[0], p[1], p[2]};
+  }
+  // Stores the x, y, z coordinates at |xyz[0]|, |xyz[1]|, |xyz[2]|.
+  FORCE_INLINE static void Store(double* const xyz, Register const r) {
+    xyz[0] = r.x;
+    xyz[1] = r.y;
+    xyz[2] = r.z;
+  }
+  FORCE_INLINE static Register Add(Register const a, Register const b) {
+    return {a.x + b.x, a.y + b.y, a.z + b.z};
+  }
+  FORCE_INLINE static Register Subtract(Register const a, Register const b) {
+    return {a.x - b.x, a.y - b.y, a.z - b.z};
+  }
+  FORCE_INLINE static Register Multiply(Register const a, Register const b) {
+    return {a.x * b.x, a.y * b.y, a.z * b.z};
+  }
+};
+
+#if PRINCIPIA_SIMD_SSE2
+
+template<>
+struct Pack<InstructionSet::SSE2> final {
+  using Register = __m128d;
+  static int constexpr width = 2;
+  static int constexpr newton_iterations = 3;
+
+  FORCE_INLINE static Register Broadcast(double const d) {
+    return _mm_set1_pd(d);
+  }
+  FORCE_INLINE static Register Load(double const* const p) {
+    return _mm_loadu_pd(p);
+  }
+  FORCE_INLINE static void Store(double* const p, Register const r) {
+    _mm_storeu_pd(p, r);
+  }
+  FORCE_INLINE static Register Add(Register const a, Register const b) {
+    return _mm_add_pd(a, b);
+  }
+  FORCE_INLINE static Register Subtract(Register const a, Register const b) {
+    return _mm_sub_pd(a, b);
+  }
+  FORCE_INLINE static Register Multiply(Register const a, Register const b) {
+    return _mm_mul_pd(a, b);
+  }
+  // Relative error below 1.5 × 2⁻¹².
+  FORCE_INLINE static Register ApproximateReciprocalSquareRoot(
+      Register const r) {
+    return _mm_cvtps_pd(_mm_rsqrt_ps(_mm_cvtpd_ps(r)));
+  }
+  FORCE_INLINE static double HorizontalSum(Register const r) {
+    return _mm_cvtsd_f64(_mm_add_sd(r, _mm_unpackhi_pd(r, r)));
+  }
+};
+
+template<>
+struct CoordinatesPack<InstructionSet::SSE2> final {
+  struct Register {
+    __m128d xy;
+    __m128d z0;
+  };
+
+  FORCE_INLINE static Register Broadcast(double const d) {
+    __m128d const dd = _mm_set1_pd(d);
+    return {dd, dd};
+  }
+  FORCE_INLINE static Register Load(double const* const p) {
+    return {_mm_loadu_pd(p), _mm_loadu_pd(p + 2)};
+  }
+  FORCE_INLINE static void Store(double* const xyz, Register const r) {
+    _mm_storeu_pd(xyz, r.xy);
+    _mm_store_sd(xyz + 2, r.z0);
+  }
+  FORCE_INLINE static Register Add(Register const a, Register const b) {
+    return {_mm_add_pd(a.xy, b.xy), _mm_add_pd(a.z0, b.z0)};
+  }
+  FORCE_INLINE static Register Subtract(Register const a, Register const b) {
+    return {_mm_sub_pd(a.xy, b.xy), _mm_sub_pd(a.z0, b.z0)};
+  }
+  FORCE_INLINE static Register Multiply(Register const a, Register const b) {
+    return {_mm_mul_pd(a.xy, b.xy), _mm_mul_pd(a.z0, b.z0)};
+  }
+};
+
+#if PRINCIPIA_SIMD_AVX2 || PRINCIPIA_COMPILER_MSVC || PRINCIPIA_COMPILER_ICC
+
+template<>
+struct Pack<InstructionSet::AVX2> final {
+  using Register = __m256d;
+  static int constexpr width = 4;
+  static int constexpr newton_iterations = 3;
+
+  FORCE_INLINE static Register Broadcast(double const d) {
+    return _mm256_set1_pd(d);
+  }
+  FORCE_INLINE static Register Load(double const* const p) {
+    return _mm256_loadu_pd(p);
+  }
+  FORCE_INLINE static void Store(double* const p, Register const r) {
+    _mm256_storeu_pd(p, r);
+  }
+  FORCE_INLINE static Register Add(Register const a, Register const b) {
+    return _mm256_add_pd(a, b);
+  }
+  FORCE_INLINE static Register Subtract(Register const a, Register const b) {
+    return _mm256_sub_pd(a, b);
+  }
+  FORCE_INLINE static Register Multiply(Register const a, Register const b) {
+    return _mm256_mul_pd(a, b);
+  }
+  // Relative error below 1.5 × 2⁻¹².
+  FORCE_INLINE static Register ApproximateReciprocalSquareRoot(
+      Register const r) {
+    return _mm256_cvtps_pd(_mm_rsqrt_ps(_mm256_cvtpd_ps(r)));
+  }
+  FORCE_INLINE static double HorizontalSum(Register const r) {
+    __m128d const sum = _mm_add_pd(_mm256_castpd256_pd128(r),
+                                   _mm256_extractf128_pd(r, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+  }
+};
+
+template<>
+struct CoordinatesPack<InstructionSet::AVX2> final {
+  using Register = __m256d;
+
+  FORCE_INLINE static Register Broadcast(double const d) {
+    return _mm256_set1_pd(d);
+  }
+  FORCE_INLINE static Register Load(double const* const p) {
+    return _mm256_loadu_pd(p);
+  }
+  FORCE_INLINE static void Store(double* const xyz, Register const r) {
+    double xyz0[4];
+    _mm256_storeu_pd(xyz0, r);
+    xyz[0] = xyz0[0];
+    xyz[1] = xyz0[1];
+    xyz[2] = xyz0[2];
+  }
+  FORCE_INLINE static Register Add(Register const a, Register const b) {
+    return _mm256_add_pd(a, b);
+  }
+  FORCE_INLINE static Register Subtract(Register const a, Register const b) {
+    return _mm256_sub_pd(a, b);
+  }
+  FORCE_INLINE static Register Multiply(Register const a, Register const b) {
+    return _mm256_mul_pd(a, b);
+  }
+};
+
+#else
+
+// Clang and G++ reject the AVX intrinsics in functions that are not compiled
+// for AVX, even if they are only inlined in |PRINCIPIA_TARGET_AVX2| functions.
+// The vector extensions have no such restriction: they are lowered to 256-bit
+// instructions in the |PRINCIPIA_TARGET_AVX2| functions.  There is no
+// |ApproximateReciprocalSquareRoot| nor |HorizontalSum| because these
+// instructions don't have a portable spelling; the code that uses them is
+// compiled for |compiled_instruction_set|.
+
+template<>
+struct Pack<InstructionSet::AVX2> final {
+  typedef double Register __attribute__((vector_size(32)));
+  static int constexpr width = 4;
+
+  FORCE_INLINE static Register Broadcast(double const d) {
+    return Register{d, d, d, d};
+  }
+  FORCE_INLINE static Register Load(double const* const p) {
+    Register r;
+    std::memcpy(&r, p, sizeof(r));
+    return r;
+  }
+  FORCE_INLINE static void Store(double* const p, Register const r) {
+    std::memcpy(p, &r, sizeof(r));
+  }
+  FORCE_INLINE static Register Add(Register const a, Register const b) {
+    return a + b;
+  }
+  FORCE_INLINE static Register Subtract(Register const a, Register const b) {
+    return a - b;
+  }
+  FORCE_INLINE static Register Multiply(Register const a, Register const b) {
+    return a * b;
+  }
+};
+
+template<>
+struct CoordinatesPack<InstructionSet::AVX2> final {
+  using Register = Pack<InstructionSet::AVX2>::Register;
+
+  FORCE_INLINE static Register Broadcast(double const d) {
+    return Register{d, d, d, d};
+  }
+  FORCE_INLINE static Register Load(double const* const p) {
+    Register r;
+    std::memcpy(&r, p, sizeof(r));
+    return r;
+  }
+  FORCE_INLINE static void Store(double* const xyz, Register const r) {
+    xyz[0] = r[0];
+    xyz[1] = r[1];
+    xyz[2] = r[2];
+  }
+  FORCE_INLINE static Register Add(Register const a, Register const b) {
+    return a + b;
+  }
+  FORCE_INLINE static Register Subtract(Register const a, Register const b) {
+    return a - b;
+  }
+  FORCE_INLINE static Register Multiply(Register const a, Register const b) {
+    return a * b;
+  }
+};
+
+#endif
+
+#endif
+
+#if PRINCIPIA_SIMD_AVX512
+
+template<>
+struct Pack<InstructionSet::AVX512> final {
+  using Register = __m512d;
+  static int constexpr width = 8;
+  static int constexpr newton_iterations = 2;
+
+  FORCE_INLINE static Register Broadcast(double const d) {
+    return _mm512_set1_pd(d);
+  }
+  FORCE_INLINE static Register Load(double const* const p) {
+    return _mm512_loadu_pd(p);
+  }
+  FORCE_INLINE static void Store(double* const p, Register const r) {
+    _mm512_storeu_pd(p, r);
+  }
+  FORCE_INLINE static Register Add(Register const a, Register const b) {
+    return _mm512_add_pd(a, b);
+  }
+  FORCE_INLINE static Register Subtract(Register const a, Register const b) {
+    return _mm512_sub_pd(a, b);
+  }
+  FORCE_INLINE static Register Multiply(Register const a, Register const b) {
+    return _mm512_mul_pd(a, b);
+  }
+  // Relative error below 2⁻¹⁴.
+  FORCE_INLINE static Register ApproximateReciprocalSquareRoot(
+      Register const r) {
+    return _mm512_rsqrt14_pd(r);
+  }
+  FORCE_INLINE static double HorizontalSum(Register const r) {
+    return _mm512_reduce_add_pd(r);
+  }
+};
+
+#endif
+
+}  // namespace internal_simd
+
+using internal_simd::compiled_instruction_set;
+using internal_simd::CoordinatesPack;
+using internal_simd::InstructionSet;
+using internal_simd::Pack;
+using internal_simd::SupportedInstructionSet;
+
+}  // namespace base
+}  // namespace principia
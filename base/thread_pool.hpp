@@ -0,0 +1,60 @@
+﻿
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "base/macros.hpp"
+
+namespace principia {
+namespace base {
+namespace internal_thread_pool {
+
+// A persistent pool of threads which execute the functions passed to |Add| in
+// the order in which they were added.  Unlike |Bundle|, the pool may be used
+// repeatedly, which makes it suitable for parallelizing computations that are
+// performed many times, e.g., at each step of an integration.
+template<typename T>
+class ThreadPool final {
+ public:
+  // Creates a pool with |pool_size| threads.
+  explicit ThreadPool(std::int64_t pool_size);
+
+  // Executes the functions that are still queued and joins the threads.
+  ~ThreadPool();
+
+  // Schedules |function| for execution on one of the threads of the pool.
+  // The result of the function, or the exception that it throws, is
+  // available through the returned future.
+  std::future<T> Add(std::function<T()> function);
+
+  std::int64_t size() const;
+
+ private:
+  // The loop executed by each of the |threads_|.  Returns when |shutdown_| is
+  // set and there are no more |calls_|.
+  void DequeueCallAndExecute();
+
+  std::mutex lock_;
+  // Notified when a call is added or when |shutdown_| is set.
+  std::condition_variable has_new_calls_or_shutdown_;
+  bool shutdown_ GUARDED_BY(lock_) = false;
+  std::list<std::packaged_task<T()>> calls_ GUARDED_BY(lock_);
+
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace internal_thread_pool
+
+using internal_thread_pool::ThreadPool;
+
+}  // namespace base
+}  // namespace principia
+
+#include "base/thread_pool_body.hpp"
@@ -0,0 +1,93 @@
+﻿
+#include "base/thread_pool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace principia {
+namespace base {
+namespace internal_thread_pool {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::Le;
+
+class ThreadPoolTest : public ::testing::Test {
+ protected:
+  ThreadPoolTest() : pool_(std::thread::hardware_concurrency() + 1) {}
+
+  ThreadPool<void> pool_;
+};
+
+// Check that the calls are executed on the threads of the pool, not on the
+// calling thread.
+TEST_F(ThreadPoolTest, Threads) {
+  std::mutex lock;
+  std::set<std::thread::id> thread_ids;
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < 100; ++i) {
+    futures.push_back(pool_.Add([&lock, &thread_ids]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      std::lock_guard<std::mutex> l(lock);
+      thread_ids.insert(std::this_thread::get_id());
+    }));
+  }
+  for (auto const& future : futures) {
+    future.wait();
+  }
+  EXPECT_THAT(thread_ids.size(), Le(pool_.size()));
+  EXPECT_EQ(0, thread_ids.count(std::this_thread::get_id()));
+}
+
+TEST_F(ThreadPoolTest, Results) {
+  ThreadPool<int> pool(3);
+  std::vector<std::future<int>> futures;
+  for (int i = 0; i < 10; ++i) {
+    futures.push_back(pool.Add([i]() { return i * i; }));
+  }
+  std::vector<int> results;
+  for (auto& future : futures) {
+    results.push_back(future.get());
+  }
+  EXPECT_THAT(results, ElementsAre(0, 1, 4, 9, 16, 25, 36, 49, 64, 81));
+}
+
+// The pool may be used repeatedly.
+TEST_F(ThreadPoolTest, Reuse) {
+  std::atomic<int> count(0);
+  for (int round = 0; round < 1000; ++round) {
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 4; ++i) {
+      futures.push_back(pool_.Add([&count]() { ++count; }));
+    }
+    for (auto const& future : futures) {
+      future.wait();
+    }
+    EXPECT_THAT(count, Eq(4 * (round + 1)));
+  }
+}
+
+// The queued calls are executed before the destruction completes.
+TEST_F(ThreadPoolTest, Destruction) {
+  std::atomic<int> count(0);
+  {
+    ThreadPool<void> pool(2);
+    for (int i = 0; i < 10; ++i) {
+      pool.Add([&count]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ++count;
+      });
+    }
+  }
+  EXPECT_THAT(count, Eq(10));
+}
+
+}  // namespace internal_thread_pool
+}  // namespace base
+}  // namespace principia
@@ -0,0 +1,102 @@
+﻿
+// .\Release\x64\benchmarks.exe --benchmark_repetitions=3 --benchmark_filter=ContinuousTrajectory  // NOLINT(whitespace/line_length)
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "geometry/frame.hpp"
+#include "geometry/grassmann.hpp"
+#include "geometry/named_quantities.hpp"
+#include "physics/continuous_trajectory.hpp"
+#include "physics/degrees_of_freedom.hpp"
+#include "quantities/elementary_functions.hpp"
+#include "quantities/quantities.hpp"
+#include "quantities/si.hpp"
+#include "serialization/geometry.pb.h"
+
+// Must come last to avoid conflicts when defining the CHECK macros.
+#include "benchmark/benchmark.h"
+
+namespace principia {
+
+using geometry::Displacement;
+using geometry::Frame;
+using geometry::Instant;
+using geometry::Position;
+using geometry::Velocity;
+using quantities::Angle;
+using quantities::AngularFrequency;
+using quantities::Cos;
+using quantities::Length;
+using quantities::Sin;
+using quantities::Time;
+using quantities::si::Kilo;
+using quantities::si::Metre;
+using quantities::si::Milli;
+using quantities::si::Radian;
+using quantities::si::Second;
+
+namespace physics {
+
+namespace {
+
+using World = Frame<serialization::Frame::TestTag,
+                    serialization::Frame::TEST,
+                    /*frame_is_inertial=*/true>;
+
+Time const step = 3600 * Second;
+
+// A trajectory similar to that of Io, with |steps| points.
+std::unique_ptr<ContinuousTrajectory<World>> MakeTrajectory(int const steps) {
+  auto trajectory = std::make_unique<ContinuousTrajectory<World>>(
+      step, /*tolerance=*/5 * Milli(Metre));
+  Length const r = 421700 * Kilo(Metre);
+  AngularFrequency const ω = 4.11e-5 * Radian / Second;
+  for (int i = 0; i < steps; ++i) {
+    Instant const ti = Instant() + i * step;
+    Angle const θ = ω * (ti - Instant());
+    trajectory->Append(
+        ti,
+        DegreesOfFreedom<World>(
+            World::origin + Displacement<World>({r * Cos(θ),
+                                                 r * Sin(θ),
+                                                 0 * Metre}),
+            Velocity<World>({-ω * r * Sin(θ) / Radian,
+                             ω * r * Cos(θ) / Radian,
+                             0 * Metre / Second})));
+  }
+  return trajectory;
+}
+
+}  // namespace
+
+// Evaluates the trajectory at random times, without a hint, so that each
+// evaluation has to look up its series.
+void BM_ContinuousTrajectoryEvaluatePositionRandom(benchmark::State& state) {
+  auto const trajectory = MakeTrajectory(state.range_x());
+  Instant const t_min = trajectory->t_min();
+  Time const duration = trajectory->t_max() - t_min;
+  std::mt19937_64 random(42);
+  std::uniform_real_distribution<> fraction_distribution(0, 1);
+  std::vector<Instant> times;
+  for (int i = 0; i < 1000; ++i) {
+    times.push_back(t_min + fraction_distribution(random) * duration);
+  }
+  while (state.KeepRunning()) {
+    for (Instant const& t : times) {
+      benchmark::DoNotOptimize(
+          trajectory->EvaluatePosition(t, /*hint=*/nullptr));
+    }
+  }
+  state.SetLabel(std::to_string(times.size()) + " evaluations");
+}
+
+BENCHMARK(BM_ContinuousTrajectoryEvaluatePositionRandom)
+    ->Arg(1000)
+    ->Arg(100000)
+    ->Arg(1000000);
+
+}  // namespace physics
+}  // namespace principia
@@ -0,0 +1,156 @@
+﻿
+// .\Release\x64\benchmarks.exe --benchmark_repetitions=3 --benchmark_filter=DiscreteTrajectory  // NOLINT(whitespace/line_length)
+
+#include <experimental/optional>  // NOLINT
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/not_null.hpp"
+#include "geometry/frame.hpp"
+#include "geometry/grassmann.hpp"
+#include "geometry/named_quantities.hpp"
+#include "physics/degrees_of_freedom.hpp"
+#include "physics/discrete_trajectory.hpp"
+#include "quantities/elementary_functions.hpp"
+#include "quantities/quantities.hpp"
+#include "quantities/si.hpp"
+#include "serialization/geometry.pb.h"
+#include "serialization/physics.pb.h"
+
+// Must come last to avoid conflicts when defining the CHECK macros.
+#include "benchmark/benchmark.h"
+
+namespace principia {
+
+using base::not_null;
+using geometry::Displacement;
+using geometry::Frame;
+using geometry::Instant;
+using geometry::Velocity;
+using physics::DegreesOfFreedom;
+using physics::DiscreteTrajectory;
+using quantities::Cos;
+using quantities::Length;
+using quantities::Sin;
+using quantities::Speed;
+using quantities::si::Kilo;
+using quantities::si::Metre;
+using quantities::si::Radian;
+using quantities::si::Second;
+
+namespace physics {
+
+namespace {
+
+using World = Frame<serialization::Frame::TestTag,
+                    serialization::Frame::TEST,
+                    /*frame_is_inertial=*/true>;
+
+using Compression = serialization::DiscreteTrajectory::PackedTimeline;
+
+// A history similar to that of a vessel in low orbit, with points every 10 s.
+std::unique_ptr<DiscreteTrajectory<World>> MakeHistory(int const size) {
+  auto trajectory = std::make_unique<DiscreteTrajectory<World>>();
+  Instant const t0 = Instant() + 5e8 * Second;
+  Length const r = 6700 * Kilo(Metre);
+  Speed const v = 7.7 * Kilo(Metre) / Second;
+  double const ω = 1.15e-3;
+  for (int i = 0; i < size; ++i) {
+    double const θ = ω * 10 * i;
+    trajectory->Append(
+        t0 + 10 * i * Second,
+        DegreesOfFreedom<World>(
+            World::origin + Displacement<World>({r * Cos(θ * Radian),
+                                                 r * Sin(θ * Radian),
+                                                 0.01 * r * Sin(θ * Radian)}),
+            Velocity<World>({-v * Sin(θ * Radian),
+                             v * Cos(θ * Radian),
+                             0.01 * v * Cos(θ * Radian)})));
+  }
+  return trajectory;
+}
+
+void WriteToMessage(
+    DiscreteTrajectory<World> const& trajectory,
+    std::experimental::optional<
+        serialization::DiscreteTrajectory::PackedTimeline::Compression> const&
+        compression,
+    not_null<serialization::DiscreteTrajectory*> const message) {
+  if (compression) {
+    trajectory.WriteToMessage(message, /*forks=*/{}, *compression);
+  } else {
+    trajectory.WriteToMessage(message, /*forks=*/{});
+  }
+}
+
+void BenchmarkWriteToMessage(
+    std::experimental::optional<
+        serialization::DiscreteTrajectory::PackedTimeline::Compression> const&
+        compression,
+    benchmark::State& state) {
+  auto const trajectory = MakeHistory(state.range_x());
+  std::string bytes;
+  while (state.KeepRunning()) {
+    serialization::DiscreteTrajectory message;
+    WriteToMessage(*trajectory, compression, &message);
+    message.SerializeToString(&bytes);
+  }
+  state.SetLabel(std::to_string(bytes.size()) + " bytes");
+}
+
+void BenchmarkReadFromMessage(
+    std::experimental::optional<
+        serialization::DiscreteTrajectory::PackedTimeline::Compression> const&
+        compression,
+    benchmark::State& state) {
+  std::string bytes;
+  {
+    auto const trajectory = MakeHistory(state.range_x());
+    serialization::DiscreteTrajectory message;
+    WriteToMessage(*trajectory, compression, &message);
+    message.SerializeToString(&bytes);
+  }
+  while (state.KeepRunning()) {
+    serialization::DiscreteTrajectory message;
+    message.ParseFromString(bytes);
+    benchmark::DoNotOptimize(
+        DiscreteTrajectory<World>::ReadFromMessage(message, /*forks=*/{}));
+  }
+}
+
+}  // namespace
+
+void BM_DiscreteTrajectoryWriteToMessageVerbose(benchmark::State& state) {
+  BenchmarkWriteToMessage(std::experimental::nullopt, state);
+}
+
+void BM_DiscreteTrajectoryWriteToMessagePacked(benchmark::State& state) {
+  BenchmarkWriteToMessage(Compression::NONE, state);
+}
+
+void BM_DiscreteTrajectoryWriteToMessagePackedXor(benchmark::State& state) {
+  BenchmarkWriteToMessage(Compression::XOR, state);
+}
+
+void BM_DiscreteTrajectoryReadFromMessageVerbose(benchmark::State& state) {
+  BenchmarkReadFromMessage(std::experimental::nullopt, state);
+}
+
+void BM_DiscreteTrajectoryReadFromMessagePacked(benchmark::State& state) {
+  BenchmarkReadFromMessage(Compression::NONE, state);
+}
+
+void BM_DiscreteTrajectoryReadFromMessagePackedXor(benchmark::State& state) {
+  BenchmarkReadFromMessage(Compression::XOR, state);
+}
+
+BENCHMARK(BM_DiscreteTrajectoryWriteToMessageVerbose)->Arg(100000);
+BENCHMARK(BM_DiscreteTrajectoryWriteToMessagePacked)->Arg(100000);
+BENCHMARK(BM_DiscreteTrajectoryWriteToMessagePackedXor)->Arg(100000);
+BENCHMARK(BM_DiscreteTrajectoryReadFromMessageVerbose)->Arg(100000);
+BENCHMARK(BM_DiscreteTrajectoryReadFromMessagePacked)->Arg(100000);
+BENCHMARK(BM_DiscreteTrajectoryReadFromMessagePackedXor)->Arg(100000);
+
+}  // namespace physics
+}  // namespace principia
@@ -4,7 +4,9 @@
 #include <cmath>
 #include <limits>
 #include <memory>
+#include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "astronomy/frames.hpp"
@@ -17,6 +19,9 @@
 #include "physics/degrees_of_freedom.hpp"
 #include "physics/discrete_trajectory.hpp"
 #include "physics/ephemeris.hpp"
+#include "physics/hierarchical_system.hpp"
+#include "physics/kepler_orbit.hpp"
+#include "physics/massive_body.hpp"
 #include "physics/massless_body.hpp"
 #include "quantities/astronomy.hpp"
 #include "quantities/bipm.hpp"
@@ -34,6 +39,7 @@ namespace principia {
 using astronomy::ICRFJ2000Ecliptic;
 using astronomy::ICRFJ2000Equator;
 using astronomy::ICRFJ200EquatorialToEcliptic;
+using base::make_not_null_unique;
 using base::not_null;
 using geometry::Displacement;
 using geometry::Instant;
@@ -44,16 +50,21 @@ using geometry::Velocity;
 using integrators::DormandElMikkawyPrince1986RKN434FM;
 using integrators::McLachlanAtela1992Order5Optimal;
 using quantities::DebugString;
+using quantities::GravitationalParameter;
 using quantities::Length;
+using quantities::Pow;
 using quantities::Speed;
 using quantities::Sqrt;
 using quantities::astronomy::JulianYear;
 using quantities::bipm::NauticalMile;
 using quantities::si::AstronomicalUnit;
+using quantities::si::Day;
+using quantities::si::Degree;
 using quantities::si::Kilo;
 using quantities::si::Metre;
 using quantities::si::Milli;
 using quantities::si::Minute;
+using quantities::si::Radian;
 using quantities::si::Second;
 using testing_utilities::SolarSystemFactory;
 
@@ -61,8 +72,10 @@ namespace physics {
 
 namespace {
 
-void EphemerisSolarSystemBenchmark(SolarSystemFactory::Accuracy const accuracy,
-                                   benchmark::State& state) {
+void EphemerisSolarSystemBenchmark(
+    SolarSystemFactory::Accuracy const accuracy,
+    Ephemeris<ICRFJ2000Equator>::MassiveBodiesKernel const kernel,
+    benchmark::State& state) {
   Length const fitting_tolerance = 5 * std::pow(10.0, state.range_x()) * Metre;
   Length error;
   while (state.KeepRunning()) {
@@ -77,6 +90,7 @@ void EphemerisSolarSystemBenchmark(SolarSystemFactory::Accuracy const accuracy,
             Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
                 McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
                 /*step=*/45 * Minute));
+    ephemeris->set_massive_bodies_kernel(kernel);
 
     state.ResumeTiming();
     ephemeris->Prolong(final_time);
@@ -95,6 +109,77 @@ void EphemerisSolarSystemBenchmark(SolarSystemFactory::Accuracy const accuracy,
   state.SetLabel(quantities::DebugString(error / AstronomicalUnit) + " ua");
 }
 
+// The Sun, the giant planets, and enough asteroids in the main belt to make
+// |number_of_bodies| bodies.
+not_null<std::unique_ptr<Ephemeris<ICRFJ2000Equator>>>
+MakeAsteroidBeltEphemeris(int const number_of_bodies) {
+  auto const μ = [](double const value) {
+    return value * Pow<3>(Metre) / Pow<2>(Second);
+  };
+  auto sun = make_not_null_unique<MassiveBody>(μ(1.32712440018e20));
+  MassiveBody const* const sun_pointer = sun.get();
+  HierarchicalSystem<ICRFJ2000Equator> system(std::move(sun));
+
+  // The gravitational parameters (in m³/s²) and semimajor axes (in ua) of the
+  // giant planets.
+  std::vector<std::pair<double, double>> const planets = {{1.26686534e17, 5.20},
+                                                          {3.7931187e16, 9.58},
+                                                          {5.793939e15, 19.2},
+                                                          {6.836529e15, 30.05}};
+  KeplerianElements<ICRFJ2000Equator> elements;
+  for (auto const& planet : planets) {
+    elements.semimajor_axis = planet.second * AstronomicalUnit;
+    elements.mean_anomaly += 1 * Radian;
+    system.Add(make_not_null_unique<MassiveBody>(μ(planet.first)),
+               sun_pointer,
+               elements);
+  }
+
+  std::mt19937_64 random(42);
+  std::uniform_real_distribution<> asteroid_μ_distribution(1e5, 1e9);
+  std::uniform_real_distribution<> semimajor_axis_distribution(2.1, 3.3);
+  std::uniform_real_distribution<> eccentricity_distribution(0, 0.2);
+  std::uniform_real_distribution<> inclination_distribution(0, 10);
+  std::uniform_real_distribution<> angle_distribution(0, 360);
+  for (int i = 1 + planets.size(); i < number_of_bodies; ++i) {
+    elements.eccentricity = eccentricity_distribution(random);
+    elements.semimajor_axis =
+        semimajor_axis_distribution(random) * AstronomicalUnit;
+    elements.inclination = inclination_distribution(random) * Degree;
+    elements.longitude_of_ascending_node = angle_distribution(random) * Degree;
+    elements.argument_of_periapsis = angle_distribution(random) * Degree;
+    elements.mean_anomaly = angle_distribution(random) * Degree;
+    system.Add(
+        make_not_null_unique<MassiveBody>(μ(asteroid_μ_distribution(random))),
+        sun_pointer,
+        elements);
+  }
+
+  auto barycentric_system = system.ConsumeBarycentricSystem();
+  return make_not_null_unique<Ephemeris<ICRFJ2000Equator>>(
+      std::move(barycentric_system.bodies),
+      barycentric_system.degrees_of_freedom,
+      Instant(),
+      /*fitting_tolerance=*/1 * Metre,
+      Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+          McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+          /*step=*/1 * Day));
+}
+
+void EphemerisAsteroidBeltBenchmark(
+    Ephemeris<ICRFJ2000Equator>::MassiveBodiesKernel const kernel,
+    benchmark::State& state) {
+  int const number_of_bodies = state.range_x();
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    auto const ephemeris = MakeAsteroidBeltEphemeris(number_of_bodies);
+    ephemeris->set_massive_bodies_kernel(kernel);
+    state.ResumeTiming();
+    ephemeris->Prolong(Instant() + 30 * Day);
+  }
+  state.SetLabel(std::to_string(number_of_bodies) + " bodies");
+}
+
 void EphemerisL4ProbeBenchmark(SolarSystemFactory::Accuracy const accuracy,
                                benchmark::State& state) {
   Length const fitting_tolerance = 5 * std::pow(10.0, state.range_x()) * Metre;
@@ -277,14 +362,17 @@ void EphemerisLEOProbeBenchmark(SolarSystemFactory::Accuracy const accuracy,
 
 void BM_EphemerisSolarSystemMajorBodiesOnly(
     benchmark::State& state) {  // NOLINT(runtime/references)
-  EphemerisSolarSystemBenchmark(SolarSystemFactory::Accuracy::MajorBodiesOnly,
-                                state);
+  EphemerisSolarSystemBenchmark(
+      SolarSystemFactory::Accuracy::MajorBodiesOnly,
+      Ephemeris<ICRFJ2000Equator>::MassiveBodiesKernel::Scalar,
+      state);
 }
 
 void BM_EphemerisSolarSystemMinorAndMajorBodies(
     benchmark::State& state) {  // NOLINT(runtime/references)
   EphemerisSolarSystemBenchmark(
       SolarSystemFactory::Accuracy::MinorAndMajorBodies,
+      Ephemeris<ICRFJ2000Equator>::MassiveBodiesKernel::Scalar,
       state);
 }
 
@@ -292,9 +380,30 @@ void BM_EphemerisSolarSystemAllBodiesAndOblateness(
     benchmark::State& state) {  // NOLINT(runtime/references)
   EphemerisSolarSystemBenchmark(
       SolarSystemFactory::Accuracy::AllBodiesAndOblateness,
+      Ephemeris<ICRFJ2000Equator>::MassiveBodiesKernel::Scalar,
+      state);
+}
+
+void BM_EphemerisSolarSystemAllBodiesAndOblatenessVectorized(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  EphemerisSolarSystemBenchmark(
+      SolarSystemFactory::Accuracy::AllBodiesAndOblateness,
+      Ephemeris<ICRFJ2000Equator>::MassiveBodiesKernel::Vectorized,
       state);
 }
 
+void BM_EphemerisAsteroidBeltScalar(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  EphemerisAsteroidBeltBenchmark(
+      Ephemeris<ICRFJ2000Equator>::MassiveBodiesKernel::Scalar, state);
+}
+
+void BM_EphemerisAsteroidBeltBarnesHut(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  EphemerisAsteroidBeltBenchmark(
+      Ephemeris<ICRFJ2000Equator>::MassiveBodiesKernel::BarnesHut, state);
+}
+
 void BM_EphemerisL4ProbeMajorBodiesOnly(
     benchmark::State& state) {  // NOLINT(runtime/references)
   EphemerisL4ProbeBenchmark(SolarSystemFactory::Accuracy::MajorBodiesOnly,
@@ -342,6 +451,11 @@ void BM_EphemerisFittingTolerance(
 BENCHMARK(BM_EphemerisSolarSystemMajorBodiesOnly)->Arg(-3);
 BENCHMARK(BM_EphemerisSolarSystemMinorAndMajorBodies)->Arg(-3);
 BENCHMARK(BM_EphemerisSolarSystemAllBodiesAndOblateness)->Arg(-3);
+BENCHMARK(BM_EphemerisSolarSystemAllBodiesAndOblatenessVectorized)->Arg(-3);
+BENCHMARK(BM_EphemerisAsteroidBeltScalar)
+    ->Arg(100)->Arg(300)->Arg(1000)->Arg(3000)->Arg(10000);
+BENCHMARK(BM_EphemerisAsteroidBeltBarnesHut)
+    ->Arg(100)->Arg(300)->Arg(1000)->Arg(3000)->Arg(10000);
 BENCHMARK(BM_EphemerisL4ProbeMajorBodiesOnly)->Arg(-3);
 BENCHMARK(BM_EphemerisL4ProbeMinorAndMajorBodies)->Arg(-3);
 BENCHMARK(BM_EphemerisL4ProbeAllBodiesAndOblateness)->Arg(-3);
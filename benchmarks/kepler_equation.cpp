@@ -0,0 +1,104 @@
+﻿
+// .\Release\x64\benchmarks.exe --benchmark_repetitions=3 --benchmark_filter=KeplerEquation  // NOLINT(whitespace/line_length)
+
+#include <random>
+#include <vector>
+
+#include "numerics/root_finders.hpp"
+#include "physics/kepler_equation.hpp"
+#include "quantities/elementary_functions.hpp"
+#include "quantities/numbers.hpp"
+#include "quantities/quantities.hpp"
+#include "quantities/si.hpp"
+
+// Must come last to avoid conflicts when defining the CHECK macros.
+#include "benchmark/benchmark.h"
+
+namespace principia {
+
+using numerics::Bisect;
+using quantities::Angle;
+using quantities::Sin;
+using quantities::si::Radian;
+
+namespace physics {
+
+namespace {
+
+// The number of mean anomalies solved per iteration of the benchmarks.
+constexpr int mean_anomalies_size = 1000;
+
+// Mean anomalies spread over a few revolutions.
+std::vector<Angle> MeanAnomalies() {
+  std::mt19937_64 random(42);
+  std::uniform_real_distribution<> distribution(-4 * π, 4 * π);
+  std::vector<Angle> mean_anomalies;
+  for (int i = 0; i < mean_anomalies_size; ++i) {
+    mean_anomalies.push_back(distribution(random) * Radian);
+  }
+  return mean_anomalies;
+}
+
+// The eccentricity is given in thousandths by the benchmark argument.
+double Eccentricity(benchmark::State const& state) {
+  return state.range_x() / 1000.0;
+}
+
+}  // namespace
+
+// The solver formerly used by |KeplerOrbit::StateVectors|, for comparison.
+void BM_KeplerEquationBisect(benchmark::State& state) {
+  double const e = Eccentricity(state);
+  std::vector<Angle> const mean_anomalies = MeanAnomalies();
+  while (state.KeepRunning()) {
+    for (Angle const& M : mean_anomalies) {
+      auto const kepler_equation = [e, M](Angle const& E) -> Angle {
+        return M - (E - e * Sin(E) * Radian);
+      };
+      benchmark::DoNotOptimize(
+          Bisect(kepler_equation, M - e * Radian, M + e * Radian));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * mean_anomalies_size);
+}
+
+void BM_KeplerEquationElliptic(benchmark::State& state) {
+  double const e = Eccentricity(state);
+  std::vector<Angle> const mean_anomalies = MeanAnomalies();
+  while (state.KeepRunning()) {
+    for (Angle const& M : mean_anomalies) {
+      benchmark::DoNotOptimize(EllipticEccentricAnomaly(e, M));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * mean_anomalies_size);
+}
+
+void BM_KeplerEquationHyperbolic(benchmark::State& state) {
+  double const e = Eccentricity(state);
+  std::vector<Angle> const mean_anomalies = MeanAnomalies();
+  while (state.KeepRunning()) {
+    for (Angle const& M : mean_anomalies) {
+      benchmark::DoNotOptimize(HyperbolicEccentricAnomaly(e, M));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * mean_anomalies_size);
+}
+
+void BM_KeplerEquationBatched(benchmark::State& state) {
+  double const e = Eccentricity(state);
+  std::vector<Angle> const mean_anomalies = MeanAnomalies();
+  std::vector<Angle> eccentric_anomalies;
+  while (state.KeepRunning()) {
+    EccentricAnomalies(e, mean_anomalies, eccentric_anomalies);
+    benchmark::DoNotOptimize(eccentric_anomalies.data());
+  }
+  state.SetItemsProcessed(state.iterations() * mean_anomalies_size);
+}
+
+BENCHMARK(BM_KeplerEquationBisect)->Arg(10)->Arg(500)->Arg(990);
+BENCHMARK(BM_KeplerEquationElliptic)->Arg(10)->Arg(500)->Arg(990);
+BENCHMARK(BM_KeplerEquationHyperbolic)->Arg(1010)->Arg(2000)->Arg(10000);
+BENCHMARK(BM_KeplerEquationBatched)->Arg(500)->Arg(2000);
+
+}  // namespace physics
+}  // namespace principia
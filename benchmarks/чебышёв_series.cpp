@@ -222,6 +222,49 @@ void BM_EvaluateDisplacement(
   state.SetLabel(ss.str().substr(0, 0));
 }
 
+// Evaluates the position and the velocity in a single pass, as done by
+// |ContinuousTrajectory::EvaluateDegreesOfFreedom|.
+void BM_EvaluateDisplacementWithDerivative(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  int const degree = state.range_x();
+  std::mt19937_64 random(42);
+  std::vector<Displacement<ICRFJ2000Ecliptic>> coefficients;
+  for (int i = 0; i <= degree; ++i) {
+    coefficients.push_back(
+        Displacement<ICRFJ2000Ecliptic>(
+            {static_cast<double>(random()) * Metre,
+             static_cast<double>(random()) * Metre,
+             static_cast<double>(random()) * Metre}));
+  }
+  Instant const t0;
+  Instant const t_min = t0 + static_cast<double>(random()) * Second;
+  Instant const t_max = t_min + static_cast<double>(random()) * Second;
+  ЧебышёвSeries<Displacement<ICRFJ2000Ecliptic>> const series(
+    coefficients, t_min, t_max);
+
+  Instant t = t_min;
+  Time const Δt = (t_max - t_min) * 1e-9;
+  Displacement<ICRFJ2000Ecliptic> result{};
+  Variation<Displacement<ICRFJ2000Ecliptic>> derivative_result{};
+
+  while (state.KeepRunning()) {
+    for (int i = 0; i < evaluations_per_iteration; ++i) {
+      Displacement<ICRFJ2000Ecliptic> value;
+      Variation<Displacement<ICRFJ2000Ecliptic>> derivative;
+      series.EvaluateWithDerivative(t, value, derivative);
+      result += value;
+      derivative_result += derivative;
+      t += Δt;
+    }
+  }
+
+  // This weird call to |SetLabel| has no effect except that it uses |result|
+  // and therefore prevents the loop from being optimized away.
+  std::stringstream ss;
+  ss << result << derivative_result;
+  state.SetLabel(ss.str().substr(0, 0));
+}
+
 void BM_NewhallApproximation(
     benchmark::State& state) {  // NOLINT(runtime/references)
   int const degree = state.range_x();
@@ -246,6 +289,85 @@ void BM_NewhallApproximation(
   }
 }
 
+namespace {
+
+// The degree of the approximations of the benchmarks below, typical of the
+// trajectories of the planets.
+int const displacements_degree = 12;
+
+// Fills |q| and |v| with random samples for the number of bodies given by the
+// benchmark argument.
+void RandomDisplacements(
+    benchmark::State const& state,
+    std::mt19937_64& random,
+    std::vector<std::vector<Displacement<ICRFJ2000Ecliptic>>>& q,
+    std::vector<std::vector<Variation<Displacement<ICRFJ2000Ecliptic>>>>& v) {
+  int const bodies = state.range_x();
+  q.assign(bodies, {});
+  v.assign(bodies, {});
+  for (int b = 0; b < bodies; ++b) {
+    for (int i = 0; i <= 8; ++i) {
+      q[b].push_back(Displacement<ICRFJ2000Ecliptic>(
+          {static_cast<double>(random()) * Metre,
+           static_cast<double>(random()) * Metre,
+           static_cast<double>(random()) * Metre}));
+      v[b].push_back(Displacement<ICRFJ2000Ecliptic>(
+                         {static_cast<double>(random()) * Metre,
+                          static_cast<double>(random()) * Metre,
+                          static_cast<double>(random()) * Metre}) /
+                     Second);
+    }
+  }
+}
+
+}  // namespace
+
+// One approximation per body, as done by |ContinuousTrajectory|.
+void BM_NewhallApproximationDisplacements(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  std::mt19937_64 random(42);
+  std::vector<std::vector<Displacement<ICRFJ2000Ecliptic>>> q;
+  std::vector<std::vector<Variation<Displacement<ICRFJ2000Ecliptic>>>> v;
+  Instant const t0;
+  Instant const t_min = t0 + static_cast<double>(random()) * Second;
+  Instant const t_max = t_min + static_cast<double>(random()) * Second;
+
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    RandomDisplacements(state, random, q, v);
+    state.ResumeTiming();
+    for (int b = 0; b < q.size(); ++b) {
+      auto const series =
+          ЧебышёвSeries<Displacement<ICRFJ2000Ecliptic>>::NewhallApproximation(
+              displacements_degree, q[b], v[b], t_min, t_max);
+      benchmark::DoNotOptimize(series);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range_x());
+}
+
+// All the bodies at once.
+void BM_NewhallApproximationDisplacementsBatched(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  std::mt19937_64 random(42);
+  std::vector<std::vector<Displacement<ICRFJ2000Ecliptic>>> q;
+  std::vector<std::vector<Variation<Displacement<ICRFJ2000Ecliptic>>>> v;
+  Instant const t0;
+  Instant const t_min = t0 + static_cast<double>(random()) * Second;
+  Instant const t_max = t_min + static_cast<double>(random()) * Second;
+
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    RandomDisplacements(state, random, q, v);
+    state.ResumeTiming();
+    auto const series =
+        ЧебышёвSeries<Displacement<ICRFJ2000Ecliptic>>::NewhallApproximations(
+            {displacements_degree}, q, v, t_min, t_max);
+    benchmark::DoNotOptimize(series);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range_x());
+}
+
 BENCHMARK(BM_EvaluateDouble)->
     Arg(4)->Arg(8)->Arg(15)->Arg(16)->Arg(17)->Arg(18)->Arg(19);
 BENCHMARK(BM_EvaluateQuantity)->
@@ -256,8 +378,13 @@ BENCHMARK(BM_EvaluateVectorDouble)->
     Arg(4)->Arg(8)->Arg(15)->Arg(16)->Arg(17)->Arg(18)->Arg(19);
 BENCHMARK(BM_EvaluateDisplacement)->
     Arg(4)->Arg(8)->Arg(15)->Arg(16)->Arg(17)->Arg(18)->Arg(19);
+BENCHMARK(BM_EvaluateDisplacementWithDerivative)->
+    Arg(4)->Arg(8)->Arg(15)->Arg(16)->Arg(17)->Arg(18)->Arg(19);
 BENCHMARK(BM_NewhallApproximation)->
     Arg(4)->Arg(8)->Arg(16);
+BENCHMARK(BM_NewhallApproximationDisplacements)->Arg(1)->Arg(16)->Arg(64);
+BENCHMARK(BM_NewhallApproximationDisplacementsBatched)->
+    Arg(1)->Arg(16)->Arg(64);
 
 }  // namespace numerics
 }  // namespace principia
@@ -96,6 +96,20 @@ class EmbeddedExplicitRungeKuttaNyströmIntegrator
              EmbeddedExplicitRungeKuttaNyströmIntegrator const& integrator);
 
     EmbeddedExplicitRungeKuttaNyströmIntegrator const& integrator_;
+
+    // The buffers used by |Solve|, kept here so that they are only allocated
+    // once.  See |Solve| for their meaning.
+    std::vector<typename ODE::Displacement> Δq_hat_;
+    std::vector<typename ODE::Velocity> Δv_hat_;
+    typename ODE::SystemStateError error_estimate_;
+    std::vector<Position> q_stage_;
+    std::vector<std::vector<typename ODE::Acceleration>> g_;
+    typename ODE::SystemState final_state_;
+    typename ODE::DenseOutput dense_output_;
+    std::vector<Position> q_start_;
+    std::vector<typename ODE::Velocity> v_start_;
+    std::vector<typename ODE::Acceleration> g_end_;
+
     friend class EmbeddedExplicitRungeKuttaNyströmIntegrator;
   };
 
@@ -6,7 +6,7 @@
 #include <algorithm>
 #include <cmath>
 #include <ctime>
-#include <experimental/optional>
+#include <utility>
 #include <vector>
 
 #include "geometry/sign.hpp"
@@ -111,7 +111,8 @@ Instance::Solve(Instant const& t_final) {
   // restartability.
 
   // State before the last, truncated step.
-  std::experimental::optional<typename ODE::SystemState> final_state;
+  typename ODE::SystemState& final_state = final_state_;
+  bool has_final_state = false;
 
   // Argument checks.
   int const dimension = current_state.positions.size();
@@ -132,9 +133,11 @@ Instance::Solve(Instant const& t_final) {
   DoublePrecision<Instant>& t = current_state.time;
 
   // Position increment (high-order).
-  std::vector<Displacement> Δq_hat(dimension);
+  std::vector<Displacement>& Δq_hat = Δq_hat_;
+  Δq_hat.resize(dimension);
   // Velocity increment (high-order).
-  std::vector<Velocity> Δv_hat(dimension);
+  std::vector<Velocity>& Δv_hat = Δv_hat_;
+  Δv_hat.resize(dimension);
   // Current position.  This is a non-const reference whose purpose is to make
   // the equations more readable.
   std::vector<DoublePrecision<Position>>& q_hat = current_state.positions;
@@ -143,19 +146,41 @@ Instance::Solve(Instant const& t_final) {
   std::vector<DoublePrecision<Velocity>>& v_hat = current_state.velocities;
 
   // Difference between the low- and high-order approximations.
-  typename ODE::SystemStateError error_estimate;
+  typename ODE::SystemStateError& error_estimate = error_estimate_;
   error_estimate.position_error.resize(dimension);
   error_estimate.velocity_error.resize(dimension);
 
   // Current Runge-Kutta-Nyström stage.
-  std::vector<Position> q_stage(dimension);
+  std::vector<Position>& q_stage = q_stage_;
+  q_stage.resize(dimension);
   // Accelerations at each stage.
   // TODO(egg): this is a rectangular container, use something more appropriate.
-  std::vector<std::vector<Acceleration>> g(stages);
+  std::vector<std::vector<Acceleration>>& g = g_;
+  g.resize(stages);
   for (auto& g_stage : g) {
     g_stage.resize(dimension);
   }
 
+  // Interpolant of the last step, only computed if requested.
+  bool const has_dense_output =
+      adaptive_step_size.append_dense_output != nullptr;
+  typename ODE::DenseOutput& dense_output = dense_output_;
+  // Positions and velocities at the beginning of the last step, used to
+  // compute |dense_output|.
+  std::vector<Position>& q_start = q_start_;
+  std::vector<Velocity>& v_start = v_start_;
+  // Accelerations at the end of the last step, used to compute |dense_output|
+  // if the accelerations of the next step cannot be reused.
+  std::vector<Acceleration>& g_end = g_end_;
+  if (has_dense_output) {
+    dense_output.reserve(dimension);
+    q_start.resize(dimension);
+    v_start.resize(dimension);
+    if (!first_same_as_last) {
+      g_end.resize(dimension);
+    }
+  }
+
   bool at_end = false;
   double tolerance_to_error_ratio;
 
@@ -197,7 +222,9 @@ Instance::Solve(Instant const& t_final) {
         // The chosen step size will overshoot.  Clip it to just reach the end,
         // and terminate if the step is accepted.
         h = time_to_end;
+        // Reuses the storage of |final_state|.
         final_state = current_state;
+        has_final_state = true;
       }
 
       // Runge-Kutta-Nyström iteration; fills |g|.
@@ -248,11 +275,42 @@ Instance::Solve(Instant const& t_final) {
     }
 
     // Increment the solution with the high-order approximation.
+    Instant const t_start = t.value;
     t.Increment(h);
     for (int k = 0; k < dimension; ++k) {
+      if (has_dense_output) {
+        q_start[k] = q_hat[k].value;
+        v_start[k] = v_hat[k].value;
+      }
       q_hat[k].Increment(Δq_hat[k]);
       v_hat[k].Increment(Δv_hat[k]);
     }
+    if (has_dense_output) {
+      // In the FSAL case, the swap above has moved the accelerations at the
+      // beginning of the step to |g.back()|, and the last stage, which is
+      // evaluated at the end of the step, to |g.front()|.  Otherwise we need
+      // one more evaluation.
+      std::vector<Acceleration> const* g_start_of_step = &g.front();
+      std::vector<Acceleration> const* g_end_of_step = &g.back();
+      if (first_same_as_last) {
+        std::swap(g_start_of_step, g_end_of_step);
+      } else {
+        for (int k = 0; k < dimension; ++k) {
+          q_stage[k] = q_hat[k].value;
+        }
+        equation.compute_acceleration(t.value, q_stage, g_end);
+        g_end_of_step = &g_end;
+      }
+      dense_output.clear();
+      for (int k = 0; k < dimension; ++k) {
+        dense_output.emplace_back(
+            std::make_pair(t_start, t.value),
+            std::make_pair(q_start[k], q_hat[k].value),
+            std::make_pair(v_start[k], v_hat[k].value),
+            std::make_pair((*g_start_of_step)[k], (*g_end_of_step)[k]));
+      }
+      adaptive_step_size.append_dense_output(dense_output);
+    }
     append_state(current_state);
     ++step_count;
     if (step_count == adaptive_step_size.max_steps && !at_end) {
@@ -265,8 +323,8 @@ Instance::Solve(Instant const& t_final) {
     }
   }
   // The resolution is restartable from the last non-truncated state.
-  CHECK(final_state);
-  current_state = *final_state;
+  CHECK(has_final_state);
+  current_state = final_state;
   return Status(termination_condition::Done, "");
 }
 
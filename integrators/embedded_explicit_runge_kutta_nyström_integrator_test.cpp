@@ -235,6 +235,107 @@ TEST_F(EmbeddedExplicitRungeKuttaNyströmIntegratorTest,
   }
 }
 
+TEST_F(EmbeddedExplicitRungeKuttaNyströmIntegratorTest, DenseOutput) {
+  AdaptiveStepSizeIntegrator<ODE> const& integrator =
+      DormandElMikkawyPrince1986RKN434FM<Length>();
+  Length const x_initial = 1 * Metre;
+  Speed const v_initial = 0 * Metre / Second;
+  Time const period = 2 * π * Second;
+  AngularFrequency const ω = 1 * Radian / Second;
+  Instant const t_initial;
+  Instant const t_final = t_initial + 10 * period;
+  Length const length_tolerance = 1 * Milli(Metre);
+  Speed const speed_tolerance = 1 * Milli(Metre) / Second;
+  int const steps_forward = 132;
+
+  auto const step_size_callback = [](bool tolerable) {};
+
+  int evaluations = 0;
+  std::vector<ODE::SystemState> solution;
+  std::vector<ODE::DenseOutput> dense_outputs;
+  ODE harmonic_oscillator;
+  harmonic_oscillator.compute_acceleration =
+      std::bind(ComputeHarmonicOscillatorAcceleration,
+                _1, _2, _3, &evaluations);
+  IntegrationProblem<ODE> problem;
+  problem.equation = harmonic_oscillator;
+  ODE::SystemState const initial_state = {{x_initial}, {v_initial}, t_initial};
+  problem.initial_state = &initial_state;
+  auto const append_state = [&solution](ODE::SystemState const& state) {
+    solution.push_back(state);
+  };
+  AdaptiveStepSize<ODE> adaptive_step_size;
+  adaptive_step_size.first_time_step = t_final - t_initial;
+  adaptive_step_size.safety_factor = 0.9;
+  adaptive_step_size.tolerance_to_error_ratio =
+      std::bind(HarmonicOscillatorToleranceRatio,
+                _1, _2, length_tolerance, speed_tolerance, step_size_callback);
+
+  auto instance =
+      integrator.NewInstance(problem, append_state, adaptive_step_size);
+  auto outcome = instance->Solve(t_final);
+  EXPECT_EQ(termination_condition::Done, outcome.error());
+  std::vector<ODE::SystemState> const solution_without_dense_output = solution;
+  int const evaluations_without_dense_output = evaluations;
+
+  solution.clear();
+  evaluations = 0;
+  adaptive_step_size.append_dense_output =
+      [&dense_outputs](ODE::DenseOutput const& dense_output) {
+        dense_outputs.push_back(dense_output);
+      };
+  instance = integrator.NewInstance(problem, append_state, adaptive_step_size);
+  outcome = instance->Solve(t_final);
+  EXPECT_EQ(termination_condition::Done, outcome.error());
+
+  // The dense output doesn't change the integration, and, thanks to the FSAL
+  // property, it doesn't cost any evaluation.
+  EXPECT_EQ(evaluations_without_dense_output, evaluations);
+  ASSERT_EQ(steps_forward, solution.size());
+  ASSERT_EQ(steps_forward, dense_outputs.size());
+
+  Length max_position_error;
+  Speed max_velocity_error;
+  for (int i = 0; i < steps_forward; ++i) {
+    EXPECT_EQ(solution_without_dense_output[i].positions[0].value,
+              solution[i].positions[0].value);
+    ASSERT_EQ(1, dense_outputs[i].size());
+    auto const& interpolant = dense_outputs[i][0];
+    ODE::SystemState const& start =
+        i == 0 ? initial_state : solution[i - 1];
+    ODE::SystemState const& end = solution[i];
+    EXPECT_EQ(start.time.value, interpolant.arguments().first);
+    EXPECT_EQ(end.time.value, interpolant.arguments().second);
+    EXPECT_THAT(AbsoluteError(end.positions[0].value,
+                              interpolant.Evaluate(end.time.value)),
+                Le(1e-15 * Metre));
+    EXPECT_THAT(AbsoluteError(end.velocities[0].value,
+                              interpolant.EvaluateDerivative(end.time.value)),
+                Le(1e-15 * Metre / Second));
+
+    // Compare the interpolant with the exact solution starting from the
+    // beginning of the step.
+    Length const q0 = start.positions[0].value;
+    Speed const v0 = start.velocities[0].value;
+    Time const h = end.time.value - start.time.value;
+    for (int j = 1; j < 10; ++j) {
+      Time const τ = j * h / 10;
+      Instant const t = start.time.value + τ;
+      max_position_error = std::max(
+          max_position_error,
+          AbsoluteError(q0 * Cos(ω * τ) + v0 * Sin(ω * τ) * Radian / ω,
+                        interpolant.Evaluate(t)));
+      max_velocity_error = std::max(
+          max_velocity_error,
+          AbsoluteError(v0 * Cos(ω * τ) - q0 * ω * Sin(ω * τ) / Radian,
+                        interpolant.EvaluateDerivative(t)));
+    }
+  }
+  EXPECT_THAT(max_position_error, AllOf(Ge(1e-5 * Metre), Le(2e-5 * Metre)));
+  EXPECT_THAT(max_velocity_error,
+              AllOf(Ge(5e-5 * Metre / Second), Le(6e-5 * Metre / Second)));
+}
+
 TEST_F(EmbeddedExplicitRungeKuttaNyströmIntegratorTest, Singularity) {
   // Integrating the position of an ideal rocket,
   //   x"(t) = m' I_sp / m(t),
@@ -11,6 +11,7 @@
 #include "base/status.hpp"
 #include "geometry/named_quantities.hpp"
 #include "numerics/double_precision.hpp"
+#include "numerics/hermite5.hpp"
 #include "quantities/named_quantities.hpp"
 #include "serialization/integrators.pb.h"
 
@@ -35,6 +36,7 @@ using base::not_null;
 using base::Status;
 using geometry::Instant;
 using numerics::DoublePrecision;
+using numerics::Hermite5;
 using quantities::Difference;
 using quantities::Time;
 using quantities::Variation;
@@ -76,6 +78,11 @@ struct SpecialSecondOrderDifferentialEquation final {
     std::vector<Velocity> velocity_error;
   };
 
+  // The solution over one step of an integrator, interpolated for each
+  // dimension from the positions, velocities and accelerations at both ends of
+  // the step.
+  using DenseOutput = std::vector<Hermite5<Instant, Position>>;
+
   // A functor that computes f(q, t) and stores it in |*accelerations|.
   // This functor must be called with |accelerations->size()| equal to
   // |positions->size()|, but there is no requirement on the values in
@@ -97,6 +104,8 @@ struct AdaptiveStepSize final {
       std::function<
           double(Time const& current_step_size,
                  typename ODE::SystemStateError const& error)>;
+  using AppendDenseOutput =
+      std::function<void(typename ODE::DenseOutput const& dense_output)>;
   // The first time step tried by the integrator. It must have the same sign as
   // |problem.t_final - initial_state.time.value|.
   Time first_time_step;
@@ -114,6 +123,10 @@ struct AdaptiveStepSize final {
   // Integration will stop after |*max_steps| even if it has not reached
   // |t_final|.
   std::int64_t max_steps = std::numeric_limits<std::int64_t>::max();
+  // If not null, this functor is called after each accepted step, before
+  // |append_state|, with an interpolant of the solution over that step.  Not
+  // serialized.
+  AppendDenseOutput append_dense_output;
 
   void WriteToMessage(
       not_null<serialization::AdaptiveStepSizeIntegratorInstance::
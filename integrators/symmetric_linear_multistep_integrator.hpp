@@ -9,7 +9,7 @@
 #ifndef PRINCIPIA_INTEGRATORS_SYMMETRIC_LINEAR_MULTISTEP_INTEGRATOR_HPP_
 #define PRINCIPIA_INTEGRATORS_SYMMETRIC_LINEAR_MULTISTEP_INTEGRATOR_HPP_
 
-#include <list>
+#include <array>
 #include <vector>
 
 #include "base/status.hpp"
@@ -78,7 +78,7 @@ class SymmetricLinearMultistepIntegrator
     Instance(IntegrationProblem<ODE> const& problem,
              AppendState const& append_state,
              Time const& step,
-             std::list<Step> const& previous_steps,
+             std::vector<Step> const& previous_steps,
              SymmetricLinearMultistepIntegrator const& integrator);
 
     // Performs the startup integration, i.e., computes enough states to either
@@ -91,11 +91,38 @@ class SymmetricLinearMultistepIntegrator
     // method using the accelerations computed by the main integrator.
     void VelocitySolve(int dimension);
 
-    static void FillStepFromSystemState(ODE const& equation,
-                                        typename ODE::SystemState const& state,
-                                        Step& step);
+    // Uses |positions_| as a workspace, so must not be called while |Solve| is
+    // taking steps.
+    void FillStepFromSystemState(ODE const& equation,
+                                 typename ODE::SystemState const& state,
+                                 Step& step);
+
+    // Returns the |i|-th oldest of the previous steps.
+    Step& previous_step(int i);
+    Step const& previous_step(int i) const;
+
+    // Appends a step to the previous steps and returns it.
+    Step& PushPreviousStep();
+
+    // Drops the oldest previous step, appends a step and returns it.
+    Step& ShiftPreviousSteps();
+
+    // The previous steps, in a ring buffer where the oldest step is at index
+    // |first_previous_step_|.  The |Step|s are recycled, and their vectors keep
+    // their storage, so that no allocation takes place once the buffer is
+    // full.  The caller must clear or overwrite the steps returned by
+    // |PushPreviousStep| and |ShiftPreviousSteps|.
+    std::array<Step, order_> previous_steps_;
+    int first_previous_step_ = 0;
+    int number_of_previous_steps_ = 0;  // At most |order_|.
+
+    // The buffers used by |Solve|, kept here so that they are only allocated
+    // once.  See |Solve| for their meaning.  |positions_| is also used by
+    // |FillStepFromSystemState|.
+    std::vector<Position> positions_;
+    std::vector<DoublePrecision<typename ODE::Displacement>> Σj_minus_ɑj_qj_;
+    std::vector<typename ODE::Acceleration> Σj_βj_numerator_aj_;
 
-    std::list<Step> previous_steps_;  // At most |order_ - 1| elements.
     SymmetricLinearMultistepIntegrator const& integrator_;
     friend class SymmetricLinearMultistepIntegrator;
   };
@@ -4,7 +4,6 @@
 #include "integrators/symmetric_linear_multistep_integrator.hpp"
 
 #include <algorithm>
-#include <list>
 #include <vector>
 
 #include "geometry/serialization.hpp"
@@ -38,49 +37,56 @@ Status SymmetricLinearMultistepIntegrator<Position, order_>::Instance::Solve(
   auto const& step = this->step_;
   auto const& equation = this->equation_;
 
-  if (previous_steps_.size() < order_ - 1) {
+  if (number_of_previous_steps_ < order_ - 1) {
     StartupSolve(t_final);
   }
 
   // Argument checks.
-  int const dimension = previous_steps_.back().displacements.size();
+  int const dimension =
+      previous_step(number_of_previous_steps_ - 1).displacements.size();
 
   // Time step.
   CHECK_LT(Time(), step);
   Time const& h = step;
   // Current time.
-  DoublePrecision<Instant> t = previous_steps_.back().time;
+  DoublePrecision<Instant> t =
+      previous_step(number_of_previous_steps_ - 1).time;
   // Order.
   int const k = order_;
 
-  std::vector<Position> positions(dimension);
+  std::vector<Position>& positions = positions_;
+  positions.resize(dimension);
 
-  DoubleDisplacements Σj_minus_ɑj_qj(dimension);
-  std::vector<Acceleration> Σj_βj_numerator_aj(dimension);
+  DoubleDisplacements& Σj_minus_ɑj_qj = Σj_minus_ɑj_qj_;
+  Σj_minus_ɑj_qj.resize(dimension);
+  std::vector<Acceleration>& Σj_βj_numerator_aj = Σj_βj_numerator_aj_;
+  Σj_βj_numerator_aj.resize(dimension);
   while (h <= (t_final - t.value) - t.error) {
-    // We take advantage of the symmetry to iterate on the list of previous
-    // steps from both ends.
-    auto front_it = previous_steps_.begin();
-    auto back_it = previous_steps_.rbegin();
+    // We take advantage of the symmetry to iterate on the previous steps from
+    // both ends.
 
     // This block corresponds to j = 0.  We must not pair it with j = k.
     {
-      DoubleDisplacements const& qj = front_it->displacements;
-      std::vector<Acceleration> const& aj = front_it->accelerations;
+      Step const& step_j = previous_step(0);
+      DoubleDisplacements const& qj = step_j.displacements;
+      std::vector<Acceleration> const& aj = step_j.accelerations;
       double const ɑj = ɑ[0];
       double const βj_numerator = β_numerator[0];
       for (int d = 0; d < dimension; ++d) {
         Σj_minus_ɑj_qj[d] = Scale(-ɑj, qj[d]);
         Σj_βj_numerator_aj[d] = βj_numerator * aj[d];
       }
-      ++front_it;
     }
     // The generic value of j, paired with k - j.
     for (int j = 1; j < k / 2; ++j) {
-      DoubleDisplacements const& qj = front_it->displacements;
-      DoubleDisplacements const& qk_minus_j = back_it->displacements;
-      std::vector<Acceleration> const& aj = front_it->accelerations;
-      std::vector<Acceleration> const& ak_minus_j = back_it->accelerations;
+      Step const& step_j = previous_step(j);
+      Step const& step_k_minus_j =
+          previous_step(number_of_previous_steps_ - j);
+      DoubleDisplacements const& qj = step_j.displacements;
+      DoubleDisplacements const& qk_minus_j = step_k_minus_j.displacements;
+      std::vector<Acceleration> const& aj = step_j.accelerations;
+      std::vector<Acceleration> const& ak_minus_j =
+          step_k_minus_j.accelerations;
       double const ɑj = ɑ[j];
       double const βj_numerator = β_numerator[j];
       for (int d = 0; d < dimension; ++d) {
@@ -88,13 +94,12 @@ Status SymmetricLinearMultistepIntegrator<Position, order_>::Instance::Solve(
         Σj_minus_ɑj_qj[d] -= Scale(ɑj, qk_minus_j[d]);
         Σj_βj_numerator_aj[d] += βj_numerator * (aj[d] + ak_minus_j[d]);
       }
-      ++front_it;
-      ++back_it;
     }
     // This block corresponds to j = k / 2.  We must not pair it with j = k / 2.
     {
-      DoubleDisplacements const& qj = front_it->displacements;
-      std::vector<Acceleration> const& aj = front_it->accelerations;
+      Step const& step_j = previous_step(k / 2);
+      DoubleDisplacements const& qj = step_j.displacements;
+      std::vector<Acceleration> const& aj = step_j.accelerations;
       double const ɑj = ɑ[k / 2];
       double const βj_numerator = β_numerator[k / 2];
       for (int d = 0; d < dimension; ++d) {
@@ -103,12 +108,11 @@ Status SymmetricLinearMultistepIntegrator<Position, order_>::Instance::Solve(
       }
     }
 
-    // Create a new step in the instance.
+    // Create a new step in the instance, reusing the oldest one.
     t.Increment(h);
-    previous_steps_.pop_front();
-    previous_steps_.emplace_back();
-    Step& current_step = previous_steps_.back();
+    Step& current_step = ShiftPreviousSteps();
     current_step.time = t;
+    current_step.displacements.clear();
     current_step.accelerations.resize(dimension);
 
     // Fill the new step.  We skip the division by ɑk as it is equal to 1.0.
@@ -156,8 +160,8 @@ Instance::WriteToMessage(
           ->MutableExtension(
               serialization::SymmetricLinearMultistepIntegratorInstance::
                   extension);
-  for (auto const& previous_step : previous_steps_) {
-    previous_step.WriteToMessage(extension->add_previous_steps());
+  for (int i = 0; i < number_of_previous_steps_; ++i) {
+    previous_step(i).WriteToMessage(extension->add_previous_steps());
   }
 }
 
@@ -214,10 +218,9 @@ SymmetricLinearMultistepIntegrator<Position, order_>::Instance::Instance(
                                              std::move(append_state),
                                              step),
       integrator_(integrator) {
-  previous_steps_.emplace_back();
   FillStepFromSystemState(this->equation_,
                           this->current_state_,
-                          this->previous_steps_.back());
+                          PushPreviousStep());
 }
 
 template<typename Position, int order_>
@@ -225,13 +228,16 @@ SymmetricLinearMultistepIntegrator<Position, order_>::Instance::Instance(
     IntegrationProblem<ODE> const& problem,
     AppendState const& append_state,
     Time const& step,
-    std::list<Step> const& previous_steps,
+    std::vector<Step> const& previous_steps,
     SymmetricLinearMultistepIntegrator const& integrator)
     : FixedStepSizeIntegrator<ODE>::Instance(problem,
                                              std::move(append_state),
                                              step),
-      previous_steps_(previous_steps),
-      integrator_(integrator) {}
+      integrator_(integrator) {
+  for (auto const& previous_step : previous_steps) {
+    PushPreviousStep() = previous_step;
+  }
+}
 
 template<typename Position, int order_>
 void SymmetricLinearMultistepIntegrator<Position, order_>::
@@ -243,26 +249,25 @@ Instance::StartupSolve(Instant const& t_final) {
 
   Time const startup_step = step / startup_step_divisor;
 
-  CHECK(!previous_steps_.empty());
-  CHECK_LT(previous_steps_.size(), order_);
+  CHECK_LT(0, number_of_previous_steps_);
+  CHECK_LT(number_of_previous_steps_, order_);
 
   int startup_step_index = 0;
   auto const startup_append_state =
       [this, &startup_step_index](typename ODE::SystemState const& state) {
         // Stop changing anything once we're done with the startup.  We may be
         // called one more time by the |startup_integrator_|.
-        if (previous_steps_.size() < order_) {
+        if (number_of_previous_steps_ < order_) {
           this->current_state_ = state;
           // The startup integrator has a smaller step.  We do not record all
           // the states it computes, but only those that are a multiple of the
           // main integrator step.
           if (++startup_step_index % startup_step_divisor == 0) {
-            CHECK_LT(previous_steps_.size(), order_);
-            previous_steps_.emplace_back();
+            Step& previous_step = PushPreviousStep();
             this->append_state_(state);
             FillStepFromSystemState(this->equation_,
                                     this->current_state_,
-                                    previous_steps_.back());
+                                    previous_step);
           }
         }
       };
@@ -274,10 +279,10 @@ Instance::StartupSolve(Instant const& t_final) {
 
   startup_instance->Solve(
       std::min(current_state.time.value +
-                   (order_ - previous_steps_.size()) * step + step / 2.0,
+                   (order_ - number_of_previous_steps_) * step + step / 2.0,
                t_final));
 
-  CHECK_LE(previous_steps_.size(), order_);
+  CHECK_LE(number_of_previous_steps_, order_);
 }
 
 template<typename Position, int order_>
@@ -292,25 +297,60 @@ Instance::VelocitySolve(int const dimension) {
 
   for (int d = 0; d < dimension; ++d) {
     DoublePrecision<Velocity>& velocity = current_state.velocities[d];
-    auto it = previous_steps_.rbegin();
     Acceleration weighted_acceleration;
     for (int i = 0; i < velocity_integrator.numerators.size; ++i) {
       double const numerator = velocity_integrator.numerators[i];
-      weighted_acceleration += numerator * it->accelerations[d];
-      ++it;
+      weighted_acceleration +=
+          numerator *
+          previous_step(number_of_previous_steps_ - 1 - i).accelerations[d];
     }
     velocity.Increment(step * weighted_acceleration /
                        velocity_integrator.denominator);
   }
 }
 
+template<typename Position, int order_>
+typename SymmetricLinearMultistepIntegrator<Position, order_>::Instance::Step&
+SymmetricLinearMultistepIntegrator<Position, order_>::Instance::previous_step(
+    int const i) {
+  return previous_steps_[(first_previous_step_ + i) % order_];
+}
+
+template<typename Position, int order_>
+typename SymmetricLinearMultistepIntegrator<Position, order_>::Instance::
+    Step const&
+SymmetricLinearMultistepIntegrator<Position, order_>::Instance::previous_step(
+    int const i) const {
+  return previous_steps_[(first_previous_step_ + i) % order_];
+}
+
+template<typename Position, int order_>
+typename SymmetricLinearMultistepIntegrator<Position, order_>::Instance::Step&
+SymmetricLinearMultistepIntegrator<Position, order_>::Instance::
+PushPreviousStep() {
+  CHECK_LT(number_of_previous_steps_, order_);
+  ++number_of_previous_steps_;
+  return previous_step(number_of_previous_steps_ - 1);
+}
+
+template<typename Position, int order_>
+typename SymmetricLinearMultistepIntegrator<Position, order_>::Instance::Step&
+SymmetricLinearMultistepIntegrator<Position, order_>::Instance::
+ShiftPreviousSteps() {
+  CHECK_LT(0, number_of_previous_steps_);
+  first_previous_step_ = (first_previous_step_ + 1) % order_;
+  return previous_step(number_of_previous_steps_ - 1);
+}
+
 template<typename Position, int order_>
 void SymmetricLinearMultistepIntegrator<Position, order_>::
 Instance::FillStepFromSystemState(ODE const& equation,
                                   typename ODE::SystemState const& state,
                                   Step& step) {
-  std::vector<typename ODE::Position> positions;
+  std::vector<Position>& positions = positions_;
+  positions.clear();
   step.time = state.time;
+  step.displacements.clear();
   for (auto const& position : state.positions) {
     step.displacements.push_back(position - DoublePrecision<Position>());
     positions.push_back(position.value);
@@ -368,7 +408,7 @@ SymmetricLinearMultistepIntegrator<Position, order_>::ReadFromMessage(
   auto const& extension = message.GetExtension(
       serialization::SymmetricLinearMultistepIntegratorInstance::extension);
 
-  std::list<typename Instance::Step> previous_steps;
+  std::vector<typename Instance::Step> previous_steps;
   for (auto const& previous_step : extension.previous_steps()) {
     previous_steps.push_back(Instance::Step::ReadFromMessage(previous_step));
   }
@@ -9,6 +9,8 @@
 #ifndef PRINCIPIA_INTEGRATORS_SYMPLECTIC_RUNGE_KUTTA_NYSTRÖM_INTEGRATOR_HPP_
 #define PRINCIPIA_INTEGRATORS_SYMPLECTIC_RUNGE_KUTTA_NYSTRÖM_INTEGRATOR_HPP_
 
+#include <vector>
+
 #include "base/status.hpp"
 #include "integrators/ordinary_differential_equations.hpp"
 #include "numerics/fixed_arrays.hpp"
@@ -103,6 +105,14 @@ class SymplecticRungeKuttaNyströmIntegrator
              SymplecticRungeKuttaNyströmIntegrator const& integrator);
 
     SymplecticRungeKuttaNyströmIntegrator const& integrator_;
+
+    // The buffers used by |Solve|, kept here so that they are only allocated
+    // once.  See |Solve| for their meaning.
+    std::vector<typename ODE::Displacement> Δq_;
+    std::vector<typename ODE::Velocity> Δv_;
+    std::vector<Position> q_stage_;
+    std::vector<typename ODE::Acceleration> g_;
+
     friend class SymplecticRungeKuttaNyströmIntegrator;
   };
 
@@ -71,12 +71,13 @@ Method<Profile>::~Method() {
     serialization::Method method;
     auto* const extension =
         method.MutableExtension(Profile::Message::extension);
-    if (out_filler_ != nullptr) {
-      out_filler_(extension);
-    }
+    // The return is filled first because the out may depend on it.
     if (return_filler_ != nullptr) {
       return_filler_(extension);
     }
+    if (out_filler_ != nullptr) {
+      out_filler_(extension);
+    }
     Recorder::active_recorder_->Write(method);
   }
 }
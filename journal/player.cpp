@@ -2,11 +2,13 @@
 #include "journal/player.hpp"
 
 #include <chrono>
+#include <cstring>
 #include <string>
 
 #include "base/array.hpp"
 #include "base/get_line.hpp"
 #include "base/hexadecimal.hpp"
+#include "base/macros.hpp"
 #include "journal/profiles.hpp"
 #include "glog/logging.h"
 
@@ -19,8 +21,23 @@ using base::UniqueBytes;
 namespace journal {
 
 Player::Player(std::experimental::filesystem::path const& path)
-    : stream_(path, std::ios::in) {
+    : format_(Recorder::Format::Hexadecimal),
+      stream_(path, std::ios::in | std::ios::binary),
+      last_method_duration_(std::chrono::nanoseconds::zero()) {
   CHECK(!stream_.fail());
+  std::streamsize const header_size = sizeof(binary_journal_header) - 1;
+  char header[header_size];
+  stream_.read(header, header_size);
+  if (stream_.gcount() == header_size &&
+      std::memcmp(header, binary_journal_header, header_size) == 0) {
+    format_ = Recorder::Format::Binary;
+  } else {
+    // A hexadecimal journal, which must be read in text mode.
+    stream_.close();
+    stream_.clear();
+    stream_.open(path, std::ios::in);
+    CHECK(!stream_.fail());
+  }
 }
 
 bool Player::Play() {
@@ -35,17 +52,23 @@ bool Player::Play() {
     return false;
   }
 
-  auto const before = std::chrono::system_clock::now();
+  std::int64_t const allocations_before =
+      allocation_counter_ == nullptr ? 0 : allocation_counter_();
+  auto const before = std::chrono::steady_clock::now();
 
 #include "journal/player.generated.cc"
 
-  auto const after = std::chrono::system_clock::now();
+  auto const after = std::chrono::steady_clock::now();
+  std::int64_t const allocations_after =
+      allocation_counter_ == nullptr ? 0 : allocation_counter_();
   if (after - before > std::chrono::milliseconds(100)) {
     LOG(ERROR) << "Long method:\n" << method_in->DebugString();
   }
 
   last_method_in_.swap(method_in);
   last_method_out_return_.swap(method_out_return);
+  last_method_duration_ = after - before;
+  last_method_allocations_ = allocations_after - allocations_before;
 
   return true;
 }
@@ -58,7 +81,31 @@ serialization::Method const& Player::last_method_out_return() const {
   return *last_method_out_return_;
 }
 
+std::chrono::nanoseconds Player::last_method_duration() const {
+  return last_method_duration_;
+}
+
+void Player::set_allocation_counter(
+    AllocationCounter const allocation_counter) {
+  allocation_counter_ = allocation_counter;
+}
+
+std::int64_t Player::last_method_allocations() const {
+  return last_method_allocations_;
+}
+
 std::unique_ptr<serialization::Method> Player::Read() {
+  switch (format_) {
+    case Recorder::Format::Hexadecimal:
+      return ReadHexadecimal();
+    case Recorder::Format::Binary:
+      return ReadBinary();
+  }
+  LOG(FATAL) << "Unexpected format " << static_cast<int>(format_);
+  base::noreturn();
+}
+
+std::unique_ptr<serialization::Method> Player::ReadHexadecimal() {
   std::string const line = GetLine(stream_);
   if (line.empty()) {
     return nullptr;
@@ -77,5 +124,32 @@ std::unique_ptr<serialization::Method> Player::Read() {
   return method;
 }
 
+std::unique_ptr<serialization::Method> Player::ReadBinary() {
+  // The size of the method, as a varint.
+  std::uint32_t size = 0;
+  for (int shift = 0;; shift += 7) {
+    int const byte = stream_.get();
+    if (byte == std::ifstream::traits_type::eof()) {
+      CHECK_EQ(0, shift) << "Truncated size";
+      return nullptr;
+    }
+    // The fifth byte may only hold the 4 high bits of the size.
+    CHECK(shift < 28 || byte <= 0x0F) << "Malformed size";
+    size |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      break;
+    }
+  }
+
+  UniqueBytes bytes(size);
+  stream_.read(reinterpret_cast<char*>(bytes.data.get()), bytes.size);
+  CHECK_EQ(bytes.size, stream_.gcount()) << "Truncated method";
+  auto method = std::make_unique<serialization::Method>();
+  CHECK(method->ParseFromArray(bytes.data.get(),
+                               static_cast<int>(bytes.size)));
+
+  return method;
+}
+
 }  // namespace journal
 }  // namespace principia
@@ -1,11 +1,14 @@
 ﻿
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <experimental/filesystem>
 #include <fstream>
 #include <map>
 #include <memory>
 
+#include "journal/recorder.hpp"
 #include "serialization/journal.pb.h"
 
 namespace principia {
@@ -14,7 +17,11 @@ namespace journal {
 class Player final {
  public:
   using PointerMap = std::map<std::uint64_t, void*>;
+  // Returns the number of allocations performed so far by the process.
+  using AllocationCounter = std::int64_t (*)();
 
+  // The format of the journal, hexadecimal or binary, is detected from its
+  // first bytes.
   explicit Player(std::experimental::filesystem::path const& path);
 
   // Replays the next message in the journal.  Returns false at end of journal.
@@ -24,19 +31,37 @@ class Player final {
   serialization::Method const& last_method_in() const;
   serialization::Method const& last_method_out_return() const;
 
+  // The time taken by the plugin to run the last replayed method, excluding
+  // the reading of the journal.
+  std::chrono::nanoseconds last_method_duration() const;
+
+  // The |allocation_counter| is sampled before and after the plugin runs each
+  // method.  If it is null, which is the default, no allocations are counted.
+  void set_allocation_counter(AllocationCounter allocation_counter);
+
+  // The number of allocations performed while running the last replayed
+  // method, over the same interval as |last_method_duration|.
+  std::int64_t last_method_allocations() const;
+
  private:
   // Reads one message from the stream.  Returns a |nullptr| at end of stream.
   std::unique_ptr<serialization::Method> Read();
+  std::unique_ptr<serialization::Method> ReadHexadecimal();
+  std::unique_ptr<serialization::Method> ReadBinary();
 
   template<typename Profile>
   bool RunIfAppropriate(serialization::Method const& method_in,
                         serialization::Method const& method_out_return);
 
   PointerMap pointer_map_;
+  Recorder::Format format_;
   std::ifstream stream_;
 
   std::unique_ptr<serialization::Method> last_method_in_;
   std::unique_ptr<serialization::Method> last_method_out_return_;
+  std::chrono::nanoseconds last_method_duration_;
+  AllocationCounter allocation_counter_ = nullptr;
+  std::int64_t last_method_allocations_ = 0;
 
   friend class PlayerTest;
   friend class RecorderTest;
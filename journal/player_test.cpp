@@ -1,6 +1,7 @@
 ﻿
 #include "journal/player.hpp"
 
+#include <fstream>
 #include <list>
 #include <string>
 #include <thread>
@@ -34,6 +35,12 @@ void BM_PlayForReal(benchmark::State& state) {  // NOLINT(runtime/references)
 
 BENCHMARK(BM_PlayForReal);
 
+// An allocation counter that counts its own calls.
+std::int64_t CountCalls() {
+  static std::int64_t calls = 0;
+  return calls++;
+}
+
 class PlayerTest : public ::testing::Test {
  protected:
   PlayerTest()
@@ -85,6 +92,78 @@ TEST_F(PlayerTest, PlayTiny) {
   EXPECT_EQ(2, count);
 }
 
+TEST_F(PlayerTest, PlayTinyBinary) {
+  std::thread recorder([this]() {
+    Recorder* const r(new Recorder(test_name_ + ".journal.bin",
+                                   Recorder::Format::Binary));
+    Recorder::Activate(r);
+
+    {
+      Method<NewPlugin> m({"1 s", "2 s", 3});
+      m.Return(plugin_.get());
+    }
+    {
+      const ksp_plugin::Plugin* plugin = plugin_.get();
+      Method<DeletePlugin> m({&plugin}, {&plugin});
+      m.Return();
+    }
+    Recorder::Deactivate();
+  });
+  recorder.join();
+
+  Player player(test_name_ + ".journal.bin");
+  player.set_allocation_counter(&CountCalls);
+
+  // Replay the journal.
+  int count = 0;
+  while (player.Play()) {
+    ++count;
+  }
+  EXPECT_EQ(2, count);
+  EXPECT_TRUE(player.last_method_in().HasExtension(
+      serialization::DeletePlugin::extension));
+  // The counter is sampled once before and once after the method.
+  EXPECT_EQ(1, player.last_method_allocations());
+}
+
+using PlayerDeathTest = PlayerTest;
+
+TEST_F(PlayerDeathTest, FailureInBinary) {
+  // The methods recorded before the failure are drained to the journal.
+  EXPECT_DEATH({
+    Recorder* const r(new Recorder(test_name_ + ".journal.bin",
+                                   Recorder::Format::Binary));
+    Recorder::Activate(r);
+    {
+      Method<NewPlugin> m({"1 s", "2 s", 3});
+      m.Return(plugin_.get());
+    }
+    LOG(FATAL) << "Failure after NewPlugin";
+  }, "Failure after NewPlugin");
+
+  Player player(test_name_ + ".journal.bin");
+  int count = 0;
+  while (player.Play()) {
+    ++count;
+  }
+  EXPECT_EQ(1, count);
+}
+
+TEST_F(PlayerDeathTest, MalformedBinarySize) {
+  {
+    std::ofstream stream(test_name_ + ".journal.bin",
+                         std::ios::out | std::ios::binary);
+    stream.write(binary_journal_header, sizeof(binary_journal_header) - 1);
+    // A varint whose fifth byte has bits beyond the 32 bits of the size.
+    char const size[] = {'\xFF', '\xFF', '\xFF', '\xFF', '\x1F'};
+    stream.write(size, sizeof(size));
+  }
+  EXPECT_DEATH({
+    Player player(test_name_ + ".journal.bin");
+    player.Play();
+  }, "Malformed size");
+}
+
 // This test (a.k.a. benchmark) is only run if the --gtest_filter flag names it
 // explicitly.
 TEST_F(PlayerTest, Benchmarks) {
@@ -1,6 +1,7 @@
 ﻿
 #include "journal/profiles.hpp"
 
+#include <algorithm>
 #include <fstream>
 #include <list>
 #include <string>
@@ -1,47 +1,88 @@
 ﻿
 #include "journal/recorder.hpp"
 
+#include <chrono>
+#include <cstdlib>
+
 #include "base/array.hpp"
 #include "base/hexadecimal.hpp"
 #include "glog/logging.h"
+#include "google/protobuf/io/coded_stream.h"
 
 namespace principia {
 
+using base::Bytes;
 using base::HexadecimalEncode;
+using base::RingBuffer;
 using base::UniqueBytes;
+using google::protobuf::io::CodedOutputStream;
 
 namespace journal {
 
-Recorder::Recorder(std::experimental::filesystem::path const& path)
-    : stream_(path, std::ios::out) {
+namespace {
+
+// The capacity of the buffer between the calling thread and the writer in
+// |Format::Binary|.  The calling thread blocks if the writer falls behind by
+// more than this many bytes.
+std::int64_t const buffer_capacity = 1 << 22;
+
+// How often the writer flushes the file in |Format::Binary|, if there is
+// anything to flush.
+std::chrono::milliseconds const flush_period(100);
+
+// How long the writer sleeps when it finds the buffer empty.
+std::chrono::milliseconds const idle_period(1);
+
+}  // namespace
+
+Recorder::Recorder(std::experimental::filesystem::path const& path,
+                   Format const format)
+    : format_(format),
+      stream_(path,
+              format == Format::Binary ? std::ios::out | std::ios::binary
+                                       : std::ios::out),
+      shutdown_(false) {
   CHECK(!stream_.fail()) << path;
+  if (format_ == Format::Binary) {
+    stream_.write(binary_journal_header, sizeof(binary_journal_header) - 1);
+    buffer_ = std::make_unique<RingBuffer>(buffer_capacity);
+    writer_ = std::make_unique<std::thread>(&Recorder::WriteInBackground, this);
+  }
 }
 
 Recorder::~Recorder() {
+  if (writer_ != nullptr) {
+    shutdown_.store(true, std::memory_order_release);
+    writer_->join();
+  }
   stream_.close();
 }
 
 void Recorder::Write(serialization::Method const& method) {
   CHECK_LT(0, method.ByteSize()) << method.DebugString();
-  UniqueBytes bytes(method.ByteSize());
-  method.SerializeToArray(bytes.data.get(), static_cast<int>(bytes.size));
-
-  std::int64_t const hexadecimal_size = (bytes.size << 1) + 2;
-  UniqueBytes hexadecimal(hexadecimal_size);
-  HexadecimalEncode({bytes.data.get(), bytes.size}, hexadecimal.get());
-  hexadecimal.data.get()[hexadecimal_size - 2] = '\n';
-  hexadecimal.data.get()[hexadecimal_size - 1] = '\0';
-  stream_ << hexadecimal.data.get();
-  stream_.flush();
+  switch (format_) {
+    case Format::Hexadecimal:
+      WriteHexadecimal(method);
+      break;
+    case Format::Binary:
+      WriteBinary(method);
+      break;
+  }
 }
 
 void Recorder::Activate(base::not_null<Recorder*> const journal) {
   CHECK(active_recorder_ == nullptr);
   active_recorder_ = journal;
+  if (journal->format_ == Format::Binary) {
+    binary_recorder_.store(journal);
+    google::InstallFailureFunction(&DrainAndAbort);
+  }
 }
 
 void Recorder::Deactivate() {
   CHECK(active_recorder_ != nullptr);
+  Recorder* expected = active_recorder_;
+  binary_recorder_.compare_exchange_strong(expected, nullptr);
   delete active_recorder_;
   active_recorder_ = nullptr;
 }
@@ -50,7 +91,76 @@ bool Recorder::IsActivated() {
   return active_recorder_ != nullptr;
 }
 
+void Recorder::DrainAndAbort() {
+  Recorder* const recorder = binary_recorder_.exchange(nullptr);
+  // The writer cannot drain the buffer if it is the thread that failed.
+  if (recorder != nullptr &&
+      recorder->writer_->get_id() != std::this_thread::get_id()) {
+    recorder->shutdown_.store(true, std::memory_order_release);
+    recorder->writer_->join();
+  }
+  std::abort();
+}
+
+void Recorder::WriteHexadecimal(serialization::Method const& method) {
+  UniqueBytes bytes(method.ByteSize());
+  method.SerializeToArray(bytes.data.get(), static_cast<int>(bytes.size));
+
+  std::int64_t const hexadecimal_size = (bytes.size << 1) + 2;
+  UniqueBytes hexadecimal(hexadecimal_size);
+  HexadecimalEncode({bytes.data.get(), bytes.size}, hexadecimal.get());
+  hexadecimal.data.get()[hexadecimal_size - 2] = '\n';
+  hexadecimal.data.get()[hexadecimal_size - 1] = '\0';
+  stream_ << hexadecimal.data.get();
+  stream_.flush();
+}
+
+void Recorder::WriteBinary(serialization::Method const& method) {
+  // |ByteSize| caches the sizes of the submessages, so it must be called
+  // before |SerializeWithCachedSizesToArray|.
+  std::uint32_t const size = method.ByteSize();
+  std::int64_t const frame_size = CodedOutputStream::VarintSize32(size) + size;
+  if (static_cast<std::int64_t>(frame_.size()) < frame_size) {
+    frame_.resize(frame_size);
+  }
+  std::uint8_t* const message =
+      CodedOutputStream::WriteVarint32ToArray(size, frame_.data());
+  method.SerializeWithCachedSizesToArray(message);
+  buffer_->Push(Bytes(frame_.data(), frame_size));
+}
+
+void Recorder::WriteInBackground() {
+  auto last_flush = std::chrono::steady_clock::now();
+  bool has_unflushed_bytes = false;
+  for (;;) {
+    Bytes const bytes = buffer_->Peek();
+    if (bytes.size > 0) {
+      stream_.write(reinterpret_cast<char const*>(bytes.data), bytes.size);
+      buffer_->Consume(bytes.size);
+      has_unflushed_bytes = true;
+      continue;
+    }
+    // The calling thread pushes all its bytes before setting |shutdown_|, so
+    // the buffer must be checked again once |shutdown_| has been seen.
+    if (shutdown_.load(std::memory_order_acquire)) {
+      if (buffer_->empty()) {
+        break;
+      }
+      continue;
+    }
+    auto const now = std::chrono::steady_clock::now();
+    if (has_unflushed_bytes && now - last_flush >= flush_period) {
+      stream_.flush();
+      last_flush = now;
+      has_unflushed_bytes = false;
+    }
+    std::this_thread::sleep_for(idle_period);
+  }
+  stream_.flush();
+}
+
 thread_local Recorder* Recorder::active_recorder_ = nullptr;
+std::atomic<Recorder*> Recorder::binary_recorder_(nullptr);
 
 }  // namespace journal
 }  // namespace principia
@@ -1,10 +1,15 @@
 ﻿
 #pragma once
 
+#include <atomic>
 #include <experimental/filesystem>
 #include <fstream>
+#include <memory>
+#include <thread>
+#include <vector>
 
 #include "base/not_null.hpp"
+#include "base/ring_buffer.hpp"
 #include "serialization/journal.pb.h"
 
 namespace principia {
@@ -12,9 +17,29 @@ namespace journal {
 
 FORWARD_DECLARE_FROM(method, template<typename Profile> class, Method);
 
+// The first bytes of a journal in |Recorder::Format::Binary|.  They cannot be
+// confused with the beginning of a hexadecimal journal.
+constexpr char binary_journal_header[] = "PRINCIPIA BINARY JOURNAL\n";
+
 class Recorder final {
  public:
-  explicit Recorder(std::experimental::filesystem::path const& path);
+  enum class Format {
+    // One hexadecimal-encoded method per line.  The methods are written and
+    // flushed by the thread that calls them, so nothing is lost if the process
+    // crashes, but recording is slow.
+    Hexadecimal,
+    // A |binary_journal_header| followed by the serialized methods, each
+    // preceded by its size as a varint.  The calling thread only serializes the
+    // method and hands the bytes to a background thread through a lock-free
+    // |RingBuffer|.  The background thread flushes the file at most every
+    // |flush_period|.  If a |CHECK| fails, the buffer is drained before the
+    // process aborts, see |DrainAndAbort|, but the last few methods may be lost
+    // if the process crashes otherwise.
+    Binary,
+  };
+
+  explicit Recorder(std::experimental::filesystem::path const& path,
+                    Format format = Format::Hexadecimal);
   ~Recorder();
 
   void Write(serialization::Method const& method);
@@ -23,10 +48,32 @@ class Recorder final {
   static void Deactivate();
   static bool IsActivated();
 
+  // Installed as the glog failure function when a recorder in |Format::Binary|
+  // is activated.  Waits until the methods still in the buffer have been
+  // written and flushed, and aborts.  May be called on any thread.
+  static void DrainAndAbort();
+
  private:
+  void WriteHexadecimal(serialization::Method const& method);
+  void WriteBinary(serialization::Method const& method);
+
+  // The loop executed by the |writer_| in |Format::Binary|.  Returns when
+  // |shutdown_| is set and the |buffer_| is empty.
+  void WriteInBackground();
+
+  Format const format_;
   std::ofstream stream_;
 
+  // Only used in |Format::Binary|.  |frame_| holds the size and serialized
+  // bytes of the method being written; it is reused to avoid allocations.
+  std::vector<std::uint8_t> frame_;
+  std::unique_ptr<base::RingBuffer> buffer_;
+  std::atomic<bool> shutdown_;
+  std::unique_ptr<std::thread> writer_;
+
   static thread_local Recorder* active_recorder_;
+  // The activated recorder in |Format::Binary|, if any, for |DrainAndAbort|.
+  static std::atomic<Recorder*> binary_recorder_;
 
   template<typename>
   friend class Method;
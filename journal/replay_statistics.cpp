@@ -0,0 +1,115 @@
+﻿
+#include "journal/replay_statistics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "glog/logging.h"
+#include "google/protobuf/descriptor.h"
+
+namespace principia {
+
+using google::protobuf::FieldDescriptor;
+
+namespace journal {
+
+namespace {
+
+// The duration below which a fraction |q| of the |sorted_durations| fall,
+// using the nearest-rank method.
+std::chrono::nanoseconds Quantile(
+    std::vector<std::chrono::nanoseconds> const& sorted_durations,
+    double const q) {
+  std::int64_t const size = sorted_durations.size();
+  std::int64_t rank = static_cast<std::int64_t>(std::ceil(q * size));
+  rank = std::max<std::int64_t>(1, std::min(rank, size));
+  return sorted_durations[rank - 1];
+}
+
+}  // namespace
+
+void ReplayStatistics::Add(std::string const& name,
+                           std::chrono::nanoseconds const duration,
+                           std::int64_t const allocations) {
+  Calls& calls = calls_[name];
+  calls.durations.push_back(duration);
+  calls.allocations += allocations;
+}
+
+void ReplayStatistics::WriteCSV(std::ostream& out) const {
+  out << "method,calls,allocations,total_ns,p50_ns,p99_ns,max_ns\n";
+  for (auto const& pair : calls_) {
+    Summary const summary = Summarize(pair.second);
+    out << pair.first << ","
+        << summary.calls << ","
+        << summary.allocations << ","
+        << summary.total.count() << ","
+        << summary.p50.count() << ","
+        << summary.p99.count() << ","
+        << summary.max.count() << "\n";
+  }
+}
+
+void ReplayStatistics::WriteJSON(std::ostream& out) const {
+  out << "{";
+  bool first = true;
+  for (auto const& pair : calls_) {
+    Summary const summary = Summarize(pair.second);
+    out << (first ? "\n" : ",\n");
+    first = false;
+    // Profile names are C++ identifiers, so they need no escaping.
+    out << "  \"" << pair.first << "\": {"
+        << "\"calls\": " << summary.calls << ", "
+        << "\"allocations\": " << summary.allocations << ", "
+        << "\"total_ns\": " << summary.total.count() << ", "
+        << "\"p50_ns\": " << summary.p50.count() << ", "
+        << "\"p99_ns\": " << summary.p99.count() << ", "
+        << "\"max_ns\": " << summary.max.count() << ", "
+        << "\"log2_ns_histogram\": [";
+    for (int i = 0; i < summary.histogram.size(); ++i) {
+      out << (i == 0 ? "" : ", ") << summary.histogram[i];
+    }
+    out << "]}";
+  }
+  out << "\n}\n";
+}
+
+std::string ReplayStatistics::ProfileName(
+    serialization::Method const& method) {
+  // The extensions of |Method| are declared in the scope of the message that
+  // bears the name of the profile.
+  std::vector<FieldDescriptor const*> fields;
+  method.GetReflection()->ListFields(method, &fields);
+  CHECK_EQ(1, fields.size()) << method.DebugString();
+  CHECK(fields[0]->is_extension()) << method.DebugString();
+  return fields[0]->extension_scope()->name();
+}
+
+ReplayStatistics::Summary ReplayStatistics::Summarize(Calls const& calls) {
+  std::vector<std::chrono::nanoseconds> sorted_durations = calls.durations;
+  std::sort(sorted_durations.begin(), sorted_durations.end());
+
+  Summary summary;
+  summary.calls = sorted_durations.size();
+  summary.allocations = calls.allocations;
+  summary.total = std::chrono::nanoseconds::zero();
+  for (auto const& duration : sorted_durations) {
+    summary.total += duration;
+    int bucket = 0;
+    for (std::int64_t ns = duration.count(); ns > 1; ns >>= 1) {
+      ++bucket;
+    }
+    if (bucket >= summary.histogram.size()) {
+      summary.histogram.resize(bucket + 1, 0);
+    }
+    ++summary.histogram[bucket];
+  }
+  summary.p50 = Quantile(sorted_durations, 0.5);
+  summary.p99 = Quantile(sorted_durations, 0.99);
+  summary.max = sorted_durations.back();
+  return summary;
+}
+
+}  // namespace journal
+}  // namespace principia
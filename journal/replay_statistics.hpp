@@ -0,0 +1,62 @@
+﻿
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "serialization/journal.pb.h"
+
+namespace principia {
+namespace journal {
+
+// Accumulates the latencies and allocation counts of the methods replayed by a
+// |Player|, grouped by profile, and writes them in a form that is easy to diff
+// between two builds of the plugin replaying the same journal.
+class ReplayStatistics final {
+ public:
+  // Records one call of the method whose profile is |name|, which took
+  // |duration| and performed |allocations| allocations.
+  void Add(std::string const& name,
+           std::chrono::nanoseconds duration,
+           std::int64_t allocations);
+
+  // One line per profile, sorted by name, with the columns:
+  //   method,calls,allocations,total_ns,p50_ns,p99_ns,max_ns
+  void WriteCSV(std::ostream& out) const;
+
+  // An object mapping each profile to its statistics, including a histogram
+  // of the latencies in buckets of powers of 2 nanoseconds.
+  void WriteJSON(std::ostream& out) const;
+
+  // The name of the profile of |method|, e.g., "AdvanceTime".
+  static std::string ProfileName(serialization::Method const& method);
+
+ private:
+  struct Calls final {
+    std::vector<std::chrono::nanoseconds> durations;
+    std::int64_t allocations = 0;
+  };
+
+  struct Summary final {
+    std::int64_t calls;
+    std::int64_t allocations;
+    std::chrono::nanoseconds total;
+    std::chrono::nanoseconds p50;
+    std::chrono::nanoseconds p99;
+    std::chrono::nanoseconds max;
+    // The number of calls whose duration in nanoseconds has a base 2
+    // logarithm in [i, i + 1[, for each index i.
+    std::vector<std::int64_t> histogram;
+  };
+
+  static Summary Summarize(Calls const& calls);
+
+  std::map<std::string, Calls> calls_;
+};
+
+}  // namespace journal
+}  // namespace principia
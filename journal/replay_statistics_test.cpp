@@ -0,0 +1,57 @@
+﻿
+#include "journal/replay_statistics.hpp"
+
+#include <chrono>
+#include <sstream>
+
+#include "gtest/gtest.h"
+#include "serialization/journal.pb.h"
+
+namespace principia {
+namespace journal {
+
+class ReplayStatisticsTest : public ::testing::Test {
+ protected:
+  ReplayStatisticsTest() {
+    // 100 calls of 1 to 100 ns, with 2 allocations each.
+    for (int i = 100; i >= 1; --i) {
+      statistics_.Add("AdvanceTime", std::chrono::nanoseconds(i), 2);
+    }
+    statistics_.Add("DeletePlugin", std::chrono::nanoseconds(3), 5);
+  }
+
+  ReplayStatistics statistics_;
+};
+
+TEST_F(ReplayStatisticsTest, CSV) {
+  std::stringstream csv;
+  statistics_.WriteCSV(csv);
+  EXPECT_EQ("method,calls,allocations,total_ns,p50_ns,p99_ns,max_ns\n"
+            "AdvanceTime,100,200,5050,50,99,100\n"
+            "DeletePlugin,1,5,3,3,3,3\n",
+            csv.str());
+}
+
+TEST_F(ReplayStatisticsTest, JSON) {
+  std::stringstream json;
+  statistics_.WriteJSON(json);
+  EXPECT_EQ("{\n"
+            "  \"AdvanceTime\": {\"calls\": 100, \"allocations\": 200, "
+            "\"total_ns\": 5050, \"p50_ns\": 50, \"p99_ns\": 99, "
+            "\"max_ns\": 100, "
+            "\"log2_ns_histogram\": [1, 2, 4, 8, 16, 32, 37]},\n"
+            "  \"DeletePlugin\": {\"calls\": 1, \"allocations\": 5, "
+            "\"total_ns\": 3, \"p50_ns\": 3, \"p99_ns\": 3, "
+            "\"max_ns\": 3, \"log2_ns_histogram\": [0, 1]}\n"
+            "}\n",
+            json.str());
+}
+
+TEST_F(ReplayStatisticsTest, ProfileName) {
+  serialization::Method method;
+  method.MutableExtension(serialization::AdvanceTime::extension);
+  EXPECT_EQ("AdvanceTime", ReplayStatistics::ProfileName(method));
+}
+
+}  // namespace journal
+}  // namespace principia
@@ -66,6 +66,7 @@ NavigationManœuvre const& FlightPlan::GetManœuvre(int const index) const {
 }
 
 bool FlightPlan::Append(Burn burn) {
+  DiscardCandidates();
   auto manœuvre =
       MakeNavigationManœuvre(
           std::move(burn),
@@ -85,6 +86,7 @@ bool FlightPlan::Append(Burn burn) {
 
 void FlightPlan::ForgetBefore(Instant const& time,
                               std::function<void()> const& on_empty) {
+  DiscardCandidates();
   // Find the first segment to keep.  Note that incrementing by 2 ensures that
   // we only look at coasts.
   std::experimental::optional<int> first_to_keep;
@@ -127,15 +129,19 @@ void FlightPlan::ForgetBefore(Instant const& time,
 
 void FlightPlan::RemoveLast() {
   CHECK(!manœuvres_.empty());
+  DiscardCandidates();
   manœuvres_.pop_back();
   PopLastSegment();  // Last coast.
   PopLastSegment();  // Last burn.
-  ResetLastSegment();
+  // The penultimate coast is still valid up to the removed manœuvre, it only
+  // needs to be extended.
+  ForgetLastSegmentFrom(desired_final_time_);
   CoastLastSegment(desired_final_time_);
 }
 
 bool FlightPlan::ReplaceLast(Burn burn) {
   CHECK(!manœuvres_.empty());
+  DiscardCandidates();
   auto manœuvre = MakeNavigationManœuvre(std::move(burn),
                                          manœuvres_.back().initial_mass());
   if (manœuvre.FitsBetween(start_of_penultimate_coast(), desired_final_time_) &&
@@ -155,16 +161,179 @@ bool FlightPlan::ReplaceLast(Burn burn) {
 }
 
 bool FlightPlan::SetDesiredFinalTime(Instant const& desired_final_time) {
+  DiscardCandidates();
   if (start_of_last_coast() > desired_final_time) {
     return false;
   } else {
     desired_final_time_ = desired_final_time;
-    ResetLastSegment();
+    // Only the part of the last coast after |desired_final_time_| changes.
+    ForgetLastSegmentFrom(desired_final_time_);
     CoastLastSegment(desired_final_time_);
     return true;
   }
 }
 
+void FlightPlan::EvaluateReplaceLastCandidates(std::vector<Burn> burns) {
+  CHECK(!manœuvres_.empty());
+  DiscardCandidates();
+  DiscreteTrajectory<Barycentric>& coast = penultimate_coast();
+  Mass const initial_mass = manœuvres_.back().initial_mass();
+  Instant const start_of_coast = start_of_penultimate_coast();
+
+  // The intrinsic accelerations refer to the manœuvres, which must not move.
+  candidates_.reserve(burns.size());
+  for (auto& burn : burns) {
+    candidates_.emplace_back(
+        MakeNavigationManœuvre(std::move(burn), initial_mass));
+  }
+
+  // The |trajectories| to integrate concurrently, and for each of them the
+  // index of its candidate, its final time and its parameters.
+  std::vector<not_null<DiscreteTrajectory<Barycentric>*>> trajectories;
+  std::vector<int> indices;
+  std::vector<Instant> final_times;
+  std::vector<Ephemeris<Barycentric>::AdaptiveStepParameters> parameters;
+  Ephemeris<Barycentric>::IntrinsicAccelerations intrinsic_accelerations;
+  auto const clear = [&trajectories, &indices, &final_times, &parameters,
+                      &intrinsic_accelerations]() {
+    trajectories.clear();
+    indices.clear();
+    final_times.clear();
+    parameters.clear();
+    intrinsic_accelerations.clear();
+  };
+  auto const flow_each = [this, &trajectories, &final_times, &parameters,
+                          &intrinsic_accelerations]() {
+    return ephemeris_->FlowEachWithAdaptiveStep(trajectories,
+                                                intrinsic_accelerations,
+                                                final_times,
+                                                parameters,
+                                                max_ephemeris_steps_per_frame);
+  };
+
+  // The coasts until the manœuvres.  A manœuvre is rejected if its coast
+  // doesn't reach it, as in |ReplaceLast|.
+  std::vector<bool> coast_reached_manœuvre(candidates_.size(), false);
+  for (int i = 0; i < candidates_.size(); ++i) {
+    Candidate& candidate = candidates_[i];
+    NavigationManœuvre const& manœuvre = candidate.manœuvre;
+    if (manœuvre.FitsBetween(start_of_coast, desired_final_time_) &&
+        !manœuvre.IsSingular()) {
+      auto const candidate_coast =
+          NewCoastBefore(coast, manœuvre.initial_time());
+      candidate.segments.push_back(candidate_coast);
+      auto const candidate_parameters = ParametersToExtend(*candidate_coast);
+      if (candidate_coast->last().time() == manœuvre.initial_time()) {
+        coast_reached_manœuvre[i] = true;
+      } else if (candidate_parameters.max_steps() > 0) {
+        trajectories.push_back(candidate_coast);
+        indices.push_back(i);
+        final_times.push_back(manœuvre.initial_time());
+        parameters.push_back(candidate_parameters);
+      }
+    }
+  }
+  std::vector<bool> reached_final_times = flow_each();
+  for (int j = 0; j < indices.size(); ++j) {
+    coast_reached_manœuvre[indices[j]] = reached_final_times[j];
+  }
+  for (int i = 0; i < candidates_.size(); ++i) {
+    Candidate& candidate = candidates_[i];
+    if (!candidate.segments.empty() && !coast_reached_manœuvre[i]) {
+      DiscreteTrajectory<Barycentric>* candidate_coast =
+          candidate.segments.back();
+      candidate_coast->parent()->DeleteFork(candidate_coast);
+      candidate.segments.clear();
+    }
+  }
+
+  // The burns.
+  clear();
+  for (int i = 0; i < candidates_.size(); ++i) {
+    Candidate& candidate = candidates_[i];
+    if (!candidate.segments.empty()) {
+      NavigationManœuvre& manœuvre = candidate.manœuvre;
+      manœuvre.set_coasting_trajectory(candidate.segments.back());
+      candidate.segments.push_back(candidate.segments.back()->NewForkAtLast());
+      trajectories.push_back(candidate.segments.back());
+      indices.push_back(i);
+      final_times.push_back(manœuvre.final_time());
+      parameters.push_back(adaptive_step_parameters_);
+      intrinsic_accelerations.push_back(manœuvre.IntrinsicAcceleration());
+    }
+  }
+  reached_final_times = flow_each();
+  for (int j = 0; j < indices.size(); ++j) {
+    if (!reached_final_times[j]) {
+      candidates_[indices[j]].anomalous_segments = 1;
+    }
+  }
+
+  // The last coasts.
+  clear();
+  for (int i = 0; i < candidates_.size(); ++i) {
+    Candidate& candidate = candidates_[i];
+    if (!candidate.segments.empty()) {
+      candidate.segments.push_back(candidate.segments.back()->NewForkAtLast());
+      if (candidate.anomalous_segments > 0) {
+        ++candidate.anomalous_segments;
+      } else {
+        trajectories.push_back(candidate.segments.back());
+        indices.push_back(i);
+        final_times.push_back(desired_final_time_);
+        parameters.push_back(adaptive_step_parameters_);
+      }
+    }
+  }
+  reached_final_times = flow_each();
+  for (int j = 0; j < indices.size(); ++j) {
+    if (!reached_final_times[j]) {
+      candidates_[indices[j]].anomalous_segments = 1;
+    }
+  }
+}
+
+int FlightPlan::number_of_candidates() const {
+  return candidates_.size();
+}
+
+bool FlightPlan::IsValidCandidate(int const index) const {
+  CHECK_LE(0, index);
+  CHECK_LT(index, number_of_candidates());
+  return !candidates_[index].segments.empty();
+}
+
+void FlightPlan::GetCandidateSegments(
+    int const index,
+    DiscreteTrajectory<Barycentric>::Iterator& begin,
+    DiscreteTrajectory<Barycentric>::Iterator& end) const {
+  CHECK(IsValidCandidate(index));
+  auto const& last_segment = *candidates_[index].segments.back();
+  begin = last_segment.Find(segments_.front()->Fork().time());
+  end = last_segment.End();
+  CHECK(begin != end);
+}
+
+bool FlightPlan::ReplaceLastWithCandidate(int const index) {
+  if (!IsValidCandidate(index)) {
+    return false;
+  }
+  Candidate& candidate = candidates_[index];
+  manœuvres_.pop_back();
+  PopLastSegment();  // Last coast.
+  PopLastSegment();  // Last burn.
+  ReplaceLastSegment(candidate.segments[0]);
+  segments_.push_back(candidate.segments[1]);
+  segments_.push_back(candidate.segments[2]);
+  anomalous_segments_ = candidate.anomalous_segments;
+  manœuvres_.push_back(std::move(candidate.manœuvre));
+  manœuvres_.back().set_coasting_trajectory(candidate.segments[0]);
+  // The segments now belong to |segments_|.
+  candidate.segments.clear();
+  DiscardCandidates();
+  return true;
+}
+
 Ephemeris<Barycentric>::AdaptiveStepParameters const&
 FlightPlan::adaptive_step_parameters() const {
   return adaptive_step_parameters_;
@@ -173,14 +342,30 @@ FlightPlan::adaptive_step_parameters() const {
 bool FlightPlan::SetAdaptiveStepParameters(
     Ephemeris<Barycentric>::AdaptiveStepParameters const&
         adaptive_step_parameters) {
+  DiscardCandidates();
+  // The new segments are computed in a new fork of the root, so that the
+  // original ones can be restored without being recomputed.
   auto const original_adaptive_step_parameters = adaptive_step_parameters_;
+  auto const original_segments = segments_;
+  int const original_anomalous_segments = anomalous_segments_;
   adaptive_step_parameters_ = adaptive_step_parameters;
+  segments_ = {root_->NewForkWithoutCopy(initial_time_)};
+  anomalous_segments_ = 0;
   if (RecomputeSegments()) {
+    DiscreteTrajectory<Barycentric>* original_first_segment =
+        original_segments.front();
+    root_->DeleteFork(original_first_segment);
     return true;
   } else {
     // If the recomputation fails, leave this place as clean as we found it.
+    DiscreteTrajectory<Barycentric>* first_segment = segments_.front();
+    root_->DeleteFork(first_segment);
     adaptive_step_parameters_ = original_adaptive_step_parameters;
-    CHECK(RecomputeSegments());
+    segments_ = original_segments;
+    anomalous_segments_ = original_anomalous_segments;
+    for (int i = 0; i < manœuvres_.size(); ++i) {
+      manœuvres_[i].set_coasting_trajectory(segments_[2 * i]);
+    }
     return false;
   }
 }
@@ -304,6 +489,9 @@ std::unique_ptr<FlightPlan> FlightPlan::ReadFromMessage(
   return flight_plan;
 }
 
+FlightPlan::Candidate::Candidate(NavigationManœuvre manœuvre)
+    : manœuvre(std::move(manœuvre)) {}
+
 FlightPlan::FlightPlan()
     : initial_degrees_of_freedom_(Barycentric::origin, Velocity<Barycentric>()),
       root_(make_not_null_unique<DiscreteTrajectory<Barycentric>>()),
@@ -365,20 +553,28 @@ void FlightPlan::BurnLastSegment(NavigationManœuvre const& manœuvre) {
 void FlightPlan::CoastLastSegment(Instant const& desired_final_time) {
   if (anomalous_segments_ > 0) {
     return;
-  } else {
-    bool const reached_desired_final_time =
-        ephemeris_->FlowWithAdaptiveStep(
-                        segments_.back(),
-                        Ephemeris<Barycentric>::NoIntrinsicAcceleration,
-                        desired_final_time,
-                        adaptive_step_parameters_,
-                        max_ephemeris_steps_per_frame);
-    if (!reached_desired_final_time) {
-      anomalous_segments_ = 1;
-    }
+  } else if (!CoastSegment(segments_.back(), desired_final_time)) {
+    anomalous_segments_ = 1;
   }
 }
 
+bool FlightPlan::CoastSegment(
+    not_null<DiscreteTrajectory<Barycentric>*> const segment,
+    Instant const& desired_final_time) {
+  auto const parameters = ParametersToExtend(*segment);
+  if (segment->last().time() == desired_final_time) {
+    return true;
+  } else if (parameters.max_steps() <= 0) {
+    return false;
+  }
+  return ephemeris_->FlowWithAdaptiveStep(
+             segment,
+             Ephemeris<Barycentric>::NoIntrinsicAcceleration,
+             desired_final_time,
+             parameters,
+             max_ephemeris_steps_per_frame);
+}
+
 void FlightPlan::ReplaceLastSegment(
     not_null<DiscreteTrajectory<Barycentric>*> const segment) {
   CHECK_EQ(segment->parent(), segments_.back()->parent());
@@ -397,6 +593,38 @@ void FlightPlan::AddSegment() {
   }
 }
 
+Ephemeris<Barycentric>::AdaptiveStepParameters FlightPlan::ParametersToExtend(
+    DiscreteTrajectory<Barycentric> const& segment) const {
+  std::int64_t existing_steps = 0;
+  auto it = segment.Fork();
+  for (++it; it != segment.End(); ++it) {
+    ++existing_steps;
+  }
+  Ephemeris<Barycentric>::AdaptiveStepParameters parameters =
+      adaptive_step_parameters_;
+  parameters.set_max_steps(parameters.max_steps() - existing_steps);
+  return parameters;
+}
+
+void FlightPlan::ForgetLastSegmentFrom(Instant const& time) {
+  DiscreteTrajectory<Barycentric>& segment = *segments_.back();
+  Instant const fork_time = segment.Fork().time();
+  CHECK_LE(fork_time, time);
+  auto it = segment.LowerBound(time);
+  if (it != segment.End()) {
+    if (it.time() > fork_time) {
+      --it;
+    }
+    segment.ForgetAfter(it.time());
+  }
+  if (anomalous_segments_ == 1) {
+    // If there was one anomalous segment, it was the last one, which was
+    // anomalous because it ended early.  It will be extended from where it
+    // ended.
+    anomalous_segments_ = 0;
+  }
+}
+
 void FlightPlan::ResetLastSegment() {
   segments_.back()->ForgetAfter(segments_.back()->Fork().time());
   if (anomalous_segments_ == 1) {
@@ -416,18 +644,39 @@ void FlightPlan::PopLastSegment() {
   }
 }
 
+not_null<DiscreteTrajectory<Barycentric>*> FlightPlan::NewCoastBefore(
+    DiscreteTrajectory<Barycentric>& coast,
+    Instant const& time) {
+  not_null<DiscreteTrajectory<Barycentric>*> const new_coast =
+      coast.parent()->NewForkWithoutCopy(coast.Fork().time());
+  auto it = coast.Fork();
+  for (++it; it != coast.End() && it.time() < time; ++it) {
+    new_coast->Append(it.time(), it.degrees_of_freedom());
+  }
+  return new_coast;
+}
+
+void FlightPlan::DiscardCandidates() {
+  for (auto& candidate : candidates_) {
+    if (!candidate.segments.empty()) {
+      // Deleting the coast deletes its forks.
+      DiscreteTrajectory<Barycentric>* coast = candidate.segments.front();
+      coast->parent()->DeleteFork(coast);
+    }
+  }
+  candidates_.clear();
+}
+
 DiscreteTrajectory<Barycentric>* FlightPlan::CoastIfReachesManœuvreInitialTime(
     DiscreteTrajectory<Barycentric>& coast,
     NavigationManœuvre const& manœuvre) {
+  // The points of |coast| before the manœuvre don't depend on it, so they are
+  // copied and only the end of the coast is integrated.  |coast| is left
+  // untouched in case the manœuvre is rejected.
   DiscreteTrajectory<Barycentric>* recomputed_coast =
-      coast.parent()->NewForkWithoutCopy(coast.Fork().time());
+      NewCoastBefore(coast, manœuvre.initial_time());
   bool const reached_manœuvre_initial_time =
-      ephemeris_->FlowWithAdaptiveStep(
-          recomputed_coast,
-          Ephemeris<Barycentric>::NoIntrinsicAcceleration,
-          manœuvre.initial_time(),
-          adaptive_step_parameters_,
-          max_ephemeris_steps_per_frame);
+      CoastSegment(recomputed_coast, manœuvre.initial_time());
   if (!reached_manœuvre_initial_time) {
     recomputed_coast->parent()->DeleteFork(recomputed_coast);
   }
@@ -74,6 +74,38 @@ class FlightPlan {
   // |size()| must be greater than 0.
   virtual bool ReplaceLast(Burn burn);
 
+  // Integrates the flight plans that would result from replacing the last
+  // manœuvre with each of the |burns|, without changing the segments of this
+  // object.  The integrations for the different |burns| are distributed over
+  // the threads requested by |Ephemeris::set_massless_bodies_threads|.  The
+  // resulting candidates are kept until one of them is committed by
+  // |ReplaceLastWithCandidate|, or until any other function modifies this
+  // object.  |number_of_manœuvres()| must be greater than 0.
+  virtual void EvaluateReplaceLastCandidates(std::vector<Burn> burns);
+
+  // Returns the number of candidates from the last call to
+  // |EvaluateReplaceLastCandidates|, or 0 if they were discarded.
+  virtual int number_of_candidates() const;
+
+  // |index| must be in [0, number_of_candidates()[.  Returns false if
+  // |ReplaceLast| would have rejected the burn of candidate |index|.
+  virtual bool IsValidCandidate(int index) const;
+
+  // |index| must denote a valid candidate.  Sets the iterators to denote all
+  // the segments of the flight plan that would result from committing the
+  // candidate, as |GetAllSegments| does.  The last point is the final state
+  // of that flight plan.
+  virtual void GetCandidateSegments(
+      int index,
+      DiscreteTrajectory<Barycentric>::Iterator& begin,
+      DiscreteTrajectory<Barycentric>::Iterator& end) const;
+
+  // Has the same effect as |ReplaceLast| with the burn of candidate |index|,
+  // but reuses the segments computed by |EvaluateReplaceLastCandidates|
+  // instead of integrating them.  Returns false and has no effect if the
+  // candidate is not valid.  Discards all the candidates.
+  virtual bool ReplaceLastWithCandidate(int index);
+
   // Returns false and has no effect if |desired_final_time| is before the end
   // of the last manœuvre or before |initial_time_|.
   virtual bool SetDesiredFinalTime(Instant const& desired_final_time);
@@ -83,7 +115,9 @@ class FlightPlan {
 
   // Sets the parameters used to compute the trajectories.  The trajectories are
   // recomputed.  Returns false (and doesn't change this object) if the
-  // parameters would make it impossible to recompute the trajectories.
+  // parameters would make it impossible to recompute the trajectories.  The
+  // original trajectories are kept until the recomputation succeeds, so they
+  // are restored without being recomputed.
   virtual bool SetAdaptiveStepParameters(
       Ephemeris<Barycentric>::AdaptiveStepParameters const&
           adaptive_step_parameters);
@@ -116,6 +150,20 @@ class FlightPlan {
   FlightPlan();
 
  private:
+  // A possible replacement for the last manœuvre, see
+  // |EvaluateReplaceLastCandidates|.
+  struct Candidate final {
+    explicit Candidate(NavigationManœuvre manœuvre);
+
+    NavigationManœuvre manœuvre;
+    // The coast until the manœuvre, the burn and the last coast, each of them a
+    // fork of the previous one.  The coast is a sibling of the penultimate
+    // coast of |segments_|.  Empty if the manœuvre was rejected.
+    std::vector<not_null<DiscreteTrajectory<Barycentric>*>> segments;
+    // Same as |anomalous_segments_|, for |segments|.
+    int anomalous_segments = 0;
+  };
+
   // Appends |manœuvre| to |manœuvres_|, adds a burn and a coast segment.
   // |manœuvre| must fit between |start_of_last_coast()| and
   // |desired_final_time_|, the last coast segment must end at
@@ -132,6 +180,17 @@ class FlightPlan {
   // Flows the last segment until |desired_final_time| with no intrinsic
   // acceleration.
   void CoastLastSegment(Instant const& desired_final_time);
+  // Flows |segment| from its last point until |desired_final_time| with no
+  // intrinsic acceleration.  Returns false if |desired_final_time| was not
+  // reached.
+  bool CoastSegment(not_null<DiscreteTrajectory<Barycentric>*> segment,
+                    Instant const& desired_final_time);
+  // Returns the parameters for extending |segment|: the points already in
+  // |segment| count against |max_steps|, so that an extended segment is no
+  // longer than one computed from scratch.  The resulting |max_steps| may be
+  // nonpositive, in which case |segment| must not be extended.
+  Ephemeris<Barycentric>::AdaptiveStepParameters ParametersToExtend(
+      DiscreteTrajectory<Barycentric> const& segment) const;
 
   // Replaces the last segment with |segment|.  |segment| must be forked from
   // the same trajectory as the last segment, and at the same time.  |segment|
@@ -142,13 +201,27 @@ class FlightPlan {
   void AddSegment();
   // Forgets the last segment after its fork.
   void ResetLastSegment();
+  // Forgets the points of the last segment at or after |time|, which must not
+  // be before its fork.  The last segment ceases to be anomalous if it was
+  // anomalous because it ended early.
+  void ForgetLastSegmentFrom(Instant const& time);
 
   // Deletes the last segment and removes it from |segments_|.
   void PopLastSegment();
 
+  // Returns a new fork of the parent of |coast|, at the same time, containing
+  // the points of |coast| before |time|.
+  not_null<DiscreteTrajectory<Barycentric>*> NewCoastBefore(
+      DiscreteTrajectory<Barycentric>& coast,
+      Instant const& time);
+
+  // Deletes the segments of the |candidates_| and clears them.
+  void DiscardCandidates();
+
   // If the integration of a coast from the fork of |coast| until
   // |manœuvre.initial_time()| reaches the end, returns the integrated
-  // trajectory.  Otherwise, returns null.
+  // trajectory, a new fork of the parent of |coast|.  Otherwise, returns null.
+  // The points of |coast| before |manœuvre.initial_time()| are reused.
   DiscreteTrajectory<Barycentric>* CoastIfReachesManœuvreInitialTime(
       DiscreteTrajectory<Barycentric>& coast,
       NavigationManœuvre const& manœuvre);
@@ -180,6 +253,7 @@ class FlightPlan {
   // |anomalous_segments_| is at most 2: the penultimate coast is never
   // anomalous.
   int anomalous_segments_ = 0;
+  std::vector<Candidate> candidates_;
 };
 
 }  // namespace internal_flight_plan
@@ -53,6 +53,7 @@ using ksp_plugin::Barycentric;
 using ksp_plugin::Part;
 using ksp_plugin::World;
 using physics::DegreesOfFreedom;
+using physics::Ephemeris;
 using physics::FrameField;
 using physics::MassiveBody;
 using physics::OblateBody;
@@ -77,6 +78,24 @@ namespace {
 int const chunk_size = 64 << 10;
 int const number_of_chunks = 8;
 
+// The positions rendered by |principia__RenderPrediction|,
+// |principia__RenderVesselTrajectory| and their decimated variants.  Reused
+// from call to call so that rendering doesn't allocate once the vector has
+// reached its final size.
+std::vector<Position<World>> rendered_positions;
+
+// Stores the first |count| elements of |positions|, in metres, in |xyzs|, and
+// returns the size of |positions|.
+int ToXYZs(std::vector<Position<World>> const& positions,
+           XYZ* const xyzs,
+           int const count) {
+  int const size = positions.size();
+  for (int i = 0; i < size && i < count; ++i) {
+    xyzs[i] = ToXYZ((positions[i] - World::origin).coordinates() / Metre);
+  }
+  return size;
+}
+
 base::not_null<std::unique_ptr<MassiveBody>> MakeMassiveBody(
     BodyParameters const& body_parameters) {
   // Logging operators would dereference a null C string.
@@ -150,7 +169,8 @@ void principia__ActivateRecorder(bool const activate) {
     name << std::put_time(localtime, "JOURNAL.%Y%m%d-%H%M%S");
     journal::Recorder* const recorder =
         new journal::Recorder(std::experimental::filesystem::path("glog") /
-                                  "Principia" / name.str());
+                                  "Principia" / name.str(),
+                              journal::Recorder::Format::Binary);
     journal::Recorder::Activate(recorder);
   } else if (!activate && journal::Recorder::IsActivated()) {
     journal::Recorder::Deactivate();
@@ -640,6 +660,106 @@ bool principia__PhysicsBubbleIsEmpty(Plugin const* const plugin) {
   return m.Return(plugin->PhysicsBubbleIsEmpty());
 }
 
+// Same as |principia__RenderPrediction| below, but for
+// |plugin->RenderDecimatedPrediction|.  |angular_tolerance| is in radians.
+int principia__RenderDecimatedPrediction(Plugin const* const plugin,
+                                         char const* const vessel_guid,
+                                         XYZ const sun_world_position,
+                                         XYZ const camera_world_position,
+                                         double const angular_tolerance,
+                                         int const max_points,
+                                         XYZ* const positions,
+                                         int const count) {
+  journal::Method<journal::RenderDecimatedPrediction> m(
+      {plugin,
+       vessel_guid,
+       sun_world_position,
+       camera_world_position,
+       angular_tolerance,
+       max_points},
+      {positions, count});
+  CHECK_NOTNULL(plugin);
+  plugin->RenderDecimatedPrediction(
+      vessel_guid,
+      World::origin + Displacement<World>(FromXYZ(sun_world_position) * Metre),
+      World::origin +
+          Displacement<World>(FromXYZ(camera_world_position) * Metre),
+      angular_tolerance * Radian,
+      max_points,
+      rendered_positions);
+  return m.Return(ToXYZs(rendered_positions, positions, count));
+}
+
+// Same as |principia__RenderVesselTrajectory| below, but for
+// |plugin->RenderDecimatedVesselTrajectory|.  |angular_tolerance| is in
+// radians.
+int principia__RenderDecimatedVesselTrajectory(
+    Plugin const* const plugin,
+    char const* const vessel_guid,
+    XYZ const sun_world_position,
+    XYZ const camera_world_position,
+    double const angular_tolerance,
+    int const max_points,
+    XYZ* const positions,
+    int const count) {
+  journal::Method<journal::RenderDecimatedVesselTrajectory> m(
+      {plugin,
+       vessel_guid,
+       sun_world_position,
+       camera_world_position,
+       angular_tolerance,
+       max_points},
+      {positions, count});
+  CHECK_NOTNULL(plugin);
+  plugin->RenderDecimatedVesselTrajectory(
+      vessel_guid,
+      World::origin + Displacement<World>(FromXYZ(sun_world_position) * Metre),
+      World::origin +
+          Displacement<World>(FromXYZ(camera_world_position) * Metre),
+      angular_tolerance * Radian,
+      max_points,
+      rendered_positions);
+  return m.Return(ToXYZs(rendered_positions, positions, count));
+}
+
+// Calls |plugin->RenderPrediction| with the arguments given and stores the
+// first |count| rendered positions in |positions|.  Returns the number of
+// rendered positions; if it is larger than |count|, the caller must call again
+// with a larger buffer to get all of them.  |plugin| must not be null.  No
+// transfer of ownership.
+int principia__RenderPrediction(Plugin const* const plugin,
+                                char const* const vessel_guid,
+                                XYZ const sun_world_position,
+                                XYZ* const positions,
+                                int const count) {
+  journal::Method<journal::RenderPrediction> m(
+      {plugin, vessel_guid, sun_world_position},
+      {positions, count});
+  CHECK_NOTNULL(plugin);
+  plugin->RenderPrediction(
+      vessel_guid,
+      World::origin + Displacement<World>(FromXYZ(sun_world_position) * Metre),
+      rendered_positions);
+  return m.Return(ToXYZs(rendered_positions, positions, count));
+}
+
+// Same as above, but for |plugin->RenderVesselTrajectory|.
+int principia__RenderVesselTrajectory(Plugin const* const plugin,
+                                      char const* const vessel_guid,
+                                      XYZ const sun_world_position,
+                                      XYZ* const positions,
+                                      int const count) {
+  journal::Method<journal::RenderVesselTrajectory> m(
+      {plugin, vessel_guid, sun_world_position},
+      {positions, count});
+  CHECK_NOTNULL(plugin);
+  plugin->RenderVesselTrajectory(
+      vessel_guid,
+      World::origin + Displacement<World>(FromXYZ(sun_world_position) * Metre),
+      rendered_positions);
+  return m.Return(ToXYZs(rendered_positions, positions, count));
+}
+
 Iterator* principia__RenderedPrediction(Plugin* const plugin,
                                         char const* const vessel_guid,
                                         XYZ const sun_world_position) {
@@ -665,15 +785,13 @@ void principia__RenderedPredictionApsides(Plugin const* const plugin,
       {plugin, vessel_guid, celestial_index, sun_world_position},
       {apoapsides, periapsides});
   CHECK_NOTNULL(plugin);
-  auto const& prediction = plugin->GetVessel(vessel_guid)->prediction();
   Position<World> q_sun =
       World::origin +
       Displacement<World>(FromXYZ(sun_world_position) * Metre);
   std::unique_ptr<DiscreteTrajectory<World>> rendered_apoapsides;
   std::unique_ptr<DiscreteTrajectory<World>> rendered_periapsides;
-  plugin->ComputeAndRenderApsides(celestial_index,
-                                  prediction.Fork(),
-                                  prediction.End(),
+  plugin->RenderPredictionApsides(vessel_guid,
+                                  celestial_index,
                                   q_sun,
                                   rendered_apoapsides,
                                   rendered_periapsides);
@@ -776,6 +894,54 @@ void principia__SetBufferedLogging(int const max_severity) {
   return m.Return();
 }
 
+// |kernel| is the name of an |Ephemeris::MassiveBodiesKernel|.  See
+// |Plugin::SetEphemerisMassiveBodiesKernel|.
+void principia__SetEphemerisMassiveBodiesKernel(
+    Plugin* const plugin,
+    char const* const kernel,
+    double const barnes_hut_opening_angle,
+    double const barnes_hut_dominant_fraction) {
+  journal::Method<journal::SetEphemerisMassiveBodiesKernel> m(
+      {plugin, kernel, barnes_hut_opening_angle, barnes_hut_dominant_fraction});
+  CHECK_NOTNULL(plugin);
+  using MassiveBodiesKernel = Ephemeris<Barycentric>::MassiveBodiesKernel;
+  std::string const name = kernel;
+  MassiveBodiesKernel massive_bodies_kernel;
+  if (name == "Scalar") {
+    massive_bodies_kernel = MassiveBodiesKernel::Scalar;
+  } else if (name == "Vectorized") {
+    massive_bodies_kernel = MassiveBodiesKernel::Vectorized;
+  } else if (name == "BarnesHut") {
+    massive_bodies_kernel = MassiveBodiesKernel::BarnesHut;
+  } else {
+    LOG(FATAL) << "Unexpected kernel " << name;
+    base::noreturn();
+  }
+  plugin->SetEphemerisMassiveBodiesKernel(massive_bodies_kernel,
+                                          barnes_hut_opening_angle,
+                                          barnes_hut_dominant_fraction);
+  return m.Return();
+}
+
+// |horizon| is in seconds.  See |Plugin::SetEphemerisProlongationHorizon|.
+void principia__SetEphemerisProlongationHorizon(Plugin* const plugin,
+                                                double const horizon) {
+  journal::Method<journal::SetEphemerisProlongationHorizon> m({plugin,
+                                                               horizon});
+  CHECK_NOTNULL(plugin);
+  plugin->SetEphemerisProlongationHorizon(horizon * Second);
+  return m.Return();
+}
+
+// See |Plugin::SetFullEphemerisSerialization|.
+void principia__SetFullEphemerisSerialization(Plugin* const plugin,
+                                              bool const full) {
+  journal::Method<journal::SetFullEphemerisSerialization> m({plugin, full});
+  CHECK_NOTNULL(plugin);
+  plugin->SetFullEphemerisSerialization(full);
+  return m.Return();
+}
+
 void principia__SetMainBody(Plugin* const plugin, int const index) {
   journal::Method<journal::SetMainBody> m({plugin, index});
   CHECK_NOTNULL(plugin);
@@ -7,6 +7,7 @@
 #include <limits>
 #include <map>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 #include <set>
@@ -32,6 +33,7 @@
 #include "physics/body_surface_dynamic_frame.hpp"
 #include "physics/dynamic_frame.hpp"
 #include "physics/frame_field.hpp"
+#include "physics/polyline_decimation.hpp"
 #include "physics/rotating_body.hpp"
 
 namespace principia {
@@ -62,6 +64,7 @@ using physics::BodyCentredBodyDirectionDynamicFrame;
 using physics::BodyCentredNonRotatingDynamicFrame;
 using physics::BodySurfaceDynamicFrame;
 using physics::CoordinateFrameField;
+using physics::DecimatedPolyline;
 using physics::DynamicFrame;
 using physics::Frenet;
 using physics::KeplerianElements;
@@ -77,6 +80,10 @@ namespace {
 
 Length const fitting_tolerance = 1 * Milli(Metre);
 
+// Below this number of celestials the computation of the accelerations of the
+// massive bodies is too cheap to be worth distributing over threads.
+std::size_t const massive_bodies_threads_threshold = 64;
+
 std::uint64_t const ksp_stock_system_fingerprint = 0xD15286A27180CD31u;
 std::uint64_t const ksp_fixed_system_fingerprint = 0x648C354716008328u;
 
@@ -380,12 +387,14 @@ void Plugin::AdvanceTime(Instant const& t, Angle const& planetarium_rotation) {
   bubble_->Prepare(BarycentricToWorldSun(), current_time_, t);
 
   EvolveBubble(t);
+  std::vector<not_null<Vessel*>> vessels_not_in_bubble;
   for (auto const& pair : vessels_) {
     not_null<std::unique_ptr<Vessel>> const& vessel = pair.second;
     if (!bubble_->contains(vessel.get())) {
-      vessel->AdvanceTimeNotInBubble(t);
+      vessels_not_in_bubble.push_back(vessel.get());
     }
   }
+  Vessel::AdvanceTimeNotInBubble(vessels_not_in_bubble, t);
 
   VLOG(1) << "Time has been advanced" << '\n'
           << "from : " << current_time_ << '\n'
@@ -394,6 +403,32 @@ void Plugin::AdvanceTime(Instant const& t, Angle const& planetarium_rotation) {
   planetarium_rotation_ = planetarium_rotation;
 }
 
+void Plugin::SetEphemerisProlongationHorizon(Time const& horizon) {
+  CHECK(!initializing_);
+  CHECK_LE(Time(), horizon);
+  ephemeris_->StopBackgroundProlongation();
+  if (horizon > Time()) {
+    ephemeris_->StartBackgroundProlongation(horizon);
+  }
+}
+
+void Plugin::SetFullEphemerisSerialization(bool const full) {
+  CHECK(!initializing_);
+  ephemeris_->set_serialization_mode(
+      full ? Ephemeris<Barycentric>::SerializationMode::Full
+           : Ephemeris<Barycentric>::SerializationMode::Compact);
+}
+
+void Plugin::SetEphemerisMassiveBodiesKernel(
+    Ephemeris<Barycentric>::MassiveBodiesKernel const kernel,
+    double const barnes_hut_opening_angle,
+    double const barnes_hut_dominant_fraction) {
+  CHECK(!initializing_);
+  ephemeris_->set_barnes_hut_parameters(barnes_hut_opening_angle,
+                                        barnes_hut_dominant_fraction);
+  ephemeris_->set_massive_bodies_kernel(kernel);
+}
+
 void Plugin::ForgetAllHistoriesBefore(Instant const& t) const {
   CHECK(!initializing_);
   CHECK_LT(t, current_time_);
@@ -486,45 +521,149 @@ Plugin::RenderedTrajectoryFromIterators(
     DiscreteTrajectory<Barycentric>::Iterator const& end,
     Position<World> const& sun_world_position) const {
   auto result = make_not_null_unique<DiscreteTrajectory<World>>();
-  auto const to_world =
-      AffineMap<Barycentric, World, Length, OrthogonalMap>(
-          sun_->current_position(current_time_),
-          sun_world_position,
-          OrthogonalMap<WorldSun, World>::Identity() * BarycentricToWorldSun());
+  auto const from_navigation_frame_to_world_at_current_time =
+      NavigationToWorldAtCurrentTime(sun_world_position);
 
-  // Compute the trajectory in the navigation frame.
-  DiscreteTrajectory<Navigation> intermediate_trajectory;
+  // Compute each point in the navigation frame and render it at current time
+  // in |World|.
   for (auto it = begin; it != end; ++it) {
-    intermediate_trajectory.Append(
-        it.time(),
-        plotting_frame_->ToThisFrameAtTime(it.time())(
-            it.degrees_of_freedom()));
-  }
-
-  // Render the trajectory at current time in |World|.
-  DiscreteTrajectory<Navigation>::Iterator const intermediate_end =
-      intermediate_trajectory.End();
-  auto from_navigation_frame_to_world_at_current_time =
-      to_world *
-          plotting_frame_->
-              FromThisFrameAtTime(current_time_).rigid_transformation();
-  for (auto intermediate_it = intermediate_trajectory.Begin();
-       intermediate_it != intermediate_end;
-       ++intermediate_it) {
     DegreesOfFreedom<Navigation> const navigation_degrees_of_freedom =
-        intermediate_it.degrees_of_freedom();
+        plotting_frame_->ToThisFrameAtTime(it.time())(
+            it.degrees_of_freedom());
     DegreesOfFreedom<World> const world_degrees_of_freedom =
         DegreesOfFreedom<World>(
             from_navigation_frame_to_world_at_current_time(
                 navigation_degrees_of_freedom.position()),
             from_navigation_frame_to_world_at_current_time.linear_map()(
                 navigation_degrees_of_freedom.velocity()));
-    result->Append(intermediate_it.time(), world_degrees_of_freedom);
+    result->Append(it.time(), world_degrees_of_freedom);
   }
   VLOG(1) << "Returning a " << result->Size() << "-point trajectory";
   return result;
 }
 
+void Plugin::RenderTrajectoryFromIterators(
+    DiscreteTrajectory<Barycentric>::Iterator const& begin,
+    DiscreteTrajectory<Barycentric>::Iterator const& end,
+    Position<World> const& sun_world_position,
+    std::vector<Position<World>>& positions) const {
+  positions.clear();
+  auto const from_navigation_frame_to_world_at_current_time =
+      NavigationToWorldAtCurrentTime(sun_world_position);
+  for (auto it = begin; it != end; ++it) {
+    // Only the positions are needed, so the velocities are not transformed.
+    positions.push_back(from_navigation_frame_to_world_at_current_time(
+        plotting_frame_->ToThisFrameAtTime(it.time()).rigid_transformation()(
+            it.degrees_of_freedom().position())));
+  }
+  VLOG(1) << "Returning " << positions.size() << " positions";
+}
+
+void Plugin::RenderVesselTrajectory(
+    GUID const& vessel_guid,
+    Position<World> const& sun_world_position,
+    std::vector<Position<World>>& positions) const {
+  CHECK(!initializing_);
+  Vessel const& vessel = *find_vessel_by_guid_or_die(vessel_guid);
+  CHECK(vessel.is_initialized());
+  RenderTrajectoryFromIterators(vessel.history().Begin(),
+                                vessel.history().End(),
+                                sun_world_position,
+                                positions);
+}
+
+void Plugin::RenderPrediction(
+    GUID const& vessel_guid,
+    Position<World> const& sun_world_position,
+    std::vector<Position<World>>& positions) const {
+  CHECK(!initializing_);
+  Vessel const& vessel = *find_vessel_by_guid_or_die(vessel_guid);
+  RenderTrajectoryFromIterators(vessel.prediction().Fork(),
+                                vessel.prediction().End(),
+                                sun_world_position,
+                                positions);
+}
+
+void Plugin::RenderDecimatedTrajectoryFromIterators(
+    DiscreteTrajectory<Barycentric>::Iterator const& begin,
+    DiscreteTrajectory<Barycentric>::Iterator const& end,
+    Position<World> const& sun_world_position,
+    Position<World> const& camera_world_position,
+    Angle const& angular_tolerance,
+    int const max_points,
+    std::vector<Position<World>>& positions) const {
+  positions.clear();
+  if (begin == end) {
+    return;
+  }
+
+  // The decimation takes place in the plotting frame, which is the frame in
+  // which the trajectory is displayed and in which the apsides are defined.
+  // Distances, and therefore angles, are the same as in |World|.
+  std::vector<Instant> times;
+  std::vector<DegreesOfFreedom<Navigation>> degrees_of_freedom;
+  for (auto it = begin; it != end; ++it) {
+    times.push_back(it.time());
+    degrees_of_freedom.push_back(
+        plotting_frame_->ToThisFrameAtTime(it.time())(
+            it.degrees_of_freedom()));
+  }
+  auto const from_navigation_frame_to_world_at_current_time =
+      NavigationToWorldAtCurrentTime(sun_world_position);
+  std::vector<Position<Navigation>> const polyline =
+      DecimatedPolyline(
+          times,
+          degrees_of_freedom,
+          from_navigation_frame_to_world_at_current_time.Inverse()(
+              camera_world_position),
+          Navigation::origin,
+          angular_tolerance,
+          max_points);
+  for (auto const& position : polyline) {
+    positions.push_back(
+        from_navigation_frame_to_world_at_current_time(position));
+  }
+  VLOG(1) << "Returning " << positions.size() << " positions out of "
+          << times.size() << " points";
+}
+
+void Plugin::RenderDecimatedVesselTrajectory(
+    GUID const& vessel_guid,
+    Position<World> const& sun_world_position,
+    Position<World> const& camera_world_position,
+    Angle const& angular_tolerance,
+    int const max_points,
+    std::vector<Position<World>>& positions) const {
+  CHECK(!initializing_);
+  Vessel const& vessel = *find_vessel_by_guid_or_die(vessel_guid);
+  CHECK(vessel.is_initialized());
+  RenderDecimatedTrajectoryFromIterators(vessel.history().Begin(),
+                                         vessel.history().End(),
+                                         sun_world_position,
+                                         camera_world_position,
+                                         angular_tolerance,
+                                         max_points,
+                                         positions);
+}
+
+void Plugin::RenderDecimatedPrediction(
+    GUID const& vessel_guid,
+    Position<World> const& sun_world_position,
+    Position<World> const& camera_world_position,
+    Angle const& angular_tolerance,
+    int const max_points,
+    std::vector<Position<World>>& positions) const {
+  CHECK(!initializing_);
+  Vessel const& vessel = *find_vessel_by_guid_or_die(vessel_guid);
+  RenderDecimatedTrajectoryFromIterators(vessel.prediction().Fork(),
+                                         vessel.prediction().End(),
+                                         sun_world_position,
+                                         camera_world_position,
+                                         angular_tolerance,
+                                         max_points,
+                                         positions);
+}
+
 void Plugin::ComputeAndRenderApsides(
     Index const celestial_index,
     DiscreteTrajectory<Barycentric>::Iterator const& begin,
@@ -546,6 +685,36 @@ void Plugin::ComputeAndRenderApsides(
                                                 sun_world_position);
 }
 
+void Plugin::RenderPredictionApsides(
+    GUID const& vessel_guid,
+    Index const celestial_index,
+    Position<World> const& sun_world_position,
+    std::unique_ptr<DiscreteTrajectory<World>>& apoapsides,
+    std::unique_ptr<DiscreteTrajectory<World>>& periapsides) const {
+  Vessel& vessel = *find_vessel_by_guid_or_die(vessel_guid);
+  auto const body = FindOrDie(celestials_, celestial_index)->body();
+  if (body == vessel.prediction_apsides_body()) {
+    auto const& apoapsides_trajectory = vessel.prediction_apoapsides();
+    auto const& periapsides_trajectory = vessel.prediction_periapsides();
+    apoapsides = RenderedTrajectoryFromIterators(apoapsides_trajectory.Begin(),
+                                                 apoapsides_trajectory.End(),
+                                                 sun_world_position);
+    periapsides = RenderedTrajectoryFromIterators(
+        periapsides_trajectory.Begin(),
+        periapsides_trajectory.End(),
+        sun_world_position);
+  } else {
+    vessel.set_prediction_apsides_body(body);
+    auto const& prediction = vessel.prediction();
+    ComputeAndRenderApsides(celestial_index,
+                            prediction.Fork(),
+                            prediction.End(),
+                            sun_world_position,
+                            apoapsides,
+                            periapsides);
+  }
+}
+
 void Plugin::SetPredictionLength(Time const& t) {
   prediction_length_ = t;
 }
@@ -993,6 +1162,9 @@ Plugin::Plugin(
     main_body_ = CHECK_NOTNULL(
         dynamic_cast_not_null<RotatingBody<Barycentric> const*>(sun_->body()));
   }
+  if (ephemeris_ != nullptr) {
+    SetEphemerisThreads();
+  }
   initializing_.Flop();
 }
 
@@ -1014,6 +1186,7 @@ void Plugin::InitializeEphemerisAndSetCelestialTrajectories() {
                             current_time_,
                             fitting_tolerance,
                             DefaultEphemerisParameters());
+  SetEphemerisThreads();
   for (auto const& pair : celestials_) {
     auto& celestial = *pair.second;
     celestial.set_trajectory(ephemeris_->trajectory(celestial.body()));
@@ -1030,6 +1203,19 @@ void Plugin::InitializeEphemerisAndSetCelestialTrajectories() {
           sun_->body()));
 }
 
+void Plugin::SetEphemerisThreads() {
+  // |hardware_concurrency| returns 0 if it cannot tell.
+  int const threads = std::max(1u, std::thread::hardware_concurrency());
+  if (celestials_.size() >= massive_bodies_threads_threshold) {
+    ephemeris_->set_massive_bodies_threads(threads);
+  }
+  // The prolongations of the vessels and the candidate burns of the flight
+  // plans are independent integrations.
+  ephemeris_->set_massless_bodies_threads(threads);
+  // The series of the celestials are fitted independently.
+  ephemeris_->set_fitting_threads(threads);
+}
+
 not_null<std::unique_ptr<Vessel>> const& Plugin::find_vessel_by_guid_or_die(
     GUID const& vessel_guid) const {
   VLOG(1) << __FUNCTION__ << '\n' << NAMED(vessel_guid);
@@ -1067,6 +1253,18 @@ Rotation<Barycentric, AliceSun> Plugin::PlanetariumRotation() const {
   }
 }
 
+RigidTransformation<Navigation, World> Plugin::NavigationToWorldAtCurrentTime(
+    Position<World> const& sun_world_position) const {
+  auto const to_world =
+      AffineMap<Barycentric, World, Length, OrthogonalMap>(
+          sun_->current_position(current_time_),
+          sun_world_position,
+          OrthogonalMap<WorldSun, World>::Identity() * BarycentricToWorldSun());
+  return to_world *
+         plotting_frame_->
+             FromThisFrameAtTime(current_time_).rigid_transformation();
+}
+
 void Plugin::FreeVessels() {
   VLOG(1) <<  __FUNCTION__;
   // Remove the vessels which were not updated since last time.
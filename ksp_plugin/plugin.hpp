@@ -27,6 +27,7 @@
 #include "physics/frame_field.hpp"
 #include "physics/hierarchical_system.hpp"
 #include "physics/kepler_orbit.hpp"
+#include "physics/rigid_motion.hpp"
 #include "quantities/quantities.hpp"
 #include "quantities/named_quantities.hpp"
 #include "quantities/si.hpp"
@@ -58,6 +59,7 @@ using physics::Frenet;
 using physics::HierarchicalSystem;
 using physics::MassiveBody;
 using physics::RelativeDegreesOfFreedom;
+using physics::RigidTransformation;
 using physics::RotatingBody;
 using quantities::Angle;
 using quantities::Length;
@@ -179,6 +181,29 @@ class Plugin {
   // degrees.
   virtual void AdvanceTime(Instant const& t, Angle const& planetarium_rotation);
 
+  // If |horizon| is positive, the ephemeris is integrated on a background
+  // thread, which tries to stay |horizon| ahead of the times passed to
+  // |AdvanceTime|, so that |AdvanceTime| rarely has to wait for it.  If
+  // |horizon| is zero, the ephemeris is integrated synchronously by
+  // |AdvanceTime|, which is the default.  Must be called after initialization.
+  virtual void SetEphemerisProlongationHorizon(Time const& horizon);
+
+  // If |full| is true, the saves include the state of the ephemeris past its
+  // first checkpoint, so that loading them doesn't integrate the ephemeris
+  // again.  Such saves are larger and slower to write.  The default is false.
+  // Must be called after initialization.  Not serialized.
+  virtual void SetFullEphemerisSerialization(bool full);
+
+  // Selects the computation of the mutual accelerations of the massive bodies,
+  // see |Ephemeris::MassiveBodiesKernel|.  The Barnes-Hut parameters are only
+  // used by the |BarnesHut| kernel, see |Ephemeris::set_barnes_hut_parameters|.
+  // The default is |Scalar|, which is the only kernel that is bit-reproducible
+  // across platforms.  Must be called after initialization.  Not serialized.
+  virtual void SetEphemerisMassiveBodiesKernel(
+      Ephemeris<Barycentric>::MassiveBodiesKernel kernel,
+      double barnes_hut_opening_angle,
+      double barnes_hut_dominant_fraction);
+
   // Forgets the histories of the |celestials_| and of the vessels before |t|.
   virtual void ForgetAllHistoriesBefore(Instant const& t) const;
 
@@ -241,6 +266,59 @@ class Plugin {
       DiscreteTrajectory<Barycentric>::Iterator const& end,
       Position<World> const& sun_world_position) const;
 
+  // Same as above, but only computes the positions, and stores them in
+  // |positions|, which is cleared first.  No trajectory is built, and the
+  // storage of |positions| is reused, so that rendering every frame into the
+  // same |positions| doesn't allocate once it has reached its final size.
+  virtual void RenderTrajectoryFromIterators(
+      DiscreteTrajectory<Barycentric>::Iterator const& begin,
+      DiscreteTrajectory<Barycentric>::Iterator const& end,
+      Position<World> const& sun_world_position,
+      std::vector<Position<World>>& positions) const;
+
+  // Same as |RenderedVesselTrajectory| and |RenderedPrediction|, but using
+  // |RenderTrajectoryFromIterators| to store the positions in |positions|.
+  virtual void RenderVesselTrajectory(
+      GUID const& vessel_guid,
+      Position<World> const& sun_world_position,
+      std::vector<Position<World>>& positions) const;
+  virtual void RenderPrediction(
+      GUID const& vessel_guid,
+      Position<World> const& sun_world_position,
+      std::vector<Position<World>>& positions) const;
+
+  // Same as |RenderTrajectoryFromIterators|, but the trajectory is simplified
+  // for display, see |DecimatedPolyline|.  Seen from |camera_world_position|,
+  // the polyline deviates from the trajectory by at most |angular_tolerance|,
+  // unless that would take more than |max_points| points.  The endpoints and
+  // the apsides with respect to the origin of the plotting frame are always
+  // part of the polyline.  The simplification is done in the plotting frame.
+  virtual void RenderDecimatedTrajectoryFromIterators(
+      DiscreteTrajectory<Barycentric>::Iterator const& begin,
+      DiscreteTrajectory<Barycentric>::Iterator const& end,
+      Position<World> const& sun_world_position,
+      Position<World> const& camera_world_position,
+      Angle const& angular_tolerance,
+      int max_points,
+      std::vector<Position<World>>& positions) const;
+
+  // Same as |RenderVesselTrajectory| and |RenderPrediction|, but using
+  // |RenderDecimatedTrajectoryFromIterators|.
+  virtual void RenderDecimatedVesselTrajectory(
+      GUID const& vessel_guid,
+      Position<World> const& sun_world_position,
+      Position<World> const& camera_world_position,
+      Angle const& angular_tolerance,
+      int max_points,
+      std::vector<Position<World>>& positions) const;
+  virtual void RenderDecimatedPrediction(
+      GUID const& vessel_guid,
+      Position<World> const& sun_world_position,
+      Position<World> const& camera_world_position,
+      Angle const& angular_tolerance,
+      int max_points,
+      std::vector<Position<World>>& positions) const;
+
   virtual void ComputeAndRenderApsides(
       Index celestial_index,
       DiscreteTrajectory<Barycentric>::Iterator const& begin,
@@ -249,6 +327,18 @@ class Plugin {
       std::unique_ptr<DiscreteTrajectory<World>>& apoapsides,
       std::unique_ptr<DiscreteTrajectory<World>>& periapsides) const;
 
+  // Renders the apsides of the prediction of the given vessel with respect to
+  // the given celestial.  The apsides are detected while the prediction is
+  // integrated; if they were detected with respect to another celestial, they
+  // are computed from the prediction this time, and detected from the next
+  // update of the prediction on.
+  virtual void RenderPredictionApsides(
+      GUID const& vessel_guid,
+      Index celestial_index,
+      Position<World> const& sun_world_position,
+      std::unique_ptr<DiscreteTrajectory<World>>& apoapsides,
+      std::unique_ptr<DiscreteTrajectory<World>>& periapsides) const;
+
   virtual void SetPredictionLength(Time const& t);
 
   virtual void SetPredictionAdaptiveStepParameters(
@@ -375,6 +465,10 @@ class Plugin {
   // Requires |absolute_initialization_| and consumes it.
   virtual void InitializeEphemerisAndSetCelestialTrajectories();
 
+  // Distributes the computations of |ephemeris_| over the available hardware
+  // threads where this is profitable.  Requires |ephemeris_| to be non-null.
+  void SetEphemerisThreads();
+
   not_null<std::unique_ptr<Vessel>> const& find_vessel_by_guid_or_die(
       GUID const& vessel_guid) const;
 
@@ -384,6 +478,11 @@ class Plugin {
   // or displacements between simultaneous events.
   Rotation<Barycentric, AliceSun> PlanetariumRotation() const;
 
+  // The transformation from the current |plotting_frame_| at |current_time_|
+  // to |World|, where the sun is at |sun_world_position|.
+  RigidTransformation<Navigation, World> NavigationToWorldAtCurrentTime(
+      Position<World> const& sun_world_position) const;
+
   // Utilities for |AdvanceTime|.
 
   // Remove vessels not in |kept_vessels_|, and clears |kept_vessels_|.
@@ -6,6 +6,7 @@
 #include <list>
 #include <vector>
 
+#include "astronomy/epoch.hpp"
 #include "integrators/embedded_explicit_runge_kutta_nyström_integrator.hpp"
 #include "ksp_plugin/pile_up.hpp"
 #include "ksp_plugin/vessel_subsets.hpp"
@@ -19,6 +20,7 @@ namespace internal_vessel {
 
 using base::make_not_null_unique;
 using geometry::Position;
+using geometry::Velocity;
 using integrators::DormandElMikkawyPrince1986RKN434FM;
 using integrators::McLachlanAtela1992Order5Optimal;
 using quantities::IsFinite;
@@ -103,6 +105,7 @@ void Vessel::set_prediction_adaptive_step_parameters(
     Ephemeris<Barycentric>::AdaptiveStepParameters const&
         prediction_adaptive_step_parameters) {
   prediction_adaptive_step_parameters_ = prediction_adaptive_step_parameters;
+  prediction_is_reusable_ = false;
 }
 
 Ephemeris<Barycentric>::AdaptiveStepParameters const&
@@ -126,6 +129,36 @@ void Vessel::AdvanceTimeNotInBubble(Instant const& time) {
   FlowProlongation(time);
 }
 
+void Vessel::AdvanceTimeNotInBubble(
+    std::vector<not_null<Vessel*>> const& vessels,
+    Instant const& time) {
+  if (vessels.empty()) {
+    return;
+  }
+  not_null<Ephemeris<Barycentric>*> const ephemeris =
+      vessels.front()->ephemeris_;
+  std::vector<not_null<DiscreteTrajectory<Barycentric>*>> prolongations;
+  std::vector<Ephemeris<Barycentric>::AdaptiveStepParameters> parameters;
+  for (not_null<Vessel*> const vessel : vessels) {
+    CHECK(vessel->is_initialized());
+    CHECK_EQ(ephemeris, vessel->ephemeris_);
+    vessel->AdvanceHistoryIfNeeded(time);
+    Instant const& prolongation_last_time =
+        vessel->prolongation_->last().time();
+    CHECK_LE(prolongation_last_time, time);
+    if (prolongation_last_time < time) {
+      prolongations.push_back(vessel->prolongation_);
+      parameters.push_back(vessel->prolongation_adaptive_step_parameters_);
+    }
+  }
+  ephemeris->FlowAllWithAdaptiveStep(
+      prolongations,
+      Ephemeris<Barycentric>::NoIntrinsicAccelerations,
+      time,
+      parameters,
+      Ephemeris<Barycentric>::unlimited_max_ephemeris_steps);
+}
+
 void Vessel::AdvanceTimeInBubble(
     Instant const& time,
     DegreesOfFreedom<Barycentric> const& degrees_of_freedom) {
@@ -140,6 +173,7 @@ void Vessel::ForgetBefore(Instant const& time) {
   if (prediction_->Fork().time() < time) {
     history_->DeleteFork(prediction_);
     prediction_ = history_->NewForkAtLast();
+    ClearPredictionApsides();
   }
   if (flight_plan_ != nullptr) {
     flight_plan_->ForgetBefore(time, [this]() { flight_plan_.reset(); });
@@ -168,14 +202,100 @@ void Vessel::DeleteFlightPlan() {
 
 void Vessel::UpdatePrediction(Instant const& last_time) {
   CHECK(is_initialized());
+  auto const history_last = history_->last();
+  auto const prolongation_last = prolongation_->last();
+  Instant const& start_time = prolongation_last.time();
+  std::int64_t const max_steps =
+      prediction_adaptive_step_parameters_.max_steps();
+
+  if (prediction_is_reusable_ &&
+      intrinsic_force_ == Vector<Force, Barycentric>() &&
+      start_time <= last_time &&
+      PredictionMatches(start_time, prolongation_last.degrees_of_freedom())) {
+    // The existing prediction agrees with the prolongation.  If it starts at
+    // the end of the prolongation, it is kept in place, otherwise it is
+    // detached, its points up to the end of the prolongation are forgotten,
+    // and it is attached back at the end of the history.
+    auto first_point = prediction_->Fork();
+    ++first_point;
+    bool const starts_at_start_time =
+        prediction_->Fork().time() == history_last.time() &&
+        (history_last.time() == start_time ||
+         (first_point != prediction_->End() &&
+          first_point.time() == start_time));
+    if (starts_at_start_time) {
+      if (last_time < prediction_->last().time()) {
+        prediction_->ForgetAfter(last_time);
+      }
+    } else {
+      not_null<std::unique_ptr<DiscreteTrajectory<Barycentric>>> prediction =
+          prediction_->DetachFork();
+      prediction->ForgetAfter(last_time);
+      auto first_kept = prediction->LowerBound(start_time);
+      if (first_kept != prediction->End() && first_kept.time() == start_time) {
+        ++first_kept;
+      }
+      prediction->ForgetBefore(first_kept == prediction->End()
+                                   ? astronomy::InfiniteFuture
+                                   : first_kept.time());
+      if (history_last.time() != start_time) {
+        prediction->Prepend(start_time,
+                            prolongation_last.degrees_of_freedom());
+      }
+      // This point is not appended to the history, which already has it.
+      prediction->Prepend(history_last.time(),
+                          history_last.degrees_of_freedom());
+      prediction_ = prediction.get();
+      history_->AttachFork(std::move(prediction));
+    }
+    prediction_apoapsides_->ForgetBefore(start_time);
+    prediction_apoapsides_->ForgetAfter(last_time);
+    prediction_periapsides_->ForgetBefore(start_time);
+    prediction_periapsides_->ForgetAfter(last_time);
+
+    // Each step of the existing prediction counts against |max_steps|, so that
+    // the prediction is no longer than one computed from scratch.
+    std::int64_t kept_steps = 0;
+    for (auto it = prediction_->LowerBound(start_time);
+         it != prediction_->End();
+         ++it) {
+      if (it.time() > start_time) {
+        ++kept_steps;
+      }
+    }
+    FlowPrediction(last_time, max_steps - kept_steps);
+    return;
+  }
+
   history_->DeleteFork(prediction_);
   prediction_ = history_->NewForkAtLast();
-  auto const prolongation_last = prolongation_->last();
-  if (history_->last().time() != prolongation_last.time()) {
-    prediction_->Append(prolongation_last.time(),
-                        prolongation_last.degrees_of_freedom());
+  if (history_last.time() != start_time) {
+    prediction_->Append(start_time, prolongation_last.degrees_of_freedom());
   }
-  FlowPrediction(last_time);
+  ClearPredictionApsides();
+  FlowPrediction(last_time, max_steps);
+  prediction_is_reusable_ = true;
+}
+
+void Vessel::set_prediction_apsides_body(
+    not_null<MassiveBody const*> const body) {
+  if (prediction_apsides_body_ != body) {
+    prediction_apsides_body_ = body;
+    ClearPredictionApsides();
+    prediction_is_reusable_ = false;
+  }
+}
+
+MassiveBody const* Vessel::prediction_apsides_body() const {
+  return prediction_apsides_body_;
+}
+
+DiscreteTrajectory<Barycentric> const& Vessel::prediction_apoapsides() const {
+  return *prediction_apoapsides_;
+}
+
+DiscreteTrajectory<Barycentric> const& Vessel::prediction_periapsides() const {
+  return *prediction_periapsides_;
 }
 
 void Vessel::clear_mass() {
@@ -237,7 +357,10 @@ void Vessel::WriteToMessage(
       message->mutable_prolongation_adaptive_step_parameters());
   history_fixed_step_parameters_.WriteToMessage(
       message->mutable_history_fixed_step_parameters());
-  history_->WriteToMessage(message->mutable_history(), {prolongation_});
+  history_->WriteToMessage(
+      message->mutable_history(),
+      {prolongation_},
+      serialization::DiscreteTrajectory::PackedTimeline::NONE);
   prediction_->Fork().time().WriteToMessage(
       message->mutable_prediction_fork_time());
   prediction_->last().time().WriteToMessage(
@@ -317,7 +440,8 @@ not_null<std::unique_ptr<Vessel>> Vessel::ReadFromMessage(
     vessel->prediction_ = vessel->history_->NewForkWithoutCopy(
         Instant::ReadFromMessage(message.prediction_fork_time()));
     vessel->FlowPrediction(
-        Instant::ReadFromMessage(message.prediction_last_time()));
+        Instant::ReadFromMessage(message.prediction_last_time()),
+        vessel->prediction_adaptive_step_parameters_.max_steps());
     if (message.has_flight_plan()) {
       vessel->flight_plan_ = FlightPlan::ReadFromMessage(
           message.flight_plan(), vessel->history_.get(), ephemeris);
@@ -375,30 +499,84 @@ void Vessel::FlowProlongation(Instant const& time) {
       Ephemeris<Barycentric>::unlimited_max_ephemeris_steps);
 }
 
-void Vessel::FlowPrediction(Instant const& time) {
-  if (time > prediction_->last().time()) {
+void Vessel::FlowPrediction(Instant const& time,
+                            std::int64_t const max_steps) {
+  if (time > prediction_->last().time() && max_steps > 0) {
+    Ephemeris<Barycentric>::AdaptiveStepParameters parameters =
+        prediction_adaptive_step_parameters_;
+    parameters.set_max_steps(max_steps);
     bool const finite_time = IsFinite(time - prediction_->last().time());
     Instant const t = finite_time ? time : ephemeris_->t_max();
+    // The apsides are detected during the integration, with increasing
+    // distance to the body at the periapsides.
+    Ephemeris<Barycentric>::EventDetector event_detector;
+    if (prediction_apsides_body_ != nullptr) {
+      event_detector.Add(
+          ephemeris_->ApsisEventFunction(prediction_apsides_body_),
+          /*increasing=*/prediction_periapsides_.get(),
+          /*decreasing=*/prediction_apoapsides_.get());
+    }
+    auto const flow = [this, &event_detector, &parameters](Instant const& t) {
+      if (prediction_apsides_body_ == nullptr) {
+        return ephemeris_->FlowWithAdaptiveStep(
+            prediction_,
+            Ephemeris<Barycentric>::NoIntrinsicAcceleration,
+            t,
+            parameters,
+            FlightPlan::max_ephemeris_steps_per_frame);
+      } else {
+        return ephemeris_->FlowWithAdaptiveStep(
+            prediction_,
+            Ephemeris<Barycentric>::NoIntrinsicAcceleration,
+            t,
+            parameters,
+            FlightPlan::max_ephemeris_steps_per_frame,
+            event_detector);
+      }
+    };
     // This will not prolong the ephemeris if |time| is infinite (but it may do
     // so if it is finite).
-    bool const reached_t = ephemeris_->FlowWithAdaptiveStep(
-        prediction_,
-        Ephemeris<Barycentric>::NoIntrinsicAcceleration,
-        t,
-        prediction_adaptive_step_parameters_,
-        FlightPlan::max_ephemeris_steps_per_frame);
+    bool const reached_t = flow(t);
     if (!finite_time && reached_t) {
       // This will prolong the ephemeris by |max_ephemeris_steps_per_frame|.
-      ephemeris_->FlowWithAdaptiveStep(
-        prediction_,
-        Ephemeris<Barycentric>::NoIntrinsicAcceleration,
-        time,
-        prediction_adaptive_step_parameters_,
-        FlightPlan::max_ephemeris_steps_per_frame);
+      flow(time);
     }
   }
 }
 
+void Vessel::ClearPredictionApsides() {
+  prediction_apoapsides_ =
+      make_not_null_unique<DiscreteTrajectory<Barycentric>>();
+  prediction_periapsides_ =
+      make_not_null_unique<DiscreteTrajectory<Barycentric>>();
+}
+
+bool Vessel::PredictionMatches(
+    Instant const& time,
+    DegreesOfFreedom<Barycentric> const& degrees_of_freedom) const {
+  if (time < prediction_->Fork().time() ||
+      time > prediction_->last().time()) {
+    return false;
+  }
+  DegreesOfFreedom<Barycentric> const prediction_degrees_of_freedom =
+      prediction_->EvaluateDegreesOfFreedom(time, /*hint=*/nullptr);
+  // Each step of the prediction may contribute an error up to the integration
+  // tolerances, so these are scaled by the number of steps up to |time|.
+  std::int64_t steps = 0;
+  for (auto it = prediction_->Fork();
+       it != prediction_->End() && it.time() < time;
+       ++it) {
+    ++steps;
+  }
+  auto const& parameters = prediction_adaptive_step_parameters_;
+  return (prediction_degrees_of_freedom.position() -
+          degrees_of_freedom.position()).Norm() <=
+             steps * parameters.length_integration_tolerance() &&
+         (prediction_degrees_of_freedom.velocity() -
+          degrees_of_freedom.velocity()).Norm() <=
+             steps * parameters.speed_integration_tolerance();
+}
+
 Ephemeris<Barycentric>::FixedStepParameters DefaultHistoryParameters() {
   return Ephemeris<Barycentric>::FixedStepParameters(
              McLachlanAtela1992Order5Optimal<Position<Barycentric>>(),
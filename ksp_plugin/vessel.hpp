@@ -14,6 +14,7 @@
 #include "ksp_plugin/vessel_subsets.hpp"
 #include "physics/discrete_trajectory.hpp"
 #include "physics/ephemeris.hpp"
+#include "physics/massive_body.hpp"
 #include "physics/massless_body.hpp"
 #include "quantities/named_quantities.hpp"
 #include "serialization/ksp_plugin.pb.h"
@@ -22,6 +23,7 @@ namespace principia {
 namespace ksp_plugin {
 namespace internal_vessel {
 
+using base::make_not_null_unique;
 using base::not_null;
 using base::IteratorOn;
 using base::Subset;
@@ -30,6 +32,7 @@ using geometry::Vector;
 using physics::DegreesOfFreedom;
 using physics::DiscreteTrajectory;
 using physics::Ephemeris;
+using physics::MassiveBody;
 using physics::MasslessBody;
 using quantities::Force;
 using quantities::GravitationalParameter;
@@ -105,6 +108,13 @@ class Vessel {
   // vessel.
   virtual void AdvanceTimeNotInBubble(Instant const& time);
 
+  // Same as above for all the |vessels|, which must share the same ephemeris.
+  // The prolongations are integrated together by the ephemeris, see
+  // |Ephemeris::FlowAllWithAdaptiveStep|.
+  static void AdvanceTimeNotInBubble(
+      std::vector<not_null<Vessel*>> const& vessels,
+      Instant const& time);
+
   // Advances time for a vessel in the physics bubble.  This dirties the vessel.
   virtual void AdvanceTimeInBubble(
       Instant const& time,
@@ -125,8 +135,26 @@ class Vessel {
   // Deletes the |flight_plan_|.  Performs no action unless |has_flight_plan()|.
   virtual void DeleteFlightPlan();
 
+  // Makes the prediction start at the end of the prolongation and end at
+  // |last_time| (or earlier if the number of steps is exhausted).  If the
+  // vessel has no intrinsic force, and if the end of the prolongation agrees
+  // with the existing prediction within the integration tolerances, the
+  // existing prediction is kept: only its points before the end of the
+  // prolongation are dropped, and only its missing tail is integrated.
+  // Otherwise the prediction is recomputed from scratch.
   virtual void UpdatePrediction(Instant const& last_time);
 
+  // The apsides of the prediction with respect to |body| are detected while
+  // the prediction is integrated.  If |body| is not the current one, the
+  // apsides are cleared and the next |UpdatePrediction| recomputes the
+  // prediction from scratch.
+  virtual void set_prediction_apsides_body(not_null<MassiveBody const*> body);
+  // Null if |set_prediction_apsides_body| was never called.
+  virtual MassiveBody const* prediction_apsides_body() const;
+  virtual DiscreteTrajectory<Barycentric> const& prediction_apoapsides() const;
+  virtual DiscreteTrajectory<Barycentric> const& prediction_periapsides()
+      const;
+
   // Clears, increments or returns the mass.  Event though a vessel is massless
   // in the sense that it doesn't exert gravity, it has a mass used to determine
   // its intrinsic acceleration.
@@ -171,7 +199,18 @@ class Vessel {
   void AdvanceHistoryIfNeeded(Instant const& time);
   void FlowHistory(Instant const& time);
   void FlowProlongation(Instant const& time);
-  void FlowPrediction(Instant const& time);
+  // Integrates the prediction until |time|, taking at most |max_steps| steps.
+  void FlowPrediction(Instant const& time, std::int64_t max_steps);
+  void ClearPredictionApsides();
+
+  // Returns true if the prediction may be reused for a prolongation that ends
+  // at |time| with the given |degrees_of_freedom|, i.e., if the prediction
+  // covers |time| and, interpolated at that time, is within the integration
+  // tolerances of |prediction_adaptive_step_parameters_|, multiplied by the
+  // number of steps of the prediction up to |time|, of |degrees_of_freedom|.
+  bool PredictionMatches(
+      Instant const& time,
+      DegreesOfFreedom<Barycentric> const& degrees_of_freedom) const;
 
   MasslessBody const body_;
   Ephemeris<Barycentric>::FixedStepParameters const
@@ -196,6 +235,20 @@ class Vessel {
 
   // Child trajectory of |*history_|.
   DiscreteTrajectory<Barycentric>* prediction_ = nullptr;
+  // False if the prediction was not computed by |UpdatePrediction| with the
+  // current |prediction_adaptive_step_parameters_|, in which case it must not
+  // be extended incrementally.
+  bool prediction_is_reusable_ = false;
+  // The body with respect to which the apsides of the prediction are detected,
+  // and the apsides detected since the prediction was last computed from
+  // scratch.  Not owning.
+  MassiveBody const* prediction_apsides_body_ = nullptr;
+  not_null<std::unique_ptr<DiscreteTrajectory<Barycentric>>>
+      prediction_apoapsides_ =
+          make_not_null_unique<DiscreteTrajectory<Barycentric>>();
+  not_null<std::unique_ptr<DiscreteTrajectory<Barycentric>>>
+      prediction_periapsides_ =
+          make_not_null_unique<DiscreteTrajectory<Barycentric>>();
 
   std::unique_ptr<FlightPlan> flight_plan_;
   bool is_dirty_ = false;
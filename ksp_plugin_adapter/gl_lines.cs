@@ -126,6 +126,25 @@ public enum Style {
     }
   }
 
+  // Same as above, but for the first |size| elements of |positions|.
+  public static void RenderTrajectory(XYZ[] positions,
+                                      int size,
+                                      UnityEngine.Color colour,
+                                      Style style) {
+    UnityEngine.GL.Color(colour);
+    for (int i = 1; i < size; ++i) {
+      if (style == Style.FADED) {
+        colour.a = (float)(4 * i + size) / (float)(5 * size);
+        UnityEngine.GL.Color(colour);
+      }
+      if (style != Style.DASHED || i % 2 == 1) {
+        AddSegment((Vector3d)positions[i - 1],
+                   (Vector3d)positions[i],
+                   hide_behind_bodies : true);
+      }
+    }
+  }
+
   private static UnityEngine.Vector3 WorldToMapScreen(Vector3d world) {
     return PlanetariumCamera.Camera.WorldToScreenPoint(
                ScaledSpace.LocalToScaledSpace(world));
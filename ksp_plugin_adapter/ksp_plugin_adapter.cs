@@ -22,6 +22,14 @@ public partial class PrincipiaPluginAdapter
   private const String principia_gravity_model_config_name =
       "principia_gravity_model";
   private const double Δt = 10;
+  // How far ahead of the game time the ephemeris is integrated on a background
+  // thread, in seconds.
+  private const double ephemeris_prolongation_horizon = 6 * 3600;
+  // The angle, in radians, under which the rendered trajectories may deviate
+  // from the actual ones, and the maximum number of points that may be used to
+  // achieve that.
+  private const double rendering_angular_tolerance = 1e-3;
+  private const int rendering_max_points = 10000;
 
   private KSP.UI.Screens.ApplicationLauncherButton toolbar_button_;
   private bool hide_all_gui_ = false;
@@ -38,12 +46,19 @@ public partial class PrincipiaPluginAdapter
   internal Controlled<ReferenceFrameSelector> plotting_frame_selector_;
   private Controlled<FlightPlanner> flight_planner_;
   private MapNodePool map_node_pool_;
+  // The buffer in which the plugin renders the trajectories, see
+  // |RenderPositions|.
+  private XYZ[] rendered_positions_ = new XYZ[0];
 
   private IntPtr plugin_ = IntPtr.Zero;
 
   private bool display_patched_conics_ = false;
   [KSPField(isPersistant = true)]
   private bool fix_navball_in_plotting_frame_ = true;
+  // Whether the saves include the integrated state of the ephemeris, so that
+  // they load faster.  They are larger.
+  [KSPField(isPersistant = true)]
+  private bool full_ephemeris_serialization_ = false;
 
   private readonly double[] prediction_length_tolerances_ =
       {1e-3, 1e-2, 1e0, 1e1, 1e2, 1e3, 1e4};
@@ -457,6 +472,9 @@ where is_in_physics_bubble(vessel)
                                     ref plugin_);
       }
       Interface.DeserializePlugin("", 0, ref deserializer, ref plugin_);
+      plugin_.SetEphemerisProlongationHorizon(ephemeris_prolongation_horizon);
+      plugin_.SetFullEphemerisSerialization(full_ephemeris_serialization_);
+      SetEphemerisMassiveBodiesKernel();
 
       plotting_frame_selector_.reset(
           new ReferenceFrameSelector(this, 
@@ -984,18 +1002,37 @@ private System.Collections.IEnumerator
       RemoveStockTrajectoriesIfNeeded(active_vessel);
 
       XYZ sun_world_position = (XYZ)Planetarium.fetch.Sun.position;
+      XYZ camera_world_position = (XYZ)ScaledSpace.ScaledToLocalSpace(
+                                      MapView.MapCamera.transform.position);
 
       GLLines.Draw(() => {
-        GLLines.RenderAndDeleteTrajectory(
-            plugin_.RenderedVesselTrajectory(active_vessel_guid,
-                                             sun_world_position),
-            XKCDColors.AcidGreen,
-            GLLines.Style.FADED);
+        int size = RenderPositions(
+            (positions, count) => plugin_.RenderDecimatedVesselTrajectory(
+                                      active_vessel_guid,
+                                      sun_world_position,
+                                      camera_world_position,
+                                      rendering_angular_tolerance,
+                                      rendering_max_points,
+                                      positions,
+                                      count));
+        GLLines.RenderTrajectory(rendered_positions_,
+                                 size,
+                                 XKCDColors.AcidGreen,
+                                 GLLines.Style.FADED);
         RenderPredictionApsides(active_vessel_guid, sun_world_position);
-        GLLines.RenderAndDeleteTrajectory(
-            plugin_.RenderedPrediction(active_vessel_guid, sun_world_position),
-            XKCDColors.Fuchsia,
-            GLLines.Style.SOLID);
+        size = RenderPositions(
+            (positions, count) => plugin_.RenderDecimatedPrediction(
+                                      active_vessel_guid,
+                                      sun_world_position,
+                                      camera_world_position,
+                                      rendering_angular_tolerance,
+                                      rendering_max_points,
+                                      positions,
+                                      count));
+        GLLines.RenderTrajectory(rendered_positions_,
+                                 size,
+                                 XKCDColors.Fuchsia,
+                                 GLLines.Style.SOLID);
         if (plugin_.FlightPlanExists(active_vessel_guid)) {
           RenderFlightPlanApsides(active_vessel_guid, sun_world_position);
 
@@ -1040,6 +1077,19 @@ private System.Collections.IEnumerator
     }
   }
 
+  // Calls |render| with |rendered_positions_| and its length, and returns the
+  // number of positions that |render| returns.  If |rendered_positions_| is too
+  // small, it is reallocated, with room to spare since the trajectories grow
+  // from frame to frame, and |render| is called again.
+  private int RenderPositions(Func<XYZ[], int, int> render) {
+    int size = render(rendered_positions_, rendered_positions_.Length);
+    if (size > rendered_positions_.Length) {
+      rendered_positions_ = new XYZ[2 * size];
+      size = render(rendered_positions_, rendered_positions_.Length);
+    }
+    return size;
+  }
+
   private void RenderPredictionApsides(String vessel_guid,
                                        XYZ sun_world_position) {
     foreach (CelestialBody celestial in
@@ -1314,6 +1364,14 @@ private System.Collections.IEnumerator
     Sun.Instance.sunFlare.enabled =
         UnityEngine.GUILayout.Toggle(value : Sun.Instance.sunFlare.enabled,
                                      text  : "Enable Sun lens flare");
+    bool was_full_ephemeris_serialization = full_ephemeris_serialization_;
+    full_ephemeris_serialization_ = UnityEngine.GUILayout.Toggle(
+        value : full_ephemeris_serialization_,
+        text  : "Faster loading (larger saves)");
+    if (PluginRunning() &&
+        was_full_ephemeris_serialization != full_ephemeris_serialization_) {
+      plugin_.SetFullEphemerisSerialization(full_ephemeris_serialization_);
+    }
   }
 
   private void LoggingSettings() {
@@ -1438,6 +1496,35 @@ private System.Collections.IEnumerator
     }
   }
 
+  // The gravity model may select the computation of the mutual accelerations
+  // of the massive bodies, e.g., the Barnes-Hut approximation for systems with
+  // thousands of minor bodies.  This is not serialized by the plugin.
+  private void SetEphemerisMassiveBodiesKernel() {
+    var gravity_model_configs =
+        GameDatabase.Instance.GetConfigs(principia_gravity_model_config_name);
+    if (gravity_model_configs.Length != 1) {
+      return;
+    }
+    ConfigNode gravity_model = gravity_model_configs[0].config;
+    if (!gravity_model.HasValue("massive_bodies_kernel")) {
+      return;
+    }
+    double barnes_hut_opening_angle = 0.5;
+    double barnes_hut_dominant_fraction = 1e-9;
+    if (gravity_model.HasValue("barnes_hut_opening_angle")) {
+      barnes_hut_opening_angle =
+          double.Parse(gravity_model.GetValue("barnes_hut_opening_angle"));
+    }
+    if (gravity_model.HasValue("barnes_hut_dominant_fraction")) {
+      barnes_hut_dominant_fraction =
+          double.Parse(gravity_model.GetValue("barnes_hut_dominant_fraction"));
+    }
+    plugin_.SetEphemerisMassiveBodiesKernel(
+        gravity_model.GetValue("massive_bodies_kernel"),
+        barnes_hut_opening_angle,
+        barnes_hut_dominant_fraction);
+  }
+
   private void ResetPlugin() {
     Cleanup();
     SetRotatingFrameThresholds();
@@ -1591,6 +1678,9 @@ private System.Collections.IEnumerator
         }
       }
     }
+    plugin_.SetEphemerisProlongationHorizon(ephemeris_prolongation_horizon);
+    plugin_.SetFullEphemerisSerialization(full_ephemeris_serialization_);
+    SetEphemerisMassiveBodiesKernel();
     plotting_frame_selector_.reset(
         new ReferenceFrameSelector(this,
                                    plugin_,
@@ -2,6 +2,7 @@
 #include "ksp_plugin/flight_plan.hpp"
 
 #include <limits>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -344,6 +345,120 @@ TEST_F(FlightPlanTest, ReplaceLast) {
   EXPECT_EQ(1, flight_plan_->number_of_manœuvres());
 }
 
+// The edits reuse the points of the coasts that precede them.
+TEST_F(FlightPlanTest, IncrementalRecomputation) {
+  DiscreteTrajectory<Barycentric>::Iterator begin;
+  DiscreteTrajectory<Barycentric>::Iterator end;
+  std::vector<std::pair<Instant, DegreesOfFreedom<Barycentric>>> first_coast;
+  flight_plan_->GetSegment(0, begin, end);
+  for (auto it = begin; it != end; ++it) {
+    first_coast.emplace_back(it.time(), it.degrees_of_freedom());
+  }
+
+  // Extending the flight plan keeps the existing points, including the one at
+  // the former final time.
+  flight_plan_->SetDesiredFinalTime(t0_ + 42 * Second);
+  flight_plan_->GetSegment(0, begin, end);
+  auto it = begin;
+  for (auto const& point : first_coast) {
+    ASSERT_TRUE(it != end);
+    EXPECT_EQ(point.first, it.time());
+    EXPECT_EQ(point.second, it.degrees_of_freedom());
+    ++it;
+  }
+  --end;
+  EXPECT_EQ(t0_ + 42 * Second, end.time());
+
+  // Appending a burn keeps the points of the coast before it.
+  first_coast.clear();
+  for (it = begin; it.time() < MakeFirstBurn().initial_time; ++it) {
+    first_coast.emplace_back(it.time(), it.degrees_of_freedom());
+  }
+  EXPECT_TRUE(flight_plan_->Append(MakeFirstBurn()));
+  flight_plan_->GetSegment(0, begin, end);
+  it = begin;
+  for (auto const& point : first_coast) {
+    ASSERT_TRUE(it != end);
+    EXPECT_EQ(point.first, it.time());
+    EXPECT_EQ(point.second, it.degrees_of_freedom());
+    ++it;
+  }
+  --end;
+  EXPECT_EQ(MakeFirstBurn().initial_time, end.time());
+
+  // Shortening the flight plan ends it exactly at the desired final time.
+  flight_plan_->SetDesiredFinalTime(t0_ + 30 * Second);
+  flight_plan_->GetSegment(2, begin, end);
+  --end;
+  EXPECT_EQ(t0_ + 30 * Second, end.time());
+
+  // Removing the burn extends the first coast to the final time.
+  flight_plan_->RemoveLast();
+  EXPECT_EQ(1, flight_plan_->number_of_segments());
+  flight_plan_->GetSegment(0, begin, end);
+  --end;
+  EXPECT_EQ(t0_ + 30 * Second, end.time());
+}
+
+TEST_F(FlightPlanTest, ReplaceLastCandidates) {
+  flight_plan_->SetDesiredFinalTime(t0_ + 42 * Second);
+  EXPECT_TRUE(flight_plan_->Append(MakeFirstBurn()));
+  DiscreteTrajectory<Barycentric>::Iterator begin;
+  DiscreteTrajectory<Barycentric>::Iterator end;
+  flight_plan_->GetAllSegments(begin, end);
+  --end;
+  DegreesOfFreedom<Barycentric> const original_final_degrees_of_freedom =
+      end.degrees_of_freedom();
+
+  std::vector<Burn> burns;
+  burns.push_back(MakeFirstBurn());
+  burns.push_back(MakeThirdBurn());
+  burns.push_back(MakeFirstBurn());
+  // Ends after the desired final time.
+  burns.back().initial_time = t0_ + 41.9 * Second;
+  flight_plan_->EvaluateReplaceLastCandidates(std::move(burns));
+  ASSERT_EQ(3, flight_plan_->number_of_candidates());
+  EXPECT_TRUE(flight_plan_->IsValidCandidate(0));
+  EXPECT_TRUE(flight_plan_->IsValidCandidate(1));
+  EXPECT_FALSE(flight_plan_->IsValidCandidate(2));
+
+  // The flight plan is unchanged.
+  EXPECT_EQ(3, flight_plan_->number_of_segments());
+  flight_plan_->GetAllSegments(begin, end);
+  --end;
+  EXPECT_EQ(t0_ + 42 * Second, end.time());
+  EXPECT_EQ(original_final_degrees_of_freedom, end.degrees_of_freedom());
+
+  // The first candidate has the same burn as the flight plan.
+  flight_plan_->GetCandidateSegments(0, begin, end);
+  --end;
+  EXPECT_EQ(t0_ + 42 * Second, end.time());
+  EXPECT_EQ(original_final_degrees_of_freedom, end.degrees_of_freedom());
+
+  flight_plan_->GetCandidateSegments(1, begin, end);
+  --end;
+  EXPECT_EQ(t0_ + 42 * Second, end.time());
+  DegreesOfFreedom<Barycentric> const candidate_final_degrees_of_freedom =
+      end.degrees_of_freedom();
+  EXPECT_NE(original_final_degrees_of_freedom,
+            candidate_final_degrees_of_freedom);
+
+  EXPECT_FALSE(flight_plan_->ReplaceLastWithCandidate(2));
+  EXPECT_TRUE(flight_plan_->ReplaceLastWithCandidate(1));
+  EXPECT_EQ(0, flight_plan_->number_of_candidates());
+  EXPECT_EQ(1, flight_plan_->number_of_manœuvres());
+  EXPECT_EQ(3, flight_plan_->number_of_segments());
+  flight_plan_->GetAllSegments(begin, end);
+  --end;
+  EXPECT_EQ(candidate_final_degrees_of_freedom, end.degrees_of_freedom());
+
+  // The candidate is the same as the result of |ReplaceLast|.
+  EXPECT_TRUE(flight_plan_->ReplaceLast(MakeThirdBurn()));
+  flight_plan_->GetAllSegments(begin, end);
+  --end;
+  EXPECT_EQ(candidate_final_degrees_of_freedom, end.degrees_of_freedom());
+}
+
 TEST_F(FlightPlanTest, Segments) {
   flight_plan_->SetDesiredFinalTime(t0_ + 42 * Second);
   EXPECT_TRUE(flight_plan_->Append(MakeFirstBurn()));
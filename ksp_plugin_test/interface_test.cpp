@@ -54,6 +54,7 @@ using ksp_plugin::WorldSun;
 using physics::CoordinateFrameField;
 using physics::DegreesOfFreedom;
 using physics::DynamicFrame;
+using physics::Ephemeris;
 using physics::Frenet;
 using physics::MassiveBody;
 using physics::MockDynamicFrame;
@@ -73,6 +74,7 @@ using quantities::si::Degree;
 using quantities::si::Kilo;
 using quantities::si::Metre;
 using quantities::si::Newton;
+using quantities::si::Radian;
 using quantities::si::Second;
 using quantities::si::Tonne;
 using testing_utilities::AlmostEquals;
@@ -91,6 +93,7 @@ using ::testing::Ref;
 using ::testing::Return;
 using ::testing::ReturnRef;
 using ::testing::SetArgPointee;
+using ::testing::SetArgReferee;
 using ::testing::StrictMock;
 using ::testing::_;
 
@@ -548,6 +551,88 @@ TEST_F(InterfaceTest, RenderedPrediction) {
   EXPECT_THAT(iterator, IsNull());
 }
 
+TEST_F(InterfaceTest, RenderPrediction) {
+  std::vector<Position<World>> const rendered_positions = {
+      World::origin + Displacement<World>({1 * SIUnit<Length>(),
+                                           2 * SIUnit<Length>(),
+                                           3 * SIUnit<Length>()}),
+      World::origin + Displacement<World>({11 * SIUnit<Length>(),
+                                           22 * SIUnit<Length>(),
+                                           33 * SIUnit<Length>()})};
+  EXPECT_CALL(*plugin_,
+              RenderPrediction(
+                  vessel_guid,
+                  World::origin + Displacement<World>(
+                                      {parent_position.x * SIUnit<Length>(),
+                                       parent_position.y * SIUnit<Length>(),
+                                       parent_position.z * SIUnit<Length>()}),
+                  _))
+      .Times(2)
+      .WillRepeatedly(SetArgReferee<2>(rendered_positions));
+
+  // A buffer that is too small only gets the first positions.
+  XYZ small_buffer[1];
+  EXPECT_EQ(2,
+            principia__RenderPrediction(plugin_.get(),
+                                        vessel_guid,
+                                        parent_position,
+                                        small_buffer,
+                                        1));
+  EXPECT_EQ(1, small_buffer[0].x);
+  EXPECT_EQ(2, small_buffer[0].y);
+  EXPECT_EQ(3, small_buffer[0].z);
+
+  XYZ large_buffer[3];
+  EXPECT_EQ(2,
+            principia__RenderPrediction(plugin_.get(),
+                                        vessel_guid,
+                                        parent_position,
+                                        large_buffer,
+                                        3));
+  EXPECT_EQ(1, large_buffer[0].x);
+  EXPECT_EQ(2, large_buffer[0].y);
+  EXPECT_EQ(3, large_buffer[0].z);
+  EXPECT_EQ(11, large_buffer[1].x);
+  EXPECT_EQ(22, large_buffer[1].y);
+  EXPECT_EQ(33, large_buffer[1].z);
+}
+
+TEST_F(InterfaceTest, RenderDecimatedVesselTrajectory) {
+  std::vector<Position<World>> const rendered_positions = {
+      World::origin + Displacement<World>({1 * SIUnit<Length>(),
+                                           2 * SIUnit<Length>(),
+                                           3 * SIUnit<Length>()})};
+  XYZ const camera_position = {7, 8, 9};
+  EXPECT_CALL(*plugin_,
+              RenderDecimatedVesselTrajectory(
+                  vessel_guid,
+                  World::origin + Displacement<World>(
+                                      {parent_position.x * SIUnit<Length>(),
+                                       parent_position.y * SIUnit<Length>(),
+                                       parent_position.z * SIUnit<Length>()}),
+                  World::origin + Displacement<World>(
+                                      {camera_position.x * SIUnit<Length>(),
+                                       camera_position.y * SIUnit<Length>(),
+                                       camera_position.z * SIUnit<Length>()}),
+                  1e-3 * Radian,
+                  100,
+                  _))
+      .WillOnce(SetArgReferee<5>(rendered_positions));
+  XYZ buffer[2];
+  EXPECT_EQ(1,
+            principia__RenderDecimatedVesselTrajectory(plugin_.get(),
+                                                       vessel_guid,
+                                                       parent_position,
+                                                       camera_position,
+                                                       1e-3,
+                                                       100,
+                                                       buffer,
+                                                       2));
+  EXPECT_EQ(1, buffer[0].x);
+  EXPECT_EQ(2, buffer[0].y);
+  EXPECT_EQ(3, buffer[0].z);
+}
+
 TEST_F(InterfaceTest, Iterator) {
   StrictMock<MockDynamicFrame<Barycentric, Navigation>>* const
      mock_navigation_frame =
@@ -624,6 +709,28 @@ TEST_F(InterfaceTest, PredictionGettersAndSetters) {
   principia__SetPredictionLength(plugin_.get(), 42);
 }
 
+TEST_F(InterfaceTest, SetEphemerisMassiveBodiesKernel) {
+  EXPECT_CALL(*plugin_,
+              SetEphemerisMassiveBodiesKernel(
+                  Ephemeris<Barycentric>::MassiveBodiesKernel::BarnesHut,
+                  0.7,
+                  1e-6));
+  principia__SetEphemerisMassiveBodiesKernel(plugin_.get(),
+                                             "BarnesHut",
+                                             0.7,
+                                             1e-6);
+}
+
+TEST_F(InterfaceTest, SetEphemerisProlongationHorizon) {
+  EXPECT_CALL(*plugin_, SetEphemerisProlongationHorizon(3600 * Second));
+  principia__SetEphemerisProlongationHorizon(plugin_.get(), 3600);
+}
+
+TEST_F(InterfaceTest, SetFullEphemerisSerialization) {
+  EXPECT_CALL(*plugin_, SetFullEphemerisSerialization(true));
+  principia__SetFullEphemerisSerialization(plugin_.get(), true);
+}
+
 TEST_F(InterfaceTest, PhysicsBubble) {
   KSPPart parts[3] = {{{1, 2, 3}, {10, 20, 30}, 300.0, {0, 0, 0}, 1},
                       {{4, 5, 6}, {40, 50, 60}, 600.0, {3, 3, 3}, 4},
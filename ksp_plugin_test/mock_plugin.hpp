@@ -99,8 +99,39 @@ class MockPlugin : public Plugin {
            std::unique_ptr<DiscreteTrajectory<World>>*
                rendered_trajectory_from_iterators));
 
+  MOCK_CONST_METHOD3(RenderVesselTrajectory,
+                     void(GUID const& vessel_guid,
+                          Position<World> const& sun_world_position,
+                          std::vector<Position<World>>& positions));
+  MOCK_CONST_METHOD3(RenderPrediction,
+                     void(GUID const& vessel_guid,
+                          Position<World> const& sun_world_position,
+                          std::vector<Position<World>>& positions));
+
+  MOCK_CONST_METHOD6(RenderDecimatedVesselTrajectory,
+                     void(GUID const& vessel_guid,
+                          Position<World> const& sun_world_position,
+                          Position<World> const& camera_world_position,
+                          Angle const& angular_tolerance,
+                          int max_points,
+                          std::vector<Position<World>>& positions));
+  MOCK_CONST_METHOD6(RenderDecimatedPrediction,
+                     void(GUID const& vessel_guid,
+                          Position<World> const& sun_world_position,
+                          Position<World> const& camera_world_position,
+                          Angle const& angular_tolerance,
+                          int max_points,
+                          std::vector<Position<World>>& positions));
+
   MOCK_METHOD1(SetPredictionLength, void(Time const& t));
 
+  MOCK_METHOD1(SetEphemerisProlongationHorizon, void(Time const& horizon));
+  MOCK_METHOD1(SetFullEphemerisSerialization, void(bool full));
+  MOCK_METHOD3(SetEphemerisMassiveBodiesKernel,
+               void(Ephemeris<Barycentric>::MassiveBodiesKernel kernel,
+                    double barnes_hut_opening_angle,
+                    double barnes_hut_dominant_fraction));
+
   MOCK_METHOD1(SetPredictionAdaptiveStepParameters,
                void(Ephemeris<Barycentric>::AdaptiveStepParameters const&
                         prediction_adaptive_step_parameters));
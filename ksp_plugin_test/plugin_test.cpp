@@ -44,6 +44,7 @@ using geometry::Permutation;
 using geometry::Trivector;
 using integrators::McLachlanAtela1992Order5Optimal;
 using physics::ContinuousTrajectory;
+using physics::DiscreteTrajectory;
 using physics::KeplerianElements;
 using physics::KeplerOrbit;
 using physics::MockDynamicFrame;
@@ -424,17 +425,24 @@ TEST_F(PluginTest, Serialization) {
   EXPECT_EQ(SolarSystemFactory::Earth, message.vessel(0).parent_index());
   EXPECT_TRUE(message.vessel(0).vessel().has_flight_plan());
   EXPECT_TRUE(message.vessel(0).vessel().has_history());
+  // The history is written in packed form.
   auto const& vessel_0_history = message.vessel(0).vessel().history();
+  EXPECT_EQ(0, vessel_0_history.timeline_size());
+  EXPECT_TRUE(vessel_0_history.has_packed_timeline());
+  DiscreteTrajectory<Barycentric>* vessel_0_prolongation = nullptr;
+  auto const vessel_0_deserialized_history =
+      DiscreteTrajectory<Barycentric>::ReadFromMessage(
+          vessel_0_history, {&vessel_0_prolongation});
 #if defined(WE_LOVE_228)
-  EXPECT_EQ(2, vessel_0_history.timeline_size());
-  EXPECT_EQ((HistoryTime(time, 3) - shift - Instant()) / (1 * Second),
-            vessel_0_history.timeline(0).instant().scalar().magnitude());
-  EXPECT_EQ((HistoryTime(time, 6) - shift - Instant()) / (1 * Second),
-            vessel_0_history.timeline(1).instant().scalar().magnitude());
+  EXPECT_EQ(2, vessel_0_deserialized_history->Size());
+  EXPECT_EQ(HistoryTime(time, 3) - shift,
+            vessel_0_deserialized_history->Begin().time());
+  EXPECT_EQ(HistoryTime(time, 6) - shift,
+            vessel_0_deserialized_history->last().time());
 #else
-  EXPECT_EQ(3, vessel_0_history.timeline_size());
-  EXPECT_EQ((HistoryTime(time, 4) - Instant()) / (1 * Second),
-            vessel_0_history.timeline(0).instant().scalar().magnitude());
+  EXPECT_EQ(3, vessel_0_deserialized_history->Size());
+  EXPECT_EQ(HistoryTime(time, 4),
+            vessel_0_deserialized_history->Begin().time());
 #endif
   EXPECT_FALSE(message.bubble().has_current());
   EXPECT_TRUE(message.has_plotting_frame());
@@ -745,6 +753,30 @@ TEST_F(PluginTest, ForgetAllHistoriesBeforeAfterPredictionFork) {
   plugin_->ForgetAllHistoriesBefore(HistoryTime(time, 5));
   auto const rendered_prediction =
       plugin_->RenderedPrediction(guid, World::origin);
+
+  // The bulk rendering gives the same positions.
+  std::vector<Position<World>> positions;
+  plugin_->RenderPrediction(guid, World::origin, positions);
+  ASSERT_EQ(rendered_prediction->Size(), positions.size());
+  int i = 0;
+  for (auto it = rendered_prediction->Begin();
+       it != rendered_prediction->End();
+       ++it, ++i) {
+    EXPECT_EQ(it.degrees_of_freedom().position(), positions[i]);
+  }
+
+  // The decimated rendering keeps the endpoints.
+  std::vector<Position<World>> decimated_positions;
+  plugin_->RenderDecimatedPrediction(guid,
+                                     World::origin,
+                                     /*camera_world_position=*/World::origin,
+                                     /*angular_tolerance=*/1e-3 * Radian,
+                                     /*max_points=*/100,
+                                     decimated_positions);
+  ASSERT_FALSE(decimated_positions.empty());
+  EXPECT_GE(positions.size(), decimated_positions.size());
+  EXPECT_EQ(positions.front(), decimated_positions.front());
+  EXPECT_EQ(positions.back(), decimated_positions.back());
 }
 
 TEST_F(PluginDeathTest, VesselFromParentError) {
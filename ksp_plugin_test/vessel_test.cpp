@@ -14,14 +14,17 @@ namespace internal_vessel {
 
 using geometry::Displacement;
 using geometry::Position;
+using geometry::Vector;
 using geometry::Velocity;
 using integrators::DormandElMikkawyPrince1986RKN434FM;
 using integrators::McLachlanAtela1992Order5Optimal;
 using physics::Ephemeris;
 using physics::SolarSystem;
+using quantities::Force;
 using quantities::si::Kilo;
 using quantities::si::Kilogram;
 using quantities::si::Metre;
+using quantities::si::Newton;
 using quantities::si::Second;
 using ::testing::AllOf;
 using ::testing::Eq;
@@ -153,6 +156,40 @@ TEST_F(VesselTest, AdvanceTimeNotInBubble) {
   EXPECT_FALSE(vessel_->is_dirty());
 }
 
+TEST_F(VesselTest, AdvanceTimeNotInBubbleBatched) {
+  Vessel vessel2(earth_.get(),
+                 ephemeris_.get(),
+                 history_fixed_parameters_,
+                 adaptive_parameters_,
+                 adaptive_parameters_);
+  Vessel vessel3(earth_.get(),
+                 ephemeris_.get(),
+                 history_fixed_parameters_,
+                 adaptive_parameters_,
+                 adaptive_parameters_);
+  vessel_->CreateHistoryAndForkProlongation(t1_, d1_);
+  vessel2.CreateHistoryAndForkProlongation(t1_, d1_);
+  vessel3.CreateHistoryAndForkProlongation(t2_, d2_);
+  Vessel::AdvanceTimeNotInBubble({vessel_.get(), &vessel2, &vessel3}, t2_);
+  EXPECT_EQ(t2_ - 0.2 * Second, vessel_->history().last().time());
+  EXPECT_EQ(t2_, vessel_->prolongation().last().time());
+  EXPECT_EQ(vessel_->prolongation().last().degrees_of_freedom(),
+            vessel2.prolongation().last().degrees_of_freedom());
+  EXPECT_EQ(t2_, vessel3.prolongation().last().time());
+  EXPECT_EQ(d2_, vessel3.prolongation().last().degrees_of_freedom());
+
+  // Same result as the individual integration.
+  Vessel vessel4(earth_.get(),
+                 ephemeris_.get(),
+                 history_fixed_parameters_,
+                 adaptive_parameters_,
+                 adaptive_parameters_);
+  vessel4.CreateHistoryAndForkProlongation(t1_, d1_);
+  vessel4.AdvanceTimeNotInBubble(t2_);
+  EXPECT_EQ(vessel4.prolongation().last().degrees_of_freedom(),
+            vessel_->prolongation().last().degrees_of_freedom());
+}
+
 TEST_F(VesselTest, Prediction) {
   vessel_->CreateHistoryAndForkProlongation(t1_, d1_);
   vessel_->AdvanceTimeNotInBubble(t2_);
@@ -160,6 +197,68 @@ TEST_F(VesselTest, Prediction) {
   EXPECT_LE(t3_, vessel_->prediction().last().time());
 }
 
+TEST_F(VesselTest, IncrementalPrediction) {
+  vessel_->CreateHistoryAndForkProlongation(t1_, d1_);
+  vessel_->AdvanceTimeNotInBubble(t2_);
+  vessel_->UpdatePrediction(t3_);
+  auto middle = vessel_->prediction().last();
+  --middle;
+  Instant const middle_time = middle.time();
+  DegreesOfFreedom<Barycentric> const middle_degrees_of_freedom =
+      middle.degrees_of_freedom();
+  ASSERT_LT(t2_, middle_time);
+
+  // The prolongation agrees with the prediction: the prediction is extended
+  // and its points are kept.
+  vessel_->AdvanceTimeNotInBubble(t2_ + 0.5 * Second);
+  vessel_->UpdatePrediction(t3_ + 0.5 * Second);
+  EXPECT_LE(t3_ + 0.5 * Second, vessel_->prediction().last().time());
+  auto first = vessel_->prediction().Fork();
+  ++first;
+  EXPECT_EQ(t2_ + 0.5 * Second, first.time());
+  auto const kept = vessel_->prediction().Find(middle_time);
+  ASSERT_NE(vessel_->prediction().End(), kept);
+  EXPECT_EQ(middle_degrees_of_freedom, kept.degrees_of_freedom());
+
+  // Nothing changed: the prediction is kept in place.
+  vessel_->UpdatePrediction(t3_ + 0.5 * Second);
+  EXPECT_NE(vessel_->prediction().End(),
+            vessel_->prediction().Find(middle_time));
+
+  // An intrinsic force causes the prediction to be recomputed.
+  vessel_->increment_intrinsic_force(Vector<Force, Barycentric>(
+      {1 * Newton, 0 * Newton, 0 * Newton}));
+  vessel_->UpdatePrediction(t3_ + 0.5 * Second);
+  EXPECT_EQ(vessel_->prediction().End(),
+            vessel_->prediction().Find(middle_time));
+  EXPECT_LE(t3_ + 0.5 * Second, vessel_->prediction().last().time());
+}
+
+TEST_F(VesselTest, PredictionApsides) {
+  vessel_->CreateHistoryAndForkProlongation(t1_, d1_);
+  vessel_->AdvanceTimeNotInBubble(t2_);
+  EXPECT_EQ(nullptr, vessel_->prediction_apsides_body());
+  vessel_->set_prediction_apsides_body(earth_->body());
+  EXPECT_EQ(earth_->body(), vessel_->prediction_apsides_body());
+  vessel_->UpdatePrediction(t3_);
+  for (auto const* const apsides : {&vessel_->prediction_apoapsides(),
+                                    &vessel_->prediction_periapsides()}) {
+    for (auto it = apsides->Begin(); it != apsides->End(); ++it) {
+      EXPECT_LE(vessel_->prediction().Fork().time(), it.time());
+      EXPECT_GE(vessel_->prediction().last().time(), it.time());
+    }
+  }
+  auto middle = vessel_->prediction().last();
+  --middle;
+  Instant const middle_time = middle.time();
+
+  // Setting the same body again keeps the prediction.
+  vessel_->set_prediction_apsides_body(earth_->body());
+  vessel_->UpdatePrediction(t3_);
+  EXPECT_NE(vessel_->prediction().End(),
+            vessel_->prediction().Find(middle_time));
+}
+
 TEST_F(VesselTest, FlightPlan) {
   vessel_->CreateHistoryAndForkProlongation(t1_, d1_);
   vessel_->AdvanceTimeNotInBubble(t2_);
@@ -55,6 +55,9 @@ class FixedMatrix final {
   bool operator==(FixedMatrix const& right) const;
   FixedMatrix& operator=(std::initializer_list<Scalar> const& right);
 
+  // The entry a_ij is accessed as |a[i][j]|.
+  constexpr Scalar const* operator[](int index) const;
+
  private:
   std::array<Scalar, rows * columns> data_;
 
@@ -0,0 +1,72 @@
+﻿
+#pragma once
+
+#include "numerics/hermite5.hpp"
+
+#include <utility>
+
+namespace principia {
+namespace numerics {
+namespace internal_hermite5 {
+
+using quantities::Difference;
+
+template<typename Argument, typename Value>
+Hermite5<Argument, Value>::Hermite5(
+    std::pair<Argument, Argument> const& arguments,
+    std::pair<Value, Value> const& values,
+    std::pair<Derivative1, Derivative1> const& derivatives,
+    std::pair<Derivative2, Derivative2> const& second_derivatives)
+    : arguments_(arguments) {
+  a0_ = values.first;
+  a1_ = derivatives.first;
+  a2_ = 0.5 * second_derivatives.first;
+  Difference<Argument> const Δargument = arguments_.second - arguments_.first;
+  auto const one_over_Δargument = 1.0 / Δargument;
+  auto const one_over_Δargument_squared =
+      one_over_Δargument * one_over_Δargument;
+  auto const one_over_Δargument_cubed =
+      one_over_Δargument * one_over_Δargument_squared;
+  // The parts of the value, derivative and second derivative at the upper
+  // bound that are not accounted for by the terms of degree at most 2, scaled
+  // so that they have the dimension of |Value|.
+  Difference<Value> const d =
+      values.second - values.first -
+      (derivatives.first + a2_ * Δargument) * Δargument;
+  Difference<Value> const e =
+      (derivatives.second - derivatives.first -
+       second_derivatives.first * Δargument) * Δargument;
+  Difference<Value> const f =
+      (second_derivatives.second - second_derivatives.first) *
+      Δargument * Δargument;
+  a3_ = (10.0 * d - 4.0 * e + 0.5 * f) * one_over_Δargument_cubed;
+  a4_ = (-15.0 * d + 7.0 * e - f) * one_over_Δargument_cubed *
+        one_over_Δargument;
+  a5_ = (6.0 * d - 3.0 * e + 0.5 * f) * one_over_Δargument_cubed *
+        one_over_Δargument_squared;
+}
+
+template<typename Argument, typename Value>
+Value Hermite5<Argument, Value>::Evaluate(Argument const& argument) const {
+  Difference<Argument> const Δargument = argument - arguments_.first;
+  return (((((a5_ * Δargument + a4_) * Δargument + a3_) * Δargument + a2_) *
+               Δargument + a1_) * Δargument) + a0_;
+}
+
+template<typename Argument, typename Value>
+typename Hermite5<Argument, Value>::Derivative1
+Hermite5<Argument, Value>::EvaluateDerivative(Argument const& argument) const {
+  Difference<Argument> const Δargument = argument - arguments_.first;
+  return ((((5.0 * a5_ * Δargument + 4.0 * a4_) * Δargument + 3.0 * a3_) *
+               Δargument + 2.0 * a2_) * Δargument) + a1_;
+}
+
+template<typename Argument, typename Value>
+std::pair<Argument, Argument> const&
+Hermite5<Argument, Value>::arguments() const {
+  return arguments_;
+}
+
+}  // namespace internal_hermite5
+}  // namespace numerics
+}  // namespace principia
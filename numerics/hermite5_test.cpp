@@ -0,0 +1,73 @@
+﻿
+#include "numerics/hermite5.hpp"
+
+#include "geometry/frame.hpp"
+#include "geometry/named_quantities.hpp"
+#include "gtest/gtest.h"
+#include "quantities/si.hpp"
+#include "serialization/geometry.pb.h"
+
+namespace principia {
+
+using geometry::Frame;
+using geometry::Instant;
+using geometry::Position;
+using geometry::Vector;
+using geometry::Velocity;
+using quantities::Acceleration;
+using quantities::Length;
+using quantities::si::Metre;
+using quantities::si::Second;
+
+namespace numerics {
+
+class Hermite5Test : public ::testing::Test {
+ protected:
+  using World = Frame<serialization::Frame::TestTag,
+                      serialization::Frame::TEST1, true>;
+
+  Instant const t0_;
+};
+
+TEST_F(Hermite5Test, Precomputed) {
+  // Interpolates 1 + 2 s - s² + 3 s³ - s⁴ / 2 + s⁵ / 4, where s is the time
+  // since |t0_ + 1 * Second|, which it reproduces exactly.
+  Hermite5<Instant, Length> h(
+      {t0_ + 1 * Second, t0_ + 2 * Second},
+      {1 * Metre, 4.75 * Metre},
+      {2 * Metre / Second, 8.25 * Metre / Second},
+      {-2 * Metre / Second / Second, 15 * Metre / Second / Second});
+
+  EXPECT_EQ(1 * Metre, h.Evaluate(t0_ + 1 * Second));
+  EXPECT_EQ(1.482666015625 * Metre, h.Evaluate(t0_ + 1.25 * Second));
+  EXPECT_EQ(2.1015625 * Metre, h.Evaluate(t0_ + 1.5 * Second));
+  EXPECT_EQ(3.104248046875 * Metre, h.Evaluate(t0_ + 1.75 * Second));
+  EXPECT_EQ(4.75 * Metre, h.Evaluate(t0_ + 2 * Second));
+
+  EXPECT_EQ(2 * Metre / Second, h.EvaluateDerivative(t0_ + 1 * Second));
+  EXPECT_EQ(2.0361328125 * Metre / Second,
+            h.EvaluateDerivative(t0_ + 1.25 * Second));
+  EXPECT_EQ(3.078125 * Metre / Second,
+            h.EvaluateDerivative(t0_ + 1.5 * Second));
+  EXPECT_EQ(5.1142578125 * Metre / Second,
+            h.EvaluateDerivative(t0_ + 1.75 * Second));
+  EXPECT_EQ(8.25 * Metre / Second, h.EvaluateDerivative(t0_ + 2 * Second));
+
+  EXPECT_EQ(t0_ + 1 * Second, h.arguments().first);
+  EXPECT_EQ(t0_ + 2 * Second, h.arguments().second);
+}
+
+TEST_F(Hermite5Test, Typed) {
+  // Just here to check that the types work in the presence of affine spaces.
+  Hermite5<Instant, Position<World>> h(
+      {t0_ + 1 * Second, t0_ + 2 * Second},
+      {World::origin, World::origin},
+      {Velocity<World>(), Velocity<World>()},
+      {Vector<Acceleration, World>(), Vector<Acceleration, World>()});
+
+  EXPECT_EQ(World::origin, h.Evaluate(t0_ + 1.3 * Second));
+  EXPECT_EQ(Velocity<World>(), h.EvaluateDerivative(t0_ + 1.7 * Second));
+}
+
+}  // namespace numerics
+}  // namespace principia
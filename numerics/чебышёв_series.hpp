@@ -22,15 +22,60 @@ using geometry::Instant;
 using quantities::Time;
 using quantities::Variation;
 
+// The Newhall approximations use a division of [t_min, t_max] in
+// |newhall_divisions| intervals.  Each function is therefore represented by
+// |newhall_samples| samples: its values and derivatives at the bounds of the
+// intervals.
+int constexpr newhall_divisions = 8;
+int constexpr newhall_samples = 2 * newhall_divisions + 2;
+
+// Computes the Newhall approximations of several scalar functions at once, for
+// each of the |degrees|, which must be in [3, 17].  |qv| is a row-major matrix
+// with |newhall_samples| rows and |columns| columns.  Its column f holds the
+// samples of the function f in the order of Newhall's matrices: the largest
+// time first, each value being followed by the derivative multiplied by
+// (t_max - t_min) / 2.  On return, |coefficients[d]| is a row-major matrix with
+// |degrees[d] + 1| rows and |columns| columns, whose column f holds the
+// Чебышёв coefficients of the approximation of degree |degrees[d]| of the
+// function f.  The functions are processed several at a time with the SIMD
+// instructions selected at run time, and their samples are loaded once for all
+// the |degrees|.
+void NewhallApproximationsInBatch(
+    std::vector<int> const& degrees,
+    int columns,
+    std::vector<double> const& qv,
+    std::vector<std::vector<double>>& coefficients);
+
+// A helper class for converting the values of a series to and from their
+// coordinates in SI units, on which |NewhallApproximationsInBatch| operates.
+// The |dimension| coordinates of a value are at |coordinates[0]|,
+// |coordinates[stride]|, etc.
+template<typename Vector>
+class CoordinatesHelper final {
+ public:
+  static int constexpr dimension = 1;
+
+  static void ToCoordinates(Vector const& value,
+                            int stride,
+                            double* coordinates);
+  static Vector FromCoordinates(double const* coordinates, int stride);
+};
+
 // A helper class for implementing |Evaluate| that can be specialized for speed.
 template<typename Vector>
 class EvaluationHelper final {
  public:
   EvaluationHelper(std::vector<Vector> const& coefficients, int degree);
+  EvaluationHelper(EvaluationHelper const& other) = default;
   EvaluationHelper(EvaluationHelper&& other) = default;
   EvaluationHelper& operator=(EvaluationHelper&& other) = default;
 
   Vector EvaluateImplementation(double scaled_t) const;
+  // The derivative with respect to |scaled_t|.
+  Vector EvaluateDerivativeImplementation(double scaled_t) const;
+  void EvaluateWithDerivativeImplementation(double scaled_t,
+                                            Vector& value,
+                                            Vector& derivative) const;
 
   Vector coefficients(int index) const;
   int degree() const;
@@ -51,6 +96,7 @@ class ЧебышёвSeries final {
   ЧебышёвSeries(std::vector<Vector> const& coefficients,
                 Instant const& t_min,
                 Instant const& t_max);
+  ЧебышёвSeries(ЧебышёвSeries const& other) = default;
   ЧебышёвSeries(ЧебышёвSeries&& other) = default;
   ЧебышёвSeries& operator=(ЧебышёвSeries&& other) = default;
 
@@ -68,10 +114,19 @@ class ЧебышёвSeries final {
   // a better approximation.
   Vector last_coefficient() const;
 
+  // The coefficient of Tᵢ, for i in [0, degree()].
+  Vector coefficient(int i) const;
+
   // Uses the Clenshaw algorithm.  |t| must be in the range [t_min, t_max].
   Vector Evaluate(Instant const& t) const;
   Variation<Vector> EvaluateDerivative(Instant const& t) const;
 
+  // Same as |Evaluate| and |EvaluateDerivative|, but computes both in a single
+  // pass over the coefficients.  The results are identical.
+  void EvaluateWithDerivative(Instant const& t,
+                              Vector& value,
+                              Variation<Vector>& derivative) const;
+
   void WriteToMessage(not_null<serialization::ЧебышёвSeries*> message) const;
   static ЧебышёвSeries ReadFromMessage(
       serialization::ЧебышёвSeries const& message);
@@ -85,7 +140,41 @@ class ЧебышёвSeries final {
       Instant const& t_min,
       Instant const& t_max);
 
+  // Computes in one pass the Newhall approximations of several functions over
+  // the same interval, for each of the |degrees|.  |q[f]| and |v[f]| are the
+  // values and derivatives of the function f, as for |NewhallApproximation|.
+  // The element [d][f] of the result is the approximation of degree
+  // |degrees[d]| of the function f.  The results are identical to those of
+  // |NewhallApproximation|.
+  static std::vector<std::vector<ЧебышёвSeries>> NewhallApproximations(
+      std::vector<int> const& degrees,
+      std::vector<std::vector<Vector>> const& q,
+      std::vector<std::vector<Variation<Vector>>> const& v,
+      Instant const& t_min,
+      Instant const& t_max);
+
  private:
+  // Stores the samples of the function with values |q| and derivatives |v| in
+  // the column(s) starting at |column| of |qv|, which has |columns| columns.
+  static void WriteNewhallSamples(std::vector<Vector> const& q,
+                                  std::vector<Variation<Vector>> const& v,
+                                  Time const& duration_over_two,
+                                  int column,
+                                  int columns,
+                                  std::vector<double>& qv);
+
+  // Constructs the series whose coefficients are in the column(s) starting at
+  // |column| of |coefficients|, which has |columns| columns.
+  static ЧебышёвSeries ReadNewhallCoefficients(
+      std::vector<double> const& coefficients,
+      int column,
+      int columns,
+      Instant const& t_min,
+      Instant const& t_max);
+
+  // Returns the argument of the Чебышёв polynomials for |t|.
+  double ScaledArgument(Instant const& t) const;
+
   Instant t_min_;
   Instant t_max_;
   Time::Inverse one_over_duration_;
@@ -1,8 +1,11 @@
 ﻿
 #include "numerics/чебышёв_series.hpp"
 
+#include <algorithm>
 #include <vector>
 
+#include "base/macros.hpp"
+#include "base/simd.hpp"
 #include "geometry/grassmann.hpp"
 #include "geometry/r3_element.hpp"
 #include "geometry/serialization.hpp"
@@ -14,11 +17,519 @@ namespace principia {
 namespace numerics {
 namespace internal_чебышёв_series {
 
+using base::CoordinatesPack;
+using base::InstructionSet;
+using base::Pack;
+using base::SupportedInstructionSet;
 using geometry::DoubleOrQuantityOrMultivectorSerializer;
 using geometry::Multivector;
 using geometry::R3Element;
 using quantities::SIUnit;
 
+// The largest degree for which there is a Newhall matrix.
+int constexpr newhall_max_degree = 17;
+
+// The computations below are templated on the |Pack| or |CoordinatesPack| for
+// an instruction set, and force-inlined in the kernels of
+// |InstructionSetKernels|, so that they are compiled for the instruction set of
+// each kernel.
+
+// Sets |products| to the product of |matrix| by the |samples| of |Pack::width|
+// functions.  The terms are summed in the same order as in the product of a
+// |FixedMatrix| by a |FixedVector|.
+template<typename Pack, int rows>
+FORCE_INLINE void MultiplyByNewhallMatrix(
+    FixedMatrix<double, rows, newhall_samples> const& matrix,
+    typename Pack::Register const* const samples,
+    typename Pack::Register* const products) {
+  for (int i = 0; i < rows; ++i) {
+    double const* const row = matrix[i];
+    typename Pack::Register product = Pack::Broadcast(0.0);
+    for (int j = 0; j < newhall_samples; ++j) {
+      product = Pack::Add(
+          product, Pack::Multiply(Pack::Broadcast(row[j]), samples[j]));
+    }
+    products[i] = product;
+  }
+}
+
+// Same as above, with the matrix for the given |degree|.
+template<typename Pack>
+FORCE_INLINE void MultiplyByNewhallMatrix(
+    int const degree,
+    typename Pack::Register const* const samples,
+    typename Pack::Register* const products) {
+  switch (degree) {
+    case 3:
+      MultiplyByNewhallMatrix<Pack>(
+          newhall_c_matrix_degree_3_divisions_8_w04, samples, products);
+      break;
+    case 4:
+      MultiplyByNewhallMatrix<Pack>(
+          newhall_c_matrix_degree_4_divisions_8_w04, samples, products);
+      break;
+    case 5:
+      MultiplyByNewhallMatrix<Pack>(
+          newhall_c_matrix_degree_5_divisions_8_w04, samples, products);
+      break;
+    case 6:
+      MultiplyByNewhallMatrix<Pack>(
+          newhall_c_matrix_degree_6_divisions_8_w04, samples, products);
+      break;
+    case 7:
+      MultiplyByNewhallMatrix<Pack>(
+          newhall_c_matrix_degree_7_divisions_8_w04, samples, products);
+      break;
+    case 8:
+      MultiplyByNewhallMatrix<Pack>(
+          newhall_c_matrix_degree_8_divisions_8_w04, samples, products);
+      break;
+    case 9:
+      MultiplyByNewhallMatrix<Pack>(
+          newhall_c_matrix_degree_9_divisions_8_w04, samples, products);
+      break;
+    case 10:
+      MultiplyByNewhallMatrix<Pack>(
+          newhall_c_matrix_degree_10_divisions_8_w04, samples, products);
+      break;
+    case 11:
+      MultiplyByNewhallMatrix<Pack>(
+          newhall_c_matrix_degree_11_divisions_8_w04, samples, products);
+      break;
+    case 12:
+      MultiplyByNewhallMatrix<Pack>(
+          newhall_c_matrix_degree_12_divisions_8_w04, samples, products);
+      break;
+    case 13:
+      MultiplyByNewhallMatrix<Pack>(
+          newhall_c_matrix_degree_13_divisions_8_w04, samples, products);
+      break;
+    case 14:
+      MultiplyByNewhallMatrix<Pack>(
+          newhall_c_matrix_degree_14_divisions_8_w04, samples, products);
+      break;
+    case 15:
+      MultiplyByNewhallMatrix<Pack>(
+          newhall_c_matrix_degree_15_divisions_8_w04, samples, products);
+      break;
+    case 16:
+      MultiplyByNewhallMatrix<Pack>(
+          newhall_c_matrix_degree_16_divisions_8_w04, samples, products);
+      break;
+    case 17:
+      MultiplyByNewhallMatrix<Pack>(
+          newhall_c_matrix_degree_17_divisions_8_w04, samples, products);
+      break;
+    default:
+      LOG(FATAL) << "Unexpected degree " << degree;
+      break;
+  }
+}
+
+// The loop of |NewhallApproximationsInBatch|, once the |coefficients| have
+// been resized.
+template<typename Pack>
+FORCE_INLINE void ComputeNewhallApproximationsInBatch(
+    std::vector<int> const& degrees,
+    int const columns,
+    std::vector<double> const& qv,
+    std::vector<std::vector<double>>& coefficients) {
+  using Register = typename Pack::Register;
+  Register samples[newhall_samples];
+  Register products[newhall_max_degree + 1];
+  for (int f = 0; f < columns; f += Pack::width) {
+    // The last block is padded with zeros if |columns| is not a multiple of
+    // the width of the registers.
+    bool const is_full_block = f + Pack::width <= columns;
+    for (int j = 0; j < newhall_samples; ++j) {
+      double const* const qv_j = &qv[j * columns + f];
+      if (is_full_block) {
+        samples[j] = Pack::Load(qv_j);
+      } else {
+        double padded[Pack::width] = {};
+        std::copy(qv_j, qv_j + (columns - f), padded);
+        samples[j] = Pack::Load(padded);
+      }
+    }
+    for (int d = 0; d < degrees.size(); ++d) {
+      MultiplyByNewhallMatrix<Pack>(degrees[d], samples, products);
+      for (int i = 0; i <= degrees[d]; ++i) {
+        double* const coefficients_i = &coefficients[d][i * columns + f];
+        if (is_full_block) {
+          Pack::Store(coefficients_i, products[i]);
+        } else {
+          double padded[Pack::width];
+          Pack::Store(padded, products[i]);
+          std::copy(padded, padded + (columns - f), coefficients_i);
+        }
+      }
+    }
+  }
+}
+
+// In the following functions the coordinates of the coefficient of Tₖ are at
+// |coefficients + 4 * k|, followed by a zero, see |EvaluationHelper|.  The
+// results are stored as x, y, z.
+
+template<typename CoordinatesPack>
+FORCE_INLINE void EvaluateCoordinates(double const* const coefficients,
+                                      int const degree,
+                                      double const scaled_t,
+                                      double* const value) {
+  using Register = typename CoordinatesPack::Register;
+  Register const t = CoordinatesPack::Broadcast(scaled_t);
+  Register const two_t = CoordinatesPack::Broadcast(scaled_t + scaled_t);
+  Register const c_0 = CoordinatesPack::Load(coefficients);
+  switch (degree) {
+    case 0:
+      CoordinatesPack::Store(value, c_0);
+      break;
+    case 1:
+      CoordinatesPack::Store(
+          value,
+          CoordinatesPack::Add(
+              c_0,
+              CoordinatesPack::Multiply(
+                  t, CoordinatesPack::Load(coefficients + 4))));
+      break;
+    default: {
+      // b_degree   = c_degree.
+      Register b_kplus2 = CoordinatesPack::Load(coefficients + 4 * degree);
+      // b_degree-1 = c_degree-1 + 2 t b_degree.
+      Register b_kplus1 = CoordinatesPack::Add(
+          CoordinatesPack::Load(coefficients + 4 * (degree - 1)),
+          CoordinatesPack::Multiply(two_t, b_kplus2));
+      for (int k = degree - 2; k >= 1; --k) {
+        // b_k = c_k + 2 t b_k+1 - b_k+2.
+        Register const b_k = CoordinatesPack::Subtract(
+            CoordinatesPack::Add(CoordinatesPack::Load(coefficients + 4 * k),
+                                 CoordinatesPack::Multiply(two_t, b_kplus1)),
+            b_kplus2);
+        b_kplus2 = b_kplus1;
+        b_kplus1 = b_k;
+      }
+      // c_0 + t b_1 - b_2.
+      CoordinatesPack::Store(
+          value,
+          CoordinatesPack::Subtract(
+              CoordinatesPack::Add(c_0, CoordinatesPack::Multiply(t, b_kplus1)),
+              b_kplus2));
+    }
+  }
+}
+
+// |degree| must be at least 1.
+template<typename CoordinatesPack>
+FORCE_INLINE void EvaluateDerivativeCoordinates(
+    double const* const coefficients,
+    int const degree,
+    double const scaled_t,
+    double* const derivative) {
+  using Register = typename CoordinatesPack::Register;
+  Register const zero = CoordinatesPack::Broadcast(0.0);
+  Register const two_t = CoordinatesPack::Broadcast(scaled_t + scaled_t);
+  Register d_kplus2 = zero;
+  Register d_kplus1 = zero;
+  for (int k = degree - 1; k >= 1; --k) {
+    // d_k = (k + 1) c_k+1 + 2 t d_k+1 - d_k+2.
+    Register const d_k = CoordinatesPack::Subtract(
+        CoordinatesPack::Add(
+            CoordinatesPack::Multiply(
+                CoordinatesPack::Load(coefficients + 4 * (k + 1)),
+                CoordinatesPack::Broadcast(k + 1)),
+            CoordinatesPack::Multiply(two_t, d_kplus1)),
+        d_kplus2);
+    d_kplus2 = d_kplus1;
+    d_kplus1 = d_k;
+  }
+  // c_1 + 2 t d_1 - d_2.
+  CoordinatesPack::Store(
+      derivative,
+      CoordinatesPack::Subtract(
+          CoordinatesPack::Add(CoordinatesPack::Load(coefficients + 4),
+                               CoordinatesPack::Multiply(two_t, d_kplus1)),
+          d_kplus2));
+}
+
+// |degree| must be at least 1.
+template<typename CoordinatesPack>
+FORCE_INLINE void EvaluateWithDerivativeCoordinates(
+    double const* const coefficients,
+    int const degree,
+    double const scaled_t,
+    double* const value,
+    double* const derivative) {
+  using Register = typename CoordinatesPack::Register;
+  Register const zero = CoordinatesPack::Broadcast(0.0);
+  Register const t = CoordinatesPack::Broadcast(scaled_t);
+  Register const two_t = CoordinatesPack::Broadcast(scaled_t + scaled_t);
+  Register const c_0 = CoordinatesPack::Load(coefficients);
+
+  // The recurrence for the value, as in |EvaluateCoordinates|, is
+  //   b_k = c_k + 2 t b_k+1 - b_k+2,
+  // and the one for the derivative, as in |EvaluateDerivativeCoordinates|, is
+  //   d_k = (k + 1) c_k+1 + 2 t d_k+1 - d_k+2.
+  // They run together from k = degree - 1 down to 1, sharing the loads of the
+  // coefficients.  The value is not defined by the recurrence for
+  // k = degree - 1 and k = degree, see |EvaluateCoordinates|.
+  Register c_kplus1 = CoordinatesPack::Load(coefficients + 4 * degree);
+  Register b_kplus2 = zero;
+  Register b_kplus1 = c_kplus1;
+  Register d_kplus2 = zero;
+  Register d_kplus1 = zero;
+  for (int k = degree - 1; k >= 1; --k) {
+    Register const c_k = CoordinatesPack::Load(coefficients + 4 * k);
+    Register const d_k = CoordinatesPack::Subtract(
+        CoordinatesPack::Add(
+            CoordinatesPack::Multiply(
+                c_kplus1, CoordinatesPack::Broadcast(k + 1)),
+            CoordinatesPack::Multiply(two_t, d_kplus1)),
+        d_kplus2);
+    Register const b_k =
+        k == degree - 1
+            ? CoordinatesPack::Add(c_k,
+                                   CoordinatesPack::Multiply(two_t, b_kplus1))
+            : CoordinatesPack::Subtract(
+                  CoordinatesPack::Add(
+                      c_k, CoordinatesPack::Multiply(two_t, b_kplus1)),
+                  b_kplus2);
+    d_kplus2 = d_kplus1;
+    d_kplus1 = d_k;
+    b_kplus2 = b_kplus1;
+    b_kplus1 = b_k;
+    c_kplus1 = c_k;
+  }
+
+  if (degree == 1) {
+    // c_0 + t c_1.
+    CoordinatesPack::Store(
+        value,
+        CoordinatesPack::Add(c_0, CoordinatesPack::Multiply(t, b_kplus1)));
+  } else {
+    // c_0 + t b_1 - b_2.
+    CoordinatesPack::Store(
+        value,
+        CoordinatesPack::Subtract(
+            CoordinatesPack::Add(c_0, CoordinatesPack::Multiply(t, b_kplus1)),
+            b_kplus2));
+  }
+  // c_1 + 2 t d_1 - d_2.
+  CoordinatesPack::Store(
+      derivative,
+      CoordinatesPack::Subtract(
+          CoordinatesPack::Add(c_kplus1,
+                               CoordinatesPack::Multiply(two_t, d_kplus1)),
+          d_kplus2));
+}
+
+// The kernels compiled for |instruction_set|.  They give bit-identical results
+// for all the instruction sets.  The kernels for |InstructionSet::AVX2| must
+// only be called if the processor supports it.
+template<InstructionSet instruction_set>
+struct InstructionSetKernels final {
+  static void NewhallApproximationsInBatch(
+      std::vector<int> const& degrees,
+      int columns,
+      std::vector<double> const& qv,
+      std::vector<std::vector<double>>& coefficients);
+  static void Evaluate(double const* coefficients,
+                       int degree,
+                       double scaled_t,
+                       double* value);
+  static void EvaluateDerivative(double const* coefficients,
+                                 int degree,
+                                 double scaled_t,
+                                 double* derivative);
+  static void EvaluateWithDerivative(double const* coefficients,
+                                     int degree,
+                                     double scaled_t,
+                                     double* value,
+                                     double* derivative);
+};
+
+template<InstructionSet instruction_set>
+void InstructionSetKernels<instruction_set>::NewhallApproximationsInBatch(
+    std::vector<int> const& degrees,
+    int const columns,
+    std::vector<double> const& qv,
+    std::vector<std::vector<double>>& coefficients) {
+  ComputeNewhallApproximationsInBatch<Pack<instruction_set>>(
+      degrees, columns, qv, coefficients);
+}
+
+template<InstructionSet instruction_set>
+void InstructionSetKernels<instruction_set>::Evaluate(
+    double const* const coefficients,
+    int const degree,
+    double const scaled_t,
+    double* const value) {
+  EvaluateCoordinates<CoordinatesPack<instruction_set>>(
+      coefficients, degree, scaled_t, value);
+}
+
+template<InstructionSet instruction_set>
+void InstructionSetKernels<instruction_set>::EvaluateDerivative(
+    double const* const coefficients,
+    int const degree,
+    double const scaled_t,
+    double* const derivative) {
+  EvaluateDerivativeCoordinates<CoordinatesPack<instruction_set>>(
+      coefficients, degree, scaled_t, derivative);
+}
+
+template<InstructionSet instruction_set>
+void InstructionSetKernels<instruction_set>::EvaluateWithDerivative(
+    double const* const coefficients,
+    int const degree,
+    double const scaled_t,
+    double* const value,
+    double* const derivative) {
+  EvaluateWithDerivativeCoordinates<CoordinatesPack<instruction_set>>(
+      coefficients, degree, scaled_t, value, derivative);
+}
+
+#if PRINCIPIA_SIMD_SSE2
+
+// The AVX2 kernels are compiled for AVX2 irrespective of the compiler flags.
+
+template<>
+PRINCIPIA_TARGET_AVX2 inline void
+InstructionSetKernels<InstructionSet::AVX2>::NewhallApproximationsInBatch(
+    std::vector<int> const& degrees,
+    int const columns,
+    std::vector<double> const& qv,
+    std::vector<std::vector<double>>& coefficients) {
+  ComputeNewhallApproximationsInBatch<Pack<InstructionSet::AVX2>>(
+      degrees, columns, qv, coefficients);
+}
+
+template<>
+PRINCIPIA_TARGET_AVX2 inline void
+InstructionSetKernels<InstructionSet::AVX2>::Evaluate(
+    double const* const coefficients,
+    int const degree,
+    double const scaled_t,
+    double* const value) {
+  EvaluateCoordinates<CoordinatesPack<InstructionSet::AVX2>>(
+      coefficients, degree, scaled_t, value);
+}
+
+template<>
+PRINCIPIA_TARGET_AVX2 inline void
+InstructionSetKernels<InstructionSet::AVX2>::EvaluateDerivative(
+    double const* const coefficients,
+    int const degree,
+    double const scaled_t,
+    double* const derivative) {
+  EvaluateDerivativeCoordinates<CoordinatesPack<InstructionSet::AVX2>>(
+      coefficients, degree, scaled_t, derivative);
+}
+
+template<>
+PRINCIPIA_TARGET_AVX2 inline void
+InstructionSetKernels<InstructionSet::AVX2>::EvaluateWithDerivative(
+    double const* const coefficients,
+    int const degree,
+    double const scaled_t,
+    double* const value,
+    double* const derivative) {
+  EvaluateWithDerivativeCoordinates<CoordinatesPack<InstructionSet::AVX2>>(
+      coefficients, degree, scaled_t, value, derivative);
+}
+
+#endif
+
+// The addresses of the kernels for one instruction set.
+struct Kernels final {
+  decltype(&InstructionSetKernels<InstructionSet::Scalar>::
+               NewhallApproximationsInBatch) newhall_approximations_in_batch;
+  decltype(&InstructionSetKernels<InstructionSet::Scalar>::Evaluate) evaluate;
+  decltype(&InstructionSetKernels<InstructionSet::Scalar>::
+               EvaluateDerivative) evaluate_derivative;
+  decltype(&InstructionSetKernels<InstructionSet::Scalar>::
+               EvaluateWithDerivative) evaluate_with_derivative;
+};
+
+template<InstructionSet instruction_set>
+Kernels KernelsFor() {
+  using K = InstructionSetKernels<instruction_set>;
+  return {&K::NewhallApproximationsInBatch,
+          &K::Evaluate,
+          &K::EvaluateDerivative,
+          &K::EvaluateWithDerivative};
+}
+
+// The kernels for |SupportedInstructionSet()|, selected on the first call.
+inline Kernels const& SelectedKernels() {
+  static Kernels const kernels = []() {
+    switch (SupportedInstructionSet()) {
+#if PRINCIPIA_SIMD_SSE2
+      case InstructionSet::AVX2:
+        return KernelsFor<InstructionSet::AVX2>();
+      case InstructionSet::SSE2:
+        return KernelsFor<InstructionSet::SSE2>();
+#endif
+      default:
+        return KernelsFor<InstructionSet::Scalar>();
+    }
+  }();
+  return kernels;
+}
+
+inline void NewhallApproximationsInBatch(
+    std::vector<int> const& degrees,
+    int const columns,
+    std::vector<double> const& qv,
+    std::vector<std::vector<double>>& coefficients) {
+  CHECK_EQ(newhall_samples * columns, qv.size());
+  coefficients.resize(degrees.size());
+  for (int d = 0; d < degrees.size(); ++d) {
+    CHECK_LE(degrees[d], newhall_max_degree);
+    coefficients[d].resize((degrees[d] + 1) * columns);
+  }
+  SelectedKernels().newhall_approximations_in_batch(
+      degrees, columns, qv, coefficients);
+}
+
+template<typename Vector>
+void CoordinatesHelper<Vector>::ToCoordinates(Vector const& value,
+                                              int const stride,
+                                              double* const coordinates) {
+  coordinates[0] = value / SIUnit<Vector>();
+}
+
+template<typename Vector>
+Vector CoordinatesHelper<Vector>::FromCoordinates(
+    double const* const coordinates,
+    int const stride) {
+  return coordinates[0] * SIUnit<Vector>();
+}
+
+template<typename Scalar, typename Frame, int rank>
+class CoordinatesHelper<Multivector<Scalar, Frame, rank>> final {
+ public:
+  static int constexpr dimension = 3;
+
+  static void ToCoordinates(Multivector<Scalar, Frame, rank> const& value,
+                            int const stride,
+                            double* const coordinates) {
+    R3Element<double> const r = value.coordinates() / SIUnit<Scalar>();
+    coordinates[0] = r.x;
+    coordinates[stride] = r.y;
+    coordinates[2 * stride] = r.z;
+  }
+
+  static Multivector<Scalar, Frame, rank> FromCoordinates(
+      double const* const coordinates,
+      int const stride) {
+    return Multivector<double, Frame, rank>(
+               R3Element<double>(coordinates[0],
+                                 coordinates[stride],
+                                 coordinates[2 * stride])) *
+           SIUnit<Scalar>();
+  }
+};
+
 // The compiler does a much better job on an |R3Element<double>| than on a
 // |Vector<Quantity>| so we specialize this case.
 template<typename Scalar, typename Frame, int rank>
@@ -27,17 +538,33 @@ class EvaluationHelper<Multivector<Scalar, Frame, rank>> final {
   EvaluationHelper(
       std::vector<Multivector<Scalar, Frame, rank>> const& coefficients,
       int const degree);
+  EvaluationHelper(EvaluationHelper const& other) = default;
   EvaluationHelper(EvaluationHelper&& other) = default;
   EvaluationHelper& operator=(EvaluationHelper&& other) = default;
 
   Multivector<Scalar, Frame, rank> EvaluateImplementation(
       double const scaled_t) const;
+  Multivector<Scalar, Frame, rank> EvaluateDerivativeImplementation(
+      double const scaled_t) const;
+  void EvaluateWithDerivativeImplementation(
+      double const scaled_t,
+      Multivector<Scalar, Frame, rank>& value,
+      Multivector<Scalar, Frame, rank>& derivative) const;
 
   Multivector<Scalar, Frame, rank> coefficients(int const index) const;
   int degree() const;
 
  private:
-  std::vector<R3Element<double>> coefficients_;
+  // The address of the coordinates of the coefficient of Tₖ.
+  double const* coefficient(int k) const;
+
+  // The multivector whose coordinates in SI units are |xyz[0]|, |xyz[1]|,
+  // |xyz[2]|.
+  static Multivector<Scalar, Frame, rank> FromCoordinates(double const* xyz);
+
+  // The coordinates in SI units of the coefficient of Tₖ are at indices
+  // [4 * k, 4 * k + 3[, followed by a zero.
+  std::vector<double> coefficients_;
   int degree_;
 };
 
@@ -80,6 +607,35 @@ Vector EvaluationHelper<Vector>::EvaluateImplementation(
   }
 }
 
+template<typename Vector>
+Vector EvaluationHelper<Vector>::EvaluateDerivativeImplementation(
+    double const scaled_t) const {
+  double const two_scaled_t = scaled_t + scaled_t;
+  Vector b_kplus2_vector{};
+  Vector b_kplus1_vector{};
+  Vector* b_kplus2 = &b_kplus2_vector;
+  Vector* b_kplus1 = &b_kplus1_vector;
+  Vector* const& b_k = b_kplus2;  // An overlay.
+  for (int k = degree_ - 1; k >= 1; --k) {
+    *b_k = coefficients_[k + 1] * (k + 1) +
+           two_scaled_t * *b_kplus1 - *b_kplus2;
+    Vector* const last_b_k = b_k;
+    b_kplus2 = b_kplus1;
+    b_kplus1 = last_b_k;
+  }
+  return coefficients_[1] + two_scaled_t * *b_kplus1 - *b_kplus2;
+}
+
+template<typename Vector>
+void EvaluationHelper<Vector>::EvaluateWithDerivativeImplementation(
+    double const scaled_t,
+    Vector& value,
+    Vector& derivative) const {
+  // The compiler does a good job on scalars, no need to fuse the recurrences.
+  value = EvaluateImplementation(scaled_t);
+  derivative = EvaluateDerivativeImplementation(scaled_t);
+}
+
 template<typename Vector>
 Vector EvaluationHelper<Vector>::coefficients(int const index) const {
   return coefficients_[index];
@@ -94,8 +650,14 @@ template<typename Scalar, typename Frame, int rank>
 EvaluationHelper<Multivector<Scalar, Frame, rank>>::EvaluationHelper(
     std::vector<Multivector<Scalar, Frame, rank>> const& coefficients,
     int const degree) : degree_(degree) {
+  coefficients_.reserve(4 * coefficients.size());
   for (auto const& coefficient : coefficients) {
-    coefficients_.push_back(coefficient.coordinates() / SIUnit<Scalar>());
+    R3Element<double> const coordinates =
+        coefficient.coordinates() / SIUnit<Scalar>();
+    coefficients_.push_back(coordinates.x);
+    coefficients_.push_back(coordinates.y);
+    coefficients_.push_back(coordinates.z);
+    coefficients_.push_back(0.0);
   }
 }
 
@@ -103,52 +665,51 @@ template<typename Scalar, typename Frame, int rank>
 Multivector<Scalar, Frame, rank>
 EvaluationHelper<Multivector<Scalar, Frame, rank>>::EvaluateImplementation(
     double const scaled_t) const {
-  double const two_scaled_t = scaled_t + scaled_t;
-  R3Element<double> const c_0 = coefficients_[0];
-  switch (degree_) {
-    case 0:
-      return Multivector<double, Frame, rank>(c_0) * SIUnit<Scalar>();
-    case 1:
-      return Multivector<double, Frame, rank>(
-                 c_0 + scaled_t * coefficients_[1]) * SIUnit<Scalar>();
-    default:
-      // b_degree   = c_degree.
-      R3Element<double> b_i = coefficients_[degree_];
-      // b_degree-1 = c_degree-1 + 2 t b_degree.
-      R3Element<double> b_j = coefficients_[degree_ - 1] + two_scaled_t * b_i;
-      int k = degree_ - 3;
-      for (; k >= 1; k -= 2) {
-        // b_k+1 = c_k+1 + 2 t b_k+2 - b_k+3.
-        R3Element<double> const c_kplus1 = coefficients_[k + 1];
-        b_i.x = c_kplus1.x + two_scaled_t * b_j.x - b_i.x;
-        b_i.y = c_kplus1.y + two_scaled_t * b_j.y - b_i.y;
-        b_i.z = c_kplus1.z + two_scaled_t * b_j.z - b_i.z;
-        // b_k   = c_k   + 2 t b_k+1 - b_k+2.
-        R3Element<double> const c_k = coefficients_[k];
-        b_j.x = c_k.x + two_scaled_t * b_i.x - b_j.x;
-        b_j.y = c_k.y + two_scaled_t * b_i.y - b_j.y;
-        b_j.z = c_k.z + two_scaled_t * b_i.z - b_j.z;
-      }
-      if (k == 0) {
-        // b_1 = c_1 + 2 t b_2 - b_3.
-        b_i = coefficients_[1] + two_scaled_t * b_j - b_i;
-        // c_0 + t b_1 - b_2.
-        return Multivector<double, Frame, rank>(
-                   c_0 + scaled_t * b_i - b_j) * SIUnit<Scalar>();
-      } else {
-        // c_0 + t b_1 - b_2.
-        return Multivector<double, Frame, rank>(
-                   c_0 + scaled_t * b_j - b_i) * SIUnit<Scalar>();
-      }
-    }
+  double value[3];
+  SelectedKernels().evaluate(coefficient(0), degree_, scaled_t, value);
+  return FromCoordinates(value);
+}
+
+template<typename Scalar, typename Frame, int rank>
+Multivector<Scalar, Frame, rank>
+EvaluationHelper<Multivector<Scalar, Frame, rank>>::
+EvaluateDerivativeImplementation(double const scaled_t) const {
+  if (degree_ == 0) {
+    return Multivector<Scalar, Frame, rank>();
+  }
+  double derivative[3];
+  SelectedKernels().evaluate_derivative(
+      coefficient(0), degree_, scaled_t, derivative);
+  return FromCoordinates(derivative);
+}
+
+template<typename Scalar, typename Frame, int rank>
+void EvaluationHelper<Multivector<Scalar, Frame, rank>>::
+EvaluateWithDerivativeImplementation(
+    double const scaled_t,
+    Multivector<Scalar, Frame, rank>& value,
+    Multivector<Scalar, Frame, rank>& derivative) const {
+  if (degree_ == 0) {
+    value = FromCoordinates(coefficient(0));
+    derivative = Multivector<Scalar, Frame, rank>();
+    return;
+  }
+  double value_coordinates[3];
+  double derivative_coordinates[3];
+  SelectedKernels().evaluate_with_derivative(coefficient(0),
+                                             degree_,
+                                             scaled_t,
+                                             value_coordinates,
+                                             derivative_coordinates);
+  value = FromCoordinates(value_coordinates);
+  derivative = FromCoordinates(derivative_coordinates);
 }
 
 template<typename Scalar, typename Frame, int rank>
 Multivector<Scalar, Frame, rank>
 EvaluationHelper<Multivector<Scalar, Frame, rank>>::coefficients(
     int const index) const {
-  return Multivector<double, Frame, rank>(
-             coefficients_[index]) * SIUnit<Scalar>();
+  return FromCoordinates(coefficient(index));
 }
 
 template<typename Scalar, typename Frame, int rank>
@@ -156,6 +717,21 @@ int EvaluationHelper<Multivector<Scalar, Frame, rank>>::degree() const {
   return degree_;
 }
 
+template<typename Scalar, typename Frame, int rank>
+double const* EvaluationHelper<Multivector<Scalar, Frame, rank>>::coefficient(
+    int const k) const {
+  return &coefficients_[4 * k];
+}
+
+template<typename Scalar, typename Frame, int rank>
+Multivector<Scalar, Frame, rank>
+EvaluationHelper<Multivector<Scalar, Frame, rank>>::FromCoordinates(
+    double const* const xyz) {
+  return Multivector<double, Frame, rank>(
+             R3Element<double>(xyz[0], xyz[1], xyz[2])) *
+         SIUnit<Scalar>();
+}
+
 template<typename Vector>
 ЧебышёвSeries<Vector>::ЧебышёвSeries(std::vector<Vector> const& coefficients,
                                      Instant const& t_min,
@@ -212,49 +788,33 @@ Vector ЧебышёвSeries<Vector>::last_coefficient() const {
 }
 
 template<typename Vector>
-Vector ЧебышёвSeries<Vector>::Evaluate(Instant const& t) const {
-  // This formula ensures continuity at the edges by producing -1 or +1 within
-  // 2 ulps for |t_min_| and |t_max_|.
-  double const scaled_t = ((t - t_max_) + (t - t_min_)) * one_over_duration_;
-  // We have to allow |scaled_t| to go slightly out of [-1, 1] because of
-  // computation errors.  But if it goes too far, something is broken.
-  // TODO(phl): This should use DCHECK but these macros don't work because the
-  // Principia projects don't define NDEBUG.
-#ifdef _DEBUG
-  CHECK_LE(scaled_t, 1.1);
-  CHECK_GE(scaled_t, -1.1);
-#endif
+Vector ЧебышёвSeries<Vector>::coefficient(int const i) const {
+  return helper_.coefficients(i);
+}
 
-  return helper_.EvaluateImplementation(scaled_t);
+template<typename Vector>
+Vector ЧебышёвSeries<Vector>::Evaluate(Instant const& t) const {
+  return helper_.EvaluateImplementation(ScaledArgument(t));
 }
 
 template<typename Vector>
 Variation<Vector> ЧебышёвSeries<Vector>::EvaluateDerivative(
     Instant const& t) const {
-  // See comments above.
-  double const scaled_t = ((t - t_max_) + (t - t_min_)) * one_over_duration_;
-  double const two_scaled_t = scaled_t + scaled_t;
-#ifdef _DEBUG
-  CHECK_LE(scaled_t, 1.1);
-  CHECK_GE(scaled_t, -1.1);
-#endif
-
-  Vector b_kplus2_vector{};
-  Vector b_kplus1_vector{};
-  Vector* b_kplus2 = &b_kplus2_vector;
-  Vector* b_kplus1 = &b_kplus1_vector;
-  Vector* const& b_k = b_kplus2;  // An overlay.
-  for (int k = helper_.degree() - 1; k >= 1; --k) {
-    *b_k = helper_.coefficients(k + 1) * (k + 1) +
-           two_scaled_t * *b_kplus1 - *b_kplus2;
-    Vector* const last_b_k = b_k;
-    b_kplus2 = b_kplus1;
-    b_kplus1 = last_b_k;
-  }
-  return (helper_.coefficients(1) + two_scaled_t * *b_kplus1 - *b_kplus2) *
+  return helper_.EvaluateDerivativeImplementation(ScaledArgument(t)) *
              (one_over_duration_ + one_over_duration_);
 }
 
+template<typename Vector>
+void ЧебышёвSeries<Vector>::EvaluateWithDerivative(
+    Instant const& t,
+    Vector& value,
+    Variation<Vector>& derivative) const {
+  Vector scaled_derivative;
+  helper_.EvaluateWithDerivativeImplementation(
+      ScaledArgument(t), value, scaled_derivative);
+  derivative = scaled_derivative * (one_over_duration_ + one_over_duration_);
+}
+
 template<typename Vector>
 void ЧебышёвSeries<Vector>::WriteToMessage(
     not_null<serialization::ЧебышёвSeries*> const message) const {
@@ -294,18 +854,18 @@ template<typename Vector>
     std::vector<Variation<Vector>> const& v,
     Instant const& t_min,
     Instant const& t_max) {
-  // Only supports 8 divisions for now.
-  int const divisions = 8;
-  CHECK_EQ(divisions + 1, q.size());
-  CHECK_EQ(divisions + 1, v.size());
+  // A single series gains nothing from the batched product, so the samples
+  // stay on the stack.
+  CHECK_EQ(newhall_divisions + 1, q.size());
+  CHECK_EQ(newhall_divisions + 1, v.size());
 
   Time const duration_over_two = 0.5 * (t_max - t_min);
 
   // Tricky.  The order in Newhall's matrices is such that the entries for the
   // largest time occur first.
-  FixedVector<Vector, 2 * divisions + 2> qv;
-  for (int i = 0, j = 2 * divisions;
-       i < divisions + 1 && j >= 0;
+  FixedVector<Vector, newhall_samples> qv;
+  for (int i = 0, j = 2 * newhall_divisions;
+       i < newhall_divisions + 1 && j >= 0;
        ++i, j -= 2) {
     qv[j] = q[i];
     qv[j + 1] = v[i] * duration_over_two;
@@ -367,6 +927,100 @@ template<typename Vector>
   return ЧебышёвSeries(coefficients, t_min, t_max);
 }
 
+template<typename Vector>
+std::vector<std::vector<ЧебышёвSeries<Vector>>>
+ЧебышёвSeries<Vector>::NewhallApproximations(
+    std::vector<int> const& degrees,
+    std::vector<std::vector<Vector>> const& q,
+    std::vector<std::vector<Variation<Vector>>> const& v,
+    Instant const& t_min,
+    Instant const& t_max) {
+  CHECK_EQ(q.size(), v.size());
+  if (q.size() == 1) {
+    std::vector<std::vector<ЧебышёвSeries>> approximations(degrees.size());
+    for (int d = 0; d < degrees.size(); ++d) {
+      approximations[d].push_back(
+          NewhallApproximation(degrees[d], q[0], v[0], t_min, t_max));
+    }
+    return approximations;
+  }
+  int const dimension = CoordinatesHelper<Vector>::dimension;
+  int const columns = dimension * q.size();
+  Time const duration_over_two = 0.5 * (t_max - t_min);
+  std::vector<double> qv(newhall_samples * columns);
+  for (int f = 0; f < q.size(); ++f) {
+    WriteNewhallSamples(
+        q[f], v[f], duration_over_two, dimension * f, columns, qv);
+  }
+
+  std::vector<std::vector<double>> coefficients;
+  NewhallApproximationsInBatch(degrees, columns, qv, coefficients);
+  std::vector<std::vector<ЧебышёвSeries>> approximations(degrees.size());
+  for (int d = 0; d < degrees.size(); ++d) {
+    approximations[d].reserve(q.size());
+    for (int f = 0; f < q.size(); ++f) {
+      approximations[d].push_back(ReadNewhallCoefficients(
+          coefficients[d], dimension * f, columns, t_min, t_max));
+    }
+  }
+  return approximations;
+}
+
+template<typename Vector>
+double ЧебышёвSeries<Vector>::ScaledArgument(Instant const& t) const {
+  // This formula ensures continuity at the edges by producing -1 or +1 within
+  // 2 ulps for |t_min_| and |t_max_|.
+  double const scaled_t = ((t - t_max_) + (t - t_min_)) * one_over_duration_;
+  // We have to allow |scaled_t| to go slightly out of [-1, 1] because of
+  // computation errors.  But if it goes too far, something is broken.
+  // TODO(phl): This should use DCHECK but these macros don't work because the
+  // Principia projects don't define NDEBUG.
+#ifdef _DEBUG
+  CHECK_LE(scaled_t, 1.1);
+  CHECK_GE(scaled_t, -1.1);
+#endif
+  return scaled_t;
+}
+
+template<typename Vector>
+void ЧебышёвSeries<Vector>::WriteNewhallSamples(
+    std::vector<Vector> const& q,
+    std::vector<Variation<Vector>> const& v,
+    Time const& duration_over_two,
+    int const column,
+    int const columns,
+    std::vector<double>& qv) {
+  CHECK_EQ(newhall_divisions + 1, q.size());
+  CHECK_EQ(newhall_divisions + 1, v.size());
+  // Tricky.  The order in Newhall's matrices is such that the entries for the
+  // largest time occur first.
+  for (int i = 0, j = 2 * newhall_divisions;
+       i < newhall_divisions + 1 && j >= 0;
+       ++i, j -= 2) {
+    CoordinatesHelper<Vector>::ToCoordinates(
+        q[i], columns, &qv[j * columns + column]);
+    CoordinatesHelper<Vector>::ToCoordinates(
+        v[i] * duration_over_two, columns, &qv[(j + 1) * columns + column]);
+  }
+}
+
+template<typename Vector>
+ЧебышёвSeries<Vector> ЧебышёвSeries<Vector>::ReadNewhallCoefficients(
+    std::vector<double> const& coefficients,
+    int const column,
+    int const columns,
+    Instant const& t_min,
+    Instant const& t_max) {
+  int const degree = coefficients.size() / columns - 1;
+  std::vector<Vector> series_coefficients;
+  series_coefficients.reserve(degree + 1);
+  for (int k = 0; k <= degree; ++k) {
+    series_coefficients.push_back(CoordinatesHelper<Vector>::FromCoordinates(
+        &coefficients[k * columns + column], columns));
+  }
+  return ЧебышёвSeries(series_coefficients, t_min, t_max);
+}
+
 }  // namespace internal_чебышёв_series
 }  // namespace numerics
 }  // namespace principia
@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "astronomy/frames.hpp"
+#include "base/simd.hpp"
 #include "geometry/grassmann.hpp"
 #include "geometry/named_quantities.hpp"
 #include "gtest/gtest.h"
@@ -20,16 +21,20 @@ namespace numerics {
 namespace internal_чебышёв_series {
 
 using astronomy::ICRFJ2000Ecliptic;
+using geometry::Displacement;
 using geometry::Instant;
 using geometry::Vector;
+using geometry::Velocity;
 using quantities::Length;
 using quantities::Speed;
+using quantities::Variation;
 using quantities::si::Metre;
 using quantities::si::Second;
 using testing_utilities::AbsoluteError;
 using testing_utilities::AlmostEquals;
 using ::testing::AllOf;
 using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
 using ::testing::Gt;
 using ::testing::Lt;
 
@@ -210,6 +215,49 @@ TEST_F(ЧебышёвSeriesTest, X6Vector) {
             x6.Evaluate(t0_ + 3 * Second));
 }
 
+// The fused evaluation gives the same results as the separate ones, for all
+// the degrees.  The derivatives also agree with the scalar recurrence applied
+// to each coordinate.
+TEST_F(ЧебышёвSeriesTest, EvaluateWithDerivative) {
+  using V = Vector<Length, ICRFJ2000Ecliptic>;
+  std::vector<V> coefficients;
+  std::vector<Length> x_coefficients;
+  std::vector<Length> y_coefficients;
+  std::vector<Length> z_coefficients;
+  for (int degree = 0; degree <= 17; ++degree) {
+    coefficients.push_back(V({(degree + 1) * Metre,
+                              -2.5 * degree * Metre,
+                              1.0 / (degree + 1) * Metre}));
+    x_coefficients.push_back(coefficients.back().coordinates().x);
+    y_coefficients.push_back(coefficients.back().coordinates().y);
+    z_coefficients.push_back(coefficients.back().coordinates().z);
+    ЧебышёвSeries<V> const series(coefficients, t_min_, t_max_);
+    ЧебышёвSeries<Length> const x_series(x_coefficients, t_min_, t_max_);
+    ЧебышёвSeries<Length> const y_series(y_coefficients, t_min_, t_max_);
+    ЧебышёвSeries<Length> const z_series(z_coefficients, t_min_, t_max_);
+    for (Instant t = t_min_; t <= t_max_; t += 0.3 * Second) {
+      V value;
+      Variation<V> derivative;
+      series.EvaluateWithDerivative(t, value, derivative);
+      EXPECT_EQ(series.Evaluate(t), value) << degree;
+      if (degree > 0) {
+        EXPECT_EQ(series.EvaluateDerivative(t), derivative) << degree;
+        EXPECT_THAT(derivative.coordinates().x,
+                    AlmostEquals(x_series.EvaluateDerivative(t), 0, 1))
+            << degree;
+        EXPECT_THAT(derivative.coordinates().y,
+                    AlmostEquals(y_series.EvaluateDerivative(t), 0, 1))
+            << degree;
+        EXPECT_THAT(derivative.coordinates().z,
+                    AlmostEquals(z_series.EvaluateDerivative(t), 0, 1))
+            << degree;
+      } else {
+        EXPECT_EQ(Variation<V>(), derivative);
+      }
+    }
+  }
+}
+
 TEST_F(ЧебышёвSeriesDeathTest, SerializationError) {
   ЧебышёвSeries<Speed> v({1 * Metre / Second,
                           -2 * Metre / Second,
@@ -396,6 +444,117 @@ TEST_F(ЧебышёвSeriesTest, NewhallApproximation) {
                               near_speed(1.3e-12 * Metre / Second)));
 }
 
+// The batched approximations are identical to the individual ones.
+TEST_F(ЧебышёвSeriesTest, NewhallApproximations) {
+  int const number_of_functions = 7;
+  std::vector<int> const degrees = {3, 8, 12, 17};
+  std::vector<std::vector<Displacement<ICRFJ2000Ecliptic>>> q(
+      number_of_functions);
+  std::vector<std::vector<Velocity<ICRFJ2000Ecliptic>>> v(
+      number_of_functions);
+  for (int f = 0; f < number_of_functions; ++f) {
+    for (Instant t = t_min_; t <= t_max_; t += 0.5 * Second) {
+      double const τ = (t - t_min_) / ((f + 1) * Second);
+      q[f].push_back(Displacement<ICRFJ2000Ecliptic>(
+          {std::sin(τ) * Metre, std::cos(τ) * Metre, τ * τ * τ * Metre}));
+      v[f].push_back(Displacement<ICRFJ2000Ecliptic>(
+                         {std::cos(τ) * Metre,
+                          -std::sin(τ) * Metre,
+                          3 * τ * τ * Metre}) /
+                     ((f + 1) * Second));
+    }
+  }
+
+  auto const approximations =
+      ЧебышёвSeries<Displacement<ICRFJ2000Ecliptic>>::NewhallApproximations(
+          degrees, q, v, t_min_, t_max_);
+  ASSERT_EQ(degrees.size(), approximations.size());
+  for (int d = 0; d < degrees.size(); ++d) {
+    ASSERT_EQ(number_of_functions, approximations[d].size());
+    for (int f = 0; f < number_of_functions; ++f) {
+      auto const expected =
+          ЧебышёвSeries<Displacement<ICRFJ2000Ecliptic>>::NewhallApproximation(
+              degrees[d], q[f], v[f], t_min_, t_max_);
+      auto const& actual = approximations[d][f];
+      ASSERT_EQ(degrees[d], actual.degree());
+      EXPECT_EQ(t_min_, actual.t_min());
+      EXPECT_EQ(t_max_, actual.t_max());
+      for (int k = 0; k <= degrees[d]; ++k) {
+        EXPECT_EQ(expected.coefficient(k), actual.coefficient(k));
+      }
+    }
+  }
+}
+
+// The kernels for all the instruction sets supported by the processor give the
+// same results as the scalar ones.
+TEST_F(ЧебышёвSeriesTest, InstructionSets) {
+  std::vector<Kernels> kernels;
+#if PRINCIPIA_SIMD_SSE2
+  kernels.push_back(KernelsFor<InstructionSet::SSE2>());
+  if (SupportedInstructionSet() == InstructionSet::AVX2) {
+    kernels.push_back(KernelsFor<InstructionSet::AVX2>());
+  }
+#endif
+  Kernels const scalar = KernelsFor<InstructionSet::Scalar>();
+
+  // The coordinates of the coefficients are followed by a zero.
+  std::vector<double> coefficients;
+  for (int k = 0; k <= newhall_max_degree; ++k) {
+    coefficients.push_back(std::sin(k + 1.0));
+    coefficients.push_back(std::cos(k + 1.0) / 3);
+    coefficients.push_back(k * 7.0);
+    coefficients.push_back(0.0);
+  }
+  for (auto const& k : kernels) {
+    for (int degree = 1; degree <= newhall_max_degree; ++degree) {
+      for (double t = -1; t <= 1; t += 0.125) {
+        double expected_value[3];
+        double expected_derivative[3];
+        double value[3];
+        double derivative[3];
+        double fused_value[3];
+        double fused_derivative[3];
+        scalar.evaluate(coefficients.data(), degree, t, expected_value);
+        scalar.evaluate_derivative(
+            coefficients.data(), degree, t, expected_derivative);
+        k.evaluate(coefficients.data(), degree, t, value);
+        k.evaluate_derivative(coefficients.data(), degree, t, derivative);
+        k.evaluate_with_derivative(
+            coefficients.data(), degree, t, fused_value, fused_derivative);
+        EXPECT_THAT(value, ElementsAreArray(expected_value)) << degree;
+        EXPECT_THAT(derivative, ElementsAreArray(expected_derivative))
+            << degree;
+        EXPECT_THAT(fused_value, ElementsAreArray(expected_value)) << degree;
+        EXPECT_THAT(fused_derivative, ElementsAreArray(expected_derivative))
+            << degree;
+      }
+    }
+  }
+
+  // An odd number of columns, so that the last block is padded.
+  int const columns = 7;
+  std::vector<int> const degrees = {3, 8, 12, 17};
+  std::vector<double> qv;
+  for (int i = 0; i < newhall_samples * columns; ++i) {
+    qv.push_back(std::sin(i + 1.0));
+  }
+  // The kernels expect the coefficients to be sized.
+  std::vector<std::vector<double>> zero_coefficients;
+  for (int const degree : degrees) {
+    zero_coefficients.emplace_back((degree + 1) * columns, 0.0);
+  }
+  std::vector<std::vector<double>> expected_coefficients = zero_coefficients;
+  scalar.newhall_approximations_in_batch(
+      degrees, columns, qv, expected_coefficients);
+  for (auto const& k : kernels) {
+    std::vector<std::vector<double>> actual_coefficients = zero_coefficients;
+    k.newhall_approximations_in_batch(
+        degrees, columns, qv, actual_coefficients);
+    EXPECT_EQ(expected_coefficients, actual_coefficients);
+  }
+}
+
 }  // namespace internal_чебышёв_series
 }  // namespace numerics
 }  // namespace principia
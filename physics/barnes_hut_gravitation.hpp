@@ -0,0 +1,100 @@
+﻿
+#pragma once
+
+#include <vector>
+
+#include "geometry/grassmann.hpp"
+#include "geometry/named_quantities.hpp"
+#include "quantities/named_quantities.hpp"
+#include "quantities/quantities.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_barnes_hut_gravitation {
+
+using geometry::Position;
+using geometry::Vector;
+using quantities::Acceleration;
+using quantities::GravitationalParameter;
+using quantities::Length;
+
+// Computes approximately the mutual Newtonian accelerations of a set of
+// spherical massive bodies, in O(N log N) time instead of O(N²).
+// The bodies are split in two groups:
+// - the dominant bodies (e.g., the star and the planets), whose gravitational
+//   parameter is at least a given threshold.  Their interactions with all the
+//   other bodies are computed exactly;
+// - the minor bodies (e.g., the asteroids), whose mutual interactions are
+//   computed using the Barnes-Hut algorithm: the minor bodies are sorted in an
+//   octree, and the effect of the bodies of a cell of the octree is
+//   approximated by that of their centre of mass if the side of the cell is
+//   less than |opening_angle| times the distance to the cell.
+// Note that, unlike with the exact computation, the accelerations between
+// minor bodies do not exactly satisfy the third law.
+template<typename Frame>
+class BarnesHutGravitation final {
+ public:
+  // The elements of |gravitational_parameters| correspond to the bodies in the
+  // order in which they are given to |AddAccelerations|.  If |opening_angle|
+  // is zero the cells are never approximated and the computation is exact (and
+  // slow).
+  BarnesHutGravitation(
+      std::vector<GravitationalParameter> const& gravitational_parameters,
+      GravitationalParameter const& dominant_gravitational_parameter,
+      double opening_angle);
+
+  // Adds to |accelerations[begin + i]| the acceleration exerted on the body i
+  // by all the other bodies, where the body i is at |positions[begin + i]|.
+  void AddAccelerations(
+      std::vector<Position<Frame>> const& positions,
+      int begin,
+      std::vector<Vector<Acceleration, Frame>>& accelerations);
+
+  int number_of_dominant_bodies() const;
+
+ private:
+  // A cubic cell of the octree.
+  struct Node final {
+    Position<Frame> centre;
+    Length half_side;
+    Position<Frame> centre_of_mass;
+    GravitationalParameter gravitational_parameter;
+    // The bodies in this cell are |octree_bodies_[bodies_begin, bodies_end)|.
+    int bodies_begin;
+    int bodies_end;
+    // The children of this cell are |nodes_[children_begin, children_end)|.
+    // Empty for a leaf.
+    int children_begin = 0;
+    int children_end = 0;
+  };
+
+  // Fills the centre of mass of |nodes_[node]| and recursively subdivides it.
+  void Subdivide(int node,
+                 int depth,
+                 std::vector<Position<Frame>> const& positions,
+                 int begin);
+
+  std::vector<GravitationalParameter> const gravitational_parameters_;
+  double const opening_angle_;
+
+  // Indices in |gravitational_parameters_|.
+  std::vector<int> dominant_bodies_;
+  std::vector<int> minor_bodies_;
+
+  // The octree, rebuilt by each call to |AddAccelerations|, and the stack used
+  // to traverse it.  |octree_bodies_| is a permutation of |minor_bodies_| such
+  // that the bodies of each cell are contiguous.  Kept here to avoid
+  // reallocations.
+  std::vector<Node> nodes_;
+  std::vector<int> octree_bodies_;
+  std::vector<int> stack_;
+};
+
+}  // namespace internal_barnes_hut_gravitation
+
+using internal_barnes_hut_gravitation::BarnesHutGravitation;
+
+}  // namespace physics
+}  // namespace principia
+
+#include "physics/barnes_hut_gravitation_body.hpp"
@@ -0,0 +1,262 @@
+﻿
+#pragma once
+
+#include "physics/barnes_hut_gravitation.hpp"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "base/macros.hpp"
+#include "geometry/r3_element.hpp"
+#include "glog/logging.h"
+#include "quantities/elementary_functions.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_barnes_hut_gravitation {
+
+using geometry::Displacement;
+using geometry::InnerProduct;
+using geometry::R3Element;
+using quantities::Abs;
+using quantities::Exponentiation;
+using quantities::Product;
+using quantities::Sqrt;
+using quantities::Square;
+
+// Beyond this depth the cells are not subdivided anymore.  This only matters
+// if many bodies are (nearly) at the same position.
+int const max_depth = 64;
+
+// The cells with at most that many bodies are not subdivided: it is cheaper to
+// compute their interactions directly than to traverse more cells.
+int const max_bodies_per_leaf = 8;
+
+template<typename Frame>
+FORCE_INLINE Vector<Acceleration, Frame> PointMassAcceleration(
+    Displacement<Frame> const& Δq,
+    GravitationalParameter const& μ) {
+  Square<Length> const Δq_squared = InnerProduct(Δq, Δq);
+  Exponentiation<Length, -3> const one_over_Δq_cubed =
+      Sqrt(Δq_squared) / (Δq_squared * Δq_squared);
+  return Δq * μ * one_over_Δq_cubed;
+}
+
+template<typename Frame>
+BarnesHutGravitation<Frame>::BarnesHutGravitation(
+    std::vector<GravitationalParameter> const& gravitational_parameters,
+    GravitationalParameter const& dominant_gravitational_parameter,
+    double const opening_angle)
+    : gravitational_parameters_(gravitational_parameters),
+      opening_angle_(opening_angle) {
+  CHECK_LE(0, opening_angle);
+  for (int b = 0; b < gravitational_parameters_.size(); ++b) {
+    if (gravitational_parameters_[b] >= dominant_gravitational_parameter) {
+      dominant_bodies_.push_back(b);
+    } else {
+      minor_bodies_.push_back(b);
+    }
+  }
+}
+
+template<typename Frame>
+void BarnesHutGravitation<Frame>::AddAccelerations(
+    std::vector<Position<Frame>> const& positions,
+    int const begin,
+    std::vector<Vector<Acceleration, Frame>>& accelerations) {
+  int const size = gravitational_parameters_.size();
+  CHECK_LE(begin + size, positions.size());
+  CHECK_LE(begin + size, accelerations.size());
+
+  // The interactions involving a dominant body are computed exactly.
+  for (int d1 = 0; d1 < dominant_bodies_.size(); ++d1) {
+    int const b1 = dominant_bodies_[d1];
+    GravitationalParameter const& μ1 = gravitational_parameters_[b1];
+    Position<Frame> const& q1 = positions[begin + b1];
+    Vector<Acceleration, Frame>& a1 = accelerations[begin + b1];
+    auto const add_pair = [this, b1, &μ1, &q1, &a1, begin,
+                           &positions, &accelerations](int const b2) {
+      Displacement<Frame> const Δq = q1 - positions[begin + b2];
+      Square<Length> const Δq_squared = InnerProduct(Δq, Δq);
+      Exponentiation<Length, -3> const one_over_Δq_cubed =
+          Sqrt(Δq_squared) / (Δq_squared * Δq_squared);
+      accelerations[begin + b2] += Δq * μ1 * one_over_Δq_cubed;
+      a1 -= Δq * gravitational_parameters_[b2] * one_over_Δq_cubed;
+    };
+    for (int d2 = d1 + 1; d2 < dominant_bodies_.size(); ++d2) {
+      add_pair(dominant_bodies_[d2]);
+    }
+    for (int const b2 : minor_bodies_) {
+      add_pair(b2);
+    }
+  }
+
+  if (minor_bodies_.size() < 2) {
+    return;
+  }
+
+  // Build the octree, starting from a cube that encloses all the minor bodies.
+  R3Element<Length> low = (positions[begin + minor_bodies_.front()] -
+                           Frame::origin).coordinates();
+  R3Element<Length> high = low;
+  for (int const b : minor_bodies_) {
+    R3Element<Length> const coordinates =
+        (positions[begin + b] - Frame::origin).coordinates();
+    for (int i = 0; i < 3; ++i) {
+      low[i] = std::min(low[i], coordinates[i]);
+      high[i] = std::max(high[i], coordinates[i]);
+    }
+  }
+  R3Element<Length> const extent = high - low;
+  octree_bodies_ = minor_bodies_;
+  nodes_.clear();
+  nodes_.emplace_back();
+  Node& root = nodes_.back();
+  root.centre = Frame::origin + Displacement<Frame>((low + high) / 2);
+  // Make the root cube slightly larger so that no body lies on its boundary.
+  root.half_side =
+      0.5 * (1 + 1e-6) * std::max({extent.x, extent.y, extent.z});
+  root.bodies_begin = 0;
+  root.bodies_end = minor_bodies_.size();
+  Subdivide(/*node=*/0, /*depth=*/0, positions, begin);
+
+  // Traverse the octree for each minor body.
+  double const opening_angle² = opening_angle_ * opening_angle_;
+  for (int const b : minor_bodies_) {
+    Position<Frame> const& q = positions[begin + b];
+    Vector<Acceleration, Frame> a;
+    stack_.clear();
+    stack_.push_back(0);
+    while (!stack_.empty()) {
+      Node const& node = nodes_[stack_.back()];
+      stack_.pop_back();
+      if (node.gravitational_parameter == GravitationalParameter()) {
+        continue;
+      }
+      if (node.children_begin == node.children_end) {
+        // A leaf: compute the interactions exactly.
+        for (int i = node.bodies_begin; i < node.bodies_end; ++i) {
+          int const b2 = octree_bodies_[i];
+          if (b2 != b) {
+            a += PointMassAcceleration(positions[begin + b2] - q,
+                                       gravitational_parameters_[b2]);
+          }
+        }
+        continue;
+      }
+      Displacement<Frame> const Δq = node.centre_of_mass - q;
+      R3Element<Length> const from_centre = (q - node.centre).coordinates();
+      bool const contains_body = Abs(from_centre.x) <= node.half_side &&
+                                 Abs(from_centre.y) <= node.half_side &&
+                                 Abs(from_centre.z) <= node.half_side;
+      if (!contains_body &&
+          4 * node.half_side * node.half_side <
+              opening_angle² * InnerProduct(Δq, Δq)) {
+        a += PointMassAcceleration(Δq, node.gravitational_parameter);
+      } else {
+        for (int child = node.children_begin;
+             child < node.children_end;
+             ++child) {
+          stack_.push_back(child);
+        }
+      }
+    }
+    accelerations[begin + b] += a;
+  }
+}
+
+template<typename Frame>
+int BarnesHutGravitation<Frame>::number_of_dominant_bodies() const {
+  return dominant_bodies_.size();
+}
+
+template<typename Frame>
+void BarnesHutGravitation<Frame>::Subdivide(
+    int const node,
+    int const depth,
+    std::vector<Position<Frame>> const& positions,
+    int const begin) {
+  // Note that |nodes_| may be reallocated below, so we don't keep references
+  // to its elements.
+  int const bodies_begin = nodes_[node].bodies_begin;
+  int const bodies_end = nodes_[node].bodies_end;
+  Position<Frame> const centre = nodes_[node].centre;
+  Length const half_side = nodes_[node].half_side;
+
+  GravitationalParameter μ;
+  Vector<Product<Length, GravitationalParameter>, Frame> weighted_sum;
+  for (int i = bodies_begin; i < bodies_end; ++i) {
+    int const b = octree_bodies_[i];
+    μ += gravitational_parameters_[b];
+    weighted_sum +=
+        (positions[begin + b] - Frame::origin) * gravitational_parameters_[b];
+  }
+  nodes_[node].gravitational_parameter = μ;
+  nodes_[node].centre_of_mass =
+      μ == GravitationalParameter() ? centre
+                                    : Frame::origin + weighted_sum / μ;
+
+  if (bodies_end - bodies_begin <= max_bodies_per_leaf || depth == max_depth) {
+    return;
+  }
+
+  // Partition the bodies in octants, successively along x, y and z.  After
+  // this, the bodies in octant o are in |[boundaries[o], boundaries[o + 1])|,
+  // where the bits of o indicate the side of the centre along x, y and z.
+  std::array<int, 9> boundaries;
+  boundaries[0] = bodies_begin;
+  boundaries[8] = bodies_end;
+  auto const partition = [this, &positions, begin, &centre](
+                             int const first,
+                             int const last,
+                             int const coordinate) {
+    return static_cast<int>(
+        std::partition(
+            octree_bodies_.begin() + first,
+            octree_bodies_.begin() + last,
+            [&positions, begin, &centre, coordinate](int const b) {
+              return (positions[begin + b] - centre).coordinates()[coordinate] <
+                     Length();
+            }) -
+        octree_bodies_.begin());
+  };
+  boundaries[4] = partition(boundaries[0], boundaries[8], /*coordinate=*/0);
+  for (int x = 0; x < 8; x += 4) {
+    boundaries[x + 2] =
+        partition(boundaries[x], boundaries[x + 4], /*coordinate=*/1);
+    for (int y = x; y < x + 4; y += 2) {
+      boundaries[y + 1] =
+          partition(boundaries[y], boundaries[y + 2], /*coordinate=*/2);
+    }
+  }
+
+  // Create the non-empty children, contiguously, and then subdivide them.
+  int const children_begin = nodes_.size();
+  Length const child_half_side = half_side / 2;
+  for (int octant = 0; octant < 8; ++octant) {
+    if (boundaries[octant] == boundaries[octant + 1]) {
+      continue;
+    }
+    nodes_.emplace_back();
+    Node& child = nodes_.back();
+    child.centre =
+        centre +
+        Displacement<Frame>({(octant & 4 ? 1 : -1) * child_half_side,
+                             (octant & 2 ? 1 : -1) * child_half_side,
+                             (octant & 1 ? 1 : -1) * child_half_side});
+    child.half_side = child_half_side;
+    child.bodies_begin = boundaries[octant];
+    child.bodies_end = boundaries[octant + 1];
+  }
+  int const children_end = nodes_.size();
+  nodes_[node].children_begin = children_begin;
+  nodes_[node].children_end = children_end;
+  for (int child = children_begin; child < children_end; ++child) {
+    Subdivide(child, depth + 1, positions, begin);
+  }
+}
+
+}  // namespace internal_barnes_hut_gravitation
+}  // namespace physics
+}  // namespace principia
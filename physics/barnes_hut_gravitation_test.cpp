@@ -0,0 +1,216 @@
+﻿
+#include "physics/barnes_hut_gravitation.hpp"
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "geometry/frame.hpp"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "quantities/elementary_functions.hpp"
+#include "quantities/si.hpp"
+#include "testing_utilities/numerics.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_barnes_hut_gravitation {
+
+using geometry::Displacement;
+using geometry::InnerProduct;
+using quantities::Exponentiation;
+using quantities::Length;
+using quantities::Pow;
+using quantities::Sqrt;
+using quantities::Square;
+using quantities::si::Metre;
+using quantities::si::Second;
+using testing_utilities::RelativeError;
+using ::testing::Eq;
+using ::testing::Lt;
+
+class BarnesHutGravitationTest : public ::testing::Test {
+ protected:
+  using World = geometry::Frame<serialization::Frame::TestTag,
+                                serialization::Frame::TEST,
+                                /*frame_is_inertial=*/true>;
+
+  BarnesHutGravitationTest() {
+    // A star and a few planets, followed by a belt of asteroids.
+    std::mt19937_64 random(42);
+    std::uniform_real_distribution<> planet_μ_distribution(1e14, 1e17);
+    std::uniform_real_distribution<> asteroid_μ_distribution(1e5, 1e10);
+    std::uniform_real_distribution<> planet_distance_distribution(5e10, 5e12);
+    std::uniform_real_distribution<> belt_distribution(-1, 1);
+    gravitational_parameters_.push_back(1e20 * Pow<3>(Metre) / Pow<2>(Second));
+    positions_.push_back(World::origin);
+    for (int i = 0; i < number_of_planets; ++i) {
+      gravitational_parameters_.push_back(
+          planet_μ_distribution(random) * Pow<3>(Metre) / Pow<2>(Second));
+      positions_.push_back(
+          World::origin +
+          Displacement<World>({planet_distance_distribution(random) * Metre,
+                               planet_distance_distribution(random) * Metre,
+                               0 * Metre}));
+    }
+    for (int i = 0; i < number_of_asteroids; ++i) {
+      gravitational_parameters_.push_back(
+          asteroid_μ_distribution(random) * Pow<3>(Metre) / Pow<2>(Second));
+      positions_.push_back(
+          World::origin +
+          Displacement<World>(
+              {(4e11 + 1e11 * belt_distribution(random)) * Metre,
+               (4e11 + 1e11 * belt_distribution(random)) * Metre,
+               1e10 * belt_distribution(random) * Metre}));
+    }
+    expected_accelerations_ =
+        ComputeExpectedAccelerations(gravitational_parameters_, positions_);
+  }
+
+  // The straightforward computation, as done by the scalar path of
+  // |Ephemeris|.
+  static std::vector<Vector<Acceleration, World>> ComputeExpectedAccelerations(
+      std::vector<GravitationalParameter> const& gravitational_parameters,
+      std::vector<Position<World>> const& positions) {
+    std::vector<Vector<Acceleration, World>> accelerations(positions.size());
+    for (int b1 = 0; b1 < positions.size(); ++b1) {
+      for (int b2 = b1 + 1; b2 < positions.size(); ++b2) {
+        Displacement<World> const Δq = positions[b1] - positions[b2];
+        Square<Length> const Δq_squared = InnerProduct(Δq, Δq);
+        Exponentiation<Length, -3> const one_over_Δq_cubed =
+            Sqrt(Δq_squared) / (Δq_squared * Δq_squared);
+        accelerations[b2] +=
+            Δq * gravitational_parameters[b1] * one_over_Δq_cubed;
+        accelerations[b1] -=
+            Δq * gravitational_parameters[b2] * one_over_Δq_cubed;
+      }
+    }
+    return accelerations;
+  }
+
+  // Returns the largest relative error on the acceleration of a dominant body
+  // and of a minor body, respectively.
+  std::pair<double, double> MaxRelativeErrors(
+      std::vector<Vector<Acceleration, World>> const& accelerations) {
+    double max_dominant_error = 0;
+    double max_minor_error = 0;
+    for (int i = 0; i < positions_.size(); ++i) {
+      double const error =
+          RelativeError(expected_accelerations_[i], accelerations[i]);
+      if (i <= number_of_planets) {
+        max_dominant_error = std::max(max_dominant_error, error);
+      } else {
+        max_minor_error = std::max(max_minor_error, error);
+      }
+    }
+    return {max_dominant_error, max_minor_error};
+  }
+
+  static int constexpr number_of_planets = 5;
+  static int constexpr number_of_asteroids = 500;
+  GravitationalParameter const dominant_gravitational_parameter_ =
+      1e13 * Pow<3>(Metre) / Pow<2>(Second);
+
+  std::vector<GravitationalParameter> gravitational_parameters_;
+  std::vector<Position<World>> positions_;
+  std::vector<Vector<Acceleration, World>> expected_accelerations_;
+};
+
+int constexpr BarnesHutGravitationTest::number_of_planets;
+int constexpr BarnesHutGravitationTest::number_of_asteroids;
+
+// With a zero opening angle the cells are never approximated.
+TEST_F(BarnesHutGravitationTest, Exact) {
+  BarnesHutGravitation<World> gravitation(gravitational_parameters_,
+                                          dominant_gravitational_parameter_,
+                                          /*opening_angle=*/0);
+  EXPECT_EQ(number_of_planets + 1, gravitation.number_of_dominant_bodies());
+  std::vector<Vector<Acceleration, World>> accelerations(positions_.size());
+  gravitation.AddAccelerations(positions_, /*begin=*/0, accelerations);
+  auto const errors = MaxRelativeErrors(accelerations);
+  EXPECT_THAT(errors.first, Lt(1e-14));
+  EXPECT_THAT(errors.second, Lt(1e-14));
+}
+
+TEST_F(BarnesHutGravitationTest, Approximate) {
+  BarnesHutGravitation<World> gravitation(gravitational_parameters_,
+                                          dominant_gravitational_parameter_,
+                                          /*opening_angle=*/0.5);
+  std::vector<Vector<Acceleration, World>> accelerations(positions_.size());
+  gravitation.AddAccelerations(positions_, /*begin=*/0, accelerations);
+  auto const errors = MaxRelativeErrors(accelerations);
+  // The accelerations of the dominant bodies are computed exactly.  Those of
+  // the asteroids are dominated by the star and the planets, so the
+  // approximation barely matters.
+  EXPECT_THAT(errors.first, Lt(1e-14));
+  EXPECT_THAT(errors.second, Lt(1e-7));
+
+  // Computing again yields the same results.
+  std::vector<Vector<Acceleration, World>> accelerations2(positions_.size());
+  gravitation.AddAccelerations(positions_, /*begin=*/0, accelerations2);
+  EXPECT_THAT(accelerations2, Eq(accelerations));
+}
+
+// The error of the approximation of the mutual accelerations of the asteroids.
+TEST_F(BarnesHutGravitationTest, MinorBodiesOnly) {
+  std::vector<GravitationalParameter> const gravitational_parameters(
+      gravitational_parameters_.begin() + number_of_planets + 1,
+      gravitational_parameters_.end());
+  std::vector<Position<World>> const positions(
+      positions_.begin() + number_of_planets + 1, positions_.end());
+  auto const expected_accelerations =
+      ComputeExpectedAccelerations(gravitational_parameters, positions);
+
+  // The largest errors are for the asteroids whose acceleration nearly
+  // cancels out.
+  std::vector<std::pair<double, double>> const
+      opening_angles_and_max_errors = {{0.25, 1e-2}, {0.5, 1e-1}, {1.0, 1}};
+  for (auto const& pair : opening_angles_and_max_errors) {
+    double const opening_angle = pair.first;
+    BarnesHutGravitation<World> gravitation(gravitational_parameters,
+                                            dominant_gravitational_parameter_,
+                                            opening_angle);
+    EXPECT_EQ(0, gravitation.number_of_dominant_bodies());
+    std::vector<Vector<Acceleration, World>> accelerations(positions.size());
+    gravitation.AddAccelerations(positions, /*begin=*/0, accelerations);
+    double max_error = 0;
+    for (int i = 0; i < positions.size(); ++i) {
+      max_error = std::max(max_error,
+                           RelativeError(expected_accelerations[i],
+                                         accelerations[i]));
+    }
+    EXPECT_THAT(max_error, Lt(pair.second)) << opening_angle;
+  }
+}
+
+// The accelerations are added to the ones already present, and the bodies
+// before |begin| are ignored.
+TEST_F(BarnesHutGravitationTest, Offset) {
+  Vector<Acceleration, World> const offset_acceleration(
+      {1e-5 * Metre / Pow<2>(Second),
+       2e-5 * Metre / Pow<2>(Second),
+       3e-5 * Metre / Pow<2>(Second)});
+  std::vector<Position<World>> offset_positions(3, World::origin);
+  offset_positions.insert(
+      offset_positions.end(), positions_.begin(), positions_.end());
+  std::vector<Vector<Acceleration, World>> accelerations(
+      positions_.size() + 3, offset_acceleration);
+
+  BarnesHutGravitation<World> gravitation(gravitational_parameters_,
+                                          dominant_gravitational_parameter_,
+                                          /*opening_angle=*/0);
+  gravitation.AddAccelerations(offset_positions, /*begin=*/3, accelerations);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(offset_acceleration, accelerations[i]);
+  }
+  for (int i = 0; i < positions_.size(); ++i) {
+    EXPECT_THAT(RelativeError(expected_accelerations_[i] + offset_acceleration,
+                              accelerations[i + 3]),
+                Lt(1e-14)) << i;
+  }
+}
+
+}  // namespace internal_barnes_hut_gravitation
+}  // namespace physics
+}  // namespace principia
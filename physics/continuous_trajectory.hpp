@@ -1,7 +1,9 @@
 ﻿
 #pragma once
 
+#include <experimental/filesystem>
 #include <experimental/optional>
+#include <memory>
 #include <vector>
 #include <utility>
 
@@ -9,6 +11,7 @@
 #include "geometry/named_quantities.hpp"
 #include "numerics/чебышёв_series.hpp"
 #include "physics/degrees_of_freedom.hpp"
+#include "physics/series_store.hpp"
 #include "quantities/quantities.hpp"
 #include "serialization/physics.pb.h"
 
@@ -77,9 +80,43 @@ class ContinuousTrajectory {
   Status Append(Instant const& time,
                 DegreesOfFreedom<Frame> const& degrees_of_freedom);
 
+  // Returns true iff the next call to |Append| will fit a new series, which is
+  // much more expensive than just recording a point.
+  bool next_append_fits() const;
+
   // Removes all data for times strictly less than |time|.
   void ForgetBefore(Instant const& time);
 
+  // From now on, keeps at most |2 * max_series_in_memory| series in memory:
+  // the older series are moved to a |SeriesStore| in a file at |path|, from
+  // which they are read back when the trajectory is evaluated at their times.
+  // This bounds the memory used by a long trajectory, at the cost of slower
+  // evaluation in the distant past.  The file is deleted when this object is
+  // destroyed.  The store is not serialized, and it is not used by the
+  // continuations.  There must not be a store already.
+  void SetSeriesStore(std::experimental::filesystem::path const& path,
+                      int max_series_in_memory);
+
+  // Returns a trajectory that continues this one: points may be appended to it
+  // as if they were appended to this trajectory, but independently of it, e.g.,
+  // on another thread.  The series constructed by the continuation are then
+  // transferred to this trajectory by |Splice|.  The continuation should not be
+  // used for anything else, and in particular it should not be evaluated.
+  not_null<std::unique_ptr<ContinuousTrajectory>> NewContinuation() const;
+
+  // Appends to this trajectory the series constructed by |continuation| since
+  // it was created or last spliced, and updates the state of this trajectory so
+  // that the next point appended is the one that would be appended to the
+  // |continuation|.  |continuation| must have been returned by
+  // |NewContinuation| on this object, and no points must have been appended to
+  // this object since then.  The |continuation| remains usable.
+  void Splice(ContinuousTrajectory& continuation);
+
+  // Returns true iff |continuation| may be passed to |Splice|.  Only checks
+  // that the parameters match and that the series join, so that a
+  // deserialized continuation may be validated.
+  bool CanSplice(ContinuousTrajectory const& continuation) const;
+
   // Evaluates the trajectory at the given |time|, which must be in
   // [t_min(), t_max()].  The |hint| may be used to speed up evaluation
   // in increasing time order.  It may be a nullptr (in which case no speed-up
@@ -91,6 +128,11 @@ class ContinuousTrajectory {
   virtual DegreesOfFreedom<Frame> EvaluateDegreesOfFreedom(Instant const& time,
                                                            Hint* hint) const;
 
+  // The series in memory, in increasing time order, for the clients that
+  // evaluate several trajectories together.  Invalidated by the functions that
+  // modify this object.
+  std::vector<ЧебышёвSeries<Displacement<Frame>>> const& series() const;
+
   // Returns a checkpoint for the current state of this object.
   Checkpoint GetCheckpoint() const;
 
@@ -101,6 +143,13 @@ class ContinuousTrajectory {
   // taken.
   void WriteToMessage(not_null<serialization::ContinuousTrajectory*> message,
                       Checkpoint const& checkpoint) const;
+  // Serializes the current state of this object as a continuation (see
+  // |NewContinuation|) of the state that existed when the checkpoint was
+  // taken.  The result of |ReadFromMessage| may be spliced into a trajectory
+  // deserialized from the message written for |checkpoint|.
+  void WriteContinuationToMessage(
+      not_null<serialization::ContinuousTrajectory*> message,
+      Checkpoint const& checkpoint) const;
   static not_null<std::unique_ptr<ContinuousTrajectory>> ReadFromMessage(
       serialization::ContinuousTrajectory const& message);
 
@@ -161,7 +210,9 @@ class ContinuousTrajectory {
 
   // Returns an iterator to the series applicable for the given |time|, or
   // |begin()| if |time| is before the first series or |end()| if |time| is
-  // after the last series.  Time complexity is O(N Log N).
+  // after the last series.  Time complexity is O(1) for a |time| within the
+  // trajectory, O(Log N) otherwise.  Only looks at the series in memory, see
+  // |IsInSeriesStore|.
   typename std::vector<ЧебышёвSeries<Displacement<Frame>>>::const_iterator
   FindSeriesForInstant(Instant const& time) const;
 
@@ -169,6 +220,37 @@ class ContinuousTrajectory {
   // |hint->index| is the index of the series to use.
   bool MayUseHint(Instant const& time, Hint* hint) const;
 
+  // Returns true if the series applicable for the given |time| is in the
+  // |series_store_| rather than in |series_|.
+  bool IsInSeriesStore(Instant const& time) const;
+
+  // Returns the series in the |series_store_| applicable for the given |time|,
+  // for which |IsInSeriesStore| must be true.  The series is only decoded if
+  // it is not the |last_series_from_store_|.
+  std::shared_ptr<ЧебышёвSeries<Displacement<Frame>> const> GetSeriesFromStore(
+      Instant const& time) const;
+
+  // Moves the older series to the |series_store_|, if any, so that at most
+  // |max_series_in_memory_| remain in |series_|.  Only does so when there are
+  // twice that many, to amortize the cost of erasing from |series_|.
+  void SpillSeriesToStore();
+
+  // Calls |f| for each series, including those in the |series_store_|, in
+  // increasing time order, until it returns false.
+  template<typename F>
+  void ForEachSeries(F const& f) const;
+
+  // Same as above, but starting with the first series whose |t_max| is at
+  // least |time|.  The earlier series of the |series_store_| are not decoded.
+  template<typename F>
+  void ForEachSeriesFrom(Instant const& time, F const& f) const;
+
+  // Writes to |message| the construction parameters and the state recorded in
+  // |checkpoint|, but no series.
+  void WriteStateToMessage(
+      not_null<serialization::ContinuousTrajectory*> message,
+      Checkpoint const& checkpoint) const;
+
   // Construction parameters;
   Time const step_;
   Length const tolerance_;
@@ -184,8 +266,21 @@ class ContinuousTrajectory {
   int degree_age_;
 
   // The series are in increasing time order.  Their intervals are consecutive.
+  // If there is a |series_store_|, the older series are there, and the series
+  // in |series_| follow them.
   std::vector<ЧебышёвSeries<Displacement<Frame>>> series_;
 
+  // Null unless |SetSeriesStore| was called.  If nonempty, |series_| is
+  // nonempty.
+  std::unique_ptr<SeriesStore<Frame>> series_store_;
+  int max_series_in_memory_ = 0;
+  // The series most recently decoded by |GetSeriesFromStore|, which is likely
+  // to be needed again since evaluations tend to be close in time.  Only
+  // accessed with |std::atomic_load| and |std::atomic_store| since the
+  // evaluations may happen concurrently.
+  mutable std::shared_ptr<ЧебышёвSeries<Displacement<Frame>> const>
+      last_series_from_store_;
+
   // The time at which this trajectory starts.  Set for a nonempty trajectory.
   // |*first_time_ >= series_.front().t_min()|
   std::experimental::optional<Instant> first_time_;
@@ -2,6 +2,8 @@
 #pragma once
 
 #include <algorithm>
+#include <cmath>
+#include <iterator>
 #include <limits>
 #include <sstream>
 #include <utility>
@@ -18,6 +20,7 @@ namespace physics {
 namespace internal_continuous_trajectory {
 
 using base::Error;
+using base::make_not_null_unique;
 using numerics::ULPDistance;
 using quantities::DebugString;
 using quantities::SIUnit;
@@ -73,7 +76,14 @@ double ContinuousTrajectory<Frame>::average_degree() const {
     for (auto const& series : series_) {
       total += series.degree();
     }
-    return total / series_.size();
+    int size = series_.size();
+    if (series_store_ != nullptr) {
+      for (int i = 0; i < series_store_->size(); ++i) {
+        total += series_store_->degree(i);
+      }
+      size += series_store_->size();
+    }
+    return total / size;
   }
 }
 
@@ -96,9 +106,11 @@ Status ContinuousTrajectory<Frame>::Append(
   Status status;
   if (last_points_.size() == divisions) {
     // These vectors are static to avoid deallocation/reallocation each time we
-    // go through this code path.
-    static std::vector<Displacement<Frame>> q(divisions + 1);
-    static std::vector<Velocity<Frame>> v(divisions + 1);
+    // go through this code path.  They are thread-local because a continuation
+    // may be appended to on a different thread, and because the ephemeris may
+    // fit several trajectories concurrently.
+    thread_local std::vector<Displacement<Frame>> q(divisions + 1);
+    thread_local std::vector<Velocity<Frame>> v(divisions + 1);
     q.clear();
     v.clear();
 
@@ -112,6 +124,7 @@ Status ContinuousTrajectory<Frame>::Append(
 
     status = ComputeBestNewhallApproximation(
         time, q, v, &ЧебышёвSeries<Displacement<Frame>>::NewhallApproximation);
+    SpillSeriesToStore();
 
     // Wipe-out the points that have just been incorporated in a series.
     last_points_.clear();
@@ -125,6 +138,11 @@ Status ContinuousTrajectory<Frame>::Append(
   return status;
 }
 
+template<typename Frame>
+bool ContinuousTrajectory<Frame>::next_append_fits() const {
+  return last_points_.size() == divisions;
+}
+
 template<typename Frame>
 void ContinuousTrajectory<Frame>::ForgetBefore(Instant const& time) {
   if (time < t_min()) {
@@ -132,6 +150,14 @@ void ContinuousTrajectory<Frame>::ForgetBefore(Instant const& time) {
     // |FindSeriesForInstant|.
     return;
   }
+  if (series_store_ != nullptr && !series_store_->empty()) {
+    if (IsInSeriesStore(time)) {
+      series_store_->ForgetFirst(series_store_->FindIndexForInstant(time));
+      first_time_ = time;
+      return;
+    }
+    series_store_->ForgetFirst(series_store_->size());
+  }
   series_.erase(series_.begin(), FindSeriesForInstant(time));
 
   // If there are no |series_| left, clear everything.  Otherwise, update the
@@ -144,13 +170,84 @@ void ContinuousTrajectory<Frame>::ForgetBefore(Instant const& time) {
   }
 }
 
+template<typename Frame>
+void ContinuousTrajectory<Frame>::SetSeriesStore(
+    std::experimental::filesystem::path const& path,
+    int const max_series_in_memory) {
+  CHECK(series_store_ == nullptr);
+  CHECK_LE(1, max_series_in_memory);
+  series_store_ = std::make_unique<SeriesStore<Frame>>(path, max_degree);
+  max_series_in_memory_ = max_series_in_memory;
+  SpillSeriesToStore();
+}
+
+template<typename Frame>
+not_null<std::unique_ptr<ContinuousTrajectory<Frame>>>
+ContinuousTrajectory<Frame>::NewContinuation() const {
+  auto continuation =
+      make_not_null_unique<ContinuousTrajectory<Frame>>(step_, tolerance_);
+  continuation->adjusted_tolerance_ = adjusted_tolerance_;
+  continuation->is_unstable_ = is_unstable_;
+  continuation->degree_ = degree_;
+  continuation->degree_age_ = degree_age_;
+  // The continuation keeps a copy of our last series so that its |t_max| is
+  // meaningful, e.g., for checkpointing.
+  if (!series_.empty()) {
+    continuation->series_.push_back(series_.back());
+  }
+  continuation->first_time_ = first_time_;
+  continuation->last_points_ = last_points_;
+  return continuation;
+}
+
+template<typename Frame>
+void ContinuousTrajectory<Frame>::Splice(ContinuousTrajectory& continuation) {
+  CHECK(CanSplice(continuation)) << "Not a continuation of this trajectory";
+  auto first_new_series = continuation.series_.begin();
+  if (!series_.empty()) {
+    ++first_new_series;
+  }
+  if (first_new_series != continuation.series_.end()) {
+    // Move all the new series except the last one, which must remain in the
+    // continuation.
+    std::move(first_new_series,
+              continuation.series_.end() - 1,
+              std::back_inserter(series_));
+    series_.push_back(continuation.series_.back());
+    continuation.series_.erase(continuation.series_.begin(),
+                               continuation.series_.end() - 1);
+    SpillSeriesToStore();
+  }
+  adjusted_tolerance_ = continuation.adjusted_tolerance_;
+  is_unstable_ = continuation.is_unstable_;
+  degree_ = continuation.degree_;
+  degree_age_ = continuation.degree_age_;
+  if (!first_time_) {
+    first_time_ = continuation.first_time_;
+  }
+  last_points_ = continuation.last_points_;
+}
+
+template<typename Frame>
+bool ContinuousTrajectory<Frame>::CanSplice(
+    ContinuousTrajectory const& continuation) const {
+  if (step_ != continuation.step_ || tolerance_ != continuation.tolerance_) {
+    return false;
+  }
+  return series_.empty() ||
+         (!continuation.series_.empty() &&
+          series_.back() == continuation.series_.front());
+}
+
 template<typename Frame>
 Position<Frame> ContinuousTrajectory<Frame>::EvaluatePosition(
     Instant const& time,
     Hint* const hint) const {
   CHECK_LE(t_min(), time);
   CHECK_GE(t_max(), time);
-  if (MayUseHint(time, hint)) {
+  if (IsInSeriesStore(time)) {
+    return GetSeriesFromStore(time)->Evaluate(time) + Frame::origin;
+  } else if (MayUseHint(time, hint)) {
     return series_[hint->index_].Evaluate(time) + Frame::origin;
   } else {
     auto const it = FindSeriesForInstant(time);
@@ -168,7 +265,9 @@ Velocity<Frame> ContinuousTrajectory<Frame>::EvaluateVelocity(
     Hint* const hint) const {
   CHECK_LE(t_min(), time);
   CHECK_GE(t_max(), time);
-  if (MayUseHint(time, hint)) {
+  if (IsInSeriesStore(time)) {
+    return GetSeriesFromStore(time)->EvaluateDerivative(time);
+  } else if (MayUseHint(time, hint)) {
     return series_[hint->index_].EvaluateDerivative(time);
   } else {
     auto const it = FindSeriesForInstant(time);
@@ -186,21 +285,35 @@ DegreesOfFreedom<Frame> ContinuousTrajectory<Frame>::EvaluateDegreesOfFreedom(
     Hint* const hint) const {
   CHECK_LE(t_min(), time);
   CHECK_GE(t_max(), time);
-  if (MayUseHint(time, hint)) {
-    ЧебышёвSeries<Displacement<Frame>> const& series = series_[hint->index_];
-    return DegreesOfFreedom<Frame>(series.Evaluate(time) + Frame::origin,
-                                   series.EvaluateDerivative(time));
+  // The position and the velocity are obtained in a single pass over the
+  // coefficients of the series.
+  auto const evaluate =
+      [&time](ЧебышёвSeries<Displacement<Frame>> const& series) {
+        Displacement<Frame> displacement;
+        Velocity<Frame> velocity;
+        series.EvaluateWithDerivative(time, displacement, velocity);
+        return DegreesOfFreedom<Frame>(displacement + Frame::origin, velocity);
+      };
+  if (IsInSeriesStore(time)) {
+    return evaluate(*GetSeriesFromStore(time));
+  } else if (MayUseHint(time, hint)) {
+    return evaluate(series_[hint->index_]);
   } else {
     auto const it = FindSeriesForInstant(time);
     CHECK(it != series_.end());
     if (hint != nullptr) {
       hint->index_ = it - series_.cbegin();
     }
-    return DegreesOfFreedom<Frame>(it->Evaluate(time) + Frame::origin,
-                                   it->EvaluateDerivative(time));
+    return evaluate(*it);
   }
 }
 
+template<typename Frame>
+std::vector<ЧебышёвSeries<Displacement<Frame>>> const&
+ContinuousTrajectory<Frame>::series() const {
+  return series_;
+}
+
 template<typename Frame>
 typename ContinuousTrajectory<Frame>::Checkpoint
 ContinuousTrajectory<Frame>::GetCheckpoint() const {
@@ -223,35 +336,31 @@ void ContinuousTrajectory<Frame>::WriteToMessage(
       not_null<serialization::ContinuousTrajectory*> const message,
       Checkpoint const& checkpoint) const {
   LOG(INFO) << __FUNCTION__;
-  step_.WriteToMessage(message->mutable_step());
-  tolerance_.WriteToMessage(message->mutable_tolerance());
-  checkpoint.adjusted_tolerance_.WriteToMessage(
-      message->mutable_adjusted_tolerance());
-  message->set_is_unstable(checkpoint.is_unstable_);
-  message->set_degree(checkpoint.degree_);
-  message->set_degree_age(checkpoint.degree_age_);
-  for (auto const& s : series_) {
-    if (s.t_max() <= checkpoint.t_max_) {
-      s.WriteToMessage(message->add_series());
-    }
-    if (s.t_max() == checkpoint.t_max_) {
-      break;
-    }
-    CHECK_LT(s.t_max(), checkpoint.t_max_);
-  }
-  if (first_time_) {
-    first_time_->WriteToMessage(message->mutable_first_time());
-  }
-  for (auto const& pair : checkpoint.last_points_) {
-    Instant const& instant = pair.first;
-    DegreesOfFreedom<Frame> const& degrees_of_freedom = pair.second;
-    not_null<
-        serialization::ContinuousTrajectory::InstantaneousDegreesOfFreedom*>
-        const instantaneous_degrees_of_freedom = message->add_last_point();
-    instant.WriteToMessage(instantaneous_degrees_of_freedom->mutable_instant());
-    degrees_of_freedom.WriteToMessage(
-        instantaneous_degrees_of_freedom->mutable_degrees_of_freedom());
-  }
+  WriteStateToMessage(message, checkpoint);
+  ForEachSeries([message, &checkpoint](
+                    ЧебышёвSeries<Displacement<Frame>> const& s) {
+    CHECK_LE(s.t_max(), checkpoint.t_max_);
+    s.WriteToMessage(message->add_series());
+    return s.t_max() < checkpoint.t_max_;
+  });
+  LOG(INFO) << NAMED(this);
+  LOG(INFO) << NAMED(message->SpaceUsed());
+  LOG(INFO) << NAMED(message->ByteSize());
+}
+
+template<typename Frame>
+void ContinuousTrajectory<Frame>::WriteContinuationToMessage(
+      not_null<serialization::ContinuousTrajectory*> const message,
+      Checkpoint const& checkpoint) const {
+  LOG(INFO) << __FUNCTION__;
+  WriteStateToMessage(message, GetCheckpoint());
+  // Like |NewContinuation|, include the last series of the checkpointed state
+  // so that |Splice| may check that the trajectories join.
+  ForEachSeriesFrom(checkpoint.t_max_,
+                    [message](ЧебышёвSeries<Displacement<Frame>> const& s) {
+                      s.WriteToMessage(message->add_series());
+                      return true;
+                    });
   LOG(INFO) << NAMED(this);
   LOG(INFO) << NAMED(message->SpaceUsed());
   LOG(INFO) << NAMED(message->ByteSize());
@@ -412,6 +521,31 @@ Status ContinuousTrajectory<Frame>::ComputeBestNewhallApproximation(
 template<typename Frame>
 typename std::vector<ЧебышёвSeries<Displacement<Frame>>>::const_iterator
 ContinuousTrajectory<Frame>::FindSeriesForInstant(Instant const& time) const {
+  // We want the first series |s| such that |time <= s.t_max()|.  The series
+  // are built from |divisions| equally spaced points, so they all have nearly
+  // the same duration, and we can compute the index of the desired series,
+  // except for rounding errors near the boundaries.
+  if (!series_.empty()) {
+    double const index =
+        std::floor((time - series_.front().t_min()) / (divisions * step_));
+    if (index >= 0 && index < series_.size()) {
+      auto it = series_.cbegin() + static_cast<int>(index);
+      // Handle the rounding errors by looking at the neighbours.
+      if (it->t_max() < time && it + 1 != series_.cend()) {
+        ++it;
+      } else if (it != series_.cbegin() && time <= (it - 1)->t_max()) {
+        --it;
+      }
+      if (time <= it->t_max() &&
+          (it == series_.cbegin() || (it - 1)->t_max() < time)) {
+        return it;
+      }
+    }
+  }
+
+  // The computed index was off, either because |time| is outside of the
+  // trajectory or because the durations of the series are irregular: use a
+  // binary search.
   // Need to use |lower_bound|, not |upper_bound|, because it allows
   // heterogeneous arguments.  This returns the first series |s| such that
   // |time <= s.t_max()|.
@@ -445,6 +579,104 @@ bool ContinuousTrajectory<Frame>::MayUseHint(Instant const& time,
   return false;
 }
 
+template<typename Frame>
+bool ContinuousTrajectory<Frame>::IsInSeriesStore(Instant const& time) const {
+  return series_store_ != nullptr && !series_store_->empty() &&
+         time <= series_store_->t_max(series_store_->size() - 1);
+}
+
+template<typename Frame>
+std::shared_ptr<ЧебышёвSeries<Displacement<Frame>> const>
+ContinuousTrajectory<Frame>::GetSeriesFromStore(Instant const& time) const {
+  // If |time| is the |t_min| of the last series, the applicable series is the
+  // previous one, so the interval is open on the left.
+  auto last_series = std::atomic_load(&last_series_from_store_);
+  if (last_series != nullptr &&
+      last_series->t_min() < time && time <= last_series->t_max()) {
+    return last_series;
+  }
+  last_series = std::make_shared<ЧебышёвSeries<Displacement<Frame>> const>(
+      series_store_->Get(series_store_->FindIndexForInstant(time)));
+  std::atomic_store(&last_series_from_store_, last_series);
+  return last_series;
+}
+
+template<typename Frame>
+void ContinuousTrajectory<Frame>::SpillSeriesToStore() {
+  if (series_store_ == nullptr ||
+      series_.size() <= 2 * max_series_in_memory_) {
+    return;
+  }
+  auto const first_kept = series_.end() - max_series_in_memory_;
+  for (auto it = series_.begin(); it != first_kept; ++it) {
+    series_store_->Append(*it);
+  }
+  series_.erase(series_.begin(), first_kept);
+}
+
+template<typename Frame>
+template<typename F>
+void ContinuousTrajectory<Frame>::ForEachSeries(F const& f) const {
+  if (series_store_ != nullptr) {
+    for (int i = 0; i < series_store_->size(); ++i) {
+      if (!f(series_store_->Get(i))) {
+        return;
+      }
+    }
+  }
+  for (auto const& s : series_) {
+    if (!f(s)) {
+      return;
+    }
+  }
+}
+
+template<typename Frame>
+template<typename F>
+void ContinuousTrajectory<Frame>::ForEachSeriesFrom(Instant const& time,
+                                                    F const& f) const {
+  if (series_store_ != nullptr) {
+    for (int i = series_store_->FindIndexForInstant(time);
+         i < series_store_->size();
+         ++i) {
+      if (!f(series_store_->Get(i))) {
+        return;
+      }
+    }
+  }
+  for (auto const& s : series_) {
+    if (s.t_max() >= time && !f(s)) {
+      return;
+    }
+  }
+}
+
+template<typename Frame>
+void ContinuousTrajectory<Frame>::WriteStateToMessage(
+    not_null<serialization::ContinuousTrajectory*> const message,
+    Checkpoint const& checkpoint) const {
+  step_.WriteToMessage(message->mutable_step());
+  tolerance_.WriteToMessage(message->mutable_tolerance());
+  checkpoint.adjusted_tolerance_.WriteToMessage(
+      message->mutable_adjusted_tolerance());
+  message->set_is_unstable(checkpoint.is_unstable_);
+  message->set_degree(checkpoint.degree_);
+  message->set_degree_age(checkpoint.degree_age_);
+  if (first_time_) {
+    first_time_->WriteToMessage(message->mutable_first_time());
+  }
+  for (auto const& pair : checkpoint.last_points_) {
+    Instant const& instant = pair.first;
+    DegreesOfFreedom<Frame> const& degrees_of_freedom = pair.second;
+    not_null<
+        serialization::ContinuousTrajectory::InstantaneousDegreesOfFreedom*>
+        const instantaneous_degrees_of_freedom = message->add_last_point();
+    instant.WriteToMessage(instantaneous_degrees_of_freedom->mutable_instant());
+    degrees_of_freedom.WriteToMessage(
+        instantaneous_degrees_of_freedom->mutable_degrees_of_freedom());
+  }
+}
+
 }  // namespace internal_continuous_trajectory
 }  // namespace physics
 }  // namespace principia
@@ -1,9 +1,11 @@
 ﻿
 #include "physics/continuous_trajectory.hpp"
 
+#include <algorithm>
 #include <deque>
 #include <functional>
 #include <limits>
+#include <random>
 #include <vector>
 
 #include "geometry/frame.hpp"
@@ -103,6 +105,24 @@ class ContinuousTrajectoryTest : public testing::Test {
     trajectory_->degree_age_ = std::numeric_limits<int>::max();
   }
 
+  std::vector<ЧебышёвSeries<Displacement<World>>> const& series() const {
+    return trajectory_->series_;
+  }
+
+  // Checks that |FindSeriesForInstant| agrees with a binary search.
+  void ExpectFindsSeriesForInstant(Instant const& time) {
+    auto const& series = trajectory_->series_;
+    auto const expected_it = std::lower_bound(
+        series.cbegin(), series.cend(), time,
+        [](ЧебышёвSeries<Displacement<World>> const& left,
+           Instant const& right) {
+          return left.t_max() < right;
+        });
+    EXPECT_EQ(expected_it - series.cbegin(),
+              trajectory_->FindSeriesForInstant(time) - series.cbegin())
+        << time;
+  }
+
   static std::deque<Displacement<World>>* error_estimates_;
   Instant const t0_;
   std::unique_ptr<ContinuousTrajectory<World>> trajectory_;
@@ -539,6 +559,220 @@ TEST_F(ContinuousTrajectoryTest, Checkpoint) {
   }
 }
 
+TEST_F(ContinuousTrajectoryTest, Continuation) {
+  int const number_of_steps1 = 30;
+  int const number_of_steps2 = 40;
+  int const number_of_steps3 = 25;
+  int const number_of_substeps = 50;
+  Time const step = 0.01 * Second;
+  Length const tolerance = 0.1 * Metre;
+
+  auto position_function =
+      [this](Instant const t) {
+        return World::origin +
+            Displacement<World>({(t - t0_) * 3 * Metre / Second,
+                                 (t - t0_) * 5 * Metre / Second,
+                                 (t - t0_) * (-2) * Metre / Second});
+      };
+  auto velocity_function =
+      [](Instant const t) {
+        return Velocity<World>({3 * Metre / Second,
+                                5 * Metre / Second,
+                                -2 * Metre / Second});
+      };
+  auto fill = [this, step, &position_function, &velocity_function](
+                  int const first_step,
+                  int const last_step,
+                  ContinuousTrajectory<World>& trajectory) {
+    for (int i = first_step; i < last_step; ++i) {
+      Instant const ti = t0_ + (i + 1) * step;
+      trajectory.Append(ti,
+                        DegreesOfFreedom<World>(position_function(ti),
+                                                velocity_function(ti)));
+    }
+  };
+
+  // The reference trajectory, filled directly.
+  auto const expected_trajectory =
+      std::make_unique<ContinuousTrajectory<World>>(step, tolerance);
+  fill(0,
+       number_of_steps1 + number_of_steps2 + number_of_steps3,
+       *expected_trajectory);
+
+  // Fill the trajectory, then fill a continuation and splice it, twice.
+  trajectory_ = std::make_unique<ContinuousTrajectory<World>>(step, tolerance);
+  fill(0, number_of_steps1, *trajectory_);
+  Instant const t_max1 = trajectory_->t_max();
+  auto const continuation = trajectory_->NewContinuation();
+  fill(number_of_steps1, number_of_steps1 + number_of_steps2, *continuation);
+  EXPECT_EQ(t_max1, trajectory_->t_max());
+  trajectory_->Splice(*continuation);
+  EXPECT_EQ(continuation->t_max(), trajectory_->t_max());
+  EXPECT_LT(t_max1, trajectory_->t_max());
+  fill(number_of_steps1 + number_of_steps2,
+       number_of_steps1 + number_of_steps2 + number_of_steps3,
+       *continuation);
+  trajectory_->Splice(*continuation);
+
+  EXPECT_EQ(expected_trajectory->t_min(), trajectory_->t_min());
+  EXPECT_EQ(expected_trajectory->t_max(), trajectory_->t_max());
+  for (Instant time = trajectory_->t_min();
+       time <= trajectory_->t_max();
+       time += step / number_of_substeps) {
+    EXPECT_EQ(
+        expected_trajectory->EvaluateDegreesOfFreedom(time, /*hint=*/nullptr),
+        trajectory_->EvaluateDegreesOfFreedom(time, /*hint=*/nullptr));
+  }
+
+  // Appending to the spliced trajectory is the same as appending to the
+  // reference trajectory.
+  int const end = number_of_steps1 + number_of_steps2 + number_of_steps3;
+  fill(end, end + 20, *expected_trajectory);
+  fill(end, end + 20, *trajectory_);
+  EXPECT_EQ(expected_trajectory->t_max(), trajectory_->t_max());
+  serialization::ContinuousTrajectory expected_message;
+  expected_trajectory->WriteToMessage(&expected_message);
+  serialization::ContinuousTrajectory message;
+  trajectory_->WriteToMessage(&message);
+  EXPECT_EQ(expected_message.SerializeAsString(), message.SerializeAsString());
+}
+
+// A trajectory whose older series are in a |SeriesStore| behaves like one that
+// keeps them in memory.
+TEST_F(ContinuousTrajectoryTest, SeriesStore) {
+  int const number_of_steps = 300;
+  int const number_of_substeps = 7;
+  Length const radius = 421700 * Kilo(Metre);
+  Time const period = 152853.5047 * Second;
+  Time const step = 3600 * Second;
+  AngularFrequency const ω = 2 * π * Radian / period;
+
+  auto fill = [this, step, radius, ω](
+                  int const first_step,
+                  int const last_step,
+                  ContinuousTrajectory<World>& trajectory) {
+    for (int i = first_step; i < last_step; ++i) {
+      Instant const ti = t0_ + (i + 1) * step;
+      Angle const angle = ω * (ti - t0_);
+      trajectory.Append(
+          ti,
+          DegreesOfFreedom<World>(
+              World::origin + Displacement<World>({radius * Cos(angle),
+                                                   radius * Sin(angle),
+                                                   0 * Metre}),
+              Velocity<World>({-ω * radius * Sin(angle) / Radian,
+                               ω * radius * Cos(angle) / Radian,
+                               0 * Metre / Second})));
+    }
+  };
+  auto expect_same_trajectories = [number_of_substeps, step](
+      ContinuousTrajectory<World> const& expected,
+      ContinuousTrajectory<World> const& actual) {
+    EXPECT_EQ(expected.t_min(), actual.t_min());
+    EXPECT_EQ(expected.t_max(), actual.t_max());
+    EXPECT_EQ(expected.average_degree(), actual.average_degree());
+    ContinuousTrajectory<World>::Hint expected_hint;
+    ContinuousTrajectory<World>::Hint actual_hint;
+    for (Instant time = expected.t_min();
+         time <= expected.t_max();
+         time += step / number_of_substeps) {
+      EXPECT_EQ(expected.EvaluateDegreesOfFreedom(time, &expected_hint),
+                actual.EvaluateDegreesOfFreedom(time, &actual_hint));
+      EXPECT_EQ(expected.EvaluatePosition(time, /*hint=*/nullptr),
+                actual.EvaluatePosition(time, /*hint=*/nullptr));
+      EXPECT_EQ(expected.EvaluateVelocity(time, /*hint=*/nullptr),
+                actual.EvaluateVelocity(time, /*hint=*/nullptr));
+    }
+  };
+
+  auto const expected_trajectory =
+      std::make_unique<ContinuousTrajectory<World>>(step, 5 * Milli(Metre));
+  trajectory_ =
+      std::make_unique<ContinuousTrajectory<World>>(step, 5 * Milli(Metre));
+  fill(0, number_of_steps / 3, *expected_trajectory);
+  fill(0, number_of_steps / 3, *trajectory_);
+  trajectory_->SetSeriesStore("SeriesStore.series", /*max_series_in_memory=*/3);
+  fill(number_of_steps / 3, number_of_steps, *expected_trajectory);
+  fill(number_of_steps / 3, number_of_steps, *trajectory_);
+  expect_same_trajectories(*expected_trajectory, *trajectory_);
+
+  // Serialization reads back the series in the store.
+  auto const checkpoint = trajectory_->GetCheckpoint();
+  fill(number_of_steps, number_of_steps + 100, *expected_trajectory);
+  fill(number_of_steps, number_of_steps + 100, *trajectory_);
+  serialization::ContinuousTrajectory expected_message;
+  expected_trajectory->WriteToMessage(&expected_message, checkpoint);
+  serialization::ContinuousTrajectory message;
+  trajectory_->WriteToMessage(&message, checkpoint);
+  EXPECT_EQ(expected_message.SerializeAsString(), message.SerializeAsString());
+  expected_trajectory->WriteToMessage(&expected_message);
+  trajectory_->WriteToMessage(&message);
+  EXPECT_EQ(expected_message.SerializeAsString(), message.SerializeAsString());
+
+  // Forget a part of the store, and then all of it.
+  for (Instant const& t : {t0_ + 50 * step, t0_ + 385 * step}) {
+    expected_trajectory->ForgetBefore(t);
+    trajectory_->ForgetBefore(t);
+    expect_same_trajectories(*expected_trajectory, *trajectory_);
+  }
+  fill(number_of_steps + 100, number_of_steps + 200, *expected_trajectory);
+  fill(number_of_steps + 100, number_of_steps + 200, *trajectory_);
+  expect_same_trajectories(*expected_trajectory, *trajectory_);
+}
+
+TEST_F(ContinuousTrajectoryTest, FindSeriesForInstant) {
+  int const number_of_steps = 10000;
+  int const number_of_random_times = 10000;
+  Length const radius = 421700 * Kilo(Metre);
+  Time const period = 152853.5047 * Second;
+  Time const step = 3600 * Second;
+  AngularFrequency const ω = 2 * π * Radian / period;
+
+  trajectory_ =
+      std::make_unique<ContinuousTrajectory<World>>(step, 5 * Milli(Metre));
+  FillTrajectory(
+      number_of_steps,
+      step,
+      [this, radius, ω](Instant const t) {
+        Angle const angle = ω * (t - t0_);
+        return World::origin + Displacement<World>({radius * Cos(angle),
+                                                    radius * Sin(angle),
+                                                    0 * Metre});
+      },
+      [this, radius, ω](Instant const t) {
+        Angle const angle = ω * (t - t0_);
+        return Velocity<World>({-ω * radius * Sin(angle) / Radian,
+                                ω * radius * Cos(angle) / Radian,
+                                0 * Metre / Second});
+      },
+      t0_);
+
+  std::mt19937_64 random(42);
+  auto const check = [this, &random, number_of_random_times]() {
+    Instant const t_min = trajectory_->t_min();
+    Instant const t_max = trajectory_->t_max();
+    // Random times, including some outside of the trajectory.
+    std::uniform_real_distribution<> fraction_distribution(-0.01, 1.01);
+    for (int i = 0; i < number_of_random_times; ++i) {
+      ExpectFindsSeriesForInstant(
+          t_min + fraction_distribution(random) * (t_max - t_min));
+    }
+    // The boundaries of the series and their immediate neighbourhood.
+    for (auto const& series : series()) {
+      for (Instant const& t : {series.t_min(), series.t_max()}) {
+        ExpectFindsSeriesForInstant(t);
+        ExpectFindsSeriesForInstant(t - 1 * Milli(Second));
+        ExpectFindsSeriesForInstant(t + 1 * Milli(Second));
+      }
+    }
+  };
+
+  check();
+  // After |ForgetBefore| the first series doesn't start at |t_min()|.
+  trajectory_->ForgetBefore(t0_ + 1001.5 * step);
+  check();
+}
+
 }  // namespace internal_continuous_trajectory
 }  // namespace physics
 }  // namespace principia
@@ -1,6 +1,7 @@
 ﻿
 #pragma once
 
+#include <experimental/optional>  // NOLINT
 #include <functional>
 #include <list>
 #include <map>
@@ -11,6 +12,7 @@
 #include "base/not_null.hpp"
 #include "geometry/grassmann.hpp"
 #include "geometry/named_quantities.hpp"
+#include "numerics/hermite3.hpp"
 #include "physics/degrees_of_freedom.hpp"
 #include "physics/forkable.hpp"
 #include "quantities/named_quantities.hpp"
@@ -54,8 +56,10 @@ namespace internal_discrete_trajectory {
 
 using base::not_null;
 using geometry::Instant;
+using geometry::Position;
 using geometry::Vector;
 using geometry::Velocity;
+using numerics::Hermite3;
 using quantities::Acceleration;
 using quantities::Length;
 using quantities::Speed;
@@ -72,6 +76,16 @@ class DiscreteTrajectory : public Forkable<DiscreteTrajectory<Frame>,
  public:
   using Iterator = DiscreteTrajectoryIterator<Frame>;
 
+  // A |Hint| speeds up the evaluation functions below when they are called
+  // repeatedly at nearby times.
+  class Hint final {
+   public:
+    Hint();
+   private:
+    int index_;
+    friend class DiscreteTrajectory<Frame>;
+  };
+
   DiscreteTrajectory() = default;
   DiscreteTrajectory(DiscreteTrajectory const&) = delete;
   DiscreteTrajectory(DiscreteTrajectory&&) = delete;
@@ -116,6 +130,11 @@ class DiscreteTrajectory : public Forkable<DiscreteTrajectory<Frame>,
   void Append(Instant const& time,
               DegreesOfFreedom<Frame> const& degrees_of_freedom);
 
+  // Prepends one point to the trajectory, which must be a root.  |time| must be
+  // before the first point of the trajectory, if any.
+  void Prepend(Instant const& time,
+               DegreesOfFreedom<Frame> const& degrees_of_freedom);
+
   // Removes all data for times (strictly) greater than |time|, as well as all
   // child trajectories forked at times (strictly) greater than |time|.  |time|
   // must be at or after the fork time, if any.
@@ -126,6 +145,19 @@ class DiscreteTrajectory : public Forkable<DiscreteTrajectory<Frame>,
   // |time|.  This trajectory must be a root.
   void ForgetBefore(Instant const& time);
 
+  // Evaluates the trajectory at the given |time|, which must be in
+  // [Begin().time(), last().time()], using a cubic Hermite interpolation
+  // between the neighbouring points.  The interpolants are built when first
+  // needed, up to the evaluation time, and kept until the points that they join
+  // are forgotten, so the evaluation is O(1) amortized when the |hint| is
+  // reused for nearby times, and O(log n) otherwise.  The |hint| may be a
+  // nullptr.  These functions update a cache, so they must not be called
+  // concurrently on the same trajectory.
+  Position<Frame> EvaluatePosition(Instant const& time, Hint* hint) const;
+  Velocity<Frame> EvaluateVelocity(Instant const& time, Hint* hint) const;
+  DegreesOfFreedom<Frame> EvaluateDegreesOfFreedom(Instant const& time,
+                                                   Hint* hint) const;
+
   // This trajectory must be a root.  Only the given |forks| are serialized.
   // They must be descended from this trajectory.  The pointers in |forks| may
   // be null at entry.
@@ -133,10 +165,20 @@ class DiscreteTrajectory : public Forkable<DiscreteTrajectory<Frame>,
       not_null<serialization::DiscreteTrajectory*> message,
       std::vector<DiscreteTrajectory<Frame>*> const& forks) const;
 
+  // Same as above, but the timelines are written as |PackedTimeline|s with the
+  // given |compression|.  This is much more compact and faster, but cannot be
+  // read by versions that predate |PackedTimeline|.
+  void WriteToMessage(
+      not_null<serialization::DiscreteTrajectory*> message,
+      std::vector<DiscreteTrajectory<Frame>*> const& forks,
+      serialization::DiscreteTrajectory::PackedTimeline::Compression
+          compression) const;
+
   // |forks| must have a size appropriate for the |message| being deserialized
   // and the orders of the |forks| must be consistent during serialization and
   // deserialization.  All pointers designated by the pointers in |forks| must
-  // be null at entry; they may be null at exit.
+  // be null at entry; they may be null at exit.  Reads both the verbose and the
+  // packed timelines.
   static not_null<std::unique_ptr<DiscreteTrajectory>> ReadFromMessage(
       serialization::DiscreteTrajectory const& message,
       std::vector<DiscreteTrajectory<Frame>**> const& forks);
@@ -154,17 +196,53 @@ class DiscreteTrajectory : public Forkable<DiscreteTrajectory<Frame>,
   bool timeline_empty() const override;
 
  private:
-  // This trajectory need not be a root.
+  // This trajectory need not be a root.  If |compression| is present, the
+  // timeline is packed.
   void WriteSubTreeToMessage(
       not_null<serialization::DiscreteTrajectory*> message,
-      std::vector<DiscreteTrajectory<Frame>*>& forks) const;
+      std::vector<DiscreteTrajectory<Frame>*>& forks,
+      std::experimental::optional<
+          serialization::DiscreteTrajectory::PackedTimeline::Compression> const&
+          compression) const;
+
+  // Writes the |timeline_| to |message|, in packed form if |compression| is
+  // present.
+  void WriteTimelineToMessage(
+      not_null<serialization::DiscreteTrajectory*> message,
+      std::experimental::optional<
+          serialization::DiscreteTrajectory::PackedTimeline::Compression> const&
+          compression) const;
+
+  // Appends the points of the |message| to the |timeline_|.
+  void FillTimelineFromMessage(
+      serialization::DiscreteTrajectory const& message);
 
   void FillSubTreeFromMessage(
       serialization::DiscreteTrajectory const& message,
       std::vector<DiscreteTrajectory<Frame>**> const& forks);
 
+  // Extends |interpolants_| so that they cover |time|, i.e., up to the first
+  // point after |time|, or to the last point of this trajectory if there is no
+  // such point.
+  void UpdateInterpolants(Instant const& time) const;
+
+  // Returns the index of the element of |interpolants_| whose interval
+  // contains |time|, which must be in [interpolant_times_.front(),
+  // interpolant_times_.back()[.  Updates the |hint| if it is not null.
+  int FindInterpolant(Instant const& time, Hint* hint) const;
+
+  // Removes the interpolants that extend beyond |time|.
+  void ForgetInterpolantsAfter(Instant const& time);
+
   Timeline timeline_;
 
+  // The times of the points joined by |interpolants_|, starting at the fork
+  // point if this trajectory is not a root.  The points before the fork point
+  // are evaluated by the parent.  |interpolants_[i]| is defined on
+  // [interpolant_times_[i], interpolant_times_[i + 1]].
+  mutable std::vector<Instant> interpolant_times_;
+  mutable std::vector<Hermite3<Instant, Position<Frame>>> interpolants_;
+
   template<typename, typename>
   friend class internal_forkable::ForkableIterator;
   template<typename, typename>
@@ -4,12 +4,21 @@
 #include "physics/discrete_trajectory.hpp"
 
 #include <algorithm>
+#include <array>
+#include <iterator>
+#include <limits>
 #include <list>
 #include <map>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include "base/macros.hpp"
+#include "base/packed_doubles.hpp"
 #include "geometry/named_quantities.hpp"
+#include "geometry/r3_element.hpp"
 #include "glog/logging.h"
+#include "quantities/si.hpp"
 
 namespace principia {
 namespace physics {
@@ -50,8 +59,22 @@ DiscreteTrajectoryIterator<Frame>::that() const {
 
 namespace internal_discrete_trajectory {
 
+using base::DecodeDeltaOfDeltaDoubles;
+using base::DecodeRawDoubles;
+using base::DecodeXorDoubles;
+using base::EncodeDeltaOfDeltaDoubles;
+using base::EncodeRawDoubles;
+using base::EncodeXorDoubles;
 using base::make_not_null_unique;
+using geometry::Displacement;
 using geometry::Instant;
+using geometry::R3Element;
+using quantities::si::Metre;
+using quantities::si::Second;
+
+template<typename Frame>
+DiscreteTrajectory<Frame>::Hint::Hint()
+    : index_(std::numeric_limits<int>::max()) {}
 
 template<typename Frame>
 typename DiscreteTrajectory<Frame>::Iterator
@@ -107,6 +130,7 @@ void DiscreteTrajectory<Frame>::AttachFork(
   CHECK(!fork->timeline_.empty());
 
   // Append to this trajectory a copy of the first point of |fork|.
+  not_null<DiscreteTrajectory<Frame>*> const fork_ptr = fork.get();
   auto& fork_timeline = fork->timeline_;
   auto fork_begin = fork_timeline.begin();
   Append(fork_begin->first, fork_begin->second);
@@ -117,6 +141,8 @@ void DiscreteTrajectory<Frame>::AttachFork(
   // Remove the first point of |fork| now that it properly attached to its
   // parent.
   fork_timeline.erase(fork_begin);
+  fork_ptr->interpolant_times_.clear();
+  fork_ptr->interpolants_.clear();
 }
 
 template<typename Frame>
@@ -130,6 +156,8 @@ DiscreteTrajectory<Frame>::DetachFork() {
   auto const begin_it = timeline_.emplace_hint(
       timeline_.begin(), fork_it.time(), fork_it.degrees_of_freedom());
   CHECK(begin_it == timeline_.begin());
+  interpolant_times_.clear();
+  interpolants_.clear();
 
   // Detach this trajectory and tell the caller that it owns the pieces.
   return this->DetachForkWithCopiedBegin();
@@ -156,6 +184,19 @@ void DiscreteTrajectory<Frame>::Append(
   CHECK(--timeline_.end() == it) << "Append out of order at " << time;
 }
 
+template<typename Frame>
+void DiscreteTrajectory<Frame>::Prepend(
+    Instant const& time,
+    DegreesOfFreedom<Frame> const& degrees_of_freedom) {
+  CHECK(this->is_root());
+  CHECK(timeline_.empty() || time < timeline_.begin()->first)
+      << "Prepend out of order at " << time;
+  timeline_.emplace_hint(timeline_.begin(), time, degrees_of_freedom);
+  // The interpolants are indexed from the beginning of the timeline.
+  interpolant_times_.clear();
+  interpolants_.clear();
+}
+
 template<typename Frame>
 void DiscreteTrajectory<Frame>::ForgetAfter(Instant const& time) {
   this->DeleteAllForksAfter(time);
@@ -165,6 +206,7 @@ void DiscreteTrajectory<Frame>::ForgetAfter(Instant const& time) {
   // time == |time|.
   auto const it = timeline_.upper_bound(time);
   timeline_.erase(it, timeline_.end());
+  ForgetInterpolantsAfter(time);
 }
 
 template<typename Frame>
@@ -175,6 +217,52 @@ void DiscreteTrajectory<Frame>::ForgetBefore(Instant const& time) {
   // the entries that precede it.  This preserves any entry with time == |time|.
   auto it = timeline_.lower_bound(time);
   timeline_.erase(timeline_.begin(), it);
+  interpolant_times_.clear();
+  interpolants_.clear();
+}
+
+template<typename Frame>
+Position<Frame> DiscreteTrajectory<Frame>::EvaluatePosition(
+    Instant const& time,
+    Hint* const hint) const {
+  if (!this->is_root() && time < this->Fork().time()) {
+    return this->parent()->EvaluatePosition(time, hint);
+  }
+  UpdateInterpolants(time);
+  if (time == interpolant_times_.back()) {
+    return last().degrees_of_freedom().position();
+  }
+  return interpolants_[FindInterpolant(time, hint)].Evaluate(time);
+}
+
+template<typename Frame>
+Velocity<Frame> DiscreteTrajectory<Frame>::EvaluateVelocity(
+    Instant const& time,
+    Hint* const hint) const {
+  if (!this->is_root() && time < this->Fork().time()) {
+    return this->parent()->EvaluateVelocity(time, hint);
+  }
+  UpdateInterpolants(time);
+  if (time == interpolant_times_.back()) {
+    return last().degrees_of_freedom().velocity();
+  }
+  return interpolants_[FindInterpolant(time, hint)].EvaluateDerivative(time);
+}
+
+template<typename Frame>
+DegreesOfFreedom<Frame> DiscreteTrajectory<Frame>::EvaluateDegreesOfFreedom(
+    Instant const& time,
+    Hint* const hint) const {
+  if (!this->is_root() && time < this->Fork().time()) {
+    return this->parent()->EvaluateDegreesOfFreedom(time, hint);
+  }
+  UpdateInterpolants(time);
+  if (time == interpolant_times_.back()) {
+    return last().degrees_of_freedom();
+  }
+  auto const& interpolant = interpolants_[FindInterpolant(time, hint)];
+  return DegreesOfFreedom<Frame>(interpolant.Evaluate(time),
+                                 interpolant.EvaluateDerivative(time));
 }
 
 template<typename Frame>
@@ -186,7 +274,31 @@ void DiscreteTrajectory<Frame>::WriteToMessage(
   CHECK(this->is_root());
 
   std::vector<DiscreteTrajectory<Frame>*> mutable_forks = forks;
-  WriteSubTreeToMessage(message, mutable_forks);
+  WriteSubTreeToMessage(message,
+                        mutable_forks,
+                        /*compression=*/std::experimental::nullopt);
+  CHECK(std::all_of(mutable_forks.begin(),
+                    mutable_forks.end(),
+                    [](DiscreteTrajectory<Frame>* const fork) {
+                      return fork == nullptr;
+                    }));
+
+  LOG(INFO) << NAMED(this);
+  LOG(INFO) << NAMED(message->SpaceUsed());
+  LOG(INFO) << NAMED(message->ByteSize());
+}
+
+template<typename Frame>
+void DiscreteTrajectory<Frame>::WriteToMessage(
+    not_null<serialization::DiscreteTrajectory*> const message,
+    std::vector<DiscreteTrajectory<Frame>*> const& forks,
+    serialization::DiscreteTrajectory::PackedTimeline::Compression const
+        compression) const {
+  LOG(INFO) << __FUNCTION__;
+  CHECK(this->is_root());
+
+  std::vector<DiscreteTrajectory<Frame>*> mutable_forks = forks;
+  WriteSubTreeToMessage(message, mutable_forks, compression);
   CHECK(std::all_of(mutable_forks.begin(),
                     mutable_forks.end(),
                     [](DiscreteTrajectory<Frame>* const fork) {
@@ -256,22 +368,166 @@ bool DiscreteTrajectory<Frame>::timeline_empty() const {
 template<typename Frame>
 void DiscreteTrajectory<Frame>::WriteSubTreeToMessage(
     not_null<serialization::DiscreteTrajectory*> const message,
-    std::vector<DiscreteTrajectory<Frame>*>& forks) const {
-  Forkable<DiscreteTrajectory, Iterator>::WriteSubTreeToMessage(message, forks);
+    std::vector<DiscreteTrajectory<Frame>*>& forks,
+    std::experimental::optional<
+        serialization::DiscreteTrajectory::PackedTimeline::Compression> const&
+        compression) const {
+  Forkable<DiscreteTrajectory, Iterator>::WriteSubTreeToMessage(
+      message, forks, compression);
+  WriteTimelineToMessage(message, compression);
+}
+
+template<typename Frame>
+void DiscreteTrajectory<Frame>::FillSubTreeFromMessage(
+    serialization::DiscreteTrajectory const& message,
+    std::vector<DiscreteTrajectory<Frame>**> const& forks) {
+  FillTimelineFromMessage(message);
+  Forkable<DiscreteTrajectory, Iterator>::FillSubTreeFromMessage(message,
+                                                                 forks);
+}
+
+template<typename Frame>
+void DiscreteTrajectory<Frame>::UpdateInterpolants(Instant const& time) const {
+  if (interpolant_times_.empty()) {
+    if (this->is_root()) {
+      CHECK(!timeline_.empty()) << "Empty trajectory";
+      interpolant_times_.push_back(timeline_.begin()->first);
+    } else {
+      interpolant_times_.push_back(this->Fork().time());
+    }
+  }
+
+  // The first point not yet joined by an interpolant, and the point before it,
+  // which may be the fork point.
+  auto it = timeline_.upper_bound(interpolant_times_.back());
+  Instant previous_time = interpolant_times_.back();
+  DegreesOfFreedom<Frame> previous_degrees_of_freedom =
+      it == timeline_.begin() ? this->Fork().degrees_of_freedom()
+                              : std::prev(it)->second;
+  for (; it != timeline_.end() && previous_time <= time; ++it) {
+    Instant const& next_time = it->first;
+    DegreesOfFreedom<Frame> const& degrees_of_freedom = it->second;
+    interpolants_.emplace_back(
+        std::make_pair(previous_time, next_time),
+        std::make_pair(previous_degrees_of_freedom.position(),
+                       degrees_of_freedom.position()),
+        std::make_pair(previous_degrees_of_freedom.velocity(),
+                       degrees_of_freedom.velocity()));
+    interpolant_times_.push_back(next_time);
+    previous_time = next_time;
+    previous_degrees_of_freedom = degrees_of_freedom;
+  }
+}
+
+template<typename Frame>
+int DiscreteTrajectory<Frame>::FindInterpolant(Instant const& time,
+                                               Hint* const hint) const {
+  CHECK_LE(interpolant_times_.front(), time)
+      << "Evaluation before the beginning of the trajectory";
+  CHECK_GT(interpolant_times_.back(), time)
+      << "Evaluation after the end of the trajectory";
+  int const size = interpolants_.size();
+  auto const contains = [this, size, &time](int const index) {
+    return index < size &&
+           interpolant_times_[index] <= time &&
+           time < interpolant_times_[index + 1];
+  };
+
+  int index;
+  bool const has_hint = hint != nullptr && hint->index_ < size;
+  if (has_hint && contains(hint->index_)) {
+    index = hint->index_;
+  } else if (has_hint && contains(hint->index_ + 1)) {
+    // The hint was for the previous interval, the usual case when evaluating
+    // at increasing times.
+    index = hint->index_ + 1;
+  } else {
+    index = std::upper_bound(interpolant_times_.begin(),
+                             interpolant_times_.end(),
+                             time) -
+            interpolant_times_.begin() - 1;
+  }
+  if (hint != nullptr) {
+    hint->index_ = index;
+  }
+  return index;
+}
+
+template<typename Frame>
+void DiscreteTrajectory<Frame>::ForgetInterpolantsAfter(Instant const& time) {
+  // |Hermite3| is not assignable, hence the |pop_back|s.
+  while (!interpolant_times_.empty() && interpolant_times_.back() > time) {
+    interpolant_times_.pop_back();
+    if (!interpolants_.empty()) {
+      interpolants_.pop_back();
+    }
+  }
+}
+
+template<typename Frame>
+void DiscreteTrajectory<Frame>::WriteTimelineToMessage(
+    not_null<serialization::DiscreteTrajectory*> const message,
+    std::experimental::optional<
+        serialization::DiscreteTrajectory::PackedTimeline::Compression> const&
+        compression) const {
+  if (!compression) {
+    for (auto const& pair : timeline_) {
+      Instant const& instant = pair.first;
+      DegreesOfFreedom<Frame> const& degrees_of_freedom = pair.second;
+      auto const instantaneous_degrees_of_freedom = message->add_timeline();
+      instant.WriteToMessage(
+          instantaneous_degrees_of_freedom->mutable_instant());
+      degrees_of_freedom.WriteToMessage(
+          instantaneous_degrees_of_freedom->mutable_degrees_of_freedom());
+    }
+    return;
+  }
+
+  // Split the timeline in columns of doubles.
+  std::vector<double> times;
+  std::array<std::vector<double>, 6> coordinates;
+  times.reserve(timeline_.size());
+  for (auto& column : coordinates) {
+    column.reserve(timeline_.size());
+  }
   for (auto const& pair : timeline_) {
     Instant const& instant = pair.first;
     DegreesOfFreedom<Frame> const& degrees_of_freedom = pair.second;
-    auto const instantaneous_degrees_of_freedom = message->add_timeline();
-    instant.WriteToMessage(instantaneous_degrees_of_freedom->mutable_instant());
-    degrees_of_freedom.WriteToMessage(
-        instantaneous_degrees_of_freedom->mutable_degrees_of_freedom());
+    R3Element<Length> const position =
+        (degrees_of_freedom.position() - Frame::origin).coordinates();
+    R3Element<Speed> const velocity =
+        degrees_of_freedom.velocity().coordinates();
+    times.push_back((instant - Instant()) / Second);
+    for (int i = 0; i < 3; ++i) {
+      coordinates[i].push_back(position[i] / Metre);
+      coordinates[i + 3].push_back(velocity[i] / (Metre / Second));
+    }
+  }
+
+  auto* const packed_timeline = message->mutable_packed_timeline();
+  Frame::WriteToMessage(packed_timeline->mutable_frame());
+  packed_timeline->set_size(timeline_.size());
+  packed_timeline->set_compression(*compression);
+  EncodeDeltaOfDeltaDoubles(times, *packed_timeline->mutable_time());
+  for (auto const& column : coordinates) {
+    std::string* const bytes = packed_timeline->add_coordinates();
+    switch (*compression) {
+      case serialization::DiscreteTrajectory::PackedTimeline::NONE:
+        EncodeRawDoubles(column, *bytes);
+        break;
+      case serialization::DiscreteTrajectory::PackedTimeline::XOR:
+        EncodeXorDoubles(column, *bytes);
+        break;
+      default:
+        LOG(FATAL) << "Unexpected compression " << *compression;
+        base::noreturn();
+    }
   }
 }
 
 template<typename Frame>
-void DiscreteTrajectory<Frame>::FillSubTreeFromMessage(
-    serialization::DiscreteTrajectory const& message,
-    std::vector<DiscreteTrajectory<Frame>**> const& forks) {
+void DiscreteTrajectory<Frame>::FillTimelineFromMessage(
+    serialization::DiscreteTrajectory const& message) {
   for (auto timeline_it = message.timeline().begin();
        timeline_it != message.timeline().end();
        ++timeline_it) {
@@ -279,8 +535,44 @@ void DiscreteTrajectory<Frame>::FillSubTreeFromMessage(
            DegreesOfFreedom<Frame>::ReadFromMessage(
                timeline_it->degrees_of_freedom()));
   }
-  Forkable<DiscreteTrajectory, Iterator>::FillSubTreeFromMessage(message,
-                                                                 forks);
+  if (!message.has_packed_timeline()) {
+    return;
+  }
+
+  auto const& packed_timeline = message.packed_timeline();
+  CHECK_EQ(0, message.timeline_size());
+  Frame::ReadFromMessage(packed_timeline.frame());
+  int const size = packed_timeline.size();
+  CHECK_EQ(6, packed_timeline.coordinates_size());
+  std::vector<double> const times =
+      DecodeDeltaOfDeltaDoubles(packed_timeline.time(), size);
+  std::array<std::vector<double>, 6> coordinates;
+  for (int i = 0; i < 6; ++i) {
+    std::string const& bytes = packed_timeline.coordinates(i);
+    switch (packed_timeline.compression()) {
+      case serialization::DiscreteTrajectory::PackedTimeline::NONE:
+        coordinates[i] = DecodeRawDoubles(bytes, size);
+        break;
+      case serialization::DiscreteTrajectory::PackedTimeline::XOR:
+        coordinates[i] = DecodeXorDoubles(bytes, size);
+        break;
+      default:
+        LOG(FATAL) << "Unexpected compression "
+                   << packed_timeline.compression();
+        base::noreturn();
+    }
+  }
+  for (int j = 0; j < size; ++j) {
+    Append(Instant() + times[j] * Second,
+           DegreesOfFreedom<Frame>(
+               Frame::origin +
+                   Displacement<Frame>({coordinates[0][j] * Metre,
+                                        coordinates[1][j] * Metre,
+                                        coordinates[2][j] * Metre}),
+               Velocity<Frame>({coordinates[3][j] * (Metre / Second),
+                                coordinates[4][j] * (Metre / Second),
+                                coordinates[5][j] * (Metre / Second)})));
+  }
 }
 
 }  // namespace internal_discrete_trajectory
@@ -16,6 +16,7 @@
 #include "gtest/gtest.h"
 #include "quantities/quantities.hpp"
 #include "quantities/si.hpp"
+#include "testing_utilities/numerics.hpp"
 
 namespace principia {
 namespace physics {
@@ -28,16 +29,19 @@ using geometry::Point;
 using geometry::Position;
 using geometry::R3Element;
 using geometry::Vector;
+using quantities::Acceleration;
 using quantities::Length;
 using quantities::Speed;
 using quantities::SIUnit;
 using quantities::si::Metre;
 using quantities::si::Second;
+using testing_utilities::AbsoluteError;
 using ::std::placeholders::_1;
 using ::std::placeholders::_2;
 using ::std::placeholders::_3;
 using ::testing::ElementsAre;
 using ::testing::Eq;
+using ::testing::Lt;
 using ::testing::Pair;
 using ::testing::Ref;
 
@@ -530,6 +534,29 @@ TEST_F(DiscreteTrajectoryTest, AppendSuccess) {
   EXPECT_THAT(times, ElementsAre(t1_, t2_, t3_));
 }
 
+TEST_F(DiscreteTrajectoryTest, Prepend) {
+  massive_trajectory_->Append(t2_, d2_);
+  massive_trajectory_->Append(t3_, d3_);
+  EXPECT_EQ(d2_,
+            massive_trajectory_->EvaluateDegreesOfFreedom(t2_,
+                                                          /*hint=*/nullptr));
+  massive_trajectory_->Prepend(t1_, d1_);
+  std::map<Instant, Position<World>> const positions =
+      Positions(*massive_trajectory_);
+  std::map<Instant, Velocity<World>> const velocities =
+      Velocities(*massive_trajectory_);
+  std::list<Instant> const times = Times(*massive_trajectory_);
+  EXPECT_THAT(positions,
+              ElementsAre(Pair(t1_, q1_), Pair(t2_, q2_), Pair(t3_, q3_)));
+  EXPECT_THAT(velocities,
+              ElementsAre(Pair(t1_, p1_), Pair(t2_, p2_), Pair(t3_, p3_)));
+  EXPECT_THAT(times, ElementsAre(t1_, t2_, t3_));
+  // The interpolation covers the new point.
+  EXPECT_EQ(d1_,
+            massive_trajectory_->EvaluateDegreesOfFreedom(t1_,
+                                                          /*hint=*/nullptr));
+}
+
 TEST_F(DiscreteTrajectoryTest, ForgetAfter) {
   massive_trajectory_->Append(t1_, d1_);
   massive_trajectory_->Append(t2_, d2_);
@@ -730,6 +757,126 @@ TEST_F(DiscreteTrajectoryTest, TrajectorySerializationSuccess) {
       Eq(d4_));
 }
 
+// The packed timelines are read back exactly, including the forks, and are
+// smaller than the verbose ones.
+TEST_F(DiscreteTrajectoryTest, PackedTrajectorySerialization) {
+  for (int i = 0; i < 100; ++i) {
+    Instant const t = t1_ + i * Second;
+    massive_trajectory_->Append(
+        t,
+        DegreesOfFreedom<World>(
+            q1_ + Displacement<World>({i * Metre, 2 * i * Metre, 0 * Metre}),
+            p1_ + Velocity<World>({i * Metre / Second,
+                                   0 * Metre / Second,
+                                   0 * Metre / Second})));
+  }
+  not_null<DiscreteTrajectory<World>*> const fork0 =
+      massive_trajectory_->NewForkWithCopy(t1_ + 50 * Second);
+  fork0->Append(t1_ + 200 * Second, d4_);
+  not_null<DiscreteTrajectory<World>*> const fork1 =
+      massive_trajectory_->NewForkWithCopy(t1_ + 99 * Second);
+
+  serialization::DiscreteTrajectory verbose_message;
+  massive_trajectory_->WriteToMessage(&verbose_message, {fork1, fork0});
+  for (auto const compression :
+       {serialization::DiscreteTrajectory::PackedTimeline::NONE,
+        serialization::DiscreteTrajectory::PackedTimeline::XOR}) {
+    serialization::DiscreteTrajectory packed_message;
+    massive_trajectory_->WriteToMessage(
+        &packed_message, {fork1, fork0}, compression);
+    EXPECT_EQ(0, packed_message.timeline_size());
+    EXPECT_EQ(100, packed_message.packed_timeline().size());
+    EXPECT_EQ(compression, packed_message.packed_timeline().compression());
+    EXPECT_THAT(packed_message.ByteSize(), Lt(verbose_message.ByteSize() / 2))
+        << compression;
+
+    DiscreteTrajectory<World>* deserialized_fork0 = nullptr;
+    DiscreteTrajectory<World>* deserialized_fork1 = nullptr;
+    not_null<std::unique_ptr<DiscreteTrajectory<World>>> const
+        deserialized_trajectory =
+            DiscreteTrajectory<World>::ReadFromMessage(
+                packed_message, {&deserialized_fork1, &deserialized_fork0});
+    EXPECT_EQ(t1_ + 50 * Second, deserialized_fork0->Fork().time());
+    EXPECT_EQ(t1_ + 99 * Second, deserialized_fork1->Fork().time());
+    EXPECT_EQ(d4_, deserialized_fork0->last().degrees_of_freedom());
+
+    // Writing the deserialized trajectory verbosely yields the original
+    // message.
+    serialization::DiscreteTrajectory message;
+    deserialized_trajectory->WriteToMessage(
+        &message, {deserialized_fork1, deserialized_fork0});
+    EXPECT_EQ(verbose_message.SerializeAsString(), message.SerializeAsString());
+  }
+}
+
+TEST_F(DiscreteTrajectoryTest, Evaluate) {
+  // A uniformly accelerated motion, which the cubic interpolation reproduces.
+  Vector<Acceleration, World> const a({1 * Metre / Second / Second,
+                                       -2 * Metre / Second / Second,
+                                       3 * Metre / Second / Second});
+  auto const motion = [this, &a](Instant const& t) {
+    return DegreesOfFreedom<World>(q1_ + p1_ * (t - t0_) +
+                                       a * (t - t0_) * (t - t0_) / 2,
+                                   p1_ + a * (t - t0_));
+  };
+  massive_trajectory_->Append(t1_, motion(t1_));
+  massive_trajectory_->Append(t2_, motion(t2_));
+  massive_trajectory_->Append(t3_, motion(t3_));
+
+  // The points themselves.
+  EXPECT_EQ(motion(t1_),
+            massive_trajectory_->EvaluateDegreesOfFreedom(t1_,
+                                                          /*hint=*/nullptr));
+  EXPECT_EQ(motion(t3_),
+            massive_trajectory_->EvaluateDegreesOfFreedom(t3_,
+                                                          /*hint=*/nullptr));
+
+  // Increasing times with a hint.
+  DiscreteTrajectory<World>::Hint hint;
+  for (Instant t = t1_; t < t3_; t += 0.5 * Second) {
+    EXPECT_LT(AbsoluteError(motion(t).position(),
+                            massive_trajectory_->EvaluatePosition(t, &hint)),
+              1e-10 * Metre);
+    EXPECT_LT(AbsoluteError(motion(t).velocity(),
+                            massive_trajectory_->EvaluateVelocity(t, &hint)),
+              1e-10 * Metre / Second);
+  }
+  // The hint must not be trusted when going back in time.
+  EXPECT_LT(AbsoluteError(
+                motion(t1_ + 1 * Second).position(),
+                massive_trajectory_->EvaluatePosition(t1_ + 1 * Second, &hint)),
+            1e-10 * Metre);
+
+  // A fork evaluates the points before the fork point using its parent.  Its
+  // last point is not on the same motion.
+  not_null<DiscreteTrajectory<World>*> const fork =
+      massive_trajectory_->NewForkWithCopy(t2_);
+  fork->Append(t4_, d4_);
+  Instant const t12 = t1_ + 3 * Second;
+  Instant const t23 = t2_ + 3 * Second;
+  EXPECT_LT(AbsoluteError(motion(t12).position(),
+                          fork->EvaluatePosition(t12, /*hint=*/nullptr)),
+            1e-10 * Metre);
+  EXPECT_LT(AbsoluteError(motion(t23).position(),
+                          fork->EvaluatePosition(t23, /*hint=*/nullptr)),
+            1e-10 * Metre);
+  EXPECT_EQ(d4_, fork->EvaluateDegreesOfFreedom(t4_, /*hint=*/nullptr));
+
+  // Forgetting and appending different points updates the interpolation.
+  Instant const t34 = t3_ + 3 * Second;
+  Position<World> const position_before =
+      fork->EvaluatePosition(t34, /*hint=*/nullptr);
+  fork->ForgetAfter(t3_);
+  fork->Append(t4_, motion(t4_));
+  Position<World> const position_after =
+      fork->EvaluatePosition(t34, /*hint=*/nullptr);
+  EXPECT_NE(position_before, position_after);
+  EXPECT_LT(AbsoluteError(motion(t34).position(), position_after),
+            1e-10 * Metre);
+  EXPECT_EQ(motion(t4_),
+            fork->EvaluateDegreesOfFreedom(t4_, /*hint=*/nullptr));
+}
+
 TEST_F(DiscreteTrajectoryDeathTest, LastError) {
   EXPECT_DEATH({
     massive_trajectory_->last();
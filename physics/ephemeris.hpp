@@ -1,22 +1,32 @@
 ﻿
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <experimental/filesystem>
 #include <functional>
 #include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
+#include "base/macros.hpp"
 #include "base/not_null.hpp"
 #include "base/status.hpp"
+#include "base/thread_pool.hpp"
 #include "geometry/grassmann.hpp"
 #include "geometry/named_quantities.hpp"
 #include "google/protobuf/repeated_field.h"
 #include "integrators/ordinary_differential_equations.hpp"
+#include "physics/barnes_hut_gravitation.hpp"
 #include "physics/continuous_trajectory.hpp"
 #include "physics/discrete_trajectory.hpp"
+#include "physics/interleaved_series.hpp"
 #include "physics/massive_body.hpp"
 #include "physics/oblate_body.hpp"
+#include "physics/vectorized_gravitation.hpp"
 #include "serialization/ksp_plugin.pb.h"
 #include "serialization/physics.pb.h"
 
@@ -52,6 +62,33 @@ class Ephemeris {
   static std::int64_t constexpr unlimited_max_ephemeris_steps =
       std::numeric_limits<std::int64_t>::max();
 
+  // The computation used for the mutual accelerations of the massive bodies.
+  enum class MassiveBodiesKernel {
+    // Bit-reproducible across platforms.
+    Scalar,
+    // The accelerations between spherical bodies are computed using
+    // |VectorizedGravitation|, those involving oblate bodies are scalar.  The
+    // results differ from those of |Scalar| by a few ULPs.
+    Vectorized,
+    // The accelerations between spherical bodies are approximated using
+    // |BarnesHutGravitation|, with the parameters given by
+    // |set_barnes_hut_parameters|.  The interactions involving an oblate body
+    // or a dominant body are computed exactly.  Meant for systems with
+    // thousands of minor bodies, e.g., asteroid belts or rings.
+    BarnesHut,
+  };
+
+  // What |WriteToMessage| serializes.
+  enum class SerializationMode {
+    // The state up to the first checkpoint.  |ReadFromMessage| re-integrates
+    // the rest of the ephemeris.
+    Compact,
+    // In addition to the |Compact| state, the series and the state of the
+    // integration past the first checkpoint, so that |ReadFromMessage| doesn't
+    // need to integrate.  Larger, but faster to read.
+    Full,
+  };
+
   // The equation describing the motion of the |bodies_|.
   using NewtonianMotionEquation =
       SpecialSecondOrderDifferentialEquation<Position<Frame>>;
@@ -70,11 +107,20 @@ class Ephemeris {
     std::int64_t max_steps() const;
     Length length_integration_tolerance() const;
     Speed speed_integration_tolerance() const;
+    Time const& sampling_period() const;
 
+    void set_max_steps(std::int64_t max_steps);
     void set_length_integration_tolerance(
         Length const& length_integration_tolerance);
     void set_speed_integration_tolerance(
         Speed const& speed_integration_tolerance);
+    // If |sampling_period| is positive, a trajectory integrated with these
+    // parameters does not get a point for each step of the integrator.
+    // Instead, it gets points every |sampling_period| after its last point,
+    // interpolated from the dense output of the integrator, and a point at the
+    // end of the integration.  The steps are unchanged.  If |sampling_period|
+    // is zero, the default, the trajectory gets a point for each step.
+    void set_sampling_period(Time const& sampling_period);
 
     void WriteToMessage(
         not_null<serialization::Ephemeris::AdaptiveStepParameters*> const
@@ -89,6 +135,7 @@ class Ephemeris {
     std::int64_t max_steps_;
     Length length_integration_tolerance_;
     Speed speed_integration_tolerance_;
+    Time sampling_period_;
     friend class Ephemeris<Frame>;
   };
 
@@ -113,6 +160,40 @@ class Ephemeris {
     friend class Ephemeris<Frame>;
   };
 
+  // A function of the motion of a massless body whose sign changes mark
+  // events, e.g., apsides or nodes.  Only the sign of the result matters.
+  using EventFunction =
+      std::function<double(Instant const& time,
+                           DegreesOfFreedom<Frame> const& degrees_of_freedom)>;
+
+  // The events to detect while integrating a massless body with
+  // |FlowWithAdaptiveStep|.  The event functions are evaluated at the end of
+  // each step of the integrator, and their roots are refined within the step
+  // using the dense output of the integrator.  An event detector must only be
+  // used by one integration at a time.
+  class EventDetector final {
+   public:
+    // When |function| goes from negative to nonnegative (resp. from
+    // nonnegative to negative), the time and degrees of freedom of the massless
+    // body at the root are appended to |*increasing| (resp. |*decreasing|)
+    // unless it is null.
+    void Add(EventFunction function,
+             DiscreteTrajectory<Frame>* increasing,
+             DiscreteTrajectory<Frame>* decreasing);
+
+   private:
+    struct Event final {
+      EventFunction function;
+      DiscreteTrajectory<Frame>* increasing;
+      DiscreteTrajectory<Frame>* decreasing;
+      // The value of |function| at the end of the last step.
+      double last_value;
+    };
+
+    std::vector<Event> events_;
+    friend class Ephemeris<Frame>;
+  };
+
   // Constructs an Ephemeris that owns the |bodies|.  The elements of vectors
   // |bodies| and |initial_state| correspond to one another.
   Ephemeris(std::vector<not_null<std::unique_ptr<MassiveBody const>>>&& bodies,
@@ -121,7 +202,8 @@ class Ephemeris {
             Length const& fitting_tolerance,
             FixedStepParameters const& parameters);
 
-  virtual ~Ephemeris() = default;
+  // Stops the background prolongation, if any.
+  virtual ~Ephemeris();
 
   // Returns the bodies in the order in which they were given at construction.
   virtual std::vector<not_null<MassiveBody const*>> const& bodies() const;
@@ -146,9 +228,79 @@ class Ephemeris {
   // Calls |ForgetBefore| on all trajectories.  On return |t_min() == t|.
   virtual void ForgetBefore(Instant const& t);
 
-  // Prolongs the ephemeris up to at least |t|.  After the call, |t_max() >= t|.
+  // Prolongs the ephemeris up to at least |t|.  After the call, |t_max() >= t|
+  // unless the integrator fails, in which case its error is reported by
+  // |last_severe_integration_status|.  If a background prolongation is running,
+  // transfers its results to the trajectories, waiting for it to reach |t| if
+  // needed.  If the background integration fails, it is stopped and the
+  // integration proceeds on the calling thread.
   virtual void Prolong(Instant const& t);
 
+  // Starts a thread that keeps the ephemeris integrated |horizon| ahead of the
+  // last time passed to |Prolong|.  The background thread fits the series on
+  // continuations of the trajectories, and |Prolong| splices them into the
+  // trajectories on the calling thread.  Therefore the trajectories are never
+  // modified concurrently with their evaluation, and |Prolong| only blocks if
+  // the background integration lags behind the requested time.  The
+  // trajectories are bit-identical to those obtained without a background
+  // prolongation.  There must be no background prolongation running.
+  virtual void StartBackgroundProlongation(Time const& horizon);
+
+  // Stops the background thread, if any, and transfers its results to the
+  // trajectories.
+  virtual void StopBackgroundProlongation();
+
+  // The following setters change state that is used by the background
+  // prolongation, if any: they stop it, and restart it with the same horizon.
+
+  // Selects the kernel used by |Prolong|.  The default is |Scalar|.  The kernel
+  // is not serialized.
+  void set_massive_bodies_kernel(MassiveBodiesKernel kernel);
+
+  // Sets the parameters of the |BarnesHut| kernel.  A spherical body is
+  // dominant if its gravitational parameter is at least |dominant_fraction|
+  // times the largest gravitational parameter of the system.  See
+  // |BarnesHutGravitation| for the meaning of |opening_angle|.  The defaults
+  // are 0.5 and 1e-9, respectively, which makes the planets and the large
+  // moons of the solar system dominant.  Not serialized.
+  void set_barnes_hut_parameters(double opening_angle,
+                                 double dominant_fraction);
+
+  // Distributes the computation of the accelerations between the spherical
+  // massive bodies over a pool of |threads| threads.  Each pairwise
+  // interaction is computed once, by the thread that owns its row of the
+  // triangle of pairs, and the accelerations on a body are then summed in the
+  // same order as in the serial computation, so the results are bit-identical
+  // irrespective of the number of threads.  The interactions with the oblate
+  // bodies are computed on the calling thread.  The default, 1, does all the
+  // computations on the calling thread.  Only applies to the |Scalar| kernel.
+  // Not serialized.
+  void set_massive_bodies_threads(int threads);
+
+  // Selects what |WriteToMessage| serializes.  The default is |Compact|.  The
+  // mode is not serialized.
+  void set_serialization_mode(SerializationMode mode);
+
+  // Keeps the older parts of the trajectories of the bodies in files in
+  // |directory|, see |ContinuousTrajectory::SetSeriesStore|.  Must be called
+  // at most once.  Not serialized.
+  void SetSeriesStores(std::experimental::filesystem::path const& directory,
+                       int max_series_in_memory);
+
+  // Distributes the integrations performed by |FlowAllWithAdaptiveStep| over a
+  // pool of |threads| threads.  The default, 1, does all the integrations on
+  // the calling thread.  Not serialized.
+  void set_massless_bodies_threads(int threads);
+
+  // Distributes the fitting of the series of the massive bodies, which happens
+  // every few steps of |Prolong|, over a pool of |threads| threads, one body
+  // per task.  The trajectories are independent, so the results are
+  // bit-identical irrespective of the number of threads.  This is beneficial
+  // when the |fitting_tolerance| is small and the fits are expensive.  Also
+  // applies to the background prolongation.  The default, 1, does all the fits
+  // on the thread that integrates.  Not serialized.
+  void set_fitting_threads(int threads);
+
   // Integrates, until exactly |t| (except for timeouts or singularities), the
   // |trajectory| followed by a massless body in the gravitational potential
   // described by |*this|.  If |t > t_max()|, calls |Prolong(t)| beforehand.
@@ -161,6 +313,44 @@ class Ephemeris {
       AdaptiveStepParameters const& parameters,
       std::int64_t max_ephemeris_steps);
 
+  // Same as above, but also appends the events of |event_detector| that occur
+  // during the integration to the trajectories given to |event_detector|.
+  virtual bool FlowWithAdaptiveStep(
+      not_null<DiscreteTrajectory<Frame>*> trajectory,
+      IntrinsicAcceleration intrinsic_acceleration,
+      Instant const& t,
+      AdaptiveStepParameters const& parameters,
+      std::int64_t max_ephemeris_steps,
+      EventDetector& event_detector);
+
+  // Same as the first overload, but for all the |trajectories|, each of which
+  // is integrated with its own step size control, using the corresponding
+  // element of |parameters|.  |intrinsic_accelerations| is either empty or has
+  // one element per trajectory.  The ephemeris is prolonged once for all the
+  // trajectories.  The positions of the massive bodies are evaluated once for
+  // all the integrations that need them at the same time, which happens in
+  // particular when the trajectories end at the same time and their first steps
+  // succeed.  The integrations are distributed over the threads requested by
+  // |set_massless_bodies_threads|, so the intrinsic accelerations must be safe
+  // to call concurrently.  Returns true if and only if all the |trajectories|
+  // were integrated until |t|.
+  virtual bool FlowAllWithAdaptiveStep(
+      std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories,
+      IntrinsicAccelerations const& intrinsic_accelerations,
+      Instant const& t,
+      std::vector<AdaptiveStepParameters> const& parameters,
+      std::int64_t max_ephemeris_steps);
+
+  // Same as above, but each of the |trajectories| is integrated until the
+  // corresponding element of |t|.  Returns, for each trajectory, true if and
+  // only if it was integrated until its element of |t|.
+  virtual std::vector<bool> FlowEachWithAdaptiveStep(
+      std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories,
+      IntrinsicAccelerations const& intrinsic_accelerations,
+      std::vector<Instant> const& t,
+      std::vector<AdaptiveStepParameters> const& parameters,
+      std::int64_t max_ephemeris_steps);
+
   // Integrates, until at most |t|, the |trajectories| followed by massless
   // bodies in the gravitational potential described by |*this|.  If
   // |t > t_max()|, calls |Prolong(t)| beforehand.
@@ -192,6 +382,20 @@ class Ephemeris {
       not_null<MassiveBody const*> body,
       Instant const& t) const;
 
+  // Returns an event function that increases through zero at the periapsides
+  // of a massless body with respect to |body|, i.e., at its closest approaches
+  // to |body|, and decreases through zero at its apoapsides.
+  virtual EventFunction ApsisEventFunction(
+      not_null<MassiveBody const*> body) const;
+
+  // Returns an event function that increases through zero at the ascending
+  // nodes of a massless body on the plane going through the centre of |body|
+  // and orthogonal to |normal|, and decreases through zero at its descending
+  // nodes.
+  virtual EventFunction NodeEventFunction(
+      not_null<MassiveBody const*> body,
+      Vector<double, Frame> const& normal) const;
+
   // Computes the apsides with respect to |body| for the discrete trajectory
   // segment given by |begin| and |end|.  Appends to the given trajectories one
   // point for each apsis.
@@ -248,14 +452,144 @@ class Ephemeris {
     std::vector<typename ContinuousTrajectory<Frame>::Checkpoint> checkpoints;
   };
 
+  // The state of the integration performed on a background thread.  See
+  // |StartBackgroundProlongation|.
+  struct BackgroundProlongation final {
+    Time horizon;
+
+    std::mutex lock;
+    // Notified when |target| increases or |shutdown| is set.
+    std::condition_variable target_increased_or_shutdown;
+    // Notified each time the background integration appends a state.
+    std::condition_variable progress;
+
+    // The time until which the background thread should integrate.
+    Instant target GUARDED_BY(lock);
+    bool shutdown GUARDED_BY(lock) = false;
+
+    // The continuations of |trajectories_|, in the same order, holding the
+    // series published by the background thread and not yet spliced.
+    std::vector<not_null<std::unique_ptr<ContinuousTrajectory<Frame>>>>
+        trajectories GUARDED_BY(lock);
+    typename NewtonianMotionEquation::SystemState last_state GUARDED_BY(lock);
+    // The checkpoints not yet transferred to |checkpoints_|.
+    std::vector<Checkpoint> checkpoints GUARDED_BY(lock);
+    Status last_severe_integration_status GUARDED_BY(lock);
+    // The error returned by the integrator, if any, in which case the
+    // background thread has terminated.  |progress| is notified when it is set.
+    Status failure GUARDED_BY(lock);
+
+    // The continuations of |trajectories|, in the same order, to which the
+    // background thread appends, and which it splices into |trajectories|
+    // after each step.  The expensive fitting of the series thus happens
+    // without holding |lock|.  Only accessed by the background thread.
+    std::vector<not_null<std::unique_ptr<ContinuousTrajectory<Frame>>>>
+        working_trajectories;
+    Instant last_checkpoint_time;
+
+    // The minimum of the |t_max| of the |trajectories|.  Published by the
+    // background thread, may be read without holding |lock|.
+    std::atomic<Instant> t_max;
+
+    std::thread thread;
+  };
+
+  // The positions of the massive bodies at the times at which they were needed
+  // by the integrations of |FlowEachWithAdaptiveStep|, shared by the threads
+  // that perform these integrations.  Thread-safe.
+  class MassiveBodiesPositionsCache final {
+   public:
+    explicit MassiveBodiesPositionsCache(Ephemeris const& ephemeris);
+
+    // Returns the positions of the massive bodies at |t|, in the order of
+    // |bodies_|.  The |hints| are used if the positions have to be evaluated.
+    // The result is not copied, and remains valid after it is evicted.
+    std::shared_ptr<std::vector<Position<Frame>> const> Get(
+        Instant const& t,
+        std::vector<typename ContinuousTrajectory<Frame>::Hint>& hints);
+
+   private:
+    Ephemeris const& ephemeris_;
+    std::mutex lock_;
+    std::map<Instant, std::shared_ptr<std::vector<Position<Frame>> const>>
+        positions_ GUARDED_BY(lock_);
+  };
+
   void AppendMassiveBodiesState(
       typename NewtonianMotionEquation::SystemState const& state);
+  // Same as above, but for the background integration.  Runs on the
+  // background thread.
+  void AppendMassiveBodiesStateInBackground(
+      typename NewtonianMotionEquation::SystemState const& state);
+
+  // The body of the background thread.
+  void ProlongInBackground();
+
+  // Calls |f| with no background prolongation running, restarting it
+  // afterwards if there was one.
+  template<typename F>
+  void WithoutBackgroundProlongation(F const& f);
+
+  // Appends the degrees of freedom in |state| to the |trajectories|, which are
+  // in the order of |bodies_|.  The appends that fit a series are distributed
+  // over the |fitting_thread_pool_| if it is not null.  Errors are logged and
+  // recorded in |last_severe_integration_status|.
+  template<typename Trajectories>
+  void AppendToTrajectories(
+      typename NewtonianMotionEquation::SystemState const& state,
+      Trajectories const& trajectories,
+      Status& last_severe_integration_status);
+
+  // Transfers the results of the background integration to |trajectories_|,
+  // |checkpoints_|, etc.  |background_->lock| must be held.
+  void SpliceBackgroundProlongation();
   static void AppendMasslessBodiesState(
       typename NewtonianMotionEquation::SystemState const& state,
       std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories);
 
   Checkpoint GetCheckpoint();
 
+  // Returns the series of all the |trajectories_| over the interval of their
+  // series in memory applicable for |t|, or null if |t| is not in such an
+  // interval or if the trajectories don't have the same intervals.
+  std::shared_ptr<InterleavedSeries<Frame> const> MakeInterleavedSeries(
+      Instant const& t) const;
+
+  // Sets |positions| to the positions of the massive bodies at |t|, in the
+  // order of |bodies_|.  Uses an |InterleavedSeries| if possible, otherwise
+  // evaluates each trajectory with the corresponding element of |hints|.
+  void EvaluateAllPositions(
+      Instant const& t,
+      std::vector<Position<Frame>>& positions,
+      std::vector<typename ContinuousTrajectory<Frame>::Hint>& hints) const;
+
+  // Splices the trajectories and restores the state written by a |Full|
+  // serialization.  Returns false and leaves this object unchanged if
+  // |message.continuation()| is not consistent with the rest of |message| or
+  // with this object.
+  bool SpliceContinuationFromMessage(serialization::Ephemeris const& message);
+  // A fingerprint of the parts of |message| that |message.continuation()|
+  // depends on, and of the continuation itself.
+  static std::uint64_t ContinuationFingerprint(
+      serialization::Ephemeris const& message);
+
+  // Returns the time until which |FlowWithAdaptiveStep| integrates a trajectory
+  // whose last point is at |trajectory_last_time|.
+  Instant FlowFinalTime(Instant const& trajectory_last_time,
+                        Instant const& t,
+                        AdaptiveStepParameters const& parameters,
+                        std::int64_t max_ephemeris_steps) const;
+
+  // Integrates |trajectory| until |t_final| with the given
+  // |massless_body_equation|, which must not prolong the ephemeris.  Detects
+  // the events of |event_detector| unless it is null.
+  static Status FlowWithAdaptiveStepUntil(
+      not_null<DiscreteTrajectory<Frame>*> trajectory,
+      NewtonianMotionEquation const& massless_body_equation,
+      Instant const& t_final,
+      AdaptiveStepParameters const& parameters,
+      EventDetector* event_detector);
+
   // Computes the accelerations between one body, |body1| (with index |b1| in
   // the |positions| and |accelerations| arrays) and the bodies |bodies2| (with
   // indices [b2_begin, b2_end[ in the |bodies2|, |positions| and
@@ -275,36 +609,65 @@ class Ephemeris {
       std::vector<Position<Frame>> const& positions,
       std::vector<Vector<Acceleration, Frame>>& accelerations);
 
-  // Computes the accelerations due to one body, |body1| (with index |b1| in the
-  // |bodies_| and |trajectories_| arrays) on massless bodies at the given
-  // |positions|.  The template parameter specifies what we know about the
-  // massive body, and therefore what forces apply.
+  // Computes the accelerations due to one body, |body1| (at |position1|) on
+  // massless bodies at the given |positions|.  The template parameter
+  // specifies what we know about the massive body, and therefore what forces
+  // apply.
   template<bool body1_is_oblate>
   void ComputeGravitationalAccelerationByMassiveBodyOnMasslessBodies(
-      Instant const& t,
       MassiveBody const& body1,
-      std::size_t const b1,
+      Position<Frame> const& position1,
       std::vector<Position<Frame>> const& positions,
-      std::vector<Vector<Acceleration, Frame>>& accelerations,
-      typename ContinuousTrajectory<Frame>::Hint& hint1) const;
+      std::vector<Vector<Acceleration, Frame>>& accelerations) const;
 
   // Computes the accelerations between all the massive bodies in |bodies_|.
+  // Uses |vectorized_gravitation_| or |barnes_hut_gravitation_| for the
+  // spherical bodies if one of them is not null, otherwise uses the
+  // |thread_pool_| if it is not null.
   void ComputeMassiveBodiesGravitationalAccelerations(
       Instant const& t,
       std::vector<Position<Frame>> const& positions,
       std::vector<Vector<Acceleration, Frame>>& accelerations) const;
 
+  // The index in |spherical_pair_accelerations_| of the pair of spherical
+  // bodies |s1| < |s2|, counted from the first spherical body.  The pairs are
+  // stored row by row, in the order in which the serial computation processes
+  // them.
+  std::size_t SphericalPairIndex(std::size_t s1, std::size_t s2) const;
+
+  // Computes the accelerations of the pairs of spherical bodies in the rows
+  // [s_begin, s_end[ of the triangle of pairs and stores them in
+  // |spherical_pair_accelerations_|.
+  void ComputeSphericalPairAccelerations(
+      std::size_t s_begin,
+      std::size_t s_end,
+      std::vector<Position<Frame>> const& positions) const;
+
+  // Adds the accelerations stored in |spherical_pair_accelerations_| to the
+  // elements of |accelerations| for the spherical bodies [s_begin, s_end[, in
+  // the same order as the serial computation.
+  void AddSphericalPairAccelerations(
+      std::size_t s_begin,
+      std::size_t s_end,
+      std::vector<Vector<Acceleration, Frame>>& accelerations) const;
+
   // Computes the acceleration exerted by the massive bodies in |bodies_| on
   // massless bodies.  The massless bodies are at the given |positions|.  The
-  // |hints| are passed to
-  // ComputeGravitationalAccelerationByMassiveBodyOnMasslessBody for efficient
-  // computation of the positions of the massive bodies.
+  // positions of the massive bodies are obtained from |EvaluateAllPositions|,
+  // which uses the |hints| if needed.
   void ComputeMasslessBodiesGravitationalAccelerations(
       Instant const& t,
       std::vector<Position<Frame>> const& positions,
       std::vector<Vector<Acceleration, Frame>>& accelerations,
       std::vector<typename ContinuousTrajectory<Frame>::Hint>& hints) const;
 
+  // Same as above, but the positions of the massive bodies, in the order of
+  // |bodies_|, are given.
+  void ComputeMasslessBodiesGravitationalAccelerations(
+      std::vector<Position<Frame>> const& massive_bodies_positions,
+      std::vector<Position<Frame>> const& positions,
+      std::vector<Vector<Acceleration, Frame>>& accelerations) const;
+
   // Same as above, but the massless bodies have intrinsic accelerations.
   // |intrinsic_accelerations| may be empty.
   void ComputeMasslessBodiesTotalAccelerations(
@@ -346,11 +709,63 @@ class Ephemeris {
   // implement compact serialization.  The vector is time-ordered.
   std::vector<Checkpoint> checkpoints_;
 
+  SerializationMode serialization_mode_ = SerializationMode::Compact;
+
   int number_of_oblate_bodies_ = 0;
   int number_of_spherical_bodies_ = 0;
 
   NewtonianMotionEquation massive_bodies_equation_;
 
+  // The result of the last call to |MakeInterleavedSeries|, which is likely to
+  // be needed again since evaluations tend to be close in time.  Only accessed
+  // with |std::atomic_load| and |std::atomic_store| since the evaluations may
+  // happen concurrently.
+  mutable std::shared_ptr<InterleavedSeries<Frame> const>
+      last_interleaved_series_;
+
+  // Null unless the |MassiveBodiesKernel::Vectorized| kernel is selected.  The
+  // elements correspond to the spherical bodies of |bodies_|.  Not const
+  // because it holds the buffers used by the computation.
+  std::unique_ptr<VectorizedGravitation<Frame>> vectorized_gravitation_;
+
+  // Null unless the |MassiveBodiesKernel::BarnesHut| kernel is selected.
+  // Same remarks as above.
+  std::unique_ptr<BarnesHutGravitation<Frame>> barnes_hut_gravitation_;
+  double barnes_hut_opening_angle_ = 0.5;
+  double barnes_hut_dominant_fraction_ = 1e-9;
+
+  // Null unless more than one thread was requested by
+  // |set_massive_bodies_threads|.
+  std::unique_ptr<base::ThreadPool<void>> thread_pool_;
+
+  // The accelerations exerted on one another by two spherical bodies |b1| <
+  // |b2|: |on_b1| is subtracted from the acceleration of |b1|, |on_b2| is
+  // added to that of |b2|.
+  struct SphericalPairAccelerations {
+    Vector<Acceleration, Frame> on_b1;
+    Vector<Acceleration, Frame> on_b2;
+  };
+
+  // Only used if |thread_pool_| is not null.  The rows of the triangle of
+  // pairs of spherical bodies are split in tiles with roughly the same number
+  // of pairs, one per thread; tile |i| covers the rows
+  // [spherical_pair_tiles_[i], spherical_pair_tiles_[i + 1][.  Each thread
+  // writes its own range of |spherical_pair_accelerations_|, which is
+  // allocated once by |set_massive_bodies_threads|.
+  std::vector<std::size_t> spherical_pair_tiles_;
+  mutable std::vector<SphericalPairAccelerations>
+      spherical_pair_accelerations_;
+
+  // Null unless more than one thread was requested by
+  // |set_massless_bodies_threads|.
+  std::unique_ptr<base::ThreadPool<bool>> massless_bodies_thread_pool_;
+
+  // Null unless more than one thread was requested by |set_fitting_threads|.
+  std::unique_ptr<base::ThreadPool<Status>> fitting_thread_pool_;
+
+  // Null unless a background prolongation is running.
+  std::unique_ptr<BackgroundProlongation> background_;
+
   Status last_severe_integration_status_;
 };
 
@@ -4,12 +4,18 @@
 #include "physics/ephemeris.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <functional>
+#include <future>
+#include <iterator>
 #include <limits>
 #include <set>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "astronomy/epoch.hpp"
+#include "base/fingerprint2011.hpp"
 #include "base/macros.hpp"
 #include "base/map_util.hpp"
 #include "base/not_null.hpp"
@@ -29,6 +35,8 @@ namespace internal_ephemeris {
 
 using astronomy::J2000;
 using base::FindOrDie;
+using base::Fingerprint2011;
+using base::FingerprintCat2011;
 using base::make_not_null_unique;
 using geometry::Barycentre;
 using geometry::Displacement;
@@ -43,10 +51,12 @@ using integrators::IntegrationProblem;
 using numerics::Bisect;
 using numerics::DoublePrecision;
 using numerics::Hermite3;
+using numerics::ЧебышёвSeries;
 using quantities::Abs;
 using quantities::Exponentiation;
 using quantities::GravitationalParameter;
 using quantities::Quotient;
+using quantities::SIUnit;
 using quantities::Square;
 using quantities::Time;
 using quantities::Variation;
@@ -56,6 +66,10 @@ using ::std::placeholders::_1;
 using ::std::placeholders::_2;
 using ::std::placeholders::_3;
 
+// The maximum number of times for which |FlowEachWithAdaptiveStep| keeps the
+// positions of the massive bodies.
+int const max_cached_positions = 1000;
+
 Time const max_time_between_checkpoints = 180 * Day;
 
 // If j is a unit vector along the axis of rotation, and r a vector from the
@@ -124,6 +138,17 @@ Speed Ephemeris<Frame>::AdaptiveStepParameters::speed_integration_tolerance()
   return speed_integration_tolerance_;
 }
 
+template<typename Frame>
+Time const& Ephemeris<Frame>::AdaptiveStepParameters::sampling_period() const {
+  return sampling_period_;
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::AdaptiveStepParameters::set_max_steps(
+    std::int64_t const max_steps) {
+  max_steps_ = max_steps;
+}
+
 template<typename Frame>
 void Ephemeris<Frame>::AdaptiveStepParameters::set_length_integration_tolerance(
     Length const& length_integration_tolerance) {
@@ -136,6 +161,13 @@ void Ephemeris<Frame>::AdaptiveStepParameters::set_speed_integration_tolerance(
   speed_integration_tolerance_ = speed_integration_tolerance;
 }
 
+template<typename Frame>
+void Ephemeris<Frame>::AdaptiveStepParameters::set_sampling_period(
+    Time const& sampling_period) {
+  CHECK_LE(Time(), sampling_period);
+  sampling_period_ = sampling_period;
+}
+
 template<typename Frame>
 void Ephemeris<Frame>::AdaptiveStepParameters::WriteToMessage(
     not_null<serialization::Ephemeris::AdaptiveStepParameters*> const message)
@@ -146,18 +178,26 @@ void Ephemeris<Frame>::AdaptiveStepParameters::WriteToMessage(
       message->mutable_length_integration_tolerance());
   speed_integration_tolerance_.WriteToMessage(
       message->mutable_speed_integration_tolerance());
+  if (sampling_period_ > Time()) {
+    sampling_period_.WriteToMessage(message->mutable_sampling_period());
+  }
 }
 
 template<typename Frame>
 typename Ephemeris<Frame>::AdaptiveStepParameters
 Ephemeris<Frame>::AdaptiveStepParameters::ReadFromMessage(
     serialization::Ephemeris::AdaptiveStepParameters const& message) {
-  return AdaptiveStepParameters(
+  AdaptiveStepParameters parameters(
       AdaptiveStepSizeIntegrator<NewtonianMotionEquation>::ReadFromMessage(
           message.integrator()),
       message.max_steps(),
       Length::ReadFromMessage(message.length_integration_tolerance()),
       Speed::ReadFromMessage(message.speed_integration_tolerance()));
+  if (message.has_sampling_period()) {
+    parameters.set_sampling_period(
+        Time::ReadFromMessage(message.sampling_period()));
+  }
+  return parameters;
 }
 
 template<typename Frame>
@@ -192,6 +232,17 @@ Ephemeris<Frame>::FixedStepParameters::ReadFromMessage(
       Time::ReadFromMessage(message.step()));
 }
 
+template<typename Frame>
+void Ephemeris<Frame>::EventDetector::Add(
+    EventFunction function,
+    DiscreteTrajectory<Frame>* const increasing,
+    DiscreteTrajectory<Frame>* const decreasing) {
+  events_.push_back({std::move(function),
+                     increasing,
+                     decreasing,
+                     /*last_value=*/0});
+}
+
 template<typename Frame>
 Ephemeris<Frame>::Ephemeris(
     std::vector<not_null<std::unique_ptr<MassiveBody const>>>&& bodies,
@@ -325,10 +376,44 @@ void Ephemeris<Frame>::ForgetBefore(Instant const& t) {
     trajectory.ForgetBefore(t);
   }
   checkpoints_.erase(checkpoints_.begin(), it);
+  // The cached series may point to series that were just destroyed.
+  std::atomic_store(&last_interleaved_series_,
+                    std::shared_ptr<InterleavedSeries<Frame> const>());
+}
+
+template<typename Frame>
+Ephemeris<Frame>::~Ephemeris() {
+  StopBackgroundProlongation();
 }
 
 template<typename Frame>
 void Ephemeris<Frame>::Prolong(Instant const& t) {
+  if (background_ != nullptr) {
+    Status failure;
+    {
+      std::unique_lock<std::mutex> l(background_->lock);
+      Instant const target = t + background_->horizon;
+      if (background_->target < target) {
+        background_->target = target;
+        background_->target_increased_or_shutdown.notify_one();
+      }
+      background_->progress.wait(l, [this, &t]() {
+        return background_->t_max.load() >= t || !background_->failure.ok();
+      });
+      SpliceBackgroundProlongation();
+      if (background_->t_max.load() >= t) {
+        return;
+      }
+      failure = background_->failure;
+    }
+    // The background thread has terminated without reaching |t|.  Give up on
+    // the background prolongation and resume the integration on this thread
+    // from the last state that it reached.
+    LOG(ERROR) << "Background prolongation failed: " << failure;
+    StopBackgroundProlongation();
+    last_severe_integration_status_ = failure;
+  }
+
   IntegrationProblem<NewtonianMotionEquation> problem;
   problem.equation = massive_bodies_equation_;
   problem.initial_state = &last_state_;
@@ -352,7 +437,12 @@ void Ephemeris<Frame>::Prolong(Instant const& t) {
   // actually reaches |t| because the last series may not be fully determined
   // after the first integration.
   while (t_max() < t) {
-    instance->Solve(t_final);
+    Status const status = instance->Solve(t_final);
+    if (!status.ok()) {
+      LOG(ERROR) << "Prolongation failed: " << status;
+      last_severe_integration_status_ = status;
+      return;
+    }
     // Here |problem.initial_state| still points at |last_state_|, which is the
     // state at the end of the previous call to |Solve|.  It is therefore the
     // right initial state for the next call to |Solve|, if any.
@@ -360,6 +450,192 @@ void Ephemeris<Frame>::Prolong(Instant const& t) {
   }
 }
 
+template<typename Frame>
+void Ephemeris<Frame>::StartBackgroundProlongation(Time const& horizon) {
+  CHECK(background_ == nullptr);
+  CHECK_LE(Time(), horizon);
+  background_ = std::make_unique<BackgroundProlongation>();
+  background_->horizon = horizon;
+  background_->target = t_max() + horizon;
+  for (auto const& trajectory : trajectories_) {
+    background_->trajectories.push_back(trajectory->NewContinuation());
+    background_->working_trajectories.push_back(
+        background_->trajectories.back()->NewContinuation());
+  }
+  background_->last_state = last_state_;
+  background_->last_checkpoint_time =
+      checkpoints_.empty() ? astronomy::InfinitePast
+                           : checkpoints_.back().system_state.time.value;
+  background_->last_severe_integration_status = last_severe_integration_status_;
+  background_->t_max = t_max();
+  background_->thread = std::thread(&Ephemeris::ProlongInBackground, this);
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::StopBackgroundProlongation() {
+  if (background_ == nullptr) {
+    return;
+  }
+  {
+    std::unique_lock<std::mutex> l(background_->lock);
+    background_->shutdown = true;
+  }
+  background_->target_increased_or_shutdown.notify_one();
+  background_->thread.join();
+  {
+    std::unique_lock<std::mutex> l(background_->lock);
+    SpliceBackgroundProlongation();
+  }
+  background_.reset();
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::set_massive_bodies_kernel(
+    MassiveBodiesKernel const kernel) {
+  WithoutBackgroundProlongation([this, kernel]() {
+    switch (kernel) {
+      case MassiveBodiesKernel::Scalar:
+        vectorized_gravitation_.reset();
+        barnes_hut_gravitation_.reset();
+        break;
+      case MassiveBodiesKernel::Vectorized: {
+        std::vector<GravitationalParameter> gravitational_parameters;
+        for (int b = number_of_oblate_bodies_;
+             b < number_of_oblate_bodies_ + number_of_spherical_bodies_;
+             ++b) {
+          gravitational_parameters.push_back(
+              bodies_[b]->gravitational_parameter());
+        }
+        vectorized_gravitation_ =
+            std::make_unique<VectorizedGravitation<Frame>>(
+                gravitational_parameters);
+        barnes_hut_gravitation_.reset();
+        break;
+      }
+      case MassiveBodiesKernel::BarnesHut: {
+        std::vector<GravitationalParameter> gravitational_parameters;
+        for (int b = number_of_oblate_bodies_;
+             b < number_of_oblate_bodies_ + number_of_spherical_bodies_;
+             ++b) {
+          gravitational_parameters.push_back(
+              bodies_[b]->gravitational_parameter());
+        }
+        GravitationalParameter largest_gravitational_parameter;
+        for (auto const& body : bodies_) {
+          largest_gravitational_parameter =
+              std::max(largest_gravitational_parameter,
+                       body->gravitational_parameter());
+        }
+        barnes_hut_gravitation_ =
+            std::make_unique<BarnesHutGravitation<Frame>>(
+                gravitational_parameters,
+                barnes_hut_dominant_fraction_ * largest_gravitational_parameter,
+                barnes_hut_opening_angle_);
+        vectorized_gravitation_.reset();
+        break;
+      }
+      default:
+        LOG(FATAL) << "Unexpected kernel " << static_cast<int>(kernel);
+        base::noreturn();
+    }
+  });
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::set_barnes_hut_parameters(
+    double const opening_angle,
+    double const dominant_fraction) {
+  WithoutBackgroundProlongation([this, opening_angle, dominant_fraction]() {
+    CHECK_LE(0, opening_angle);
+    CHECK_LE(0, dominant_fraction);
+    barnes_hut_opening_angle_ = opening_angle;
+    barnes_hut_dominant_fraction_ = dominant_fraction;
+    if (barnes_hut_gravitation_ != nullptr) {
+      set_massive_bodies_kernel(MassiveBodiesKernel::BarnesHut);
+    }
+  });
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::set_massive_bodies_threads(int const threads) {
+  WithoutBackgroundProlongation([this, threads]() {
+    CHECK_LE(1, threads);
+    if (threads == 1) {
+      thread_pool_.reset();
+      spherical_pair_tiles_.clear();
+      spherical_pair_accelerations_.clear();
+      spherical_pair_accelerations_.shrink_to_fit();
+      return;
+    }
+    thread_pool_ = std::make_unique<base::ThreadPool<void>>(threads);
+
+    // Split the rows of the triangle of pairs so that the tiles have roughly
+    // the same number of pairs: the first rows are longer than the last ones.
+    std::size_t const number_of_spherical_bodies = number_of_spherical_bodies_;
+    std::size_t const number_of_pairs =
+        number_of_spherical_bodies == 0
+            ? 0
+            : SphericalPairIndex(number_of_spherical_bodies - 1,
+                                 number_of_spherical_bodies);
+    std::size_t const number_of_tiles = threads;
+    spherical_pair_tiles_.clear();
+    spherical_pair_tiles_.push_back(0);
+    std::size_t s = 0;
+    for (std::size_t tile = 1; tile < number_of_tiles; ++tile) {
+      std::size_t const first_pair_of_tile =
+          tile * number_of_pairs / number_of_tiles;
+      while (s < number_of_spherical_bodies &&
+             SphericalPairIndex(s, s + 1) < first_pair_of_tile) {
+        ++s;
+      }
+      spherical_pair_tiles_.push_back(s);
+    }
+    spherical_pair_tiles_.push_back(number_of_spherical_bodies);
+    spherical_pair_accelerations_.resize(number_of_pairs);
+  });
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::set_massless_bodies_threads(int const threads) {
+  CHECK_LE(1, threads);
+  if (threads == 1) {
+    massless_bodies_thread_pool_.reset();
+  } else {
+    massless_bodies_thread_pool_ =
+        std::make_unique<base::ThreadPool<bool>>(threads);
+  }
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::set_fitting_threads(int const threads) {
+  WithoutBackgroundProlongation([this, threads]() {
+    CHECK_LE(1, threads);
+    if (threads == 1) {
+      fitting_thread_pool_.reset();
+    } else {
+      fitting_thread_pool_ =
+          std::make_unique<base::ThreadPool<Status>>(threads);
+    }
+  });
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::set_serialization_mode(SerializationMode const mode) {
+  serialization_mode_ = mode;
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::SetSeriesStores(
+    std::experimental::filesystem::path const& directory,
+    int const max_series_in_memory) {
+  // The files are named after the serialization indices, which are stable,
+  // rather than after the names of the bodies, which are arbitrary strings.
+  for (int i = 0; i < trajectories_.size(); ++i) {
+    trajectories_[i]->SetSeriesStore(
+        directory / (std::to_string(i) + ".series"), max_series_in_memory);
+  }
+}
+
 template<typename Frame>
 bool Ephemeris<Frame>::FlowWithAdaptiveStep(
     not_null<DiscreteTrajectory<Frame>*> const trajectory,
@@ -367,24 +643,32 @@ bool Ephemeris<Frame>::FlowWithAdaptiveStep(
     Instant const& t,
     AdaptiveStepParameters const& parameters,
     std::int64_t const max_ephemeris_steps) {
+  EventDetector no_events;
+  return FlowWithAdaptiveStep(trajectory,
+                              std::move(intrinsic_acceleration),
+                              t,
+                              parameters,
+                              max_ephemeris_steps,
+                              no_events);
+}
+
+template<typename Frame>
+bool Ephemeris<Frame>::FlowWithAdaptiveStep(
+    not_null<DiscreteTrajectory<Frame>*> const trajectory,
+    IntrinsicAcceleration intrinsic_acceleration,
+    Instant const& t,
+    AdaptiveStepParameters const& parameters,
+    std::int64_t const max_ephemeris_steps,
+    EventDetector& event_detector) {
   Instant const& trajectory_last_time = trajectory->last().time();
   if (trajectory_last_time == t) {
     return true;
   }
 
-  std::vector<not_null<DiscreteTrajectory<Frame>*>> const trajectories =
-      {trajectory};
   std::vector<IntrinsicAcceleration> const intrinsic_accelerations =
       {std::move(intrinsic_acceleration)};
-  // The |min| is here to prevent us from spending too much time computing the
-  // ephemeris.  The |max| is here to ensure that we always try to integrate
-  // forward.  We use |last_state_.time.value| because this is always finite,
-  // contrary to |t_max()|, which is -∞ when |empty()|.
-  Instant const t_final =
-      std::min(std::max(last_state_.time.value +
-                            max_ephemeris_steps * parameters_.step(),
-                        trajectory_last_time + parameters_.step()),
-               t);
+  Instant const t_final = FlowFinalTime(
+      trajectory_last_time, t, parameters, max_ephemeris_steps);
   Prolong(t_final);
 
   std::vector<typename ContinuousTrajectory<Frame>::Hint> hints(bodies_.size());
@@ -395,37 +679,8 @@ bool Ephemeris<Frame>::FlowWithAdaptiveStep(
                 std::cref(intrinsic_accelerations), _1, _2, _3,
                 std::ref(hints));
 
-  typename NewtonianMotionEquation::SystemState initial_state;
-  auto const trajectory_last = trajectory->last();
-  auto const last_degrees_of_freedom = trajectory_last.degrees_of_freedom();
-  initial_state.time = DoublePrecision<Instant>(trajectory_last.time());
-  initial_state.positions.emplace_back(last_degrees_of_freedom.position());
-  initial_state.velocities.emplace_back(last_degrees_of_freedom.velocity());
-
-  IntegrationProblem<NewtonianMotionEquation> problem;
-  problem.equation = massless_body_equation;
-  problem.initial_state = &initial_state;
-
-  AdaptiveStepSize<NewtonianMotionEquation> step_size;
-  step_size.first_time_step = t_final - initial_state.time.value;
-  CHECK_GT(step_size.first_time_step, 0 * Second)
-      << "Flow back to the future: " << t_final
-      << " <= " << initial_state.time.value;
-  step_size.safety_factor = 0.9;
-  step_size.tolerance_to_error_ratio =
-      std::bind(&Ephemeris<Frame>::ToleranceToErrorRatio,
-                std::cref(parameters.length_integration_tolerance_),
-                std::cref(parameters.speed_integration_tolerance_),
-                _1, _2);
-  step_size.max_steps = parameters.max_steps_;
-
-  auto const instance = parameters.integrator_->NewInstance(
-      problem,
-      std::bind(
-          &Ephemeris::AppendMasslessBodiesState, _1, std::cref(trajectories)),
-      step_size);
-
-  auto const status = instance->Solve(t_final);
+  auto const status = FlowWithAdaptiveStepUntil(
+      trajectory, massless_body_equation, t_final, parameters, &event_detector);
   // TODO(egg): when we have events in trajectories, we should add a singularity
   // event at the end if the outcome indicates a singularity
   // (|VanishingStepSize|).  We should not have an event on the trajectory if
@@ -434,6 +689,110 @@ bool Ephemeris<Frame>::FlowWithAdaptiveStep(
   return status.ok() && t_final == t;
 }
 
+template<typename Frame>
+bool Ephemeris<Frame>::FlowAllWithAdaptiveStep(
+    std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories,
+    IntrinsicAccelerations const& intrinsic_accelerations,
+    Instant const& t,
+    std::vector<AdaptiveStepParameters> const& parameters,
+    std::int64_t const max_ephemeris_steps) {
+  std::vector<bool> const reached_t =
+      FlowEachWithAdaptiveStep(trajectories,
+                               intrinsic_accelerations,
+                               std::vector<Instant>(trajectories.size(), t),
+                               parameters,
+                               max_ephemeris_steps);
+  return std::all_of(reached_t.begin(), reached_t.end(),
+                     [](bool const b) { return b; });
+}
+
+template<typename Frame>
+std::vector<bool> Ephemeris<Frame>::FlowEachWithAdaptiveStep(
+    std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories,
+    IntrinsicAccelerations const& intrinsic_accelerations,
+    std::vector<Instant> const& t,
+    std::vector<AdaptiveStepParameters> const& parameters,
+    std::int64_t const max_ephemeris_steps) {
+  CHECK_EQ(trajectories.size(), t.size());
+  CHECK_EQ(trajectories.size(), parameters.size());
+  CHECK(intrinsic_accelerations.empty() ||
+        intrinsic_accelerations.size() == trajectories.size());
+
+  std::vector<bool> reached_t(trajectories.size(), true);
+
+  // The indices of the trajectories that need to be integrated, and the times
+  // until which they are integrated.
+  std::vector<int> indices;
+  std::vector<Instant> t_finals;
+  for (int i = 0; i < trajectories.size(); ++i) {
+    Instant const& trajectory_last_time = trajectories[i]->last().time();
+    if (trajectory_last_time != t[i]) {
+      indices.push_back(i);
+      t_finals.push_back(FlowFinalTime(
+          trajectory_last_time, t[i], parameters[i], max_ephemeris_steps));
+    }
+  }
+  if (indices.empty()) {
+    return reached_t;
+  }
+  Prolong(*std::max_element(t_finals.begin(), t_finals.end()));
+
+  // A single integration has nothing to share.
+  std::unique_ptr<MassiveBodiesPositionsCache> const cache =
+      indices.size() > 1 ? std::make_unique<MassiveBodiesPositionsCache>(*this)
+                         : nullptr;
+  auto const flow = [this, &cache, &indices, &intrinsic_accelerations,
+                     &parameters, &t, &t_finals, &trajectories](int const j) {
+    int const i = indices[j];
+    IntrinsicAcceleration const intrinsic_acceleration =
+        intrinsic_accelerations.empty() ? nullptr : intrinsic_accelerations[i];
+    std::vector<typename ContinuousTrajectory<Frame>::Hint> hints(
+        bodies_.size());
+    std::vector<Position<Frame>> massive_bodies_positions;
+    NewtonianMotionEquation massless_body_equation;
+    massless_body_equation.compute_acceleration =
+        [this, &cache, &hints, &intrinsic_acceleration,
+         &massive_bodies_positions](
+            Instant const& time,
+            std::vector<Position<Frame>> const& positions,
+            std::vector<Vector<Acceleration, Frame>>& accelerations) {
+          if (cache == nullptr) {
+            EvaluateAllPositions(time, massive_bodies_positions, hints);
+            ComputeMasslessBodiesGravitationalAccelerations(
+                massive_bodies_positions, positions, accelerations);
+          } else {
+            ComputeMasslessBodiesGravitationalAccelerations(
+                *cache->Get(time, hints), positions, accelerations);
+          }
+          if (intrinsic_acceleration != nullptr) {
+            accelerations[0] += intrinsic_acceleration(time);
+          }
+        };
+    auto const status = FlowWithAdaptiveStepUntil(trajectories[i],
+                                                  massless_body_equation,
+                                                  t_finals[j],
+                                                  parameters[i],
+                                                  /*event_detector=*/nullptr);
+    return status.ok() && t_finals[j] == t[i];
+  };
+
+  if (massless_bodies_thread_pool_ == nullptr) {
+    for (int j = 0; j < indices.size(); ++j) {
+      reached_t[indices[j]] = flow(j);
+    }
+  } else {
+    std::vector<std::future<bool>> futures;
+    for (int j = 0; j < indices.size(); ++j) {
+      futures.push_back(
+          massless_bodies_thread_pool_->Add(std::bind(flow, j)));
+    }
+    for (int j = 0; j < indices.size(); ++j) {
+      reached_t[indices[j]] = futures[j].get();
+    }
+  }
+  return reached_t;
+}
+
 template<typename Frame>
 void Ephemeris<Frame>::FlowWithFixedStep(
     std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories,
@@ -588,6 +947,41 @@ ComputeGravitationalAccelerationOnMassiveBody(
   return accelerations[0];
 }
 
+template<typename Frame>
+typename Ephemeris<Frame>::EventFunction Ephemeris<Frame>::ApsisEventFunction(
+    not_null<MassiveBody const*> const body) const {
+  not_null<ContinuousTrajectory<Frame> const*> const body_trajectory =
+      trajectory(body);
+  typename ContinuousTrajectory<Frame>::Hint hint;
+  // This is the sign of the derivative of the squared distance to |body|.
+  return [body_trajectory, hint](
+             Instant const& time,
+             DegreesOfFreedom<Frame> const& degrees_of_freedom) mutable {
+    RelativeDegreesOfFreedom<Frame> const relative =
+        degrees_of_freedom -
+        body_trajectory->EvaluateDegreesOfFreedom(time, &hint);
+    return InnerProduct(relative.displacement(), relative.velocity()) /
+           SIUnit<Variation<Square<Length>>>();
+  };
+}
+
+template<typename Frame>
+typename Ephemeris<Frame>::EventFunction Ephemeris<Frame>::NodeEventFunction(
+    not_null<MassiveBody const*> const body,
+    Vector<double, Frame> const& normal) const {
+  not_null<ContinuousTrajectory<Frame> const*> const body_trajectory =
+      trajectory(body);
+  typename ContinuousTrajectory<Frame>::Hint hint;
+  return [body_trajectory, hint, normal](
+             Instant const& time,
+             DegreesOfFreedom<Frame> const& degrees_of_freedom) mutable {
+    Displacement<Frame> const displacement =
+        degrees_of_freedom.position() -
+        body_trajectory->EvaluatePosition(time, &hint);
+    return InnerProduct(displacement, normal) / SIUnit<Length>();
+  };
+}
+
 template<typename Frame>
 void Ephemeris<Frame>::ComputeApsides(
     not_null<MassiveBody const*> const body,
@@ -794,6 +1188,19 @@ void Ephemeris<Frame>::WriteToMessage(
   }
   parameters_.WriteToMessage(message->mutable_fixed_step_parameters());
   fitting_tolerance_.WriteToMessage(message->mutable_fitting_tolerance());
+  if (serialization_mode_ == SerializationMode::Full && !checkpoints_.empty()) {
+    // The trajectories and state past the first checkpoint.  The fingerprint
+    // covers everything that the reader needs to trust to skip the
+    // integration.
+    auto const& checkpoints = checkpoints_.front().checkpoints;
+    auto* const continuation = message->mutable_continuation();
+    for (int i = 0; i < trajectories_.size(); ++i) {
+      trajectories_[i]->WriteContinuationToMessage(
+          continuation->add_trajectory(), checkpoints[i]);
+    }
+    last_state_.WriteToMessage(continuation->mutable_last_state());
+    continuation->set_fingerprint(ContinuationFingerprint(*message));
+  }
   LOG(INFO) << NAMED(message->SpaceUsed());
   LOG(INFO) << NAMED(message->ByteSize());
 }
@@ -850,8 +1257,18 @@ not_null<std::unique_ptr<Ephemeris<Frame>>> Ephemeris<Frame>::ReadFromMessage(
         body, std::move(deserialized_trajectory));
     ++index;
   }
+  // The trajectories created by the constructor are gone, and so are the
+  // series that the cache may have picked up from them.
+  std::atomic_store(&ephemeris->last_interleaved_series_,
+                    std::shared_ptr<InterleavedSeries<Frame> const>());
   if (message.has_t_max()) {
     ephemeris->checkpoints_.push_back(ephemeris->GetCheckpoint());
+    // If the continuation is usable, the trajectories already extend to
+    // |t_max| and this doesn't integrate anything.
+    if (message.has_continuation() &&
+        ephemeris->SpliceContinuationFromMessage(message)) {
+      ephemeris->checkpoints_.push_back(ephemeris->GetCheckpoint());
+    }
     ephemeris->Prolong(Instant::ReadFromMessage(message.t_max()));
   }
   return ephemeris;
@@ -955,28 +1372,44 @@ Ephemeris<Frame>::Ephemeris(
     : parameters_(integrator, 1 * Second) {}
 
 template<typename Frame>
-void Ephemeris<Frame>::AppendMassiveBodiesState(
-    typename NewtonianMotionEquation::SystemState const& state) {
-  last_state_ = state;
-  int index = 0;
-  for (int i = 0; i < trajectories_.size(); ++i) {
-    auto const& trajectory = trajectories_[i];
-    auto const status = trajectory->Append(
-        state.time.value,
-        DegreesOfFreedom<Frame>(state.positions[index].value,
-                                state.velocities[index].value));
+Ephemeris<Frame>::MassiveBodiesPositionsCache::MassiveBodiesPositionsCache(
+    Ephemeris const& ephemeris)
+    : ephemeris_(ephemeris) {}
 
-    // Handle the apocalypse.
-    if (!status.ok()) {
-      last_severe_integration_status_ =
-          Status(status.error(),
-                 "Error extending trajectory for " + bodies_[i]->name() + ". " +
-                     status.message());
-      LOG(ERROR) << "New Apocalypse: " << last_severe_integration_status_;
+template<typename Frame>
+std::shared_ptr<std::vector<Position<Frame>> const>
+Ephemeris<Frame>::MassiveBodiesPositionsCache::Get(
+    Instant const& t,
+    std::vector<typename ContinuousTrajectory<Frame>::Hint>& hints) {
+  {
+    std::lock_guard<std::mutex> l(lock_);
+    auto const it = positions_.find(t);
+    if (it != positions_.end()) {
+      return it->second;
     }
+  }
 
-    ++index;
+  // Evaluate outside of the lock so that the threads that need different times
+  // don't wait for each other.
+  auto positions = std::make_shared<std::vector<Position<Frame>>>();
+  ephemeris_.EvaluateAllPositions(t, *positions, hints);
+
+  std::lock_guard<std::mutex> l(lock_);
+  // The times of the integrations generally increase, so the earliest entry is
+  // the least likely to be useful.
+  if (positions_.size() == max_cached_positions) {
+    positions_.erase(positions_.begin());
   }
+  // If another thread evaluated the positions at |t| in the meantime, its
+  // entry is kept; the positions are the same anyway.
+  return positions_.emplace(t, std::move(positions)).first->second;
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::AppendMassiveBodiesState(
+    typename NewtonianMotionEquation::SystemState const& state) {
+  last_state_ = state;
+  AppendToTrajectories(state, trajectories_, last_severe_integration_status_);
 
   // Record an intermediate state if we haven't done so for too long.
   CHECK(!trajectories_.empty());
@@ -989,6 +1422,188 @@ void Ephemeris<Frame>::AppendMassiveBodiesState(
   }
 }
 
+template<typename Frame>
+void Ephemeris<Frame>::AppendMassiveBodiesStateInBackground(
+    typename NewtonianMotionEquation::SystemState const& state) {
+  // Fit the series without holding the lock, so that the foreground thread is
+  // not blocked.
+  Status severe_integration_status;
+  AppendToTrajectories(state,
+                       background_->working_trajectories,
+                       severe_integration_status);
+  Instant t_max = astronomy::InfiniteFuture;
+  for (auto const& trajectory : background_->working_trajectories) {
+    t_max = std::min(t_max, trajectory->t_max());
+  }
+  std::vector<typename ContinuousTrajectory<Frame>::Checkpoint> checkpoints;
+  if (t_max - background_->last_checkpoint_time >
+      max_time_between_checkpoints) {
+    for (auto const& trajectory : background_->working_trajectories) {
+      checkpoints.push_back(trajectory->GetCheckpoint());
+    }
+    background_->last_checkpoint_time = state.time.value;
+  }
+
+  // Publish the new series.
+  {
+    std::unique_lock<std::mutex> l(background_->lock);
+    for (int i = 0; i < background_->trajectories.size(); ++i) {
+      background_->trajectories[i]->Splice(
+          *background_->working_trajectories[i]);
+    }
+    background_->last_state = state;
+    if (!severe_integration_status.ok()) {
+      background_->last_severe_integration_status = severe_integration_status;
+    }
+    if (!checkpoints.empty()) {
+      background_->checkpoints.push_back(
+          Checkpoint({state, std::move(checkpoints)}));
+    }
+    background_->t_max = t_max;
+  }
+  background_->progress.notify_all();
+}
+
+template<typename Frame>
+template<typename Trajectories>
+void Ephemeris<Frame>::AppendToTrajectories(
+    typename NewtonianMotionEquation::SystemState const& state,
+    Trajectories const& trajectories,
+    Status& last_severe_integration_status) {
+  auto const append = [&state, &trajectories](int const i) {
+    return trajectories[i]->Append(
+        state.time.value,
+        DegreesOfFreedom<Frame>(state.positions[i].value,
+                                state.velocities[i].value));
+  };
+
+  // Handle the apocalypse.
+  auto const report = [this, &last_severe_integration_status](
+                          int const i,
+                          Status const& status) {
+    if (!status.ok()) {
+      last_severe_integration_status =
+          Status(status.error(),
+                 "Error extending trajectory for " + bodies_[i]->name() + ". " +
+                     status.message());
+      LOG(ERROR) << "New Apocalypse: " << last_severe_integration_status;
+    }
+  };
+
+  // Only the appends that fit a series are worth a task: the others merely
+  // record a point.  Most steps fit no series, and they are appended serially
+  // without allocating.
+  bool const parallel =
+      fitting_thread_pool_ != nullptr &&
+      std::any_of(trajectories.begin(),
+                  trajectories.end(),
+                  [](auto const& trajectory) {
+                    return trajectory->next_append_fits();
+                  });
+  if (!parallel) {
+    for (int i = 0; i < trajectories.size(); ++i) {
+      report(i, append(i));
+    }
+    return;
+  }
+
+  std::vector<Status> statuses(trajectories.size());
+  std::vector<std::pair<int, std::future<Status>>> futures;
+  for (int i = 0; i < trajectories.size(); ++i) {
+    if (trajectories[i]->next_append_fits()) {
+      futures.emplace_back(
+          i, fitting_thread_pool_->Add([&append, i]() { return append(i); }));
+    } else {
+      statuses[i] = append(i);
+    }
+  }
+  for (auto& pair : futures) {
+    statuses[pair.first] = pair.second.get();
+  }
+
+  // The statuses are examined in the order of |bodies_|, as if the appends had
+  // been serial.
+  for (int i = 0; i < trajectories.size(); ++i) {
+    report(i, statuses[i]);
+  }
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::ProlongInBackground() {
+  IntegrationProblem<NewtonianMotionEquation> problem;
+  problem.equation = massive_bodies_equation_;
+  {
+    std::unique_lock<std::mutex> l(background_->lock);
+    // The instance makes a copy of the initial state, so it is only accessed
+    // here.
+    problem.initial_state = &background_->last_state;
+  }
+  auto const instance = parameters_.integrator_->NewInstance(
+      problem,
+      std::bind(&Ephemeris::AppendMassiveBodiesStateInBackground, this, _1),
+      parameters_.step_);
+
+  Instant t_final = instance->time() + parameters_.step_;
+  for (;;) {
+    Instant target;
+    {
+      std::unique_lock<std::mutex> l(background_->lock);
+      background_->target_increased_or_shutdown.wait(l, [this]() {
+        return background_->shutdown ||
+               background_->t_max.load() < background_->target;
+      });
+      if (background_->shutdown) {
+        return;
+      }
+      target = background_->target;
+    }
+    // Integrate one step at a time, without holding the lock, so that we
+    // notice promptly if we are asked to shut down.
+    while (background_->t_max.load() < target) {
+      Status const status = instance->Solve(t_final);
+      t_final += parameters_.step_;
+      std::unique_lock<std::mutex> l(background_->lock);
+      if (!status.ok()) {
+        // Wake up |Prolong|, which would otherwise wait forever for progress.
+        background_->failure = status;
+        background_->progress.notify_all();
+        return;
+      }
+      if (background_->shutdown) {
+        return;
+      }
+      target = background_->target;
+    }
+  }
+}
+
+template<typename Frame>
+template<typename F>
+void Ephemeris<Frame>::WithoutBackgroundProlongation(F const& f) {
+  if (background_ == nullptr) {
+    f();
+    return;
+  }
+  Time const horizon = background_->horizon;
+  StopBackgroundProlongation();
+  f();
+  StartBackgroundProlongation(horizon);
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::SpliceBackgroundProlongation() {
+  for (int i = 0; i < trajectories_.size(); ++i) {
+    trajectories_[i]->Splice(*background_->trajectories[i]);
+  }
+  last_state_ = background_->last_state;
+  std::move(background_->checkpoints.begin(),
+            background_->checkpoints.end(),
+            std::back_inserter(checkpoints_));
+  background_->checkpoints.clear();
+  last_severe_integration_status_ =
+      background_->last_severe_integration_status;
+}
+
 template<typename Frame>
 void Ephemeris<Frame>::AppendMasslessBodiesState(
     typename NewtonianMotionEquation::SystemState const& state,
@@ -1012,6 +1627,290 @@ typename Ephemeris<Frame>::Checkpoint Ephemeris<Frame>::GetCheckpoint() {
   return Checkpoint({last_state_, checkpoints});
 }
 
+template<typename Frame>
+std::shared_ptr<InterleavedSeries<Frame> const>
+Ephemeris<Frame>::MakeInterleavedSeries(Instant const& t) const {
+  auto const& series = trajectories_.front()->series();
+  if (series.empty() ||
+      t < series.front().t_min() ||
+      t > series.back().t_max()) {
+    return nullptr;
+  }
+
+  // Like |ContinuousTrajectory::FindSeriesForInstant|, find the first interval
+  // such that |t <= t_max()|.  The intervals have nearly the same duration, so
+  // the computed index is off by at most one.
+  auto const& front = series.front();
+  int index = std::min(
+      static_cast<int>(series.size()) - 1,
+      static_cast<int>(std::floor((t - front.t_min()) /
+                                  (front.t_max() - front.t_min()))));
+  while (series[index].t_max() < t) {
+    ++index;
+  }
+  while (index > 0 && t <= series[index - 1].t_max()) {
+    --index;
+  }
+
+  // The trajectories are appended to and forgotten together, so normally they
+  // have the same intervals, but be careful in case one of them is different.
+  std::vector<not_null<ЧебышёвSeries<Displacement<Frame>> const*>>
+      interval_series;
+  for (auto const& trajectory : trajectories_) {
+    auto const& trajectory_series = trajectory->series();
+    if (index >= trajectory_series.size() ||
+        trajectory_series[index].t_min() != series[index].t_min() ||
+        trajectory_series[index].t_max() != series[index].t_max()) {
+      return nullptr;
+    }
+    interval_series.push_back(&trajectory_series[index]);
+  }
+  return std::make_shared<InterleavedSeries<Frame> const>(interval_series);
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::EvaluateAllPositions(
+    Instant const& t,
+    std::vector<Position<Frame>>& positions,
+    std::vector<typename ContinuousTrajectory<Frame>::Hint>& hints) const {
+  std::shared_ptr<InterleavedSeries<Frame> const> interleaved_series;
+  if (!trajectories_.empty() && t >= trajectories_.front()->t_min()) {
+    // If |t| is the |t_min| of the last interval, the applicable interval may
+    // be the previous one, so the interval is open on the left.
+    interleaved_series = std::atomic_load(&last_interleaved_series_);
+    if (interleaved_series == nullptr ||
+        t <= interleaved_series->t_min() ||
+        t > interleaved_series->t_max()) {
+      interleaved_series = MakeInterleavedSeries(t);
+      if (interleaved_series != nullptr) {
+        std::atomic_store(&last_interleaved_series_, interleaved_series);
+      }
+    }
+  }
+  if (interleaved_series == nullptr) {
+    positions.resize(trajectories_.size());
+    for (int b = 0; b < trajectories_.size(); ++b) {
+      positions[b] = trajectories_[b]->EvaluatePosition(t, &hints[b]);
+    }
+    return;
+  }
+  interleaved_series->EvaluatePositions(t, positions);
+}
+
+template<typename Frame>
+bool Ephemeris<Frame>::SpliceContinuationFromMessage(
+    serialization::Ephemeris const& message) {
+  auto const& continuation = message.continuation();
+  if (continuation.fingerprint() != ContinuationFingerprint(message)) {
+    LOG(WARNING) << "Inconsistent fingerprint " << std::hex
+                 << continuation.fingerprint()
+                 << " for the ephemeris continuation, integrating";
+    return false;
+  }
+  if (continuation.trajectory_size() != trajectories_.size()) {
+    LOG(WARNING) << "Continuation has " << continuation.trajectory_size()
+                 << " trajectories instead of " << trajectories_.size()
+                 << ", integrating";
+    return false;
+  }
+  std::vector<not_null<std::unique_ptr<ContinuousTrajectory<Frame>>>>
+      continuations;
+  for (int i = 0; i < trajectories_.size(); ++i) {
+    continuations.push_back(
+        ContinuousTrajectory<Frame>::ReadFromMessage(
+            continuation.trajectory(i)));
+    if (!trajectories_[i]->CanSplice(*continuations.back())) {
+      LOG(WARNING) << "Continuation of the trajectory of " << bodies_[i]->name()
+                   << " doesn't match, integrating";
+      return false;
+    }
+  }
+  auto const last_state =
+      NewtonianMotionEquation::SystemState::ReadFromMessage(
+          continuation.last_state());
+  if (last_state.positions.size() != last_state_.positions.size() ||
+      last_state.velocities.size() != last_state_.velocities.size() ||
+      last_state.time.value < last_state_.time.value) {
+    LOG(WARNING) << "Continuation has an inconsistent state, integrating";
+    return false;
+  }
+
+  for (int i = 0; i < trajectories_.size(); ++i) {
+    trajectories_[i]->Splice(*continuations[i]);
+  }
+  std::atomic_store(&last_interleaved_series_,
+                    std::shared_ptr<InterleavedSeries<Frame> const>());
+  last_state_ = last_state;
+  return true;
+}
+
+template<typename Frame>
+std::uint64_t Ephemeris<Frame>::ContinuationFingerprint(
+    serialization::Ephemeris const& message) {
+  auto const fingerprint = [](google::protobuf::Message const& m) {
+    std::string const serialized = m.SerializeAsString();
+    return Fingerprint2011(serialized.c_str(), serialized.size());
+  };
+  std::uint64_t result = fingerprint(message.fixed_step_parameters());
+  result = FingerprintCat2011(result, fingerprint(message.fitting_tolerance()));
+  for (auto const& body : message.body()) {
+    result = FingerprintCat2011(result, fingerprint(body));
+  }
+  result = FingerprintCat2011(result, fingerprint(message.last_state()));
+  result = FingerprintCat2011(result, fingerprint(message.t_max()));
+  auto const& continuation = message.continuation();
+  for (auto const& trajectory : continuation.trajectory()) {
+    result = FingerprintCat2011(result, fingerprint(trajectory));
+  }
+  return FingerprintCat2011(result, fingerprint(continuation.last_state()));
+}
+
+template<typename Frame>
+Instant Ephemeris<Frame>::FlowFinalTime(
+    Instant const& trajectory_last_time,
+    Instant const& t,
+    AdaptiveStepParameters const& parameters,
+    std::int64_t const max_ephemeris_steps) const {
+  // The |min| is here to prevent us from spending too much time computing the
+  // ephemeris.  The |max| is here to ensure that we always try to integrate
+  // forward.  We use |last_state_.time.value| because this is always finite,
+  // contrary to |t_max()|, which is -∞ when |empty()|.
+  return std::min(std::max(last_state_.time.value +
+                               max_ephemeris_steps * parameters_.step(),
+                           trajectory_last_time + parameters_.step()),
+                  t);
+}
+
+template<typename Frame>
+Status Ephemeris<Frame>::FlowWithAdaptiveStepUntil(
+    not_null<DiscreteTrajectory<Frame>*> const trajectory,
+    NewtonianMotionEquation const& massless_body_equation,
+    Instant const& t_final,
+    AdaptiveStepParameters const& parameters,
+    EventDetector* const event_detector) {
+  std::vector<not_null<DiscreteTrajectory<Frame>*>> const trajectories =
+      {trajectory};
+
+  typename NewtonianMotionEquation::SystemState initial_state;
+  auto const trajectory_last = trajectory->last();
+  auto const last_degrees_of_freedom = trajectory_last.degrees_of_freedom();
+  initial_state.time = DoublePrecision<Instant>(trajectory_last.time());
+  initial_state.positions.emplace_back(last_degrees_of_freedom.position());
+  initial_state.velocities.emplace_back(last_degrees_of_freedom.velocity());
+
+  IntegrationProblem<NewtonianMotionEquation> problem;
+  problem.equation = massless_body_equation;
+  problem.initial_state = &initial_state;
+
+  AdaptiveStepSize<NewtonianMotionEquation> step_size;
+  step_size.first_time_step = t_final - initial_state.time.value;
+  CHECK_GT(step_size.first_time_step, 0 * Second)
+      << "Flow back to the future: " << t_final
+      << " <= " << initial_state.time.value;
+  step_size.safety_factor = 0.9;
+  step_size.tolerance_to_error_ratio =
+      std::bind(&Ephemeris<Frame>::ToleranceToErrorRatio,
+                std::cref(parameters.length_integration_tolerance_),
+                std::cref(parameters.speed_integration_tolerance_),
+                _1, _2);
+  step_size.max_steps = parameters.max_steps_;
+
+  bool const sampled = parameters.sampling_period_ > Time();
+  bool const has_events =
+      event_detector != nullptr && !event_detector->events_.empty();
+  if (!sampled && !has_events) {
+    auto const instance = parameters.integrator_->NewInstance(
+        problem,
+        std::bind(
+            &Ephemeris::AppendMasslessBodiesState, _1, std::cref(trajectories)),
+        step_size);
+    return instance->Solve(t_final);
+  }
+
+  if (has_events) {
+    for (auto& event : event_detector->events_) {
+      event.last_value =
+          event.function(trajectory_last.time(), last_degrees_of_freedom);
+    }
+  }
+
+  // The samples are taken in [t_start, t_end[ on each step, so that the end of
+  // a step, which is the start of the next one, is sampled at most once.
+  Instant next_sample_time =
+      initial_state.time.value + parameters.sampling_period_;
+  step_size.append_dense_output =
+      [event_detector, has_events, &next_sample_time, &parameters, sampled,
+       trajectory](
+          typename NewtonianMotionEquation::DenseOutput const& dense_output) {
+        auto const& interpolant = dense_output[0];
+        Instant const& t_start = interpolant.arguments().first;
+        Instant const& t_end = interpolant.arguments().second;
+        auto const interpolated_degrees_of_freedom =
+            [&interpolant](Instant const& t) {
+              return DegreesOfFreedom<Frame>(interpolant.Evaluate(t),
+                                             interpolant.EvaluateDerivative(t));
+            };
+
+        if (has_events) {
+          for (auto& event : event_detector->events_) {
+            double const value =
+                event.function(t_end, interpolated_degrees_of_freedom(t_end));
+            if ((event.last_value < 0) != (value < 0)) {
+              auto const f = [&event, &interpolated_degrees_of_freedom](
+                                 Instant const& t) {
+                return event.function(t, interpolated_degrees_of_freedom(t));
+              };
+              // The interpolant may not reproduce the sign of |last_value| at
+              // |t_start|, in which case the root is there.
+              Instant const event_time = (f(t_start) < 0) == (value < 0)
+                                             ? t_start
+                                             : Bisect(f, t_start, t_end);
+              DiscreteTrajectory<Frame>* const events =
+                  value < 0 ? event.decreasing : event.increasing;
+              if (events != nullptr) {
+                events->Append(event_time,
+                               interpolated_degrees_of_freedom(event_time));
+              }
+            }
+            event.last_value = value;
+          }
+        }
+
+        if (sampled) {
+          while (next_sample_time < t_end) {
+            trajectory->Append(
+                next_sample_time,
+                interpolated_degrees_of_freedom(next_sample_time));
+            next_sample_time += parameters.sampling_period_;
+          }
+        }
+      };
+
+  // When sampling, the last state is appended after the integration, whether
+  // it succeeded or not, so that the trajectory ends where the integration can
+  // be restarted.
+  typename NewtonianMotionEquation::SystemState last_state;
+  auto const append_state =
+      [&last_state, sampled, &trajectories](
+          typename NewtonianMotionEquation::SystemState const& state) {
+        if (sampled) {
+          last_state = state;
+        } else {
+          AppendMasslessBodiesState(state, trajectories);
+        }
+      };
+
+  auto const instance =
+      parameters.integrator_->NewInstance(problem, append_state, step_size);
+  auto const status = instance->Solve(t_final);
+  if (sampled &&
+      !last_state.positions.empty() &&
+      last_state.time.value > trajectory->last().time()) {
+    AppendMasslessBodiesState(last_state, trajectories);
+  }
+  return status;
+}
+
 template<typename Frame>
 template<bool body1_is_oblate,
          bool body2_is_oblate,
@@ -1085,15 +1984,11 @@ template<typename Frame>
 template<bool body1_is_oblate>
 void Ephemeris<Frame>::
 ComputeGravitationalAccelerationByMassiveBodyOnMasslessBodies(
-    Instant const& t,
     MassiveBody const& body1,
-    std::size_t const b1,
+    Position<Frame> const& position1,
     std::vector<Position<Frame>> const& positions,
-    std::vector<Vector<Acceleration, Frame>>& accelerations,
-    typename ContinuousTrajectory<Frame>::Hint& hint1) const {
+    std::vector<Vector<Acceleration, Frame>>& accelerations) const {
   GravitationalParameter const& μ1 = body1.gravitational_parameter();
-  Position<Frame> const position1 =
-      trajectories_[b1]->EvaluatePosition(t, &hint1);
 
   for (std::size_t b2 = 0; b2 < positions.size(); ++b2) {
     // A vector from the center of |b2| to the center of |b1|.
@@ -1151,6 +2046,50 @@ void Ephemeris<Frame>::ComputeMassiveBodiesGravitationalAccelerations(
         positions,
         accelerations);
   }
+  if (vectorized_gravitation_ != nullptr) {
+    vectorized_gravitation_->AddAccelerations(
+        positions, /*begin=*/number_of_oblate_bodies_, accelerations);
+    return;
+  }
+  if (barnes_hut_gravitation_ != nullptr) {
+    barnes_hut_gravitation_->AddAccelerations(
+        positions, /*begin=*/number_of_oblate_bodies_, accelerations);
+    return;
+  }
+  if (thread_pool_ != nullptr) {
+    // First compute each pair once, in tiles of rows balanced by number of
+    // pairs, then sum the accelerations of each body in the serial order, in
+    // tiles of bodies.
+    std::vector<std::future<void>> futures;
+    for (std::size_t tile = 0; tile + 1 < spherical_pair_tiles_.size();
+         ++tile) {
+      std::size_t const s_begin = spherical_pair_tiles_[tile];
+      std::size_t const s_end = spherical_pair_tiles_[tile + 1];
+      futures.push_back(thread_pool_->Add([this, s_begin, s_end, &positions]() {
+        ComputeSphericalPairAccelerations(s_begin, s_end, positions);
+      }));
+    }
+    for (auto& future : futures) {
+      future.get();
+    }
+    futures.clear();
+    std::size_t const number_of_spherical_bodies = number_of_spherical_bodies_;
+    std::size_t const number_of_tiles = thread_pool_->size();
+    for (std::size_t tile = 0; tile < number_of_tiles; ++tile) {
+      std::size_t const s_begin =
+          tile * number_of_spherical_bodies / number_of_tiles;
+      std::size_t const s_end =
+          (tile + 1) * number_of_spherical_bodies / number_of_tiles;
+      futures.push_back(
+          thread_pool_->Add([this, s_begin, s_end, &accelerations]() {
+            AddSphericalPairAccelerations(s_begin, s_end, accelerations);
+          }));
+    }
+    for (auto& future : futures) {
+      future.get();
+    }
+    return;
+  }
   for (std::size_t b1 = number_of_oblate_bodies_;
        b1 < number_of_oblate_bodies_ +
             number_of_spherical_bodies_;
@@ -1168,37 +2107,111 @@ void Ephemeris<Frame>::ComputeMassiveBodiesGravitationalAccelerations(
   }
 }
 
+template<typename Frame>
+std::size_t Ephemeris<Frame>::SphericalPairIndex(std::size_t const s1,
+                                                 std::size_t const s2) const {
+  // The rows before |s1| have S - 1, S - 2, ..., S - s1 pairs.
+  std::size_t const S = number_of_spherical_bodies_;
+  return s1 * (2 * S - s1 - 1) / 2 + (s2 - s1 - 1);
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::ComputeSphericalPairAccelerations(
+    std::size_t const s_begin,
+    std::size_t const s_end,
+    std::vector<Position<Frame>> const& positions) const {
+  std::size_t const number_of_oblate_bodies = number_of_oblate_bodies_;
+  std::size_t const number_of_spherical_bodies = number_of_spherical_bodies_;
+  for (std::size_t s1 = s_begin; s1 < s_end; ++s1) {
+    std::size_t const b1 = number_of_oblate_bodies + s1;
+    Position<Frame> const& position_of_b1 = positions[b1];
+    GravitationalParameter const& μ1 = bodies_[b1]->gravitational_parameter();
+    SphericalPairAccelerations* pair =
+        spherical_pair_accelerations_.data() + SphericalPairIndex(s1, s1 + 1);
+    for (std::size_t s2 = s1 + 1; s2 < number_of_spherical_bodies;
+         ++s2, ++pair) {
+      std::size_t const b2 = number_of_oblate_bodies + s2;
+      GravitationalParameter const& μ2 =
+          bodies_[b2]->gravitational_parameter();
+
+      // Same computation as in
+      // |ComputeGravitationalAccelerationByMassiveBodyOnMassiveBodies|.
+      Displacement<Frame> const Δq = position_of_b1 - positions[b2];
+      Square<Length> const Δq_squared = InnerProduct(Δq, Δq);
+      Exponentiation<Length, -3> const one_over_Δq_cubed =
+          Sqrt(Δq_squared) / (Δq_squared * Δq_squared);
+      auto const μ1_over_Δq_cubed = μ1 * one_over_Δq_cubed;
+      pair->on_b2 = Δq * μ1_over_Δq_cubed;
+      auto const μ2_over_Δq_cubed = μ2 * one_over_Δq_cubed;
+      pair->on_b1 = Δq * μ2_over_Δq_cubed;
+    }
+  }
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::AddSphericalPairAccelerations(
+    std::size_t const s_begin,
+    std::size_t const s_end,
+    std::vector<Vector<Acceleration, Frame>>& accelerations) const {
+  std::size_t const number_of_oblate_bodies = number_of_oblate_bodies_;
+  std::size_t const number_of_spherical_bodies = number_of_spherical_bodies_;
+  for (std::size_t s = s_begin; s < s_end; ++s) {
+    Vector<Acceleration, Frame>& acceleration =
+        accelerations[number_of_oblate_bodies + s];
+    // The serial computation first reaches |s| as the second body of the rows
+    // before it, then processes its own row.
+    for (std::size_t s1 = 0; s1 < s; ++s1) {
+      acceleration +=
+          spherical_pair_accelerations_[SphericalPairIndex(s1, s)].on_b2;
+    }
+    for (std::size_t s2 = s + 1; s2 < number_of_spherical_bodies; ++s2) {
+      acceleration -=
+          spherical_pair_accelerations_[SphericalPairIndex(s, s2)].on_b1;
+    }
+  }
+}
+
 template<typename Frame>
 void Ephemeris<Frame>::ComputeMasslessBodiesGravitationalAccelerations(
       Instant const& t,
       std::vector<Position<Frame>> const& positions,
       std::vector<Vector<Acceleration, Frame>>& accelerations,
       std::vector<typename ContinuousTrajectory<Frame>::Hint>& hints) const {
+  // Kept here to avoid reallocations.  Thread-local because several
+  // integrations may run concurrently, see |FlowAllWithAdaptiveStep|.
+  thread_local std::vector<Position<Frame>> massive_bodies_positions;
+  EvaluateAllPositions(t, massive_bodies_positions, hints);
+  ComputeMasslessBodiesGravitationalAccelerations(
+      massive_bodies_positions, positions, accelerations);
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::ComputeMasslessBodiesGravitationalAccelerations(
+    std::vector<Position<Frame>> const& massive_bodies_positions,
+    std::vector<Position<Frame>> const& positions,
+    std::vector<Vector<Acceleration, Frame>>& accelerations) const {
   CHECK_EQ(positions.size(), accelerations.size());
+  CHECK_EQ(bodies_.size(), massive_bodies_positions.size());
   accelerations.assign(accelerations.size(), Vector<Acceleration, Frame>());
 
   for (std::size_t b1 = 0; b1 < number_of_oblate_bodies_; ++b1) {
-    MassiveBody const& body1 = *bodies_[b1];
     ComputeGravitationalAccelerationByMassiveBodyOnMasslessBodies<
         /*body1_is_oblate=*/true>(
-        t,
-        body1, b1,
+        *bodies_[b1],
+        massive_bodies_positions[b1],
         positions,
-        accelerations,
-        hints[b1]);
+        accelerations);
   }
   for (std::size_t b1 = number_of_oblate_bodies_;
        b1 < number_of_oblate_bodies_ +
             number_of_spherical_bodies_;
        ++b1) {
-    MassiveBody const& body1 = *bodies_[b1];
     ComputeGravitationalAccelerationByMassiveBodyOnMasslessBodies<
         /*body1_is_oblate=*/false>(
-        t,
-        body1, b1,
+        *bodies_[b1],
+        massive_bodies_positions[b1],
         positions,
-        accelerations,
-        hints[b1]);
+        accelerations);
   }
 }
 
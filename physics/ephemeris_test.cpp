@@ -1,9 +1,12 @@
 ﻿
 #include "physics/ephemeris.hpp"
 
+#include <algorithm>
 #include <limits>
 #include <map>
 #include <set>
+#include <string>
+#include <tuple>
 #include <vector>
 
 #include "astronomy/frames.hpp"
@@ -36,6 +39,7 @@ namespace internal_ephemeris {
 
 using astronomy::ICRFJ2000Equator;
 using astronomy::SolarSystemBarycentreEquator;
+using base::make_not_null_unique;
 using geometry::Barycentre;
 using geometry::AngularVelocity;
 using geometry::Displacement;
@@ -45,17 +49,23 @@ using geometry::Velocity;
 using integrators::DormandElMikkawyPrince1986RKN434FM;
 using integrators::McLachlanAtela1992Order5Optimal;
 using quantities::Abs;
+using quantities::Angle;
 using quantities::ArcTan;
 using quantities::Area;
+using quantities::Cos;
+using quantities::GravitationalParameter;
 using quantities::Mass;
 using quantities::Pow;
 using quantities::SIUnit;
+using quantities::Sin;
 using quantities::Sqrt;
 using quantities::astronomy::JulianYear;
 using quantities::astronomy::LunarDistance;
 using quantities::astronomy::SolarMass;
 using quantities::constants::GravitationalConstant;
 using quantities::si::AstronomicalUnit;
+using quantities::si::Centi;
+using quantities::si::Day;
 using quantities::si::Hour;
 using quantities::si::Kilo;
 using quantities::si::Kilogram;
@@ -518,6 +528,229 @@ TEST_F(EphemerisTest, EarthProbe) {
   EXPECT_THAT(trajectory.last().time(), Eq(old_t_max));
 }
 
+// A probe on a circular orbit around the Earth, integrated with and without a
+// sampling period.
+TEST_F(EphemerisTest, SampledFlowWithAdaptiveStep) {
+  std::vector<not_null<std::unique_ptr<MassiveBody const>>> bodies;
+  std::vector<DegreesOfFreedom<ICRFJ2000Equator>> initial_state;
+  Position<ICRFJ2000Equator> centre_of_mass;
+  Time period;
+  SetUpEarthMoonSystem(bodies, initial_state, centre_of_mass, period);
+
+  bodies.erase(bodies.begin() + 1);
+  initial_state.erase(initial_state.begin() + 1);
+
+  MassiveBody const* const earth = bodies[0].get();
+  Length const radius = 1e7 * Metre;
+  Speed const speed = Sqrt(earth->gravitational_parameter() / radius);
+  Time const orbital_period = 2 * π * radius / speed;
+
+  Ephemeris<ICRFJ2000Equator>
+      ephemeris(
+          std::move(bodies),
+          initial_state,
+          t0_,
+          5 * Milli(Metre),
+          Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+              McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+              period / 100));
+
+  DiscreteTrajectory<ICRFJ2000Equator> stepped_trajectory;
+  stepped_trajectory.Append(
+      t0_,
+      DegreesOfFreedom<ICRFJ2000Equator>(
+          initial_state[0].position() + Vector<Length, ICRFJ2000Equator>(
+                                            {0 * Metre, radius, 0 * Metre}),
+          initial_state[0].velocity() + Velocity<ICRFJ2000Equator>(
+                                            {speed, 0 * Metre / Second,
+                                             0 * Metre / Second})));
+  DiscreteTrajectory<ICRFJ2000Equator> sampled_trajectory;
+  sampled_trajectory.Append(t0_,
+                            stepped_trajectory.last().degrees_of_freedom());
+
+  Time const sampling_period = orbital_period / 100;
+  Instant const t_final = t0_ + 100.5 * sampling_period;
+  Ephemeris<ICRFJ2000Equator>::AdaptiveStepParameters parameters(
+      DormandElMikkawyPrince1986RKN434FM<Position<ICRFJ2000Equator>>(),
+      max_steps,
+      1 * Milli(Metre),
+      1 * Milli(Metre) / Second);
+  EXPECT_TRUE(ephemeris.FlowWithAdaptiveStep(
+      &stepped_trajectory,
+      Ephemeris<ICRFJ2000Equator>::NoIntrinsicAcceleration,
+      t_final,
+      parameters,
+      Ephemeris<ICRFJ2000Equator>::unlimited_max_ephemeris_steps));
+  parameters.set_sampling_period(sampling_period);
+  EXPECT_TRUE(ephemeris.FlowWithAdaptiveStep(
+      &sampled_trajectory,
+      Ephemeris<ICRFJ2000Equator>::NoIntrinsicAcceleration,
+      t_final,
+      parameters,
+      Ephemeris<ICRFJ2000Equator>::unlimited_max_ephemeris_steps));
+
+  // The steps are the same, only the points differ.
+  EXPECT_EQ(102, sampled_trajectory.Size());
+  EXPECT_LT(sampled_trajectory.Size(), stepped_trajectory.Size());
+  EXPECT_EQ(t_final, sampled_trajectory.last().time());
+  EXPECT_EQ(stepped_trajectory.last().degrees_of_freedom(),
+            sampled_trajectory.last().degrees_of_freedom());
+
+  ContinuousTrajectory<ICRFJ2000Equator> const& earth_trajectory =
+      *ephemeris.trajectory(earth);
+  ContinuousTrajectory<ICRFJ2000Equator>::Hint hint;
+  Instant previous_time = t0_;
+  for (auto it = sampled_trajectory.Begin();
+       it != sampled_trajectory.End();
+       ++it) {
+    if (it.time() != t0_ && it.time() != t_final) {
+      EXPECT_THAT(AbsoluteError(sampling_period, it.time() - previous_time),
+                  Lt(1 * Milli(Second)));
+    }
+    previous_time = it.time();
+    Length const distance =
+        (it.degrees_of_freedom().position() -
+         earth_trajectory.EvaluatePosition(it.time(), &hint)).Norm();
+    EXPECT_THAT(RelativeError(radius, distance), Lt(1e-6));
+  }
+
+  // Serialization preserves the sampling period.
+  serialization::Ephemeris::AdaptiveStepParameters message;
+  parameters.WriteToMessage(&message);
+  EXPECT_TRUE(message.has_sampling_period());
+  EXPECT_EQ(sampling_period,
+            Ephemeris<ICRFJ2000Equator>::AdaptiveStepParameters::
+                ReadFromMessage(message).sampling_period());
+}
+
+// A probe on an eccentric, inclined orbit around the Earth, starting at the
+// periapsis, which is also the ascending node.
+TEST_F(EphemerisTest, EventDetection) {
+  std::vector<not_null<std::unique_ptr<MassiveBody const>>> bodies;
+  std::vector<DegreesOfFreedom<ICRFJ2000Equator>> initial_state;
+  Position<ICRFJ2000Equator> centre_of_mass;
+  Time period;
+  SetUpEarthMoonSystem(bodies, initial_state, centre_of_mass, period);
+
+  bodies.erase(bodies.begin() + 1);
+  initial_state.erase(initial_state.begin() + 1);
+
+  MassiveBody const* const earth = bodies[0].get();
+  GravitationalParameter const μ = earth->gravitational_parameter();
+  Length const periapsis_distance = 1e7 * Metre;
+  Speed const periapsis_speed = 1.2 * Sqrt(μ / periapsis_distance);
+  Angle const inclination = 0.5 * Radian;
+  Length const semimajor_axis =
+      periapsis_distance /
+      (2 - periapsis_speed * periapsis_speed * periapsis_distance / μ);
+  Length const apoapsis_distance = 2 * semimajor_axis - periapsis_distance;
+  Time const orbital_period = 2 * π * Sqrt(Pow<3>(semimajor_axis) / μ);
+
+  Ephemeris<ICRFJ2000Equator>
+      ephemeris(
+          std::move(bodies),
+          initial_state,
+          t0_,
+          5 * Milli(Metre),
+          Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+              McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+              period / 100));
+
+  DiscreteTrajectory<ICRFJ2000Equator> trajectory;
+  trajectory.Append(
+      t0_,
+      DegreesOfFreedom<ICRFJ2000Equator>(
+          initial_state[0].position() +
+              Vector<Length, ICRFJ2000Equator>(
+                  {0 * Metre, periapsis_distance, 0 * Metre}),
+          initial_state[0].velocity() +
+              Velocity<ICRFJ2000Equator>(
+                  {periapsis_speed * Cos(inclination),
+                   0 * Metre / Second,
+                   periapsis_speed * Sin(inclination)})));
+
+  DiscreteTrajectory<ICRFJ2000Equator> apoapsides;
+  DiscreteTrajectory<ICRFJ2000Equator> periapsides;
+  DiscreteTrajectory<ICRFJ2000Equator> ascending_nodes;
+  DiscreteTrajectory<ICRFJ2000Equator> descending_nodes;
+  Ephemeris<ICRFJ2000Equator>::EventDetector event_detector;
+  event_detector.Add(ephemeris.ApsisEventFunction(earth),
+                     &periapsides,
+                     &apoapsides);
+  event_detector.Add(
+      ephemeris.NodeEventFunction(earth,
+                                  Vector<double, ICRFJ2000Equator>({0, 0, 1})),
+      &ascending_nodes,
+      &descending_nodes);
+
+  EXPECT_TRUE(ephemeris.FlowWithAdaptiveStep(
+      &trajectory,
+      Ephemeris<ICRFJ2000Equator>::NoIntrinsicAcceleration,
+      t0_ + 2.75 * orbital_period,
+      Ephemeris<ICRFJ2000Equator>::AdaptiveStepParameters(
+          DormandElMikkawyPrince1986RKN434FM<Position<ICRFJ2000Equator>>(),
+          max_steps,
+          1 * Milli(Metre),
+          1 * Milli(Metre) / Second),
+      Ephemeris<ICRFJ2000Equator>::unlimited_max_ephemeris_steps,
+      event_detector));
+
+  // The initial periapsis and ascending node are not events since the event
+  // functions vanish there.
+  ASSERT_EQ(2, periapsides.Size());
+  ASSERT_EQ(3, apoapsides.Size());
+  ASSERT_EQ(2, ascending_nodes.Size());
+  ASSERT_EQ(3, descending_nodes.Size());
+
+  ContinuousTrajectory<ICRFJ2000Equator> const& earth_trajectory =
+      *ephemeris.trajectory(earth);
+  ContinuousTrajectory<ICRFJ2000Equator>::Hint hint;
+  auto const distance = [&earth_trajectory, &hint](
+      DiscreteTrajectory<ICRFJ2000Equator>::Iterator const& it) {
+    return (it.degrees_of_freedom().position() -
+            earth_trajectory.EvaluatePosition(it.time(), &hint)).Norm();
+  };
+  auto const altitude = [&earth_trajectory, &hint](
+      DiscreteTrajectory<ICRFJ2000Equator>::Iterator const& it) {
+    return (it.degrees_of_freedom().position() -
+            earth_trajectory.EvaluatePosition(it.time(), &hint))
+        .coordinates().z;
+  };
+
+  int revolution = 1;
+  for (auto it = periapsides.Begin(); it != periapsides.End(); ++it) {
+    EXPECT_THAT(AbsoluteError(t0_ + revolution * orbital_period, it.time()),
+                Lt(1 * Milli(Second)));
+    EXPECT_THAT(RelativeError(periapsis_distance, distance(it)), Lt(1e-8));
+    ++revolution;
+  }
+  revolution = 1;
+  for (auto it = ascending_nodes.Begin(); it != ascending_nodes.End(); ++it) {
+    EXPECT_THAT(AbsoluteError(t0_ + revolution * orbital_period, it.time()),
+                Lt(1 * Milli(Second)));
+    EXPECT_THAT(Abs(altitude(it)), Lt(1 * Milli(Metre)));
+    ++revolution;
+  }
+  revolution = 0;
+  for (auto it = apoapsides.Begin(); it != apoapsides.End(); ++it) {
+    EXPECT_THAT(
+        AbsoluteError(t0_ + (revolution + 0.5) * orbital_period, it.time()),
+        Lt(1 * Milli(Second)));
+    EXPECT_THAT(RelativeError(apoapsis_distance, distance(it)), Lt(1e-8));
+    ++revolution;
+  }
+  revolution = 0;
+  for (auto it = descending_nodes.Begin();
+       it != descending_nodes.End();
+       ++it) {
+    EXPECT_THAT(
+        AbsoluteError(t0_ + (revolution + 0.5) * orbital_period, it.time()),
+        Lt(1 * Milli(Second)));
+    EXPECT_THAT(Abs(altitude(it)), Lt(1 * Milli(Metre)));
+    ++revolution;
+  }
+}
+
 // The Earth and two massless probes, similar to the previous test but flowing
 // with a fixed step.
 TEST_F(EphemerisTest, EarthTwoProbes) {
@@ -718,6 +951,552 @@ TEST_F(EphemerisTest, Serialization) {
       << "SECOND\n" << second_message.DebugString();
 }
 
+// In |Full| mode the integration past the first checkpoint is serialized, and
+// the ephemeris read from it is identical to the original.  An inconsistent
+// continuation is ignored and the ephemeris is re-integrated.
+TEST_F(EphemerisTest, FullSerialization) {
+  std::vector<not_null<std::unique_ptr<MassiveBody const>>> bodies;
+  std::vector<DegreesOfFreedom<ICRFJ2000Equator>> initial_state;
+  Position<ICRFJ2000Equator> centre_of_mass;
+  Time period;
+  SetUpEarthMoonSystem(bodies, initial_state, centre_of_mass, period);
+
+  MassiveBody const* const earth = bodies[0].get();
+  MassiveBody const* const moon = bodies[1].get();
+
+  Ephemeris<ICRFJ2000Equator>
+      ephemeris(
+          std::move(bodies),
+          initial_state,
+          t0_,
+          5 * Milli(Metre),
+          Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+              McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+              period / 100));
+  ephemeris.Prolong(t0_ + period);
+
+  serialization::Ephemeris compact_message;
+  ephemeris.WriteToMessage(&compact_message);
+  EXPECT_FALSE(compact_message.has_continuation());
+
+  ephemeris.set_serialization_mode(
+      Ephemeris<ICRFJ2000Equator>::SerializationMode::Full);
+  serialization::Ephemeris message;
+  ephemeris.WriteToMessage(&message);
+  ASSERT_TRUE(message.has_continuation());
+  EXPECT_EQ(2, message.continuation().trajectory_size());
+  EXPECT_LT(compact_message.ByteSize(), message.ByteSize());
+
+  serialization::Ephemeris wrong_fingerprint_message = message;
+  wrong_fingerprint_message.mutable_continuation()->set_fingerprint(
+      message.continuation().fingerprint() + 1);
+  serialization::Ephemeris missing_trajectory_message = message;
+  missing_trajectory_message.mutable_continuation()->
+      mutable_trajectory()->RemoveLast();
+
+  // The ephemeris as it would be re-integrated and prolonged past the
+  // serialized data.
+  auto const prolonged_ephemeris =
+      Ephemeris<ICRFJ2000Equator>::ReadFromMessage(compact_message);
+  prolonged_ephemeris->Prolong(t0_ + 2 * period);
+
+  for (auto const* const m : {&message,
+                              &compact_message,
+                              &wrong_fingerprint_message,
+                              &missing_trajectory_message}) {
+    auto const ephemeris_read =
+        Ephemeris<ICRFJ2000Equator>::ReadFromMessage(*m);
+    MassiveBody const* const earth_read = ephemeris_read->bodies()[0];
+    MassiveBody const* const moon_read = ephemeris_read->bodies()[1];
+
+    EXPECT_EQ(ephemeris.t_min(), ephemeris_read->t_min());
+    EXPECT_EQ(ephemeris.t_max(), ephemeris_read->t_max());
+    for (Instant time = ephemeris.t_min();
+         time <= ephemeris.t_max();
+         time += (ephemeris.t_max() - ephemeris.t_min()) / 100) {
+      EXPECT_EQ(
+          ephemeris.trajectory(earth)->EvaluateDegreesOfFreedom(
+              time, /*hint=*/nullptr),
+          ephemeris_read->trajectory(earth_read)->EvaluateDegreesOfFreedom(
+              time, /*hint=*/nullptr));
+      EXPECT_EQ(
+          ephemeris.trajectory(moon)->EvaluateDegreesOfFreedom(
+              time, /*hint=*/nullptr),
+          ephemeris_read->trajectory(moon_read)->EvaluateDegreesOfFreedom(
+              time, /*hint=*/nullptr));
+    }
+
+    serialization::Ephemeris second_compact_message;
+    ephemeris_read->WriteToMessage(&second_compact_message);
+    EXPECT_EQ(compact_message.SerializeAsString(),
+              second_compact_message.SerializeAsString());
+
+    // Only a valid continuation restores the integration exactly as it was:
+    // the re-integration stops as soon as |t_max| is reached, so it has a
+    // different last state.
+    ephemeris_read->set_serialization_mode(
+        Ephemeris<ICRFJ2000Equator>::SerializationMode::Full);
+    serialization::Ephemeris second_message;
+    ephemeris_read->WriteToMessage(&second_message);
+    EXPECT_EQ(m == &message,
+              message.SerializeAsString() ==
+                  second_message.SerializeAsString());
+
+    // The state of the integration was correctly restored.
+    ephemeris_read->Prolong(t0_ + 2 * period);
+    EXPECT_EQ(prolonged_ephemeris->t_max(), ephemeris_read->t_max());
+    EXPECT_EQ(prolonged_ephemeris->trajectory(
+                  prolonged_ephemeris->bodies()[1])->EvaluateDegreesOfFreedom(
+                      prolonged_ephemeris->t_max(), /*hint=*/nullptr),
+              ephemeris_read->trajectory(moon_read)->EvaluateDegreesOfFreedom(
+                  ephemeris_read->t_max(), /*hint=*/nullptr));
+  }
+}
+
+// The vectorized kernel agrees with the scalar one to a few ULPs on each step.
+// The differences get amplified for the small moons with short periods, but
+// they remain at the centimetre level after 10 days.
+TEST_F(EphemerisTest, VectorizedKernel) {
+  auto const scalar_ephemeris = solar_system_.MakeEphemeris(
+      /*fitting_tolerance=*/5 * Milli(Metre),
+      Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+          McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+          /*step=*/10 * Minute));
+  auto const vectorized_ephemeris = solar_system_.MakeEphemeris(
+      /*fitting_tolerance=*/5 * Milli(Metre),
+      Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+          McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+          /*step=*/10 * Minute));
+  vectorized_ephemeris->set_massive_bodies_kernel(
+      Ephemeris<ICRFJ2000Equator>::MassiveBodiesKernel::Vectorized);
+
+  Instant const t_final = t0_ + 10 * Day;
+  scalar_ephemeris->Prolong(t_final);
+  vectorized_ephemeris->Prolong(t_final);
+
+  for (int i = 0; i < scalar_ephemeris->bodies().size(); ++i) {
+    auto const scalar_body = scalar_ephemeris->bodies()[i];
+    auto const vectorized_body = vectorized_ephemeris->bodies()[i];
+    EXPECT_EQ(scalar_body->name(), vectorized_body->name());
+    Displacement<ICRFJ2000Equator> const difference =
+        scalar_ephemeris->trajectory(scalar_body)->EvaluatePosition(
+            t_final, /*hint=*/nullptr) -
+        vectorized_ephemeris->trajectory(vectorized_body)->EvaluatePosition(
+            t_final, /*hint=*/nullptr);
+    EXPECT_THAT(difference.Norm(), Lt(2 * Centi(Metre)))
+        << scalar_body->name();
+  }
+}
+
+// The trajectories are the same if their older series are in files.
+TEST_F(EphemerisTest, SeriesStores) {
+  auto const expected_ephemeris = solar_system_.MakeEphemeris(
+      /*fitting_tolerance=*/5 * Milli(Metre),
+      Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+          McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+          /*step=*/10 * Minute));
+  auto const ephemeris = solar_system_.MakeEphemeris(
+      /*fitting_tolerance=*/5 * Milli(Metre),
+      Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+          McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+          /*step=*/10 * Minute));
+  ephemeris->SetSeriesStores(".", /*max_series_in_memory=*/2);
+
+  Instant const t_final = t0_ + 5 * Day;
+  expected_ephemeris->Prolong(t_final);
+  ephemeris->Prolong(t_final);
+
+  for (int i = 0; i < ephemeris->bodies().size(); ++i) {
+    auto const& expected_trajectory =
+        *expected_ephemeris->trajectory(expected_ephemeris->bodies()[i]);
+    auto const& trajectory = *ephemeris->trajectory(ephemeris->bodies()[i]);
+    EXPECT_EQ(expected_trajectory.t_max(), trajectory.t_max());
+    for (Instant t = ephemeris->t_min(); t < t_final; t += 1 * Hour) {
+      EXPECT_EQ(expected_trajectory.EvaluateDegreesOfFreedom(t,
+                                                             /*hint=*/nullptr),
+                trajectory.EvaluateDegreesOfFreedom(t, /*hint=*/nullptr));
+    }
+  }
+}
+
+TEST_F(EphemerisTest, BarnesHutKernel) {
+  auto const scalar_ephemeris = solar_system_.MakeEphemeris(
+      /*fitting_tolerance=*/5 * Milli(Metre),
+      Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+          McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+          /*step=*/10 * Minute));
+  Instant const t_final = t0_ + 10 * Day;
+  scalar_ephemeris->Prolong(t_final);
+  GravitationalParameter sun_gravitational_parameter;
+  for (auto const body : scalar_ephemeris->bodies()) {
+    sun_gravitational_parameter = std::max(sun_gravitational_parameter,
+                                           body->gravitational_parameter());
+  }
+
+  // With a zero opening angle the computation is exact, even if only the Sun
+  // is dominant.  With the default parameters, the moons of Saturn and Uranus
+  // are minor bodies, and they are affected by the approximation of their
+  // mutual interactions; the dominant bodies are only affected indirectly.
+  for (auto const& parameters :
+           {std::make_tuple(0.0, 1.0, 2 * Centi(Metre), 2 * Centi(Metre)),
+            std::make_tuple(0.5, 1e-9, 5 * Centi(Metre), 2 * Kilo(Metre))}) {
+    double const opening_angle = std::get<0>(parameters);
+    double const dominant_fraction = std::get<1>(parameters);
+    Length const dominant_body_tolerance = std::get<2>(parameters);
+    Length const minor_body_tolerance = std::get<3>(parameters);
+    auto const barnes_hut_ephemeris = solar_system_.MakeEphemeris(
+        /*fitting_tolerance=*/5 * Milli(Metre),
+        Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+            McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+            /*step=*/10 * Minute));
+    barnes_hut_ephemeris->set_barnes_hut_parameters(opening_angle,
+                                                    dominant_fraction);
+    barnes_hut_ephemeris->set_massive_bodies_kernel(
+        Ephemeris<ICRFJ2000Equator>::MassiveBodiesKernel::BarnesHut);
+    barnes_hut_ephemeris->Prolong(t_final);
+
+    for (int i = 0; i < scalar_ephemeris->bodies().size(); ++i) {
+      auto const scalar_body = scalar_ephemeris->bodies()[i];
+      auto const barnes_hut_body = barnes_hut_ephemeris->bodies()[i];
+      EXPECT_EQ(scalar_body->name(), barnes_hut_body->name());
+      Displacement<ICRFJ2000Equator> const difference =
+          scalar_ephemeris->trajectory(scalar_body)->EvaluatePosition(
+              t_final, /*hint=*/nullptr) -
+          barnes_hut_ephemeris->trajectory(barnes_hut_body)->EvaluatePosition(
+              t_final, /*hint=*/nullptr);
+      bool const is_dominant = scalar_body->gravitational_parameter() >=
+                               dominant_fraction * sun_gravitational_parameter;
+      EXPECT_THAT(difference.Norm(),
+                  Lt(is_dominant ? dominant_body_tolerance
+                                 : minor_body_tolerance))
+          << scalar_body->name() << " " << opening_angle;
+    }
+  }
+}
+
+// The multithreaded computation is bit-identical to the serial one.
+TEST_F(EphemerisTest, MultithreadedProlong) {
+  auto const serial_ephemeris = solar_system_.MakeEphemeris(
+      /*fitting_tolerance=*/5 * Milli(Metre),
+      Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+          McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+          /*step=*/10 * Minute));
+  auto const parallel_ephemeris = solar_system_.MakeEphemeris(
+      /*fitting_tolerance=*/5 * Milli(Metre),
+      Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+          McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+          /*step=*/10 * Minute));
+  parallel_ephemeris->set_massive_bodies_threads(3);
+
+  Instant const t_final = t0_ + 10 * Day;
+  serial_ephemeris->Prolong(t_final);
+  parallel_ephemeris->Prolong(t_final);
+
+  for (int i = 0; i < serial_ephemeris->bodies().size(); ++i) {
+    auto const serial_body = serial_ephemeris->bodies()[i];
+    auto const parallel_body = parallel_ephemeris->bodies()[i];
+    EXPECT_EQ(serial_body->name(), parallel_body->name());
+    for (Instant t = t0_; t <= t_final; t += 1 * Day) {
+      EXPECT_EQ(serial_ephemeris->trajectory(serial_body)->
+                    EvaluateDegreesOfFreedom(t, /*hint=*/nullptr),
+                parallel_ephemeris->trajectory(parallel_body)->
+                    EvaluateDegreesOfFreedom(t, /*hint=*/nullptr))
+          << serial_body->name();
+    }
+  }
+}
+
+// Same as above with enough spherical bodies that the triangle of pairs is
+// split over many rows per thread.
+TEST_F(EphemerisTest, MultithreadedProlongManyBodies) {
+  int const number_of_asteroids = 150;
+  DegreesOfFreedom<ICRFJ2000Equator> const sun =
+      solar_system_.initial_state("Sun");
+  GravitationalParameter const sun_gravitational_parameter =
+      solar_system_.gravitational_parameter("Sun");
+  auto const make_ephemeris = [this, number_of_asteroids, &sun,
+                               &sun_gravitational_parameter]() {
+    std::vector<not_null<std::unique_ptr<MassiveBody const>>> bodies;
+    std::vector<DegreesOfFreedom<ICRFJ2000Equator>> initial_state;
+    for (std::string const& name : solar_system_.names()) {
+      bodies.push_back(SolarSystem<ICRFJ2000Equator>::MakeMassiveBody(
+          solar_system_.gravity_model_message(name)));
+      initial_state.push_back(solar_system_.initial_state(name));
+    }
+    // Asteroids on circular orbits around the Sun, spread using the golden
+    // angle.
+    for (int i = 0; i < number_of_asteroids; ++i) {
+      Length const r = (2.2 + static_cast<double>(i) / number_of_asteroids) *
+                       AstronomicalUnit;
+      Angle const θ = i * 2.39996322972865332 * Radian;
+      Speed const v = Sqrt(sun_gravitational_parameter / r);
+      bodies.push_back(make_not_null_unique<MassiveBody>(
+          MassiveBody::Parameters(
+              "Asteroid " + std::to_string(i),
+              (1 + i % 7) * 1e9 * SIUnit<GravitationalParameter>())));
+      initial_state.emplace_back(
+          sun.position() + Displacement<ICRFJ2000Equator>(
+                               {r * Cos(θ), r * Sin(θ), 0 * Metre}),
+          sun.velocity() + Velocity<ICRFJ2000Equator>(
+                               {-v * Sin(θ), v * Cos(θ), 0 * SIUnit<Speed>()}));
+    }
+    return std::make_unique<Ephemeris<ICRFJ2000Equator>>(
+        std::move(bodies),
+        initial_state,
+        t0_,
+        /*fitting_tolerance=*/5 * Milli(Metre),
+        Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+            McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+            /*step=*/10 * Minute));
+  };
+  auto const serial_ephemeris = make_ephemeris();
+  auto const parallel_ephemeris = make_ephemeris();
+  parallel_ephemeris->set_massive_bodies_threads(4);
+
+  Instant const t_final = t0_ + 1 * Day;
+  serial_ephemeris->Prolong(t_final);
+  parallel_ephemeris->Prolong(t_final);
+
+  for (int i = 0; i < serial_ephemeris->bodies().size(); ++i) {
+    auto const serial_body = serial_ephemeris->bodies()[i];
+    auto const parallel_body = parallel_ephemeris->bodies()[i];
+    EXPECT_EQ(serial_body->name(), parallel_body->name());
+    for (Instant t = t0_; t <= t_final; t += 1 * Hour) {
+      EXPECT_EQ(serial_ephemeris->trajectory(serial_body)->
+                    EvaluateDegreesOfFreedom(t, /*hint=*/nullptr),
+                parallel_ephemeris->trajectory(parallel_body)->
+                    EvaluateDegreesOfFreedom(t, /*hint=*/nullptr))
+          << serial_body->name();
+    }
+  }
+}
+
+// The fits performed concurrently are bit-identical to the serial ones, also
+// in the background.
+TEST_F(EphemerisTest, MultithreadedFitting) {
+  auto const serial_ephemeris = solar_system_.MakeEphemeris(
+      /*fitting_tolerance=*/1 * Milli(Metre),
+      Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+          McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+          /*step=*/10 * Minute));
+  auto const parallel_ephemeris = solar_system_.MakeEphemeris(
+      /*fitting_tolerance=*/1 * Milli(Metre),
+      Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+          McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+          /*step=*/10 * Minute));
+  parallel_ephemeris->set_fitting_threads(4);
+
+  Instant const t_final = t0_ + 10 * Day;
+  serial_ephemeris->Prolong(t_final);
+  parallel_ephemeris->Prolong(t_final);
+
+  Instant const t_further = t_final + 5 * Day;
+  serial_ephemeris->Prolong(t_further);
+  parallel_ephemeris->StartBackgroundProlongation(/*horizon=*/1 * Day);
+  parallel_ephemeris->Prolong(t_further);
+  parallel_ephemeris->StopBackgroundProlongation();
+
+  for (int i = 0; i < serial_ephemeris->bodies().size(); ++i) {
+    auto const serial_body = serial_ephemeris->bodies()[i];
+    auto const parallel_body = parallel_ephemeris->bodies()[i];
+    EXPECT_EQ(serial_body->name(), parallel_body->name());
+    for (Instant t = t0_; t <= t_further; t += 1 * Day) {
+      EXPECT_EQ(serial_ephemeris->trajectory(serial_body)->
+                    EvaluateDegreesOfFreedom(t, /*hint=*/nullptr),
+                parallel_ephemeris->trajectory(parallel_body)->
+                    EvaluateDegreesOfFreedom(t, /*hint=*/nullptr))
+          << serial_body->name();
+    }
+  }
+}
+
+TEST_F(EphemerisTest, BackgroundProlongation) {
+  auto const synchronous_ephemeris = solar_system_.MakeEphemeris(
+      /*fitting_tolerance=*/5 * Milli(Metre),
+      Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+          McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+          /*step=*/10 * Minute));
+  auto const background_ephemeris = solar_system_.MakeEphemeris(
+      /*fitting_tolerance=*/5 * Milli(Metre),
+      Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+          McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+          /*step=*/10 * Minute));
+
+  Instant const t_final = t0_ + 10 * Day;
+  synchronous_ephemeris->Prolong(t_final);
+
+  background_ephemeris->StartBackgroundProlongation(/*horizon=*/1 * Day);
+  for (Instant t = t0_ + 1 * Day; t <= t_final; t += 3 * Day) {
+    background_ephemeris->Prolong(t);
+    EXPECT_LE(t, background_ephemeris->t_max());
+    EXPECT_EQ(synchronous_ephemeris->
+                  trajectory(synchronous_ephemeris->bodies().back())->
+                      EvaluateDegreesOfFreedom(t, /*hint=*/nullptr),
+              background_ephemeris->
+                  trajectory(background_ephemeris->bodies().back())->
+                      EvaluateDegreesOfFreedom(t, /*hint=*/nullptr));
+  }
+  // The background prolongation is restarted around the setters.
+  background_ephemeris->set_fitting_threads(2);
+  background_ephemeris->Prolong(t_final);
+  background_ephemeris->StopBackgroundProlongation();
+  EXPECT_LE(t_final, background_ephemeris->t_max());
+
+  // The background integration yields exactly the same results as the
+  // synchronous one.
+  for (int i = 0; i < synchronous_ephemeris->bodies().size(); ++i) {
+    auto const synchronous_body = synchronous_ephemeris->bodies()[i];
+    auto const background_body = background_ephemeris->bodies()[i];
+    for (Instant t = t0_; t <= t_final; t += 1 * Day) {
+      EXPECT_EQ(synchronous_ephemeris->trajectory(synchronous_body)->
+                    EvaluateDegreesOfFreedom(t, /*hint=*/nullptr),
+                background_ephemeris->trajectory(background_body)->
+                    EvaluateDegreesOfFreedom(t, /*hint=*/nullptr))
+          << synchronous_body->name();
+    }
+  }
+
+  // The synchronous integration resumes where the background one stopped.
+  Instant const t_further = t_final + 5 * Day;
+  synchronous_ephemeris->Prolong(t_further);
+  background_ephemeris->Prolong(t_further);
+  for (int i = 0; i < synchronous_ephemeris->bodies().size(); ++i) {
+    auto const synchronous_body = synchronous_ephemeris->bodies()[i];
+    auto const background_body = background_ephemeris->bodies()[i];
+    EXPECT_EQ(synchronous_ephemeris->trajectory(synchronous_body)->
+                  EvaluateDegreesOfFreedom(t_further, /*hint=*/nullptr),
+              background_ephemeris->trajectory(background_body)->
+                  EvaluateDegreesOfFreedom(t_further, /*hint=*/nullptr))
+        << synchronous_body->name();
+  }
+}
+
+// The batched integration yields exactly the same trajectories as the
+// individual ones.
+TEST_F(EphemerisTest, FlowAllWithAdaptiveStep) {
+  std::vector<not_null<std::unique_ptr<Ephemeris<ICRFJ2000Equator>>>>
+      ephemerides;
+  std::vector<DegreesOfFreedom<ICRFJ2000Equator>> initial_state;
+  Time period;
+  for (int i = 0; i < 2; ++i) {
+    std::vector<not_null<std::unique_ptr<MassiveBody const>>> bodies;
+    Position<ICRFJ2000Equator> centre_of_mass;
+    initial_state.clear();
+    SetUpEarthMoonSystem(bodies, initial_state, centre_of_mass, period);
+    ephemerides.push_back(make_not_null_unique<Ephemeris<ICRFJ2000Equator>>(
+        std::move(bodies),
+        initial_state,
+        t0_,
+        5 * Milli(Metre),
+        Ephemeris<ICRFJ2000Equator>::FixedStepParameters(
+            McLachlanAtela1992Order5Optimal<Position<ICRFJ2000Equator>>(),
+            period / 100)));
+  }
+  Ephemeris<ICRFJ2000Equator>& individual_ephemeris = *ephemerides[0];
+  Ephemeris<ICRFJ2000Equator>& batched_ephemeris = *ephemerides[1];
+  batched_ephemeris.set_massless_bodies_threads(3);
+
+  DegreesOfFreedom<ICRFJ2000Equator> const& earth_degrees_of_freedom =
+      initial_state[0];
+  auto const intrinsic_acceleration = [](Instant const& t) {
+    return Vector<Acceleration, ICRFJ2000Equator>(
+        {0 * SIUnit<Acceleration>(),
+         1e-3 * SIUnit<Acceleration>(),
+         0 * SIUnit<Acceleration>()});
+  };
+
+  // Probes at various distances from the Earth, with various tolerances, some
+  // of them accelerating.
+  int const number_of_probes = 7;
+  std::vector<DiscreteTrajectory<ICRFJ2000Equator>> individual_trajectories(
+      number_of_probes);
+  std::vector<DiscreteTrajectory<ICRFJ2000Equator>> batched_trajectories(
+      number_of_probes);
+  std::vector<not_null<DiscreteTrajectory<ICRFJ2000Equator>*>> trajectories;
+  std::vector<Ephemeris<ICRFJ2000Equator>::IntrinsicAcceleration>
+      intrinsic_accelerations;
+  std::vector<Ephemeris<ICRFJ2000Equator>::AdaptiveStepParameters> parameters;
+  for (int i = 0; i < number_of_probes; ++i) {
+    DegreesOfFreedom<ICRFJ2000Equator> const degrees_of_freedom(
+        earth_degrees_of_freedom.position() +
+            Displacement<ICRFJ2000Equator>(
+                {0 * Metre, (i + 1) * 1e7 * Metre, 0 * Metre}),
+        earth_degrees_of_freedom.velocity() +
+            Velocity<ICRFJ2000Equator>(
+                {(i + 1) * 100 * Metre / Second,
+                 0 * Metre / Second,
+                 0 * Metre / Second}));
+    individual_trajectories[i].Append(t0_, degrees_of_freedom);
+    batched_trajectories[i].Append(t0_, degrees_of_freedom);
+    trajectories.push_back(&batched_trajectories[i]);
+    intrinsic_accelerations.push_back(
+        i % 3 == 0
+            ? Ephemeris<ICRFJ2000Equator>::IntrinsicAcceleration(
+                  intrinsic_acceleration)
+            : nullptr);
+    parameters.emplace_back(
+        DormandElMikkawyPrince1986RKN434FM<Position<ICRFJ2000Equator>>(),
+        max_steps,
+        (i + 1) * 1 * Metre,
+        (i + 1) * 1 * Metre / Second);
+  }
+
+  for (Instant t = t0_ + period / 10; t <= t0_ + period; t += period / 10) {
+    bool individual_reached_t = true;
+    for (int i = 0; i < number_of_probes; ++i) {
+      individual_reached_t &= individual_ephemeris.FlowWithAdaptiveStep(
+          &individual_trajectories[i],
+          intrinsic_accelerations[i],
+          t,
+          parameters[i],
+          Ephemeris<ICRFJ2000Equator>::unlimited_max_ephemeris_steps);
+    }
+    EXPECT_TRUE(individual_reached_t);
+    EXPECT_TRUE(batched_ephemeris.FlowAllWithAdaptiveStep(
+        trajectories,
+        intrinsic_accelerations,
+        t,
+        parameters,
+        Ephemeris<ICRFJ2000Equator>::unlimited_max_ephemeris_steps));
+  }
+
+  for (int i = 0; i < number_of_probes; ++i) {
+    EXPECT_THAT(batched_trajectories[i].Size(), Gt(10)) << i;
+    EXPECT_EQ(individual_trajectories[i].Size(),
+              batched_trajectories[i].Size()) << i;
+    EXPECT_EQ(individual_trajectories[i].last().time(),
+              batched_trajectories[i].last().time()) << i;
+    EXPECT_EQ(individual_trajectories[i].last().degrees_of_freedom(),
+              batched_trajectories[i].last().degrees_of_freedom()) << i;
+  }
+
+  // A batch where all the trajectories are already at the final time.
+  EXPECT_TRUE(batched_ephemeris.FlowAllWithAdaptiveStep(
+      trajectories,
+      Ephemeris<ICRFJ2000Equator>::NoIntrinsicAccelerations,
+      t0_ + period,
+      parameters,
+      Ephemeris<ICRFJ2000Equator>::unlimited_max_ephemeris_steps));
+
+  // A batch where each trajectory has its own final time.
+  std::vector<Instant> final_times;
+  for (int i = 0; i < number_of_probes; ++i) {
+    final_times.push_back(t0_ + period + (i + 1) * period / 100);
+  }
+  std::vector<bool> const reached_final_times =
+      batched_ephemeris.FlowEachWithAdaptiveStep(
+          trajectories,
+          intrinsic_accelerations,
+          final_times,
+          parameters,
+          Ephemeris<ICRFJ2000Equator>::unlimited_max_ephemeris_steps);
+  ASSERT_EQ(number_of_probes, reached_final_times.size());
+  for (int i = 0; i < number_of_probes; ++i) {
+    EXPECT_TRUE(reached_final_times[i]) << i;
+    EXPECT_EQ(final_times[i], batched_trajectories[i].last().time()) << i;
+  }
+}
+
 // The gravitational acceleration on at elephant located at the pole.
 TEST_F(EphemerisTest, ComputeGravitationalAccelerationMasslessBody) {
   Time const duration = 1 * Second;
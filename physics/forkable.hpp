@@ -201,10 +201,14 @@ class Forkable {
   void CheckNoForksBefore(Instant const& time);
 
   // This trajectory need not be a root.  As forks are encountered during tree
-  // traversal their pointer is nulled-out in |forks|.
+  // traversal their pointer is nulled-out in |forks|.  The |compression| is
+  // passed to the |WriteSubTreeToMessage| of the forks.
   void WriteSubTreeToMessage(
       not_null<serialization::DiscreteTrajectory*> message,
-      std::vector<Tr4jectory*>& forks) const;
+      std::vector<Tr4jectory*>& forks,
+      std::experimental::optional<
+          serialization::DiscreteTrajectory::PackedTimeline::Compression> const&
+          compression) const;
 
   void FillSubTreeFromMessage(serialization::DiscreteTrajectory const& message,
                               std::vector<Tr4jectory**> const& forks);
@@ -373,7 +373,10 @@ void Forkable<Tr4jectory, It3rator>::CheckNoForksBefore(Instant const& time) {
 template<typename Tr4jectory, typename It3rator>
 void Forkable<Tr4jectory, It3rator>::WriteSubTreeToMessage(
     not_null<serialization::DiscreteTrajectory*> const message,
-    std::vector<Tr4jectory*>& forks) const {
+    std::vector<Tr4jectory*>& forks,
+    std::experimental::optional<
+        serialization::DiscreteTrajectory::PackedTimeline::Compression> const&
+        compression) const {
   std::experimental::optional<Instant> last_instant;
   serialization::DiscreteTrajectory::Litter* litter = nullptr;
   for (auto const& pair : children_) {
@@ -396,7 +399,8 @@ void Forkable<Tr4jectory, It3rator>::WriteSubTreeToMessage(
       litter = message->add_children();
       fork_time.WriteToMessage(litter->mutable_fork_time());
     }
-    child->WriteSubTreeToMessage(litter->add_trajectories(), forks);
+    child->WriteSubTreeToMessage(
+        litter->add_trajectories(), forks, compression);
   }
 }
 
@@ -0,0 +1,70 @@
+﻿
+#pragma once
+
+#include <vector>
+
+#include "base/not_null.hpp"
+#include "geometry/grassmann.hpp"
+#include "geometry/named_quantities.hpp"
+#include "numerics/чебышёв_series.hpp"
+#include "quantities/named_quantities.hpp"
+#include "quantities/quantities.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_interleaved_series {
+
+using base::not_null;
+using geometry::Displacement;
+using geometry::Instant;
+using geometry::Position;
+using numerics::ЧебышёвSeries;
+using quantities::Length;
+using quantities::Time;
+
+// The Чебышёв series of the trajectories of several bodies over the same
+// interval.  Their coefficients are interleaved so that the series of all the
+// bodies are evaluated together, with the Clenshaw recurrence running on
+// several bodies at a time.  The series of degree lower than the maximum are
+// padded with zero coefficients, which doesn't change the results: they are
+// bit-identical to those of |ЧебышёвSeries::Evaluate|.
+template<typename Frame>
+class InterleavedSeries final {
+ public:
+  // All the |series| must have the same |t_min| and |t_max|.
+  explicit InterleavedSeries(
+      std::vector<not_null<ЧебышёвSeries<Displacement<Frame>> const*>> const&
+          series);
+
+  Instant const& t_min() const;
+  Instant const& t_max() const;
+
+  // Sets |positions[i]| to the position given by the i-th series at time |t|,
+  // which must be in [t_min, t_max].  |positions| is resized if needed.
+  void EvaluatePositions(Instant const& t,
+                         std::vector<Position<Frame>>& positions) const;
+
+ private:
+  int const size_;
+  // |size_| rounded up to a multiple of the number of bodies processed at a
+  // time.  The padding bodies have zero coefficients.
+  int const padded_size_;
+  int degree_ = 0;
+  Instant const t_min_;
+  Instant const t_max_;
+  Time::Inverse const one_over_duration_;
+
+  // The coordinate c (0 for x, 1 for y, 2 for z), in metres, of the
+  // coefficient of Tₖ for the body b is at index
+  // |(3 * k + c) * padded_size_ + b|.
+  std::vector<double> coefficients_;
+};
+
+}  // namespace internal_interleaved_series
+
+using internal_interleaved_series::InterleavedSeries;
+
+}  // namespace physics
+}  // namespace principia
+
+#include "physics/interleaved_series_body.hpp"
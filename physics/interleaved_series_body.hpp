@@ -0,0 +1,140 @@
+﻿
+#pragma once
+
+#include "physics/interleaved_series.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include "base/macros.hpp"
+#include "base/simd.hpp"
+#include "geometry/r3_element.hpp"
+#include "glog/logging.h"
+#include "quantities/si.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_interleaved_series {
+
+using geometry::R3Element;
+using quantities::SIUnit;
+using quantities::si::Metre;
+
+using Pack = base::Pack<base::compiled_instruction_set>;
+
+template<typename Frame>
+InterleavedSeries<Frame>::InterleavedSeries(
+    std::vector<not_null<ЧебышёвSeries<Displacement<Frame>> const*>> const&
+        series)
+    : size_(series.size()),
+      padded_size_((size_ + Pack::width - 1) / Pack::width * Pack::width),
+      t_min_(series.front()->t_min()),
+      t_max_(series.front()->t_max()),
+      one_over_duration_(1 / (t_max_ - t_min_)) {
+  for (auto const s : series) {
+    CHECK_EQ(t_min_, s->t_min());
+    CHECK_EQ(t_max_, s->t_max());
+    degree_ = std::max(degree_, s->degree());
+  }
+  coefficients_.resize(3 * (degree_ + 1) * padded_size_, 0.0);
+  for (int b = 0; b < size_; ++b) {
+    for (int k = 0; k <= series[b]->degree(); ++k) {
+      R3Element<double> const coefficient =
+          series[b]->coefficient(k).coordinates() / SIUnit<Length>();
+      for (int c = 0; c < 3; ++c) {
+        coefficients_[(3 * k + c) * padded_size_ + b] = coefficient[c];
+      }
+    }
+  }
+}
+
+template<typename Frame>
+Instant const& InterleavedSeries<Frame>::t_min() const {
+  return t_min_;
+}
+
+template<typename Frame>
+Instant const& InterleavedSeries<Frame>::t_max() const {
+  return t_max_;
+}
+
+template<typename Frame>
+void InterleavedSeries<Frame>::EvaluatePositions(
+    Instant const& t,
+    std::vector<Position<Frame>>& positions) const {
+  using Register = Pack::Register;
+  // Same computation as in |ЧебышёвSeries::Evaluate|.
+  double const scaled_t = ((t - t_max_) + (t - t_min_)) * one_over_duration_;
+  Register const t_register = Pack::Broadcast(scaled_t);
+  Register const two_t_register = Pack::Broadcast(scaled_t + scaled_t);
+  positions.resize(size_);
+
+  // Returns the address of the coordinate |c| of the coefficient of Tₖ for
+  // the bodies starting at |b|.
+  auto const coefficient = [this](int const k, int const c, int const b) {
+    return &coefficients_[(3 * k + c) * padded_size_ + b];
+  };
+
+  for (int b = 0; b < size_; b += Pack::width) {
+    // The values of the series for the bodies starting at |b|.
+    Register values[3];
+    for (int c = 0; c < 3; ++c) {
+      Register const c_0 = Pack::Load(coefficient(0, c, b));
+      // The Clenshaw recurrence, as in |EvaluationHelper|.
+      switch (degree_) {
+        case 0:
+          values[c] = c_0;
+          break;
+        case 1:
+          values[c] = Pack::Add(
+              c_0,
+              Pack::Multiply(t_register, Pack::Load(coefficient(1, c, b))));
+          break;
+        default: {
+          Register b_i = Pack::Load(coefficient(degree_, c, b));
+          Register b_j =
+              Pack::Add(Pack::Load(coefficient(degree_ - 1, c, b)),
+                        Pack::Multiply(two_t_register, b_i));
+          int k = degree_ - 3;
+          for (; k >= 1; k -= 2) {
+            b_i = Pack::Subtract(
+                Pack::Add(Pack::Load(coefficient(k + 1, c, b)),
+                          Pack::Multiply(two_t_register, b_j)),
+                b_i);
+            b_j = Pack::Subtract(
+                Pack::Add(Pack::Load(coefficient(k, c, b)),
+                          Pack::Multiply(two_t_register, b_i)),
+                b_j);
+          }
+          if (k == 0) {
+            b_i = Pack::Subtract(
+                Pack::Add(Pack::Load(coefficient(1, c, b)),
+                          Pack::Multiply(two_t_register, b_j)),
+                b_i);
+            values[c] = Pack::Subtract(
+                Pack::Add(c_0, Pack::Multiply(t_register, b_i)), b_j);
+          } else {
+            values[c] = Pack::Subtract(
+                Pack::Add(c_0, Pack::Multiply(t_register, b_j)), b_i);
+          }
+        }
+      }
+    }
+
+    double x[Pack::width];
+    double y[Pack::width];
+    double z[Pack::width];
+    Pack::Store(x, values[0]);
+    Pack::Store(y, values[1]);
+    Pack::Store(z, values[2]);
+    for (int i = 0; i < Pack::width && b + i < size_; ++i) {
+      positions[b + i] =
+          Displacement<Frame>(R3Element<double>(x[i], y[i], z[i]) * Metre) +
+          Frame::origin;
+    }
+  }
+}
+
+}  // namespace internal_interleaved_series
+}  // namespace physics
+}  // namespace principia
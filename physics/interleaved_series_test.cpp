@@ -0,0 +1,106 @@
+﻿
+#include "physics/interleaved_series.hpp"
+
+#include <random>
+#include <vector>
+
+#include "geometry/frame.hpp"
+#include "gtest/gtest.h"
+#include "quantities/si.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_interleaved_series {
+
+using geometry::Frame;
+using quantities::si::Metre;
+using quantities::si::Second;
+
+class InterleavedSeriesTest : public ::testing::Test {
+ protected:
+  using World = Frame<serialization::Frame::TestTag,
+                      serialization::Frame::TEST,
+                      /*frame_is_inertial=*/true>;
+
+  InterleavedSeriesTest()
+      : t_min_(Instant() + 3 * Second),
+        t_max_(Instant() + 11 * Second) {}
+
+  // Returns |size| series of various degrees, including 0 and 1, with
+  // coefficients of various magnitudes.
+  std::vector<ЧебышёвSeries<Displacement<World>>> MakeSeries(int const size) {
+    std::mt19937_64 random(42);
+    std::uniform_real_distribution<> coefficient_distribution(-1, 1);
+    std::vector<ЧебышёвSeries<Displacement<World>>> series;
+    for (int b = 0; b < size; ++b) {
+      int const degree = b % 2 == 0 ? b : 17 - b % 16;
+      std::vector<Displacement<World>> coefficients;
+      double magnitude = 1e11;
+      for (int k = 0; k <= degree; ++k) {
+        coefficients.push_back(Displacement<World>(
+            {magnitude * coefficient_distribution(random) * Metre,
+             magnitude * coefficient_distribution(random) * Metre,
+             magnitude * coefficient_distribution(random) * Metre}));
+        magnitude /= 10;
+      }
+      series.emplace_back(coefficients, t_min_, t_max_);
+    }
+    return series;
+  }
+
+  Instant const t_min_;
+  Instant const t_max_;
+};
+
+// The results are bit-identical to those of the individual series, for all
+// the sizes modulo the number of bodies processed at a time.
+TEST_F(InterleavedSeriesTest, EvaluatePositions) {
+  for (int size = 1; size <= 3 * Pack::width + 1; ++size) {
+    auto const series = MakeSeries(size);
+    std::vector<not_null<ЧебышёвSeries<Displacement<World>> const*>> pointers;
+    for (auto const& s : series) {
+      pointers.push_back(&s);
+    }
+    InterleavedSeries<World> const interleaved_series(pointers);
+    EXPECT_EQ(t_min_, interleaved_series.t_min());
+    EXPECT_EQ(t_max_, interleaved_series.t_max());
+
+    std::vector<Position<World>> positions;
+    for (Instant t = t_min_; t <= t_max_; t += 0.1 * Second) {
+      interleaved_series.EvaluatePositions(t, positions);
+      ASSERT_EQ(size, positions.size());
+      for (int b = 0; b < size; ++b) {
+        EXPECT_EQ(series[b].Evaluate(t) + World::origin, positions[b])
+            << size << " " << b << " " << t;
+      }
+    }
+  }
+}
+
+TEST_F(InterleavedSeriesTest, SingleDegree) {
+  for (int degree = 0; degree <= 3; ++degree) {
+    std::vector<ЧебышёвSeries<Displacement<World>>> series;
+    for (int b = 0; b < 3; ++b) {
+      std::vector<Displacement<World>> coefficients;
+      for (int k = 0; k <= degree; ++k) {
+        coefficients.push_back(Displacement<World>(
+            {(b + k) * Metre, (b - k) * Metre, (b * k) * Metre}));
+      }
+      series.emplace_back(coefficients, t_min_, t_max_);
+    }
+    InterleavedSeries<World> const interleaved_series(
+        {&series[0], &series[1], &series[2]});
+    std::vector<Position<World>> positions;
+    for (Instant t = t_min_; t <= t_max_; t += 0.5 * Second) {
+      interleaved_series.EvaluatePositions(t, positions);
+      for (int b = 0; b < 3; ++b) {
+        EXPECT_EQ(series[b].Evaluate(t) + World::origin, positions[b])
+            << degree << " " << b << " " << t;
+      }
+    }
+  }
+}
+
+}  // namespace internal_interleaved_series
+}  // namespace physics
+}  // namespace principia
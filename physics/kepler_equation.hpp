@@ -0,0 +1,43 @@
+﻿
+#pragma once
+
+#include <vector>
+
+#include "quantities/quantities.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_kepler_equation {
+
+using quantities::Angle;
+
+// Returns the eccentric anomaly E such that M = E - e sin E, where
+// 0 ≤ e < 1 is the |eccentricity| and M is the |mean_anomaly|.  The equation
+// is solved by Danby's quartic iteration from Danby's starter, which converges
+// to machine precision in at most 4 iterations.
+Angle EllipticEccentricAnomaly(double eccentricity, Angle const& mean_anomaly);
+
+// Returns the hyperbolic anomaly H such that M = e sinh H - H, where e > 1 is
+// the |eccentricity| and M is the |mean_anomaly|.
+Angle HyperbolicEccentricAnomaly(double eccentricity,
+                                 Angle const& mean_anomaly);
+
+// Fills |eccentric_anomalies| with the solutions of Kepler's equation for all
+// the |mean_anomalies|, using |EllipticEccentricAnomaly| if |eccentricity| is
+// less than 1 and |HyperbolicEccentricAnomaly| if it is greater than 1.
+// |eccentric_anomalies| is resized as needed, so that reusing it across calls
+// does not allocate.
+void EccentricAnomalies(double eccentricity,
+                        std::vector<Angle> const& mean_anomalies,
+                        std::vector<Angle>& eccentric_anomalies);
+
+}  // namespace internal_kepler_equation
+
+using internal_kepler_equation::EccentricAnomalies;
+using internal_kepler_equation::EllipticEccentricAnomaly;
+using internal_kepler_equation::HyperbolicEccentricAnomaly;
+
+}  // namespace physics
+}  // namespace principia
+
+#include "physics/kepler_equation_body.hpp"
@@ -0,0 +1,129 @@
+﻿
+#pragma once
+
+#include "physics/kepler_equation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "glog/logging.h"
+#include "quantities/numbers.hpp"
+#include "quantities/si.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_kepler_equation {
+
+using quantities::si::Radian;
+
+// The iterations stop when the correction is below this (in radians).  Since
+// the iteration converges quartically, the last correction is far below the
+// final error.
+constexpr double tolerance = 1e-12;
+// The iterations from the starters below converge well before this; it only
+// guards against an infinite loop on pathological inputs.
+constexpr int max_iterations = 32;
+
+// Performs Danby's quartic iteration on the equation f(x) = 0 given the value
+// |f| of the function and its first three derivatives |f1|, |f2|, |f3| at the
+// current iterate, and returns the correction to the iterate.
+inline double DanbyCorrection(double const f,
+                              double const f1,
+                              double const f2,
+                              double const f3) {
+  double const δ1 = -f / f1;
+  double const δ2 = -f / (f1 + δ1 * f2 / 2);
+  return -f / (f1 + δ2 * f2 / 2 + δ2 * δ2 * f3 / 6);
+}
+
+// Solves M = E - e sin E for 0 ≤ M ≤ π.
+inline double EllipticEccentricAnomalyInRadians(double const e,
+                                                double const m) {
+  // Danby's starter (1987), simplified by the fact that sin M ≥ 0.  Close to
+  // the periapsis of very eccentric orbits, where 1 - e cos E nearly vanishes,
+  // it is replaced by the root of the cubic approximation M = e E³ / 6, which
+  // bounds E from above.
+  double E = m + 0.85 * e;
+  if (e > 0) {
+    E = std::min(E, std::cbrt(6 * m / e));
+  }
+  for (int i = 0; i < max_iterations; ++i) {
+    double const e_sin_E = e * std::sin(E);
+    double const e_cos_E = e * std::cos(E);
+    double const δ = DanbyCorrection(/*f=*/E - e_sin_E - m,
+                                     /*f1=*/1 - e_cos_E,
+                                     /*f2=*/e_sin_E,
+                                     /*f3=*/e_cos_E);
+    E += δ;
+    if (std::abs(δ) <= tolerance) {
+      break;
+    }
+  }
+  return E;
+}
+
+// Solves M = e sinh H - H for M ≥ 0.
+inline double HyperbolicEccentricAnomalyInRadians(double const e,
+                                                  double const m) {
+  // Danby's starter (1988).
+  double H = std::log(2 * m / e + 1.8);
+  for (int i = 0; i < max_iterations; ++i) {
+    double const e_sinh_H = e * std::sinh(H);
+    double const e_cosh_H = e * std::cosh(H);
+    double const δ = DanbyCorrection(/*f=*/e_sinh_H - H - m,
+                                     /*f1=*/e_cosh_H - 1,
+                                     /*f2=*/e_sinh_H,
+                                     /*f3=*/e_cosh_H);
+    H += δ;
+    if (std::abs(δ) <= tolerance * std::max(1.0, std::abs(H))) {
+      break;
+    }
+  }
+  return H;
+}
+
+inline Angle EllipticEccentricAnomaly(double const eccentricity,
+                                      Angle const& mean_anomaly) {
+  DCHECK_LE(0, eccentricity);
+  DCHECK_LT(eccentricity, 1);
+  // E - M is an odd, 2π-periodic function of M, so we reduce M to [0, π].  The
+  // reduction is exact.
+  double const m = mean_anomaly / Radian;
+  double const reduced_m = std::remainder(m, 2 * π);
+  double const abs_E =
+      EllipticEccentricAnomalyInRadians(eccentricity, std::abs(reduced_m));
+  return (m - reduced_m + (reduced_m < 0 ? -abs_E : abs_E)) * Radian;
+}
+
+inline Angle HyperbolicEccentricAnomaly(double const eccentricity,
+                                        Angle const& mean_anomaly) {
+  DCHECK_LT(1, eccentricity);
+  // H is an odd function of M.
+  double const m = mean_anomaly / Radian;
+  double const abs_H =
+      HyperbolicEccentricAnomalyInRadians(eccentricity, std::abs(m));
+  return (m < 0 ? -abs_H : abs_H) * Radian;
+}
+
+inline void EccentricAnomalies(double const eccentricity,
+                               std::vector<Angle> const& mean_anomalies,
+                               std::vector<Angle>& eccentric_anomalies) {
+  CHECK_NE(1, eccentricity) << "parabolic orbits are not supported";
+  eccentric_anomalies.resize(mean_anomalies.size());
+  if (eccentricity < 1) {
+    for (int i = 0; i < mean_anomalies.size(); ++i) {
+      eccentric_anomalies[i] =
+          EllipticEccentricAnomaly(eccentricity, mean_anomalies[i]);
+    }
+  } else {
+    for (int i = 0; i < mean_anomalies.size(); ++i) {
+      eccentric_anomalies[i] =
+          HyperbolicEccentricAnomaly(eccentricity, mean_anomalies[i]);
+    }
+  }
+}
+
+}  // namespace internal_kepler_equation
+}  // namespace physics
+}  // namespace principia
@@ -0,0 +1,82 @@
+﻿
+#include "physics/kepler_equation.hpp"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "numerics/root_finders.hpp"
+#include "quantities/elementary_functions.hpp"
+#include "quantities/numbers.hpp"
+#include "quantities/si.hpp"
+#include "testing_utilities/numerics.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_kepler_equation {
+
+using numerics::Bisect;
+using quantities::Sin;
+using quantities::Sinh;
+using quantities::si::Degree;
+using quantities::si::Radian;
+using testing_utilities::AbsoluteError;
+using ::testing::Lt;
+
+class KeplerEquationTest : public ::testing::Test {};
+
+TEST_F(KeplerEquationTest, Elliptic) {
+  for (double const e : {0.0, 1e-3, 0.1, 0.5, 0.9, 0.99, 0.999, 1 - 1e-9}) {
+    for (Angle M = -720 * Degree; M <= 720 * Degree; M += 0.7 * Degree) {
+      auto const kepler_equation = [e, M](Angle const& E) -> Angle {
+        return M - (E - e * Sin(E) * Radian);
+      };
+      Angle const E = EllipticEccentricAnomaly(e, M);
+      EXPECT_THAT(AbsoluteError(M, E - e * Sin(E) * Radian),
+                  Lt(1e-14 * Radian)) << e << " " << M;
+      // Close to the periapsis of very eccentric orbits, the problem is
+      // ill-conditioned, so bisection does not give a better answer.
+      if (e < 0.9) {
+        EXPECT_THAT(
+            AbsoluteError(
+                Bisect(kepler_equation, M - e * Radian, M + e * Radian), E),
+            Lt(1e-14 * Radian)) << e << " " << M;
+      }
+    }
+  }
+}
+
+TEST_F(KeplerEquationTest, Hyperbolic) {
+  for (double const e : {1 + 1e-6, 1.01, 1.5, 3.0, 100.0}) {
+    for (double const m : {-1e4, -10.0, -1.0, -1e-3, 0.0, 1e-6, 0.1, 1.0, 5.0,
+                           1e3, 1e6}) {
+      Angle const M = m * Radian;
+      Angle const H = HyperbolicEccentricAnomaly(e, M);
+      EXPECT_THAT(AbsoluteError(M, (e * Sinh(H) * Radian - H)),
+                  Lt(1e-14 * Radian * std::max(1.0, std::abs(m))))
+          << e << " " << M;
+    }
+  }
+}
+
+// The batched variant gives the same results as the individual calls.
+TEST_F(KeplerEquationTest, Batched) {
+  std::vector<Angle> mean_anomalies;
+  for (Angle M = -400 * Degree; M <= 400 * Degree; M += 1 * Degree) {
+    mean_anomalies.push_back(M);
+  }
+  std::vector<Angle> eccentric_anomalies;
+  for (double const e : {0.3, 2.0}) {
+    EccentricAnomalies(e, mean_anomalies, eccentric_anomalies);
+    ASSERT_EQ(mean_anomalies.size(), eccentric_anomalies.size());
+    for (int i = 0; i < mean_anomalies.size(); ++i) {
+      EXPECT_EQ(e < 1 ? EllipticEccentricAnomaly(e, mean_anomalies[i])
+                      : HyperbolicEccentricAnomaly(e, mean_anomalies[i]),
+                eccentric_anomalies[i]);
+    }
+  }
+}
+
+}  // namespace internal_kepler_equation
+}  // namespace physics
+}  // namespace principia
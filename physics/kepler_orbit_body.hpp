@@ -6,7 +6,7 @@
 #include <string>
 
 #include "geometry/rotation.hpp"
-#include "numerics/root_finders.hpp"
+#include "physics/kepler_equation.hpp"
 #include "quantities/elementary_functions.hpp"
 
 namespace principia {
@@ -26,16 +26,20 @@ using geometry::Rotation;
 using geometry::Vector;
 using geometry::Velocity;
 using geometry::Wedge;
-using numerics::Bisect;
+using quantities::Abs;
 using quantities::ArcCos;
 using quantities::ArcTan;
+using quantities::ArcTanh;
 using quantities::Cbrt;
+using quantities::Cosh;
 using quantities::DebugString;
 using quantities::Pow;
+using quantities::Sinh;
 using quantities::SpecificAngularMomentum;
 using quantities::SpecificEnergy;
 using quantities::Speed;
 using quantities::Sqrt;
+using quantities::Tan;
 using quantities::Time;
 using quantities::si::Radian;
 
@@ -105,12 +109,17 @@ KeplerOrbit<Frame>::KeplerOrbit(
   CHECK(static_cast<bool>(elements_at_epoch_.semimajor_axis) ^
         static_cast<bool>(elements_at_epoch_.mean_motion));
   GravitationalParameter const μ = gravitational_parameter_;
+  // The semimajor axis of a hyperbolic orbit is negative.
   if (elements_at_epoch_.semimajor_axis) {
     Length const& a = *elements_at_epoch_.semimajor_axis;
-    elements_at_epoch_.mean_motion = Sqrt(μ / Pow<3>(a)) * Radian;
+    CHECK((elements_at_epoch_.eccentricity > 1) == (a < Length{}))
+        << elements_at_epoch_;
+    elements_at_epoch_.mean_motion = Sqrt(μ / Abs(Pow<3>(a))) * Radian;
   } else {
     AngularFrequency const& n = *elements_at_epoch_.mean_motion;
-    elements_at_epoch_.semimajor_axis = Cbrt(μ / Pow<2>(n / Radian));
+    Length const abs_a = Cbrt(μ / Pow<2>(n / Radian));
+    elements_at_epoch_.semimajor_axis =
+        elements_at_epoch_.eccentricity > 1 ? -abs_a : abs_a;
   }
 }
 
@@ -158,19 +167,29 @@ KeplerOrbit<Frame>::KeplerOrbit(
   Angle const Ω = positive_angle(
       ArcTan(ascending_node.coordinates().y, ascending_node.coordinates().x));
   double const eccentricity = eccentricity_vector.Norm();
-  Angle const true_anomaly =
-      positive_angle(OrientedAngleBetween(periapsis, r, x_wedge_y));
-  Angle const eccentric_anomaly =
-      ArcTan(Sqrt(1 - Pow<2>(eccentricity)) * Sin(true_anomaly),
-             eccentricity + Cos(true_anomaly));
-  Angle const mean_anomaly = positive_angle(
-      eccentric_anomaly - eccentricity * Sin(eccentric_anomaly) * Radian);
+  Angle const true_anomaly = OrientedAngleBetween(periapsis, r, x_wedge_y);
+  Angle mean_anomaly;
+  if (eccentricity < 1) {
+    Angle const eccentric_anomaly =
+        ArcTan(Sqrt(1 - Pow<2>(eccentricity)) * Sin(true_anomaly),
+               eccentricity + Cos(true_anomaly));
+    mean_anomaly = positive_angle(
+        eccentric_anomaly - eccentricity * Sin(eccentric_anomaly) * Radian);
+  } else {
+    // The mean anomaly of a hyperbolic orbit is not periodic, and it is
+    // negative before the periapsis.
+    Angle const hyperbolic_anomaly =
+        2 * ArcTanh(Sqrt((eccentricity - 1) / (eccentricity + 1)) *
+                    Tan(true_anomaly / 2));
+    mean_anomaly =
+        eccentricity * Sinh(hyperbolic_anomaly) * Radian - hyperbolic_anomaly;
+  }
 
   SpecificEnergy const ε = InnerProduct(v, v) / 2 - μ / r.Norm();
   // Semimajor axis.
   Length const a = -μ / (2 * ε);
   // Mean motion.
-  AngularFrequency const n = Sqrt(μ / Pow<3>(a)) * Radian;
+  AngularFrequency const n = Sqrt(μ / Abs(Pow<3>(a))) * Radian;
 
   elements_at_epoch_.eccentricity                = eccentricity;
   elements_at_epoch_.semimajor_axis              = a;
@@ -193,31 +212,21 @@ KeplerOrbit<Frame>::StateVectors(Instant const& t) const {
   Angle const mean_anomaly =
       elements_at_epoch_.mean_anomaly +
       *elements_at_epoch_.mean_motion * (t - epoch_);
+  Bivector<double, Frame> const x({1, 0, 0});
+  Bivector<double, Frame> const y({0, 1, 0});
+  Bivector<double, Frame> const z({0, 0, 1});
+  struct OrbitPlane;
+  Rotation<OrbitPlane, Frame> const from_orbit_plane(
+      Ω, i, ω,
+      EulerAngles::ZXZ,
+      DefinesFrame<OrbitPlane>{});
   if (eccentricity < 1) {
     // Elliptic case.
-    auto const kepler_equation =
-        [eccentricity, mean_anomaly](Angle const& eccentric_anomaly) -> Angle {
-          return mean_anomaly -
-                     (eccentric_anomaly -
-                      eccentricity * Sin(eccentric_anomaly) * Radian);
-        };
     Angle const eccentric_anomaly =
-        eccentricity == 0
-            ? mean_anomaly
-            : Bisect(kepler_equation,
-                     mean_anomaly - eccentricity * Radian,
-                     mean_anomaly + eccentricity * Radian);
+        EllipticEccentricAnomaly(eccentricity, mean_anomaly);
     Angle const true_anomaly =
        2 * ArcTan(Sqrt(1 + eccentricity) * Sin(eccentric_anomaly / 2),
                   Sqrt(1 - eccentricity) * Cos(eccentric_anomaly / 2));
-    Bivector<double, Frame> const x({1, 0, 0});
-    Bivector<double, Frame> const y({0, 1, 0});
-    Bivector<double, Frame> const z({0, 0, 1});
-    struct OrbitPlane;
-    Rotation<OrbitPlane, Frame> const from_orbit_plane(
-        Ω, i, ω,
-        EulerAngles::ZXZ,
-        DefinesFrame<OrbitPlane>{});
     Length const distance = a * (1 - eccentricity * Cos(eccentric_anomaly));
     Displacement<Frame> const r =
         distance * from_orbit_plane(Vector<double, OrbitPlane>(
@@ -234,9 +243,21 @@ KeplerOrbit<Frame>::StateVectors(Instant const& t) const {
     LOG(FATAL) << "not yet implemented";
     base::noreturn();
   } else {
-    // Hyperbolic case.
-    LOG(FATAL) << "not yet implemented";
-    base::noreturn();
+    // Hyperbolic case.  Here a < 0.
+    Angle const hyperbolic_anomaly =
+        HyperbolicEccentricAnomaly(eccentricity, mean_anomaly);
+    double const cosh_H = Cosh(hyperbolic_anomaly);
+    double const sinh_H = Sinh(hyperbolic_anomaly);
+    double const sqrt_e²_minus_1 = Sqrt(Pow<2>(eccentricity) - 1);
+    Length const distance = a * (1 - eccentricity * cosh_H);
+    Displacement<Frame> const r =
+        -a * from_orbit_plane(Vector<double, OrbitPlane>(
+                 {eccentricity - cosh_H, sqrt_e²_minus_1 * sinh_H, 0}));
+    Velocity<Frame> const v =
+        Sqrt(-μ * a) / distance *
+        from_orbit_plane(Vector<double, OrbitPlane>(
+            {-sinh_H, sqrt_e²_minus_1 * cosh_H, 0}));
+    return {r, v};
   }
 }
 
@@ -6,8 +6,10 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "mathematica/mathematica.hpp"
+#include "physics/massless_body.hpp"
 #include "physics/solar_system.hpp"
 #include "testing_utilities/almost_equals.hpp"
+#include "testing_utilities/numerics.hpp"
 
 namespace principia {
 namespace physics {
@@ -20,7 +22,9 @@ using quantities::si::Kilo;
 using quantities::si::Metre;
 using quantities::si::Milli;
 using quantities::si::Second;
+using testing_utilities::AbsoluteError;
 using testing_utilities::AlmostEquals;
+using testing_utilities::RelativeError;
 using ::testing::AllOf;
 using ::testing::Gt;
 using ::testing::Lt;
@@ -127,6 +131,65 @@ TEST_F(KeplerOrbitTest, EarthMoon) {
               AlmostEquals(moon_orbit.elements_at_epoch().mean_anomaly, 6));
 }
 
+// A hyperbolic orbit makes the round trip through the state vectors, before
+// and after the periapsis.
+TEST_F(KeplerOrbitTest, Hyperbolic) {
+  MassiveBody const sun(1.32712440018e20 * (Pow<3>(Metre) / Pow<2>(Second)));
+  MasslessBody const comet;
+  Instant const epoch = JulianDate(2457397.500000000);
+  KeplerianElements<ICRFJ2000Equator> elements;
+  elements.eccentricity                = 1.2;
+  elements.semimajor_axis              = -1.5e8 * Kilo(Metre);
+  elements.inclination                 = 122 * Degree;
+  elements.longitude_of_ascending_node = 24 * Degree;
+  elements.argument_of_periapsis       = 241 * Degree;
+  KeplerOrbit<ICRFJ2000Equator> const orbit_at_periapsis(
+      sun, comet, elements, epoch);
+  Length const periapsis_distance =
+      *elements.semimajor_axis * (1 - elements.eccentricity);
+  EXPECT_THAT(
+      RelativeError(
+          periapsis_distance,
+          orbit_at_periapsis.StateVectors(epoch).displacement().Norm()),
+      Lt(1e-15));
+
+  for (Angle const mean_anomaly : {-5 * Radian, 3 * Radian}) {
+    elements.mean_anomaly = mean_anomaly;
+    KeplerOrbit<ICRFJ2000Equator> const orbit(sun, comet, elements, epoch);
+    RelativeDegreesOfFreedom<ICRFJ2000Equator> const state_vectors =
+        orbit.StateVectors(epoch);
+    // The specific orbital energy is -μ / 2a.
+    EXPECT_THAT(
+        RelativeError(-sun.gravitational_parameter() /
+                          (2 * *elements.semimajor_axis),
+                      InnerProduct(state_vectors.velocity(),
+                                   state_vectors.velocity()) / 2 -
+                          sun.gravitational_parameter() /
+                              state_vectors.displacement().Norm()),
+        Lt(1e-14));
+
+    KeplerOrbit<ICRFJ2000Equator> const orbit_from_state_vectors(
+        sun, comet, state_vectors, epoch);
+    auto const& actual = orbit_from_state_vectors.elements_at_epoch();
+    EXPECT_THAT(RelativeError(elements.eccentricity, actual.eccentricity),
+                Lt(1e-14));
+    EXPECT_THAT(
+        RelativeError(*elements.semimajor_axis, *actual.semimajor_axis),
+        Lt(1e-14));
+    EXPECT_THAT(
+        AbsoluteError(elements.inclination, actual.inclination),
+        Lt(1e-14 * Radian));
+    EXPECT_THAT(AbsoluteError(elements.longitude_of_ascending_node,
+                              actual.longitude_of_ascending_node),
+                Lt(1e-14 * Radian));
+    EXPECT_THAT(AbsoluteError(elements.argument_of_periapsis,
+                              actual.argument_of_periapsis),
+                Lt(1e-12 * Radian));
+    EXPECT_THAT(AbsoluteError(elements.mean_anomaly, actual.mean_anomaly),
+                Lt(1e-12 * Radian));
+  }
+}
+
 }  // namespace internal_kepler_orbit
 }  // namespace physics
 }  // namespace principia
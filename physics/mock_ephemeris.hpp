@@ -39,6 +39,8 @@ class MockEphemeris : public Ephemeris<Frame> {
 
   MOCK_METHOD1_T(ForgetBefore, void(Instant const& t));
   MOCK_METHOD1_T(Prolong, void(Instant const& t));
+  MOCK_METHOD1_T(StartBackgroundProlongation, void(Time const& horizon));
+  MOCK_METHOD0_T(StopBackgroundProlongation, void());
   MOCK_METHOD5_T(
       FlowWithAdaptiveStep,
       bool(not_null<DiscreteTrajectory<Frame>*> trajectory,
@@ -47,6 +49,59 @@ class MockEphemeris : public Ephemeris<Frame> {
            Instant const& t,
            AdaptiveStepParameters const& parameters,
            std::int64_t max_ephemeris_steps));
+  MOCK_METHOD6_T(
+      FlowWithAdaptiveStep,
+      bool(not_null<DiscreteTrajectory<Frame>*> trajectory,
+           typename Ephemeris<Frame>::IntrinsicAcceleration
+               intrinsic_acceleration,
+           Instant const& t,
+           AdaptiveStepParameters const& parameters,
+           std::int64_t max_ephemeris_steps,
+           typename Ephemeris<Frame>::EventDetector& event_detector));
+
+  // Not mocked: forwards to |FlowWithAdaptiveStep| for each trajectory, so
+  // that the expectations are set on the individual trajectories.
+  bool FlowAllWithAdaptiveStep(
+      std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories,
+      typename Ephemeris<Frame>::IntrinsicAccelerations const&
+          intrinsic_accelerations,
+      Instant const& t,
+      std::vector<AdaptiveStepParameters> const& parameters,
+      std::int64_t const max_ephemeris_steps) override {
+    bool reached_t = true;
+    for (int i = 0; i < trajectories.size(); ++i) {
+      reached_t &= FlowWithAdaptiveStep(
+          trajectories[i],
+          intrinsic_accelerations.empty() ? nullptr
+                                          : intrinsic_accelerations[i],
+          t,
+          parameters[i],
+          max_ephemeris_steps);
+    }
+    return reached_t;
+  }
+
+  // Not mocked, for the same reason.
+  std::vector<bool> FlowEachWithAdaptiveStep(
+      std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories,
+      typename Ephemeris<Frame>::IntrinsicAccelerations const&
+          intrinsic_accelerations,
+      std::vector<Instant> const& t,
+      std::vector<AdaptiveStepParameters> const& parameters,
+      std::int64_t const max_ephemeris_steps) override {
+    std::vector<bool> reached_t;
+    for (int i = 0; i < trajectories.size(); ++i) {
+      reached_t.push_back(FlowWithAdaptiveStep(
+          trajectories[i],
+          intrinsic_accelerations.empty() ? nullptr
+                                          : intrinsic_accelerations[i],
+          t[i],
+          parameters[i],
+          max_ephemeris_steps));
+    }
+    return reached_t;
+  }
+
   MOCK_METHOD4_T(
       FlowWithFixedStep,
       void(std::vector<not_null<DiscreteTrajectory<Frame>*>> const&
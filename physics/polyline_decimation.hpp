@@ -0,0 +1,46 @@
+﻿
+#pragma once
+
+#include <vector>
+
+#include "geometry/named_quantities.hpp"
+#include "physics/degrees_of_freedom.hpp"
+#include "quantities/quantities.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_polyline_decimation {
+
+using geometry::Instant;
+using geometry::Position;
+using quantities::Angle;
+
+// Returns a polyline approximating the trajectory whose points have the given
+// |times| and |degrees_of_freedom|, for rendering the trajectory as seen from
+// |camera|.  |times| must be increasing and have the same (nonzero) size as
+// |degrees_of_freedom|.  The trajectory is interpolated between its points
+// using Hermite polynomials.  The polyline is built using the Douglas-Peucker
+// algorithm, always refining where the error is largest, until either the
+// angle under which the distance between the polyline and the trajectory is
+// seen from |camera| is at most |angular_tolerance|, or the polyline has
+// |max_points| points.  The polyline always contains the first and last points
+// of the trajectory and its apsides with respect to |centre|, even if there
+// are more than |max_points| of them.  |angular_tolerance| must be
+// nonnegative.
+template<typename Frame>
+std::vector<Position<Frame>> DecimatedPolyline(
+    std::vector<Instant> const& times,
+    std::vector<DegreesOfFreedom<Frame>> const& degrees_of_freedom,
+    Position<Frame> const& camera,
+    Position<Frame> const& centre,
+    Angle const& angular_tolerance,
+    int max_points);
+
+}  // namespace internal_polyline_decimation
+
+using internal_polyline_decimation::DecimatedPolyline;
+
+}  // namespace physics
+}  // namespace principia
+
+#include "physics/polyline_decimation_body.hpp"
@@ -0,0 +1,225 @@
+﻿
+#pragma once
+
+#include "physics/polyline_decimation.hpp"
+
+#include <algorithm>
+#include <queue>
+#include <set>
+#include <vector>
+
+#include "geometry/grassmann.hpp"
+#include "glog/logging.h"
+#include "numerics/hermite3.hpp"
+#include "quantities/elementary_functions.hpp"
+#include "quantities/named_quantities.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_polyline_decimation {
+
+using geometry::Displacement;
+using geometry::InnerProduct;
+using numerics::Hermite3;
+using quantities::ArcTan;
+using quantities::Length;
+using quantities::Square;
+using quantities::Variation;
+
+// Returns the angle under which the distance between |point| and the segment
+// [|a|, |b|] is seen from |camera|.
+template<typename Frame>
+Angle AngularDeviation(Position<Frame> const& point,
+                       Position<Frame> const& a,
+                       Position<Frame> const& b,
+                       Position<Frame> const& camera) {
+  Displacement<Frame> const ab = b - a;
+  Displacement<Frame> const ap = point - a;
+  Square<Length> const ab² = InnerProduct(ab, ab);
+  // The parameter of the projection of |point| on the segment.
+  double s = 0;
+  if (ab² != Square<Length>()) {
+    s = std::min(1.0, std::max(0.0, InnerProduct(ap, ab) / ab²));
+  }
+  return ArcTan((ap - s * ab).Norm(), (point - camera).Norm());
+}
+
+template<typename Frame>
+std::vector<Position<Frame>> DecimatedPolyline(
+    std::vector<Instant> const& times,
+    std::vector<DegreesOfFreedom<Frame>> const& degrees_of_freedom,
+    Position<Frame> const& camera,
+    Position<Frame> const& centre,
+    Angle const& angular_tolerance,
+    int const max_points) {
+  CHECK_EQ(times.size(), degrees_of_freedom.size());
+  CHECK(!times.empty());
+  CHECK_LE(Angle(), angular_tolerance);
+
+  struct Vertex {
+    Instant time;
+    DegreesOfFreedom<Frame> degrees_of_freedom;
+    // True for the first and last points and for the apsides.
+    bool mandatory;
+  };
+
+  // Returns the derivative of the squared distance to |centre|.
+  auto const squared_distance_derivative =
+      [&centre](DegreesOfFreedom<Frame> const& degrees_of_freedom) {
+        return 2.0 * InnerProduct(degrees_of_freedom.position() - centre,
+                                  degrees_of_freedom.velocity());
+      };
+
+  // The points of the trajectory, with the apsides inserted, as in
+  // |Ephemeris::ComputeApsides|.
+  std::vector<Vertex> vertices;
+  vertices.push_back({times[0], degrees_of_freedom[0], /*mandatory=*/true});
+  for (int i = 1; i < times.size(); ++i) {
+    Instant const& previous_time = times[i - 1];
+    Instant const& time = times[i];
+    DegreesOfFreedom<Frame> const& previous_degrees_of_freedom =
+        degrees_of_freedom[i - 1];
+    DegreesOfFreedom<Frame> const& current_degrees_of_freedom =
+        degrees_of_freedom[i];
+    Variation<Square<Length>> const previous_derivative =
+        squared_distance_derivative(previous_degrees_of_freedom);
+    Variation<Square<Length>> const derivative =
+        squared_distance_derivative(current_degrees_of_freedom);
+    bool current_is_apsis = false;
+    if ((previous_derivative < Variation<Square<Length>>()) !=
+        (derivative < Variation<Square<Length>>())) {
+      Displacement<Frame> const previous_displacement =
+          previous_degrees_of_freedom.position() - centre;
+      Displacement<Frame> const displacement =
+          current_degrees_of_freedom.position() - centre;
+      Hermite3<Instant, Square<Length>> const squared_distance_approximation(
+          {previous_time, time},
+          {InnerProduct(previous_displacement, previous_displacement),
+           InnerProduct(displacement, displacement)},
+          {previous_derivative, derivative});
+      std::set<Instant> const extrema =
+          squared_distance_approximation.FindExtrema();
+      for (Instant const& extremum : extrema) {
+        if (extremum == previous_time) {
+          vertices.back().mandatory = true;
+        } else if (extremum == time) {
+          current_is_apsis = true;
+        } else if (extremum > previous_time && extremum < time) {
+          Hermite3<Instant, Position<Frame>> const position_approximation(
+              {previous_time, time},
+              {previous_degrees_of_freedom.position(),
+               current_degrees_of_freedom.position()},
+              {previous_degrees_of_freedom.velocity(),
+               current_degrees_of_freedom.velocity()});
+          vertices.push_back(
+              {extremum,
+               DegreesOfFreedom<Frame>(
+                   position_approximation.Evaluate(extremum),
+                   position_approximation.EvaluateDerivative(extremum)),
+               /*mandatory=*/true});
+        }
+      }
+    }
+    vertices.push_back({time,
+                        current_degrees_of_freedom,
+                        /*mandatory=*/current_is_apsis ||
+                            i + 1 == times.size()});
+  }
+
+  // The midpoints of the Hermite interpolation between consecutive vertices,
+  // which measure how much the trajectory bulges between them.
+  std::vector<Position<Frame>> midpoints;
+  for (int k = 0; k + 1 < vertices.size(); ++k) {
+    Vertex const& left = vertices[k];
+    Vertex const& right = vertices[k + 1];
+    Hermite3<Instant, Position<Frame>> const position_approximation(
+        {left.time, right.time},
+        {left.degrees_of_freedom.position(),
+         right.degrees_of_freedom.position()},
+        {left.degrees_of_freedom.velocity(),
+         right.degrees_of_freedom.velocity()});
+    midpoints.push_back(position_approximation.Evaluate(
+        left.time + (right.time - left.time) / 2));
+  }
+
+  // A segment of the polyline between the vertices |first| and |last|, which
+  // may be split at vertex |split| to reduce its |error|.
+  struct Segment {
+    int first;
+    int last;
+    Angle error;
+    int split;
+  };
+  auto const make_segment = [&camera, &midpoints, &vertices](int const first,
+                                                             int const last) {
+    Segment segment{first, last, Angle(), /*split=*/-1};
+    if (last - first < 2) {
+      // Nothing to split.
+      return segment;
+    }
+    Position<Frame> const& a = vertices[first].degrees_of_freedom.position();
+    Position<Frame> const& b = vertices[last].degrees_of_freedom.position();
+    for (int k = first; k < last; ++k) {
+      if (k > first) {
+        Angle const vertex_error = AngularDeviation(
+            vertices[k].degrees_of_freedom.position(), a, b, camera);
+        if (vertex_error > segment.error) {
+          segment.error = vertex_error;
+          segment.split = k;
+        }
+      }
+      // If the curve bulges between |k| and |k + 1|, split at whichever is
+      // inside the segment.
+      Angle const midpoint_error = AngularDeviation(midpoints[k], a, b, camera);
+      if (midpoint_error > segment.error) {
+        segment.error = midpoint_error;
+        segment.split = k > first ? k : k + 1;
+      }
+    }
+    return segment;
+  };
+  auto const larger_error = [](Segment const& left, Segment const& right) {
+    return left.error < right.error;
+  };
+  std::priority_queue<Segment, std::vector<Segment>, decltype(larger_error)>
+      segments(larger_error);
+
+  std::vector<bool> kept(vertices.size());
+  int number_of_kept_vertices = 0;
+  int previous_mandatory = -1;
+  for (int k = 0; k < vertices.size(); ++k) {
+    if (vertices[k].mandatory) {
+      kept[k] = true;
+      ++number_of_kept_vertices;
+      if (previous_mandatory >= 0) {
+        segments.push(make_segment(previous_mandatory, k));
+      }
+      previous_mandatory = k;
+    }
+  }
+
+  while (!segments.empty() && number_of_kept_vertices < max_points) {
+    Segment const segment = segments.top();
+    if (segment.error <= angular_tolerance) {
+      break;
+    }
+    segments.pop();
+    kept[segment.split] = true;
+    ++number_of_kept_vertices;
+    segments.push(make_segment(segment.first, segment.split));
+    segments.push(make_segment(segment.split, segment.last));
+  }
+
+  std::vector<Position<Frame>> polyline;
+  polyline.reserve(number_of_kept_vertices);
+  for (int k = 0; k < vertices.size(); ++k) {
+    if (kept[k]) {
+      polyline.push_back(vertices[k].degrees_of_freedom.position());
+    }
+  }
+  return polyline;
+}
+
+}  // namespace internal_polyline_decimation
+}  // namespace physics
+}  // namespace principia
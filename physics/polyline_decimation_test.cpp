@@ -0,0 +1,163 @@
+﻿
+#include "physics/polyline_decimation.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include "geometry/frame.hpp"
+#include "geometry/grassmann.hpp"
+#include "gtest/gtest.h"
+#include "quantities/elementary_functions.hpp"
+#include "quantities/numbers.hpp"
+#include "quantities/si.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_polyline_decimation {
+
+using geometry::Displacement;
+using geometry::Frame;
+using geometry::Velocity;
+using quantities::Abs;
+using quantities::AngularFrequency;
+using quantities::Cos;
+using quantities::Length;
+using quantities::Sin;
+using quantities::Sqrt;
+using quantities::Time;
+using quantities::si::Kilo;
+using quantities::si::Metre;
+using quantities::si::Radian;
+using quantities::si::Second;
+
+class PolylineDecimationTest : public ::testing::Test {
+ protected:
+  using World = Frame<serialization::Frame::TestTag,
+                      serialization::Frame::TEST,
+                      /*frame_is_inertial=*/true>;
+
+  PolylineDecimationTest()
+      : camera_(World::origin +
+                Displacement<World>({0 * Metre, 0 * Metre, 1e8 * Metre})) {}
+
+  // Fills |times_| and |degrees_of_freedom_| with |points| points on an
+  // ellipse with semi-axes |a| and |b| whose focus is at the origin, starting
+  // at an eccentric anomaly of 0.5 rad and making two revolutions.
+  void MakeEllipse(int const points, Length const& a, Length const& b) {
+    Length const c = Sqrt(a * a - b * b);
+    AngularFrequency const ω = 1e-3 * Radian / Second;
+    Time const duration = 4 * π * Radian / ω;
+    for (int i = 0; i < points; ++i) {
+      Instant const t = Instant() + duration * i / (points - 1);
+      Angle const θ = 0.5 * Radian + ω * (t - Instant());
+      times_.push_back(t);
+      degrees_of_freedom_.emplace_back(
+          World::origin +
+              Displacement<World>({a * Cos(θ) - c, b * Sin(θ), 0 * Metre}),
+          Velocity<World>({-a * ω * Sin(θ) / Radian,
+                           b * ω * Cos(θ) / Radian,
+                           0 * Metre / Second}));
+    }
+  }
+
+  // Returns the largest angle under which the distance between a point of the
+  // trajectory and the |polyline| is seen from |camera_|.
+  Angle MaxDeviation(std::vector<Position<World>> const& polyline) {
+    Angle max_deviation;
+    for (auto const& degrees_of_freedom : degrees_of_freedom_) {
+      Angle deviation = π * Radian;
+      for (int k = 0; k + 1 < polyline.size(); ++k) {
+        deviation = std::min(deviation,
+                             AngularDeviation(degrees_of_freedom.position(),
+                                              polyline[k],
+                                              polyline[k + 1],
+                                              camera_));
+      }
+      max_deviation = std::max(max_deviation, deviation);
+    }
+    return max_deviation;
+  }
+
+  Position<World> const camera_;
+  std::vector<Instant> times_;
+  std::vector<DegreesOfFreedom<World>> degrees_of_freedom_;
+};
+
+TEST_F(PolylineDecimationTest, Tolerance) {
+  MakeEllipse(10000, 7000 * Kilo(Metre), 6000 * Kilo(Metre));
+  Angle const tolerance = 1e-3 * Radian;
+  auto const polyline = DecimatedPolyline(times_,
+                                          degrees_of_freedom_,
+                                          camera_,
+                                          World::origin,
+                                          tolerance,
+                                          /*max_points=*/10000);
+  EXPECT_LT(20, polyline.size());
+  EXPECT_GT(500, polyline.size());
+  EXPECT_EQ(degrees_of_freedom_.front().position(), polyline.front());
+  EXPECT_EQ(degrees_of_freedom_.back().position(), polyline.back());
+  EXPECT_GE(tolerance, MaxDeviation(polyline));
+
+  // A tighter tolerance requires more points.
+  auto const finer_polyline = DecimatedPolyline(times_,
+                                                degrees_of_freedom_,
+                                                camera_,
+                                                World::origin,
+                                                tolerance / 10,
+                                                /*max_points=*/10000);
+  EXPECT_LT(polyline.size(), finer_polyline.size());
+  EXPECT_GE(tolerance / 10, MaxDeviation(finer_polyline));
+}
+
+TEST_F(PolylineDecimationTest, Budget) {
+  MakeEllipse(10000, 7000 * Kilo(Metre), 6000 * Kilo(Metre));
+  auto const polyline = DecimatedPolyline(times_,
+                                          degrees_of_freedom_,
+                                          camera_,
+                                          World::origin,
+                                          /*angular_tolerance=*/1e-9 * Radian,
+                                          /*max_points=*/50);
+  EXPECT_EQ(50, polyline.size());
+  EXPECT_EQ(degrees_of_freedom_.front().position(), polyline.front());
+  EXPECT_EQ(degrees_of_freedom_.back().position(), polyline.back());
+}
+
+TEST_F(PolylineDecimationTest, Apsides) {
+  Length const a = 7000 * Kilo(Metre);
+  Length const b = 6000 * Kilo(Metre);
+  Length const c = Sqrt(a * a - b * b);
+  MakeEllipse(1001, a, b);
+  // Two revolutions starting after the periapsis have 2 periapsides and 2
+  // apoapsides.  With a budget of 2 points, only the mandatory points are
+  // kept.
+  auto const polyline = DecimatedPolyline(times_,
+                                          degrees_of_freedom_,
+                                          camera_,
+                                          World::origin,
+                                          /*angular_tolerance=*/1e-9 * Radian,
+                                          /*max_points=*/2);
+  ASSERT_EQ(6, polyline.size());
+  for (int k = 1; k < 5; ++k) {
+    Length const r = (polyline[k] - World::origin).Norm();
+    Length const expected_r = k % 2 == 1 ? a + c : a - c;
+    EXPECT_GT(1 * Metre, Abs(r - expected_r)) << k;
+  }
+}
+
+TEST_F(PolylineDecimationTest, SinglePoint) {
+  MakeEllipse(2, 7000 * Kilo(Metre), 6000 * Kilo(Metre));
+  times_.pop_back();
+  degrees_of_freedom_.pop_back();
+  auto const polyline = DecimatedPolyline(times_,
+                                          degrees_of_freedom_,
+                                          camera_,
+                                          World::origin,
+                                          /*angular_tolerance=*/1e-3 * Radian,
+                                          /*max_points=*/10);
+  ASSERT_EQ(1, polyline.size());
+  EXPECT_EQ(degrees_of_freedom_.front().position(), polyline.front());
+}
+
+}  // namespace internal_polyline_decimation
+}  // namespace physics
+}  // namespace principia
@@ -0,0 +1,76 @@
+﻿
+#pragma once
+
+#include <cstdint>
+#include <experimental/filesystem>
+
+#include "base/mapped_file.hpp"
+#include "geometry/named_quantities.hpp"
+#include "numerics/чебышёв_series.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_series_store {
+
+using base::MappedFile;
+using geometry::Displacement;
+using geometry::Instant;
+using numerics::ЧебышёвSeries;
+
+// A store for a long sequence of consecutive Чебышёв series, kept in a
+// memory-mapped file so that they don't use RAM except when they are accessed.
+// Each series is written in a fixed-size record: |t_min| and |t_max| in
+// seconds, the degree, and the coordinates in metres of the coefficients,
+// padded with zeros.  The records use the native representation of the
+// machine; the file is a cache, not a serialization format.
+template<typename Frame>
+class SeriesStore final {
+ public:
+  // The series appended to the store must have a degree at most |max_degree|.
+  SeriesStore(std::experimental::filesystem::path const& path, int max_degree);
+
+  bool empty() const;
+  int size() const;
+
+  // |series.t_min()| must be the |t_max| of the last series, if any.
+  void Append(ЧебышёвSeries<Displacement<Frame>> const& series);
+
+  // Decodes the series at |index|, which must be in [0, size()[.  This reads a
+  // single record.
+  ЧебышёвSeries<Displacement<Frame>> Get(int index) const;
+
+  Instant t_min(int index) const;
+  Instant t_max(int index) const;
+  int degree(int index) const;
+
+  // Returns the index of the first series whose |t_max| is at least |time|, or
+  // |size()| if there is none.  Time complexity is O(Log N), and only the
+  // times of the series are read.
+  int FindIndexForInstant(Instant const& time) const;
+
+  // Removes the first |count| series.  The space that they occupied in the
+  // file is reclaimed when it becomes larger than that of the remaining
+  // series.
+  void ForgetFirst(int count);
+
+ private:
+  double* record(std::int64_t index);
+  double const* record(std::int64_t index) const;
+
+  int const max_degree_;
+  // In doubles.
+  std::int64_t const record_size_;
+  MappedFile file_;
+  // The series are in the records |[first_, end_[| of the file.
+  std::int64_t first_ = 0;
+  std::int64_t end_ = 0;
+};
+
+}  // namespace internal_series_store
+
+using internal_series_store::SeriesStore;
+
+}  // namespace physics
+}  // namespace principia
+
+#include "physics/series_store_body.hpp"
@@ -0,0 +1,165 @@
+﻿
+#pragma once
+
+#include "physics/series_store.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "geometry/r3_element.hpp"
+#include "glog/logging.h"
+#include "quantities/si.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_series_store {
+
+using geometry::R3Element;
+using quantities::si::Metre;
+using quantities::si::Second;
+
+// The layout of a record.
+std::int64_t const t_min_offset = 0;
+std::int64_t const t_max_offset = 1;
+std::int64_t const degree_offset = 2;
+std::int64_t const coefficients_offset = 3;
+
+template<typename Frame>
+SeriesStore<Frame>::SeriesStore(
+    std::experimental::filesystem::path const& path,
+    int const max_degree)
+    : max_degree_(max_degree),
+      record_size_(coefficients_offset + 3 * (max_degree + 1)),
+      file_(path) {
+  CHECK_LE(0, max_degree_);
+}
+
+template<typename Frame>
+bool SeriesStore<Frame>::empty() const {
+  return first_ == end_;
+}
+
+template<typename Frame>
+int SeriesStore<Frame>::size() const {
+  return end_ - first_;
+}
+
+template<typename Frame>
+void SeriesStore<Frame>::Append(
+    ЧебышёвSeries<Displacement<Frame>> const& series) {
+  CHECK_LE(series.degree(), max_degree_);
+  if (!empty()) {
+    CHECK_EQ(t_max(size() - 1), series.t_min());
+  }
+  file_.Reserve((end_ + 1) * record_size_ * sizeof(double));
+  double* const r = record(end_);
+  r[t_min_offset] = (series.t_min() - Instant()) / Second;
+  r[t_max_offset] = (series.t_max() - Instant()) / Second;
+  r[degree_offset] = series.degree();
+  for (int i = 0; i <= max_degree_; ++i) {
+    double* const coefficient = &r[coefficients_offset + 3 * i];
+    if (i <= series.degree()) {
+      R3Element<double> const coordinates =
+          series.coefficient(i).coordinates() / Metre;
+      coefficient[0] = coordinates.x;
+      coefficient[1] = coordinates.y;
+      coefficient[2] = coordinates.z;
+    } else {
+      coefficient[0] = 0;
+      coefficient[1] = 0;
+      coefficient[2] = 0;
+    }
+  }
+  ++end_;
+}
+
+template<typename Frame>
+ЧебышёвSeries<Displacement<Frame>> SeriesStore<Frame>::Get(
+    int const index) const {
+  CHECK_LE(0, index);
+  CHECK_LT(index, size());
+  double const* const r = record(first_ + index);
+  int const degree = static_cast<int>(r[degree_offset]);
+  std::vector<Displacement<Frame>> coefficients;
+  coefficients.reserve(degree + 1);
+  for (int i = 0; i <= degree; ++i) {
+    double const* const coefficient = &r[coefficients_offset + 3 * i];
+    coefficients.push_back(Displacement<Frame>({coefficient[0] * Metre,
+                                                coefficient[1] * Metre,
+                                                coefficient[2] * Metre}));
+  }
+  return ЧебышёвSeries<Displacement<Frame>>(
+      coefficients,
+      Instant() + r[t_min_offset] * Second,
+      Instant() + r[t_max_offset] * Second);
+}
+
+template<typename Frame>
+Instant SeriesStore<Frame>::t_min(int const index) const {
+  CHECK_LE(0, index);
+  CHECK_LT(index, size());
+  return Instant() + record(first_ + index)[t_min_offset] * Second;
+}
+
+template<typename Frame>
+Instant SeriesStore<Frame>::t_max(int const index) const {
+  CHECK_LE(0, index);
+  CHECK_LT(index, size());
+  return Instant() + record(first_ + index)[t_max_offset] * Second;
+}
+
+template<typename Frame>
+int SeriesStore<Frame>::degree(int const index) const {
+  CHECK_LE(0, index);
+  CHECK_LT(index, size());
+  return static_cast<int>(record(first_ + index)[degree_offset]);
+}
+
+template<typename Frame>
+int SeriesStore<Frame>::FindIndexForInstant(Instant const& time) const {
+  // Find the first series |s| such that |time <= s.t_max()|.
+  int low = 0;
+  int high = size();
+  while (low < high) {
+    int const middle = low + (high - low) / 2;
+    if (t_max(middle) < time) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+template<typename Frame>
+void SeriesStore<Frame>::ForgetFirst(int const count) {
+  CHECK_LE(0, count);
+  CHECK_LE(count, size());
+  first_ += count;
+  if (first_ > end_ - first_) {
+    // Move the remaining series to the beginning of the file.  The ranges don't
+    // overlap.
+    if (!empty()) {
+      std::memcpy(record(0),
+                  record(first_),
+                  (end_ - first_) * record_size_ * sizeof(double));
+    }
+    end_ -= first_;
+    first_ = 0;
+  }
+}
+
+template<typename Frame>
+double* SeriesStore<Frame>::record(std::int64_t const index) {
+  return reinterpret_cast<double*>(file_.data()) + index * record_size_;
+}
+
+template<typename Frame>
+double const* SeriesStore<Frame>::record(std::int64_t const index) const {
+  return reinterpret_cast<double const*>(file_.data()) + index * record_size_;
+}
+
+}  // namespace internal_series_store
+}  // namespace physics
+}  // namespace principia
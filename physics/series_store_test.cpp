@@ -0,0 +1,80 @@
+﻿
+#include "physics/series_store.hpp"
+
+#include <vector>
+
+#include "geometry/frame.hpp"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "quantities/si.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_series_store {
+
+using geometry::Frame;
+using quantities::si::Metre;
+using quantities::si::Second;
+
+class SeriesStoreTest : public ::testing::Test {
+ protected:
+  using World = Frame<serialization::Frame::TestTag,
+                      serialization::Frame::TEST, true>;
+
+  // A series of the given |degree| on [t0_ + i s, t0_ + (i + 1) s].
+  ЧебышёвSeries<Displacement<World>> MakeSeries(int const i,
+                                                int const degree) {
+    std::vector<Displacement<World>> coefficients;
+    for (int k = 0; k <= degree; ++k) {
+      coefficients.push_back(Displacement<World>({(i + k) * Metre,
+                                                  (i - k) * Metre,
+                                                  1.0 / (i + k + 1) * Metre}));
+    }
+    return ЧебышёвSeries<Displacement<World>>(coefficients,
+                                              t0_ + i * Second,
+                                              t0_ + (i + 1) * Second);
+  }
+
+  Instant const t0_ = Instant() + 1.0 / 3.0 * Second;
+};
+
+TEST_F(SeriesStoreTest, AppendAndForget) {
+  int const size = 1000;
+  SeriesStore<World> store("AppendAndForget.series", /*max_degree=*/17);
+  EXPECT_TRUE(store.empty());
+  for (int i = 0; i < size; ++i) {
+    store.Append(MakeSeries(i, /*degree=*/3 + i % 15));
+  }
+  EXPECT_FALSE(store.empty());
+  EXPECT_EQ(size, store.size());
+  for (int i = 0; i < size; ++i) {
+    EXPECT_EQ(MakeSeries(i, 3 + i % 15), store.Get(i)) << i;
+    EXPECT_EQ(t0_ + i * Second, store.t_min(i));
+    EXPECT_EQ(t0_ + (i + 1) * Second, store.t_max(i));
+    EXPECT_EQ(3 + i % 15, store.degree(i));
+  }
+  EXPECT_EQ(0, store.FindIndexForInstant(t0_ - 1 * Second));
+  EXPECT_EQ(0, store.FindIndexForInstant(t0_ + 1 * Second));
+  EXPECT_EQ(42, store.FindIndexForInstant(t0_ + 42.5 * Second));
+  EXPECT_EQ(size, store.FindIndexForInstant(t0_ + (size + 1) * Second));
+
+  // Forgetting and appending again, with and without compaction.
+  store.ForgetFirst(100);
+  EXPECT_EQ(size - 100, store.size());
+  EXPECT_EQ(MakeSeries(100, 3 + 100 % 15), store.Get(0));
+  store.ForgetFirst(500);
+  EXPECT_EQ(size - 600, store.size());
+  for (int i = 0; i < store.size(); ++i) {
+    EXPECT_EQ(MakeSeries(600 + i, 3 + (600 + i) % 15), store.Get(i)) << i;
+  }
+  store.Append(MakeSeries(size, 17));
+  EXPECT_EQ(MakeSeries(size, 17), store.Get(store.size() - 1));
+  store.ForgetFirst(store.size());
+  EXPECT_TRUE(store.empty());
+  store.Append(MakeSeries(0, 4));
+  EXPECT_EQ(MakeSeries(0, 4), store.Get(0));
+}
+
+}  // namespace internal_series_store
+}  // namespace physics
+}  // namespace principia
@@ -0,0 +1,70 @@
+﻿
+#pragma once
+
+#include <vector>
+
+#include "base/simd.hpp"
+#include "geometry/grassmann.hpp"
+#include "geometry/named_quantities.hpp"
+#include "quantities/named_quantities.hpp"
+#include "quantities/quantities.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_vectorized_gravitation {
+
+using geometry::Position;
+using geometry::Vector;
+using quantities::Acceleration;
+using quantities::GravitationalParameter;
+
+// The number of pairwise interactions computed at a time.
+int constexpr vector_width =
+    base::Pack<base::compiled_instruction_set>::width;
+
+// Computes the mutual Newtonian accelerations of a set of spherical massive
+// bodies.  The coordinates of the bodies are repacked in a structure-of-arrays
+// layout, and the pairwise interactions are computed |vector_width| at a time.
+// The inverse square roots are obtained from the hardware approximation
+// refined by Newton iterations, so the results agree with those of
+// |Ephemeris::ComputeGravitationalAccelerationByMassiveBodyOnMassiveBodies| to
+// a few ULPs, but they are not bit-identical.
+template<typename Frame>
+class VectorizedGravitation final {
+ public:
+  // The elements of |gravitational_parameters| correspond to the bodies in the
+  // order in which they are given to |AddAccelerations|.
+  explicit VectorizedGravitation(
+      std::vector<GravitationalParameter> const& gravitational_parameters);
+
+  // Adds to |accelerations[begin + i]| the acceleration exerted on the body i
+  // by all the other bodies, where the body i is at |positions[begin + i]|.
+  void AddAccelerations(
+      std::vector<Position<Frame>> const& positions,
+      int begin,
+      std::vector<Vector<Acceleration, Frame>>& accelerations);
+
+ private:
+  int const size_;
+  // |size_ + vector_width - 1|, so that the vector loads never go past the
+  // end of the arrays.  The padding bodies are massless and far away from
+  // everything.
+  int const padded_size_;
+
+  std::vector<double> μ_;
+  std::vector<double> x_;
+  std::vector<double> y_;
+  std::vector<double> z_;
+  std::vector<double> ax_;
+  std::vector<double> ay_;
+  std::vector<double> az_;
+};
+
+}  // namespace internal_vectorized_gravitation
+
+using internal_vectorized_gravitation::VectorizedGravitation;
+
+}  // namespace physics
+}  // namespace principia
+
+#include "physics/vectorized_gravitation_body.hpp"
@@ -0,0 +1,161 @@
+﻿
+#pragma once
+
+#include "physics/vectorized_gravitation.hpp"
+
+#include <cmath>
+#include <vector>
+
+#include "base/macros.hpp"
+#include "glog/logging.h"
+#include "quantities/si.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_vectorized_gravitation {
+
+using geometry::Displacement;
+using geometry::R3Element;
+using quantities::SIUnit;
+using quantities::si::Metre;
+
+using Pack = base::Pack<base::compiled_instruction_set>;
+
+// The square of the distance is scaled by 2⁻¹⁰⁰ before being converted to
+// single precision for the hardware approximation of the inverse square root:
+// this brings all the distances between 10⁻⁴ m and 6 × 10³⁴ m within the range
+// of |float|.  The scaling is undone exactly at the end.
+double const squared_distance_scale = std::ldexp(1.0, -100);
+double const inverse_distance_unscale = std::ldexp(1.0, -50);
+
+// The coordinates of the padding bodies.  Their squared distance to any actual
+// body remains within the range of the scaled approximation above.
+double const padding_coordinate = 1e30;
+
+// Computes the accelerations between the |size| bodies whose gravitational
+// parameters are |μ| and whose coordinates are |x|, |y|, |z| and adds them to
+// |ax|, |ay|, |az|.  All the arrays must be padded with at least
+// |vector_width - 1| massless bodies.
+inline void AddMutualAccelerations(int const size,
+                                   double const* const μ,
+                                   double const* const x,
+                                   double const* const y,
+                                   double const* const z,
+                                   double* const ax,
+                                   double* const ay,
+                                   double* const az) {
+  using Register = Pack::Register;
+  Register const scale = Pack::Broadcast(squared_distance_scale);
+  Register const unscale = Pack::Broadcast(inverse_distance_unscale);
+  Register const one_half = Pack::Broadcast(0.5);
+  Register const three_halves = Pack::Broadcast(1.5);
+  Register const zero = Pack::Broadcast(0.0);
+
+  for (int b1 = 0; b1 < size; ++b1) {
+    Register const μ1 = Pack::Broadcast(μ[b1]);
+    Register const x1 = Pack::Broadcast(x[b1]);
+    Register const y1 = Pack::Broadcast(y[b1]);
+    Register const z1 = Pack::Broadcast(z[b1]);
+    Register ax1 = zero;
+    Register ay1 = zero;
+    Register az1 = zero;
+    for (int b2 = b1 + 1; b2 < size; b2 += vector_width) {
+      // A vector from the centres of the |b2|s to the centre of |b1|.
+      Register const Δx = Pack::Subtract(x1, Pack::Load(&x[b2]));
+      Register const Δy = Pack::Subtract(y1, Pack::Load(&y[b2]));
+      Register const Δz = Pack::Subtract(z1, Pack::Load(&z[b2]));
+      Register const Δq_squared =
+          Pack::Add(Pack::Add(Pack::Multiply(Δx, Δx), Pack::Multiply(Δy, Δy)),
+                    Pack::Multiply(Δz, Δz));
+
+      // Newton's iteration for 1 / √r is y ↦ y (3/2 - r y² / 2).
+      Register const scaled_Δq_squared = Pack::Multiply(Δq_squared, scale);
+      Register const half_scaled_Δq_squared =
+          Pack::Multiply(scaled_Δq_squared, one_half);
+      Register scaled_one_over_Δq =
+          Pack::ApproximateReciprocalSquareRoot(scaled_Δq_squared);
+      for (int i = 0; i < Pack::newton_iterations; ++i) {
+        scaled_one_over_Δq = Pack::Multiply(
+            scaled_one_over_Δq,
+            Pack::Subtract(
+                three_halves,
+                Pack::Multiply(half_scaled_Δq_squared,
+                               Pack::Multiply(scaled_one_over_Δq,
+                                              scaled_one_over_Δq))));
+      }
+      Register const one_over_Δq = Pack::Multiply(scaled_one_over_Δq, unscale);
+      Register const one_over_Δq_cubed =
+          Pack::Multiply(Pack::Multiply(one_over_Δq, one_over_Δq),
+                         one_over_Δq);
+
+      Register const μ1_over_Δq_cubed = Pack::Multiply(μ1, one_over_Δq_cubed);
+      Pack::Store(&ax[b2], Pack::Add(Pack::Load(&ax[b2]),
+                                     Pack::Multiply(Δx, μ1_over_Δq_cubed)));
+      Pack::Store(&ay[b2], Pack::Add(Pack::Load(&ay[b2]),
+                                     Pack::Multiply(Δy, μ1_over_Δq_cubed)));
+      Pack::Store(&az[b2], Pack::Add(Pack::Load(&az[b2]),
+                                     Pack::Multiply(Δz, μ1_over_Δq_cubed)));
+
+      // The padding bodies are massless, so they don't contribute here.
+      Register const μ2_over_Δq_cubed =
+          Pack::Multiply(Pack::Load(&μ[b2]), one_over_Δq_cubed);
+      ax1 = Pack::Subtract(ax1, Pack::Multiply(Δx, μ2_over_Δq_cubed));
+      ay1 = Pack::Subtract(ay1, Pack::Multiply(Δy, μ2_over_Δq_cubed));
+      az1 = Pack::Subtract(az1, Pack::Multiply(Δz, μ2_over_Δq_cubed));
+    }
+    ax[b1] += Pack::HorizontalSum(ax1);
+    ay[b1] += Pack::HorizontalSum(ay1);
+    az[b1] += Pack::HorizontalSum(az1);
+  }
+}
+
+template<typename Frame>
+VectorizedGravitation<Frame>::VectorizedGravitation(
+    std::vector<GravitationalParameter> const& gravitational_parameters)
+    : size_(gravitational_parameters.size()),
+      padded_size_(size_ + vector_width - 1),
+      μ_(padded_size_, 0.0),
+      x_(padded_size_, padding_coordinate),
+      y_(padded_size_, padding_coordinate),
+      z_(padded_size_, padding_coordinate),
+      ax_(padded_size_),
+      ay_(padded_size_),
+      az_(padded_size_) {
+  for (int i = 0; i < size_; ++i) {
+    μ_[i] = gravitational_parameters[i] / SIUnit<GravitationalParameter>();
+  }
+}
+
+template<typename Frame>
+void VectorizedGravitation<Frame>::AddAccelerations(
+    std::vector<Position<Frame>> const& positions,
+    int const begin,
+    std::vector<Vector<Acceleration, Frame>>& accelerations) {
+  CHECK_LE(begin + size_, positions.size());
+  CHECK_LE(begin + size_, accelerations.size());
+  for (int i = 0; i < size_; ++i) {
+    R3Element<double> const coordinates =
+        (positions[begin + i] - Frame::origin).coordinates() / Metre;
+    x_[i] = coordinates.x;
+    y_[i] = coordinates.y;
+    z_[i] = coordinates.z;
+    ax_[i] = 0.0;
+    ay_[i] = 0.0;
+    az_[i] = 0.0;
+  }
+
+  AddMutualAccelerations(size_,
+                         μ_.data(),
+                         x_.data(), y_.data(), z_.data(),
+                         ax_.data(), ay_.data(), az_.data());
+
+  for (int i = 0; i < size_; ++i) {
+    accelerations[begin + i] += Vector<Acceleration, Frame>(
+        R3Element<double>(ax_[i], ay_[i], az_[i]) *
+        SIUnit<Acceleration>());
+  }
+}
+
+}  // namespace internal_vectorized_gravitation
+}  // namespace physics
+}  // namespace principia
@@ -0,0 +1,141 @@
+﻿
+#include "physics/vectorized_gravitation.hpp"
+
+#include <random>
+#include <vector>
+
+#include "geometry/frame.hpp"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "quantities/elementary_functions.hpp"
+#include "quantities/si.hpp"
+#include "testing_utilities/numerics.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_vectorized_gravitation {
+
+using geometry::Displacement;
+using geometry::InnerProduct;
+using quantities::Exponentiation;
+using quantities::Length;
+using quantities::Pow;
+using quantities::Sqrt;
+using quantities::Square;
+using quantities::si::Metre;
+using quantities::si::Second;
+using testing_utilities::RelativeError;
+using ::testing::Lt;
+
+class VectorizedGravitationTest : public ::testing::Test {
+ protected:
+  using World = geometry::Frame<serialization::Frame::TestTag,
+                                serialization::Frame::TEST,
+                                /*frame_is_inertial=*/true>;
+
+  // Returns a system of |size| bodies with positions and gravitational
+  // parameters roughly similar to those of the solar system.
+  void MakeSystem(int const size,
+                  std::vector<GravitationalParameter>& gravitational_parameters,
+                  std::vector<Position<World>>& positions) {
+    std::mt19937_64 random(42);
+    std::uniform_real_distribution<> coordinate_distribution(-1e12, 1e12);
+    std::uniform_real_distribution<> μ_distribution(1e5, 1e20);
+    for (int i = 0; i < size; ++i) {
+      gravitational_parameters.push_back(
+          μ_distribution(random) * Pow<3>(Metre) / Pow<2>(Second));
+      positions.push_back(
+          World::origin +
+          Displacement<World>({coordinate_distribution(random) * Metre,
+                               coordinate_distribution(random) * Metre,
+                               coordinate_distribution(random) * Metre}));
+    }
+  }
+
+  // The straightforward computation, as done by the scalar path of
+  // |Ephemeris|.
+  std::vector<Vector<Acceleration, World>> ComputeExpectedAccelerations(
+      std::vector<GravitationalParameter> const& gravitational_parameters,
+      std::vector<Position<World>> const& positions) {
+    std::vector<Vector<Acceleration, World>> accelerations(positions.size());
+    for (int b1 = 0; b1 < positions.size(); ++b1) {
+      for (int b2 = b1 + 1; b2 < positions.size(); ++b2) {
+        Displacement<World> const Δq = positions[b1] - positions[b2];
+        Square<Length> const Δq_squared = InnerProduct(Δq, Δq);
+        Exponentiation<Length, -3> const one_over_Δq_cubed =
+            Sqrt(Δq_squared) / (Δq_squared * Δq_squared);
+        accelerations[b2] +=
+            Δq * gravitational_parameters[b1] * one_over_Δq_cubed;
+        accelerations[b1] -=
+            Δq * gravitational_parameters[b2] * one_over_Δq_cubed;
+      }
+    }
+    return accelerations;
+  }
+};
+
+// Exercise all the sizes modulo the vector width.
+TEST_F(VectorizedGravitationTest, Sizes) {
+  for (int size = 2; size <= 3 * vector_width + 1; ++size) {
+    std::vector<GravitationalParameter> gravitational_parameters;
+    std::vector<Position<World>> positions;
+    MakeSystem(size, gravitational_parameters, positions);
+    auto const expected_accelerations =
+        ComputeExpectedAccelerations(gravitational_parameters, positions);
+
+    VectorizedGravitation<World> gravitation(gravitational_parameters);
+    std::vector<Vector<Acceleration, World>> accelerations(size);
+    gravitation.AddAccelerations(positions, /*begin=*/0, accelerations);
+    for (int i = 0; i < size; ++i) {
+      EXPECT_THAT(RelativeError(expected_accelerations[i], accelerations[i]),
+                  Lt(1e-14)) << size << " " << i;
+    }
+  }
+}
+
+TEST_F(VectorizedGravitationTest, SingleBody) {
+  std::vector<GravitationalParameter> gravitational_parameters;
+  std::vector<Position<World>> positions;
+  MakeSystem(/*size=*/1, gravitational_parameters, positions);
+
+  VectorizedGravitation<World> gravitation(gravitational_parameters);
+  std::vector<Vector<Acceleration, World>> accelerations(1);
+  gravitation.AddAccelerations(positions, /*begin=*/0, accelerations);
+  EXPECT_EQ((Vector<Acceleration, World>()), accelerations[0]);
+}
+
+// The accelerations are added to the ones already present, and the bodies
+// before |begin| are ignored.
+TEST_F(VectorizedGravitationTest, Offset) {
+  int const size = 11;
+  std::vector<GravitationalParameter> gravitational_parameters;
+  std::vector<Position<World>> positions;
+  MakeSystem(size, gravitational_parameters, positions);
+  auto const expected_accelerations =
+      ComputeExpectedAccelerations(gravitational_parameters, positions);
+
+  Vector<Acceleration, World> const offset_acceleration(
+      {1e-5 * Metre / Pow<2>(Second),
+       2e-5 * Metre / Pow<2>(Second),
+       3e-5 * Metre / Pow<2>(Second)});
+  std::vector<Position<World>> offset_positions(3, World::origin);
+  offset_positions.insert(
+      offset_positions.end(), positions.begin(), positions.end());
+  std::vector<Vector<Acceleration, World>> accelerations(size + 3,
+                                                         offset_acceleration);
+
+  VectorizedGravitation<World> gravitation(gravitational_parameters);
+  gravitation.AddAccelerations(offset_positions, /*begin=*/3, accelerations);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(offset_acceleration, accelerations[i]);
+  }
+  for (int i = 0; i < size; ++i) {
+    EXPECT_THAT(RelativeError(expected_accelerations[i] + offset_acceleration,
+                              accelerations[i + 3]),
+                Lt(1e-14)) << i;
+  }
+}
+
+}  // namespace internal_vectorized_gravitation
+}  // namespace physics
+}  // namespace principia
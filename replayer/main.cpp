@@ -0,0 +1,91 @@
+﻿
+// Replays a journal end to end and reports, for each profile, the number of
+// calls, the number of allocations, and the distribution of the latencies.
+// Replaying the same journal with two builds of the plugin and diffing the
+// outputs exposes regressions that only show in particular mixes of calls.
+//
+// replayer.exe JOURNAL.20170101-000000 csv|json [output_file]
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include "glog/logging.h"
+#include "journal/player.hpp"
+#include "journal/replay_statistics.hpp"
+
+namespace {
+
+std::atomic<std::int64_t> allocations(0);
+
+std::int64_t CountAllocations() {
+  return allocations.load(std::memory_order_relaxed);
+}
+
+}  // namespace
+
+// The allocations are counted by replacing the global |operator new|, which the
+// other forms of |operator new| call.  This only counts the allocations
+// performed by the plugin if it resolves |operator new| to this executable,
+// e.g., when it is a shared library on Linux; a Windows DLL has its own
+// allocator.  The |Player| samples the count around the call to the plugin, so
+// reading the journal is excluded, but converting the arguments of the method
+// is included.
+void* operator new(std::size_t const size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* const p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* const p) noexcept {
+  std::free(p);
+}
+
+int main(int argc, char const* argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  google::LogToStderr();
+  if (argc < 3 || argc > 4) {
+    std::cerr << "Usage: " << argv[0] << " journal csv|json [output_file]\n";
+    return 1;
+  }
+  std::string const journal = argv[1];
+  std::string const format = argv[2];
+  if (format != "csv" && format != "json") {
+    std::cerr << "Unknown format " << format << "\n";
+    return 2;
+  }
+
+  principia::journal::Player player(journal);
+  player.set_allocation_counter(&CountAllocations);
+  principia::journal::ReplayStatistics statistics;
+  std::int64_t count = 0;
+  while (player.Play()) {
+    statistics.Add(principia::journal::ReplayStatistics::ProfileName(
+                       player.last_method_in()),
+                   player.last_method_duration(),
+                   player.last_method_allocations());
+    ++count;
+    LOG_IF(INFO, (count % 100'000) == 0)
+        << count << " journal entries replayed";
+  }
+  LOG(INFO) << count << " journal entries in total";
+
+  std::ofstream file;
+  if (argc == 4) {
+    file.open(argv[3]);
+    CHECK(file.good()) << argv[3];
+  }
+  std::ostream& out = argc == 4 ? file : std::cout;
+  if (format == "csv") {
+    statistics.WriteCSV(out);
+  } else {
+    statistics.WriteJSON(out);
+  }
+  return 0;
+}
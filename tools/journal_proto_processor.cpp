@@ -234,6 +234,53 @@ void JournalProtoProcessor::ProcessRepeatedMessageField(
       [message_type_name](std::string const& expr) {
         return "Serialize" + message_type_name + "(" + expr + ")";
       };
+
+  // An out repeated field is a buffer provided by the caller, and the size
+  // parameter is its capacity.  If the method returns an int32, it is the
+  // number of elements that the interface wanted to write, and only the
+  // elements actually written are journalled: the return is filled before the
+  // out, so the bound is available.  Otherwise the entire buffer is
+  // journalled.  On replay a buffer with the journalled number of elements is
+  // passed to the interface, which gives it the same capacity as far as the
+  // written elements are concerned.
+  if (Contains(out_, descriptor)) {
+    CHECK(!Contains(in_out_, descriptor))
+        << descriptor->full_name() << " cannot be in-out";
+    field_cs_marshal_[descriptor] = "Out";
+    field_cxx_type_[descriptor] = message_type_name + "*";
+    field_cxx_arguments_fn_[descriptor] =
+        [](std::string const& identifier) -> std::vector<std::string> {
+          return {identifier + ".data()", identifier + ".size()"};
+        };
+    Descriptor const* const return_descriptor =
+        descriptor->containing_type()->containing_type()->FindNestedTypeByName(
+            return_message_name);
+    if (return_descriptor != nullptr &&
+        return_descriptor->field(0)->type() == FieldDescriptor::TYPE_INT32) {
+      std::string const return_field_name = return_descriptor->field(0)->name();
+      field_cxx_assignment_fn_[descriptor] =
+          [this, descriptor, message_type_name, return_field_name](
+              std::string const& prefix, std::string const& expr) {
+            std::string const& descriptor_name = descriptor->name();
+            // Same cheat as above.
+            std::string const size = expr.substr(0, expr.find('.')) + "." +
+                                     size_member_name_[descriptor];
+            std::string const written = descriptor_name + "_written";
+            return "  int const " + written + " =\n"
+                   "      message->has_return_()\n"
+                   "          ? std::min(message->return_()." +
+                   return_field_name + "(), " + size + ")\n"
+                   "          : " + size + ";\n"
+                   "  for (" + message_type_name + " const* " +
+                   descriptor_name + " = " + expr + "; " + descriptor_name +
+                   " < " + expr + " + " + written + "; ++" + descriptor_name +
+                   ") {\n    *" + prefix + "add_" + descriptor_name +
+                   "() = " +
+                   field_cxx_serializer_fn_[descriptor]("*" + descriptor_name) +
+                   ";\n  }\n";
+          };
+    }
+  }
 }
 
 void JournalProtoProcessor::ProcessOptionalNonStringField(
@@ -704,7 +751,13 @@ void JournalProtoProcessor::ProcessInOut(
       std::copy(field_arguments.begin(), field_arguments.end(),
                 std::back_inserter(cxx_run_arguments_[descriptor]));
 
-      if (Contains(out_, field_descriptor)) {
+      if (Contains(out_, field_descriptor) && field_descriptor->is_repeated()) {
+        // A buffer with the capacity recorded in the journal.
+        cxx_run_body_prolog_[descriptor] +=
+            "  std::vector<" + field_descriptor->message_type()->name() +
+            "> " + run_local_variable + "(" + ToLower(name) + "." +
+            field_descriptor_name + "_size());\n";
+      } else if (Contains(out_, field_descriptor)) {
         cxx_run_body_prolog_[descriptor] +=
             "  " + field_cxx_type_[field_descriptor] + " " +
             run_local_variable + ";\n";